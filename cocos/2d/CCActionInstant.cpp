@@ -31,6 +31,10 @@
 
 
 NS_CC_BEGIN
+
+CC_IMPLEMENT_OBJECT_POOL(CallFunc, 64)
+CC_IMPLEMENT_OBJECT_POOL(CallFuncN, 64)
+
 //
 // InstantAction
 //
@@ -30,6 +30,7 @@ THE SOFTWARE.
 
 #include <functional>
 #include "2d/CCAction.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 NS_CC_BEGIN
 
@@ -291,6 +292,8 @@ private:
 class CC_DLL CallFunc : public ActionInstant //<NSCopying>
 {
 public:
+    CC_USE_OBJECT_POOL(CallFunc);
+
     /** creates the action with the callback of type std::function<void()>.
      This is the preferred way to create the callback.
      * When this funtion bound in js or lua ,the input param will be changed
@@ -381,6 +384,8 @@ N means Node
 class CC_DLL CallFuncN : public CallFunc
 {
 public:
+    CC_USE_OBJECT_POOL(CallFuncN);
+
     /** creates the action with the callback of type std::function<void()>.
      This is the preferred way to create the callback.
      */
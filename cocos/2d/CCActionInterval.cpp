@@ -40,6 +40,22 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+CC_IMPLEMENT_OBJECT_POOL(Sequence, 64)
+CC_IMPLEMENT_OBJECT_POOL(Repeat, 64)
+CC_IMPLEMENT_OBJECT_POOL(RepeatForever, 64)
+CC_IMPLEMENT_OBJECT_POOL(Spawn, 64)
+CC_IMPLEMENT_OBJECT_POOL(RotateTo, 64)
+CC_IMPLEMENT_OBJECT_POOL(RotateBy, 64)
+CC_IMPLEMENT_OBJECT_POOL(MoveBy, 64)
+CC_IMPLEMENT_OBJECT_POOL(MoveTo, 64)
+CC_IMPLEMENT_OBJECT_POOL(ScaleTo, 64)
+CC_IMPLEMENT_OBJECT_POOL(ScaleBy, 64)
+CC_IMPLEMENT_OBJECT_POOL(FadeTo, 64)
+CC_IMPLEMENT_OBJECT_POOL(FadeIn, 64)
+CC_IMPLEMENT_OBJECT_POOL(FadeOut, 64)
+CC_IMPLEMENT_OBJECT_POOL(TintTo, 64)
+CC_IMPLEMENT_OBJECT_POOL(DelayTime, 64)
+
 // Extra action for making a Sequence or Spawn when only adding one action to it.
 class ExtraAction : public FiniteTimeAction
 {
@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "2d/CCAnimation.h"
 #include "base/CCProtocols.h"
 #include "base/CCVector.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 NS_CC_BEGIN
 
@@ -108,6 +109,8 @@ protected:
 class CC_DLL Sequence : public ActionInterval
 {
 public:
+    CC_USE_OBJECT_POOL(Sequence);
+
     /** helper constructor to create an array of sequenceable actions */
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
     // WP8 in VS2012 does not support nullptr in variable args lists and variadic templates are also not supported
@@ -176,6 +179,8 @@ private:
 class CC_DLL Repeat : public ActionInterval
 {
 public:
+    CC_USE_OBJECT_POOL(Repeat);
+
     /** creates a Repeat action. Times is an unsigned integer between 1 and pow(2,30) */
     static Repeat* create(FiniteTimeAction *action, unsigned int times);
 
@@ -233,6 +238,8 @@ To repeat the an action for a limited number of times use the Repeat action.
 class CC_DLL RepeatForever : public ActionInterval
 {
 public:
+    CC_USE_OBJECT_POOL(RepeatForever);
+
     /** creates the action */
     static RepeatForever* create(ActionInterval *action);
 
@@ -285,6 +292,8 @@ private:
 class CC_DLL Spawn : public ActionInterval
 {
 public:
+    CC_USE_OBJECT_POOL(Spawn);
+
     /** helper constructor to create an array of spawned actions 
      * @code
      * When this funtion bound to the js or lua,the input params changed
@@ -355,6 +364,8 @@ private:
 class CC_DLL RotateTo : public ActionInterval
 {
 public:
+    CC_USE_OBJECT_POOL(RotateTo);
+
     /** 
      * creates the action with separate rotation angles
      * @param duration in seconds
@@ -425,6 +436,8 @@ private:
 class CC_DLL RotateBy : public ActionInterval
 {
 public:
+    CC_USE_OBJECT_POOL(RotateBy);
+
     /** 
      * creates the action
      * @param duration in seconds
@@ -486,6 +499,8 @@ private:
 class CC_DLL MoveBy : public ActionInterval
 {
 public:
+    CC_USE_OBJECT_POOL(MoveBy);
+
     /** 
      * creates the action
      * @param duration in seconds
@@ -534,6 +549,8 @@ private:
 class CC_DLL MoveTo : public MoveBy
 {
 public:
+    CC_USE_OBJECT_POOL(MoveTo);
+
     /** 
      * creates the action
      * @param duration in seconds
@@ -828,6 +845,8 @@ private:
 class CC_DLL ScaleTo : public ActionInterval
 {
 public:
+    CC_USE_OBJECT_POOL(ScaleTo);
+
     /** 
      * creates the action with the same scale factor for X and Y
      * @param duration in seconds
@@ -901,6 +920,8 @@ private:
 class CC_DLL ScaleBy : public ScaleTo
 {
 public:
+    CC_USE_OBJECT_POOL(ScaleBy);
+
     /** 
      * creates the action with the same scale factor for X and Y 
      * @param duration in seconds
@@ -982,6 +1003,8 @@ private:
 class CC_DLL FadeTo : public ActionInterval
 {
 public:
+    CC_USE_OBJECT_POOL(FadeTo);
+
     /** 
      * creates an action with duration and opacity 
      * @param duration in seconds
@@ -1024,6 +1047,8 @@ private:
 class CC_DLL FadeIn : public FadeTo
 {
 public:
+    CC_USE_OBJECT_POOL(FadeIn);
+
     /** 
      * creates the action
      * @param d in seconds
@@ -1054,6 +1079,8 @@ private:
 class CC_DLL FadeOut : public FadeTo
 {
 public:
+    CC_USE_OBJECT_POOL(FadeOut);
+
     /** 
      * creates the action 
      * @param d in seconds
@@ -1083,6 +1110,8 @@ private:
 class CC_DLL TintTo : public ActionInterval
 {
 public:
+    CC_USE_OBJECT_POOL(TintTo);
+
     /** 
      * creates an action with duration and color 
      * @param duration in seconds
@@ -1168,6 +1197,8 @@ private:
 class CC_DLL DelayTime : public ActionInterval
 {
 public:
+    CC_USE_OBJECT_POOL(DelayTime);
+
     /** 
      * creates the action 
      * @param d in seconds
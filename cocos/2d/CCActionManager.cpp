@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "2d/CCAction.h"
 #include "base/CCScheduler.h"
 #include "base/ccMacros.h"
+#include "base/CCFrameProfiler.h"
 #include "base/ccCArray.h"
 #include "base/uthash.h"
 
@@ -368,6 +369,8 @@ ssize_t ActionManager::getNumberOfRunningActionsInTarget(const Node *target) con
 // main loop
 void ActionManager::update(float dt)
 {
+    CC_PROFILE_ZONE("ActionManager::update");
+    
     for (tHashElement *elt = _targets; elt != nullptr; )
     {
         _currentTarget = elt;
@@ -39,6 +39,27 @@ _usedGlyphs(GlyphCollection::ASCII)
 {
 }
 
+void Font::computeHorizontalKernings(const std::u16string& text, int* kernings, int firstLetter) const
+{
+    int letterCount = 0;
+    int* sizes = getHorizontalKerningForTextUTF16(text, letterCount);
+    if (sizes)
+    {
+        for (int i = firstLetter; i < letterCount; ++i)
+        {
+            kernings[i] = sizes[i];
+        }
+        delete [] sizes;
+    }
+    else
+    {
+        for (int i = firstLetter; i < static_cast<int>(text.length()); ++i)
+        {
+            kernings[i] = 0;
+        }
+    }
+}
+
 const char * Font::getGlyphCollection(GlyphCollection glyphs) const
 {
     switch (glyphs)
@@ -43,6 +43,13 @@ public:
     virtual  FontAtlas *createFontAtlas() = 0;
 
     virtual int* getHorizontalKerningForTextUTF16(const std::u16string& text, int &outNumLetters) const = 0;
+
+    /** Computes the kernings of the letters of a string from firstLetter on, the ones before are kept.
+     The kerning of a letter depends on its neighbours, so when the end of a string changes,
+     its kernings are computed again from the letter before the first different letter.
+     @param kernings the text.length() kernings of the string
+     */
+    virtual void computeHorizontalKernings(const std::u16string& text, int* kernings, int firstLetter) const;
     virtual const char* getCurrentGlyphCollection() const;
     
     
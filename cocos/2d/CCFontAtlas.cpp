@@ -30,6 +30,10 @@
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventType.h"
+#include "base/CCJobSystem.h"
+#include "base/CCFrameProfiler.h"
+
+#include <algorithm>
 
 
 NS_CC_BEGIN
@@ -38,10 +42,17 @@ const int FontAtlas::CacheTextureWidth = 512;
 const int FontAtlas::CacheTextureHeight = 512;
 const char* FontAtlas::CMD_PURGE_FONTATLAS = "__cc_PURGE_FONTATLAS";
 const char* FontAtlas::CMD_RESET_FONTATLAS = "__cc_RESET_FONTATLAS";
+const char* FontAtlas::CMD_UPDATE_FONTATLAS = "__cc_UPDATE_FONTATLAS";
 
 FontAtlas::FontAtlas(Font &theFont) 
 : _font(&theFont)
 , _currentPageData(nullptr)
+, _bytesPerPixel(1)
+, _nextShelfY(0)
+, _dirtyTop(CacheTextureHeight)
+, _dirtyBottom(0)
+, _asyncRasterization(false)
+, _tabularDigits(-1)
 , _fontAscender(0)
 , _rendererRecreatedListener(nullptr)
 , _antialiasEnabled(true)
@@ -55,8 +66,6 @@ FontAtlas::FontAtlas(Font &theFont)
         _fontAscender = fontTTf->getFontAscender();
         auto texture = new (std::nothrow) Texture2D;
         _currentPage = 0;
-        _currentPageOrigX = 0;
-        _currentPageOrigY = 0;
         _letterPadding = 0;
 
         if(fontTTf->isDistanceFieldEnabled())
@@ -69,6 +78,7 @@ FontAtlas::FontAtlas(Font &theFont)
         {
             _commonLineHeight += 2 * outlineSize;
             _currentPageDataSize *= 2;
+            _bytesPerPixel = 2;
         }    
 
         _currentPageData = new unsigned char[_currentPageDataSize];
@@ -160,136 +170,291 @@ bool FontAtlas::getLetterDefinitionForChar(char16_t letteCharUTF16, FontLetterDe
     }
 }
 
+std::vector<unsigned short> FontAtlas::getMissingLetters(const std::u16string& utf16String, bool skipPending) const
+{
+    std::vector<unsigned short> letters;
+    for (auto letter : utf16String)
+    {
+        if (_fontLetterDefinitions.find(letter) == _fontLetterDefinitions.end()
+            && !(skipPending && _pendingLetters.find(letter) != _pendingLetters.end()))
+        {
+            letters.push_back(letter);
+        }
+    }
+    std::sort(letters.begin(), letters.end());
+    letters.erase(std::unique(letters.begin(), letters.end()), letters.end());
+    return letters;
+}
+
 bool FontAtlas::prepareLetterDefinitions(const std::u16string& utf16String)
 {
     FontFreeType* fontTTf = dynamic_cast<FontFreeType*>(_font);
     if(fontTTf == nullptr)
         return false;
-    
-    size_t length = utf16String.length();
 
-    float offsetAdjust = _letterPadding / 2;  
-    long bitmapWidth;
-    long bitmapHeight;
-    Rect tempRect;
-    FontLetterDefinition tempDef;
+    auto letters = getMissingLetters(utf16String, true);
+    if (letters.empty())
+        return true;
+
+    if (_asyncRasterization)
+    {
+        rasterizeLettersAsync(letters, nullptr);
+        return true;
+    }
 
-    auto scaleFactor = CC_CONTENT_SCALE_FACTOR();
-    auto  pixelFormat = fontTTf->getOutlineSize() > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8; 
+    CC_PROFILE_ZONE("FontAtlas::prepareLetterDefinitions");
+    FontFreeType::RasterizedGlyph glyph;
+    for (auto letter : letters)
+    {
+        fontTTf->rasterizeGlyph(letter, glyph);
+        addGlyph(letter, glyph.rect, glyph.xAdvance, glyph.pixels.empty() ? nullptr : glyph.pixels.data(), glyph.width, glyph.height);
+    }
+    uploadDirtyRows();
+    return true;
+}
 
-    bool existNewLetter = false;
-    int bottomHeight = _commonLineHeight - _fontAscender;
+void FontAtlas::prewarmLetterDefinitions(const std::u16string& utf16String, const std::function<void()>& callback)
+{
+    FontFreeType* fontTTf = dynamic_cast<FontFreeType*>(_font);
 
-    float startY = _currentPageOrigY;
+    // the letters already being rasterized are rasterized again, so that the callback waits for them
+    std::vector<unsigned short> letters;
+    if (fontTTf)
+    {
+        letters = getMissingLetters(utf16String, false);
+    }
 
-    for (size_t i = 0; i < length; ++i)
+    if (letters.empty())
     {
-        auto outIterator = _fontLetterDefinitions.find(utf16String[i]);
+        if (callback)
+            callback();
+        return;
+    }
+    rasterizeLettersAsync(letters, callback);
+}
 
-        if (outIterator == _fontLetterDefinitions.end())
-        {  
-            existNewLetter = true;
+void FontAtlas::prewarmLetterDefinitions(const std::string& utf8String, const std::function<void()>& callback)
+{
+    std::u16string utf16String;
+    StringUtils::UTF8ToUTF16(utf8String, utf16String);
+    prewarmLetterDefinitions(utf16String, callback);
+}
 
-            auto bitmap = fontTTf->getGlyphBitmap(utf16String[i],bitmapWidth,bitmapHeight,tempRect,tempDef.xAdvance);
-            if (bitmap)
+void FontAtlas::rasterizeLettersAsync(const std::vector<unsigned short>& letters, const std::function<void()>& callback)
+{
+    FontFreeType* fontTTf = static_cast<FontFreeType*>(_font);
+    _pendingLetters.insert(letters.begin(), letters.end());
+
+    // the atlas and its font live until the glyphs are added
+    retain();
+    auto glyphs = std::make_shared<std::vector<FontFreeType::RasterizedGlyph>>(letters.size());
+    JobSystem::getInstance()->schedule([fontTTf, letters, glyphs]() {
+        CC_PROFILE_ZONE("FontAtlas::rasterizeLetters");
+        for (size_t i = 0; i < letters.size(); ++i)
+        {
+            fontTTf->rasterizeGlyph(letters[i], (*glyphs)[i]);
+        }
+    }, [this, glyphs, callback]() {
+        for (const auto& glyph : *glyphs)
+        {
+            _pendingLetters.erase(glyph.charUTF16);
+            if (_fontLetterDefinitions.find(glyph.charUTF16) == _fontLetterDefinitions.end())
             {
-                tempDef.validDefinition = true;
-                tempDef.letteCharUTF16   = utf16String[i];
-                tempDef.width            = tempRect.size.width + _letterPadding;
-                tempDef.height           = tempRect.size.height + _letterPadding;
-                tempDef.offsetX          = tempRect.origin.x + offsetAdjust;
-                tempDef.offsetY          = _fontAscender + tempRect.origin.y - offsetAdjust;
-                tempDef.clipBottom     = bottomHeight - (tempDef.height + tempRect.origin.y + offsetAdjust);
-
-                if (_currentPageOrigX + tempDef.width > CacheTextureWidth)
-                {
-                    _currentPageOrigY += _commonLineHeight;
-                    _currentPageOrigX = 0;
-                    if(_currentPageOrigY + _commonLineHeight >= CacheTextureHeight)
-                    {
-                        unsigned char *data = nullptr;
-                        if(pixelFormat == Texture2D::PixelFormat::AI88)
-                        {
-                            data = _currentPageData + CacheTextureWidth * (int)startY * 2;
-                        }
-                        else
-                        {
-                            data = _currentPageData + CacheTextureWidth * (int)startY;
-                        }
-                        _atlasTextures[_currentPage]->updateWithData(data, 0, startY, 
-                            CacheTextureWidth, CacheTextureHeight - startY);
-
-                        startY = 0.0f;
-
-                        _currentPageOrigY = 0;
-                        memset(_currentPageData, 0, _currentPageDataSize);
-                        _currentPage++;
-                        auto tex = new (std::nothrow) Texture2D;
-                        if (_antialiasEnabled)
-                        {
-                            tex->setAntiAliasTexParameters();
-                        } 
-                        else
-                        {
-                            tex->setAliasTexParameters();
-                        }
-                        tex->initWithData(_currentPageData, _currentPageDataSize, 
-                            pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth,CacheTextureHeight) );
-                        addTexture(tex,_currentPage);
-                        tex->release();
-                    }  
-                }
-                fontTTf->renderCharAt(_currentPageData,_currentPageOrigX,_currentPageOrigY,bitmap,bitmapWidth,bitmapHeight);
-
-                tempDef.U                = _currentPageOrigX;
-                tempDef.V                = _currentPageOrigY;
-                tempDef.textureID        = _currentPage;
-                _currentPageOrigX        += tempDef.width + 1;
-                // take from pixels to points
-                tempDef.width  =    tempDef.width  / scaleFactor;
-                tempDef.height =    tempDef.height / scaleFactor;      
-                tempDef.U      =    tempDef.U      / scaleFactor;
-                tempDef.V      =    tempDef.V      / scaleFactor;
-            }
-            else{
-                if(tempDef.xAdvance)
-                    tempDef.validDefinition = true;
-                else
-                    tempDef.validDefinition = false;
-
-                tempDef.letteCharUTF16   = utf16String[i];
-                tempDef.width            = 0;
-                tempDef.height           = 0;
-                tempDef.U                = 0;
-                tempDef.V                = 0;
-                tempDef.offsetX          = 0;
-                tempDef.offsetY          = 0;
-                tempDef.textureID        = 0;
-                tempDef.clipBottom = 0;
-                _currentPageOrigX += 1;
+                addGlyph(glyph.charUTF16, glyph.rect, glyph.xAdvance, glyph.pixels.empty() ? nullptr : glyph.pixels.data(), glyph.width, glyph.height);
             }
+        }
+        uploadDirtyRows();
 
-            _fontLetterDefinitions[tempDef.letteCharUTF16] = tempDef;
-        }       
-    }
+        Director::getInstance()->getEventDispatcher()->dispatchCustomEvent(CMD_UPDATE_FONTATLAS, this);
+        if (callback)
+            callback();
+        release();
+    });
+}
+
+void FontAtlas::addGlyph(unsigned short letter, const Rect& rect, int xAdvance, const unsigned char* pixels, long pixelsWidth, long pixelsHeight)
+{
+    FontLetterDefinition tempDef;
+    tempDef.letteCharUTF16 = letter;
+    tempDef.xAdvance = xAdvance;
+
+    int glyphX = 0;
+    int glyphY = 0;
+    int glyphWidth = std::max((int)ceilf(rect.size.width + _letterPadding), (int)pixelsWidth);
+    int glyphHeight = std::max((int)ceilf(rect.size.height + _letterPadding), (int)pixelsHeight);
 
-    if(existNewLetter)
+    if (pixels && allocateGlyph(glyphWidth, glyphHeight, glyphX, glyphY))
+    {
+        float offsetAdjust = _letterPadding / 2;
+        int bottomHeight = _commonLineHeight - _fontAscender;
+        auto scaleFactor = CC_CONTENT_SCALE_FACTOR();
+
+        tempDef.validDefinition = true;
+        tempDef.width            = rect.size.width + _letterPadding;
+        tempDef.height           = rect.size.height + _letterPadding;
+        tempDef.offsetX          = rect.origin.x + offsetAdjust;
+        tempDef.offsetY          = _fontAscender + rect.origin.y - offsetAdjust;
+        tempDef.clipBottom     = bottomHeight - (tempDef.height + rect.origin.y + offsetAdjust);
+
+        size_t rowSize = pixelsWidth * _bytesPerPixel;
+        for (long y = 0; y < pixelsHeight; ++y)
+        {
+            memcpy(_currentPageData + ((glyphY + y) * CacheTextureWidth + glyphX) * _bytesPerPixel, pixels + y * rowSize, rowSize);
+        }
+        _dirtyTop = std::min(_dirtyTop, glyphY);
+        _dirtyBottom = std::max(_dirtyBottom, glyphY + glyphHeight);
+
+        tempDef.U                = glyphX;
+        tempDef.V                = glyphY;
+        tempDef.textureID        = _currentPage;
+        // take from pixels to points
+        tempDef.width  =    tempDef.width  / scaleFactor;
+        tempDef.height =    tempDef.height / scaleFactor;      
+        tempDef.U      =    tempDef.U      / scaleFactor;
+        tempDef.V      =    tempDef.V      / scaleFactor;
+    }
+    else
     {
-        unsigned char *data = nullptr;
-        if(pixelFormat == Texture2D::PixelFormat::AI88)
+        if (pixels)
         {
-            data = _currentPageData + CacheTextureWidth * (int)startY * 2;
+            CCLOG("cocos2d: FontAtlas: the glyph of %d doesn't fit in a page", letter);
         }
+
+        if(tempDef.xAdvance)
+            tempDef.validDefinition = true;
         else
+            tempDef.validDefinition = false;
+
+        tempDef.width            = 0;
+        tempDef.height           = 0;
+        tempDef.U                = 0;
+        tempDef.V                = 0;
+        tempDef.offsetX          = 0;
+        tempDef.offsetY          = 0;
+        tempDef.textureID        = 0;
+        tempDef.clipBottom = 0;
+    }
+
+    _fontLetterDefinitions[letter] = tempDef;
+}
+
+bool FontAtlas::allocateGlyph(int width, int height, int& outX, int& outY)
+{
+    if (width > CacheTextureWidth || height > CacheTextureHeight)
+        return false;
+
+    // the shelf that wastes the least height
+    Shelf* best = nullptr;
+    for (auto& shelf : _shelves)
+    {
+        if (shelf.x + width <= CacheTextureWidth && height <= shelf.height
+            && (best == nullptr || shelf.height < best->height))
+        {
+            best = &shelf;
+        }
+    }
+
+    // a new shelf rather than a shelf more than twice as high as the glyph
+    int shelfHeight = std::min(std::max((height + 3) & ~3, 4), CacheTextureHeight);
+    bool roomForShelf = _nextShelfY + shelfHeight <= CacheTextureHeight;
+    if (best == nullptr || (best->height > 2 * height && roomForShelf))
+    {
+        if (!roomForShelf)
         {
-            data = _currentPageData + CacheTextureWidth * (int)startY;
+            startNewPage();
         }
-        _atlasTextures[_currentPage]->updateWithData(data, 0, startY,
-                                                     CacheTextureWidth, _currentPageOrigY - startY + _commonLineHeight);
+
+        Shelf shelf = { 0, _nextShelfY, shelfHeight };
+        _shelves.push_back(shelf);
+        _nextShelfY += shelfHeight + 1;
+        best = &_shelves.back();
     }
+
+    outX = best->x;
+    outY = best->y;
+    best->x += width + 1;
     return true;
 }
 
+void FontAtlas::startNewPage()
+{
+    uploadDirtyRows();
+
+    _shelves.clear();
+    _nextShelfY = 0;
+    memset(_currentPageData, 0, _currentPageDataSize);
+    _currentPage++;
+
+    auto  pixelFormat = _bytesPerPixel == 2 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8; 
+    auto tex = new (std::nothrow) Texture2D;
+    if (_antialiasEnabled)
+    {
+        tex->setAntiAliasTexParameters();
+    } 
+    else
+    {
+        tex->setAliasTexParameters();
+    }
+    tex->initWithData(_currentPageData, _currentPageDataSize, 
+        pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth,CacheTextureHeight) );
+    addTexture(tex,_currentPage);
+    tex->release();
+}
+
+void FontAtlas::uploadDirtyRows()
+{
+    if (_dirtyBottom > _dirtyTop)
+    {
+        unsigned char *data = _currentPageData + CacheTextureWidth * _dirtyTop * _bytesPerPixel;
+        _atlasTextures[_currentPage]->updateWithData(data, 0, _dirtyTop, CacheTextureWidth, _dirtyBottom - _dirtyTop);
+    }
+    _dirtyTop = CacheTextureHeight;
+    _dirtyBottom = 0;
+}
+
+bool FontAtlas::hasTabularDigits()
+{
+    if (_tabularDigits < 0)
+    {
+        int xAdvance = 0;
+        for (char16_t digit = '0'; digit <= '9'; ++digit)
+        {
+            auto iter = _fontLetterDefinitions.find(digit);
+            if (iter == _fontLetterDefinitions.end())
+                return false;
+
+            if (digit == '0')
+            {
+                xAdvance = iter->second.xAdvance;
+            }
+            if (iter->second.xAdvance != xAdvance || !iter->second.validDefinition)
+            {
+                _tabularDigits = 0;
+                return false;
+            }
+        }
+
+        // every pair of digits
+        _tabularDigits = 1;
+        std::u16string pairs(2, '0');
+        int kernings[2];
+        for (char16_t first = '0'; first <= '9' && _tabularDigits; ++first)
+        {
+            for (char16_t second = '0'; second <= '9' && _tabularDigits; ++second)
+            {
+                pairs[0] = first;
+                pairs[1] = second;
+                _font->computeHorizontalKernings(pairs, kernings, 0);
+                if (kernings[0] != 0 || kernings[1] != 0)
+                {
+                    _tabularDigits = 0;
+                }
+            }
+        }
+    }
+    return _tabularDigits == 1;
+}
+
 void FontAtlas::addTexture(Texture2D *texture, int slot)
 {
     texture->retain();
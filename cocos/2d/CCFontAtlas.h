@@ -25,11 +25,15 @@
 #ifndef _CCFontAtlas_h_
 #define _CCFontAtlas_h_
 
+#include <functional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "platform/CCPlatformMacros.h"
 #include "base/CCRef.h"
+#include "math/CCGeometry.h"
 #include "platform/CCStdC.h" // ssize_t on windows
 
 NS_CC_BEGIN
@@ -63,6 +67,8 @@ public:
     static const int CacheTextureHeight;
     static const char* CMD_PURGE_FONTATLAS;
     static const char* CMD_RESET_FONTATLAS;
+    /** dispatched with the atlas once letters rasterized by the workers were added to it */
+    static const char* CMD_UPDATE_FONTATLAS;
     /**
      * @js ctor
      */
@@ -76,8 +82,30 @@ public:
     void addLetterDefinition(const FontLetterDefinition &letterDefinition);
     bool getLetterDefinitionForChar(char16_t letteCharUTF16, FontLetterDefinition &outDefinition);
     
+    /** Adds the missing letters of a string to the atlas.
+     With the asynchronous rasterization, the missing letters have no definition until the workers
+     rasterized them, then CMD_UPDATE_FONTATLAS is dispatched so that the labels are laid out again.
+     */
     bool prepareLetterDefinitions(const std::u16string& utf16String);
 
+    /** Rasterizes the missing letters of a string by the JobSystem workers, to fill the atlas during loading.
+     The callback is called on the main thread once all the letters are in the atlas.
+     */
+    void prewarmLetterDefinitions(const std::u16string& utf16String, const std::function<void()>& callback = nullptr);
+    void prewarmLetterDefinitions(const std::string& utf8String, const std::function<void()>& callback = nullptr);
+
+    /** Returns whether the digits are in the atlas, have the same advance and no kerning between them:
+     a counter can then be updated by replacing its changed digits only.
+     */
+    bool hasTabularDigits();
+
+    /** Whether prepareLetterDefinitions leaves the rasterization of the missing letters to the JobSystem workers. false by default */
+    void setAsyncRasterization(bool async) { _asyncRasterization = async; }
+    bool isAsyncRasterization() const { return _asyncRasterization; }
+
+    /** Whether a letter is being rasterized by the workers, it has no definition until then */
+    bool isLetterPending(char16_t letter) const { return _pendingLetters.find(letter) != _pendingLetters.end(); }
+
     inline const std::unordered_map<ssize_t, Texture2D*>& getTextures() const{ return _atlasTextures;}
     void  addTexture(Texture2D *texture, int slot);
     float getCommonLineHeight() const;
@@ -109,7 +137,27 @@ public:
      void setAliasTexParameters();
 
 protected:
+    // the rows of a page hold the glyphs of similar heights
+    struct Shelf
+    {
+        int x;
+        int y;
+        int height;
+    };
+
     void relaseTextures();
+
+    std::vector<unsigned short> getMissingLetters(const std::u16string& utf16String, bool skipPending) const;
+    void rasterizeLettersAsync(const std::vector<unsigned short>& letters, const std::function<void()>& callback);
+
+    /* Adds the definition of a rasterized glyph and copies its pixels to the current page */
+    void addGlyph(unsigned short letter, const Rect& rect, int xAdvance, const unsigned char* pixels, long pixelsWidth, long pixelsHeight);
+    /* Finds the room of a glyph in the shelves of the current page, starts a new page when it is full */
+    bool allocateGlyph(int width, int height, int& outX, int& outY);
+    void startNewPage();
+    /* Uploads the rows of the current page changed since the last upload */
+    void uploadDirtyRows();
+
     std::unordered_map<ssize_t, Texture2D*> _atlasTextures;
     std::unordered_map<unsigned short, FontLetterDefinition> _fontLetterDefinitions;
     float _commonLineHeight;
@@ -119,9 +167,18 @@ protected:
     int _currentPage;
     unsigned char *_currentPageData;
     int _currentPageDataSize;
-    float _currentPageOrigX;
-    float _currentPageOrigY;
     float _letterPadding;
+    int _bytesPerPixel;
+    std::vector<Shelf> _shelves;
+    int _nextShelfY;
+    int _dirtyTop;
+    int _dirtyBottom;
+
+    bool _asyncRasterization;
+    // -1 until the digits are in the atlas, see hasTabularDigits
+    int _tabularDigits;
+    // the letters being rasterized by the workers
+    std::unordered_set<unsigned short> _pendingLetters;
 
     int _fontAscender;
     EventListenerCustom* _rendererRecreatedListener;
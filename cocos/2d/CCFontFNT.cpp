@@ -698,6 +698,18 @@ int * FontFNT::getHorizontalKerningForTextUTF16(const std::u16string& text, int
     return sizes;
 }
 
+void FontFNT::computeHorizontalKernings(const std::u16string& text, int* kernings, int firstLetter) const
+{
+    int letterCount = static_cast<int>(text.length());
+    for (int c = firstLetter; c < letterCount; ++c)
+    {
+        if (c < (letterCount-1))
+            kernings[c] = getHorizontalKerningForChars(text[c], text[c+1]);
+        else
+            kernings[c] = 0;
+    }
+}
+
 int  FontFNT::getHorizontalKerningForChars(unsigned short firstChar, unsigned short secondChar) const
 {
     int ret = 0;
@@ -43,6 +43,7 @@ public:
     */
     static void purgeCachedData();
     virtual int* getHorizontalKerningForTextUTF16(const std::u16string& text, int &outNumLetters) const override;
+    virtual void computeHorizontalKernings(const std::u16string& text, int* kernings, int firstLetter) const override;
     virtual FontAtlas *createFontAtlas() override;
     
 protected:
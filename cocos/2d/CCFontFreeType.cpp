@@ -25,6 +25,8 @@ THE SOFTWARE.
 
 #include "2d/CCFontFreeType.h"
 
+#include <mutex>
+
 #include "base/CCDirector.h"
 #include "base/ccUTF8.h"
 #include "platform/CCFileUtils.h"
@@ -46,6 +48,9 @@ typedef struct _DataRef
 
 static std::unordered_map<std::string, DataRef> s_cacheFontData;
 
+// the library and the faces are used by the glyph rasterization jobs, FreeType isn't thread safe
+static std::mutex s_freeTypeMutex;
+
 FontFreeType * FontFreeType::create(const std::string &fontName, int fontSize, GlyphCollection glyphs, const char *customGlyphs,bool distanceFieldEnabled /* = false */,int outline /* = 0 */)
 {
     FontFreeType *tempFont =  new FontFreeType(distanceFieldEnabled,outline);
@@ -132,6 +137,7 @@ bool FontFreeType::createFontObject(const std::string &fontName, int fontSize)
         }
     }
 
+    std::lock_guard<std::mutex> lock(s_freeTypeMutex);
     if (FT_New_Memory_Face(getFTLibrary(), s_cacheFontData[fontName].data.getBytes(), s_cacheFontData[fontName].data.getSize(), 0, &face ))
         return false;
     
@@ -154,6 +160,7 @@ bool FontFreeType::createFontObject(const std::string &fontName, int fontSize)
 
 FontFreeType::~FontFreeType()
 {
+    std::unique_lock<std::mutex> lock(s_freeTypeMutex);
     if (_stroker)
     {
         FT_Stroker_Done(_stroker);
@@ -162,6 +169,7 @@ FontFreeType::~FontFreeType()
     {
         FT_Done_Face(_fontRef);
     }
+    lock.unlock();
 
     s_cacheFontData[_fontName].referenceCount -= 1;
     if (s_cacheFontData[_fontName].referenceCount == 0)
@@ -203,6 +211,7 @@ int * FontFreeType::getHorizontalKerningForTextUTF16(const std::u16string& text,
     bool hasKerning = FT_HAS_KERNING( _fontRef ) != 0;
     if (hasKerning)
     {
+        std::lock_guard<std::mutex> lock(s_freeTypeMutex);
         for (int c = 1; c < outNumLetters; ++c)
         {
             sizes[c] = getHorizontalKerningForChars(text[c-1], text[c]);
@@ -212,6 +221,32 @@ int * FontFreeType::getHorizontalKerningForTextUTF16(const std::u16string& text,
     return sizes;
 }
 
+void FontFreeType::computeHorizontalKernings(const std::u16string& text, int* kernings, int firstLetter) const
+{
+    int letterCount = static_cast<int>(text.length());
+    if (firstLetter == 0 && letterCount > 0)
+    {
+        kernings[0] = 0;
+        firstLetter = 1;
+    }
+
+    bool hasKerning = _fontRef && FT_HAS_KERNING( _fontRef ) != 0;
+    if (!hasKerning)
+    {
+        for (int c = firstLetter; c < letterCount; ++c)
+        {
+            kernings[c] = 0;
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(s_freeTypeMutex);
+    for (int c = firstLetter; c < letterCount; ++c)
+    {
+        kernings[c] = getHorizontalKerningForChars(text[c-1], text[c]);
+    }
+}
+
 int  FontFreeType::getHorizontalKerningForChars(unsigned short firstChar, unsigned short secondChar) const
 {
     // get the ID to the char we need
@@ -484,6 +519,39 @@ unsigned char * makeDistanceMap( unsigned char *img, long width, long height)
     return out;
 }
 
+void FontFreeType::rasterizeGlyph(unsigned short theChar, RasterizedGlyph& outGlyph)
+{
+    outGlyph.charUTF16 = theChar;
+    outGlyph.pixels.clear();
+
+    std::unique_lock<std::mutex> lock(s_freeTypeMutex);
+    auto bitmap = getGlyphBitmap(theChar, outGlyph.width, outGlyph.height, outGlyph.rect, outGlyph.xAdvance);
+    if (bitmap == nullptr)
+    {
+        outGlyph.width = 0;
+        outGlyph.height = 0;
+        return;
+    }
+
+    // the bitmap of the glyph slot is reused by the next glyph, the outline bitmap is ours
+    size_t bytesPerPixel = (_outlineSize > 0 && !_distanceFieldEnabled) ? 2 : 1;
+    outGlyph.pixels.assign(bitmap, bitmap + outGlyph.width * outGlyph.height * bytesPerPixel);
+    if (_outlineSize > 0)
+    {
+        delete [] bitmap;
+    }
+    lock.unlock();
+
+    if (_distanceFieldEnabled)
+    {
+        auto distanceMap = makeDistanceMap(outGlyph.pixels.data(), outGlyph.width, outGlyph.height);
+        outGlyph.width += 2 * DistanceMapSpread;
+        outGlyph.height += 2 * DistanceMapSpread;
+        outGlyph.pixels.assign(distanceMap, distanceMap + outGlyph.width * outGlyph.height);
+        free(distanceMap);
+    }
+}
+
 void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight)
 {
     int iX = posX;
@@ -29,6 +29,7 @@
 #include "CCFont.h"
 
 #include <string>
+#include <vector>
 #include <ft2build.h>
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
@@ -62,8 +63,25 @@ public:
 
     virtual FontAtlas   * createFontAtlas() override;
     virtual int         * getHorizontalKerningForTextUTF16(const std::u16string& text, int &outNumLetters) const override;
+    virtual void          computeHorizontalKernings(const std::u16string& text, int* kernings, int firstLetter) const override;
     
     unsigned char       * getGlyphBitmap(unsigned short theChar, long &outWidth, long &outHeight, Rect &outRect,int &xAdvance);
+
+    /** A glyph rasterized in the pixel format of the atlas: the distance map or the blended outline are already computed */
+    struct RasterizedGlyph
+    {
+        unsigned short charUTF16;
+        Rect rect;                          ///< as returned by getGlyphBitmap
+        int xAdvance;
+        long width;                         ///< of the pixels, the distance map spread included
+        long height;
+        std::vector<unsigned char> pixels;  ///< empty if the glyph has no bitmap, 2 bytes per pixel with an outline
+    };
+
+    /** Rasterizes a glyph. Unlike getGlyphBitmap and renderCharAt, it can be called from any thread:
+     the accesses to FreeType are serialized, the distance map is computed without the lock.
+     */
+    void rasterizeGlyph(unsigned short theChar, RasterizedGlyph& outGlyph);
     
     virtual int           getFontMaxHeight() const override;  
     virtual int           getFontAscender() const;
@@ -39,6 +39,8 @@
 
 NS_CC_BEGIN
 
+CC_IMPLEMENT_OBJECT_POOL(Label, 32)
+
 const int Label::DistanceFieldFontSize = 50;
 
 Label* Label::create()
@@ -257,6 +259,7 @@ Label::Label(FontAtlas *atlas /* = nullptr */, TextHAlignment hAlignment /* = Te
 , _uniformEffectColor(0)
 , _shadowDirty(false)
 , _insideBounds(true)
+, _updateTextureListener(nullptr)
 {
     setAnchorPoint(Vec2::ANCHOR_MIDDLE);
     reset();
@@ -267,6 +270,7 @@ Label::Label(FontAtlas *atlas /* = nullptr */, TextHAlignment hAlignment /* = Te
             Node::removeAllChildrenWithCleanup(true);
             _batchNodes.clear();
             _batchNodes.push_back(this);
+            _layoutString.clear();
 
             if (_fontAtlas)
             {
@@ -284,12 +288,25 @@ Label::Label(FontAtlas *atlas /* = nullptr */, TextHAlignment hAlignment /* = Te
         }
     });
     _eventDispatcher->addEventListenerWithSceneGraphPriority(resetTextureListener, this);
+
+    // the letters rasterized by the workers are in the atlas now
+    _updateTextureListener = EventListenerCustom::create(FontAtlas::CMD_UPDATE_FONTATLAS, [this](EventCustom* event){
+        if (_fontAtlas && _currentLabelType == LabelType::TTF && event->getUserData() == _fontAtlas)
+        {
+            // laid out again from the start, the pending letters have no quad yet
+            _layoutString.clear();
+            _contentDirty = true;
+        }
+    });
+    _eventDispatcher->addEventListenerWithFixedPriority(_updateTextureListener, 1);
 }
 
 Label::~Label()
 {
     delete [] _horizontalKernings;
 
+    _eventDispatcher->removeEventListener(_updateTextureListener);
+
     if (_fontAtlas)
     {
         FontAtlasCache::releaseFontAtlas(_fontAtlas);
@@ -309,6 +326,8 @@ void Label::reset()
 
     _batchNodes.clear();
     _batchNodes.push_back(this);
+    _layoutString.clear();
+    _kerningsString.clear();
 
     if (_fontAtlas)
     {
@@ -382,6 +401,10 @@ void Label::setFontAtlas(FontAtlas* atlas,bool distanceFieldEnabled /* = false *
 
     _fontAtlas = atlas;
 
+    // the letters and the kernings of the previous font can't be reused
+    _layoutString.clear();
+    _kerningsString.clear();
+
     if (_textureAtlas)
     {
         _textureAtlas->setTexture(_fontAtlas->getTexture(0));
@@ -468,6 +491,30 @@ bool Label::setBMFontFilePath(const std::string& bmfontFilePath, const Vec2& ima
     return true;
 }
 
+// the counters and most of the labels are ASCII
+static bool convertToUTF16(const std::string& utf8, std::u16string& outUtf16)
+{
+    size_t length = utf8.length();
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (static_cast<unsigned char>(utf8[i]) >= 0x80)
+        {
+            std::u16string utf16String;
+            if (!StringUtils::UTF8ToUTF16(utf8, utf16String))
+                return false;
+            outUtf16 = utf16String;
+            return true;
+        }
+    }
+
+    outUtf16.resize(length);
+    for (size_t i = 0; i < length; ++i)
+    {
+        outUtf16[i] = static_cast<char16_t>(utf8[i]);
+    }
+    return true;
+}
+
 void Label::setString(const std::string& text)
 {
     if (text.compare(_originalUTF8String))
@@ -475,11 +522,7 @@ void Label::setString(const std::string& text)
         _originalUTF8String = text;
         _contentDirty = true;
 
-        std::u16string utf16String;
-        if (StringUtils::UTF8ToUTF16(_originalUTF8String, utf16String))
-        {
-            _currentUTF16String  = utf16String;
-        }
+        convertToUTF16(_originalUTF8String, _currentUTF16String);
     }
 }
 
@@ -582,13 +625,10 @@ void Label::alignText()
     if (_fontAtlas == nullptr || _currentUTF16String.empty())
     {
         setContentSize(Size::ZERO);
+        _layoutString.clear();
         return;
     }
 
-    for (const auto& batchNode:_batchNodes)
-    {
-        batchNode->getTextureAtlas()->removeAllQuads();
-    }
     _fontAtlas->prepareLetterDefinitions(_currentUTF16String);
     auto& textures = _fontAtlas->getTextures();
     if (textures.size() > _batchNodes.size())
@@ -602,64 +642,252 @@ void Label::alignText()
             _batchNodes.push_back(batchNode);
         }
     }
-    LabelTextFormatter::createStringSprites(this);    
-    if(_maxLineWidth > 0 && _contentSize.width > _maxLineWidth && LabelTextFormatter::multilineText(this) )      
-        LabelTextFormatter::createStringSprites(this);
 
-    if(_labelWidth > 0 || (_currNumLines > 1 && _hAlignment != TextHAlignment::LEFT))
-        LabelTextFormatter::alignText(this);
-
-    int strLen = static_cast<int>(_currentUTF16String.length());
-    Rect uvRect;
-    Sprite* letterSprite;
-    for(const auto &child : _children) {
-        int tag = child->getTag();
-        if(tag >= strLen)
+    bool continuable = isLayoutContinuable();
+    int firstLetter = continuable ? getUnchangedLetterCount() : 0;
+    if (firstLetter > 0)
+    {
+        // the quads of the letters after the unchanged ones are inserted again
+        std::vector<ssize_t> firstQuads(_batchNodes.size(), -1);
+        for (int ctr = firstLetter; ctr < _limitShowCount; ++ctr)
         {
-            SpriteBatchNode::removeChild(child, true);
+            const auto& letterInfo = _lettersInfo[ctr];
+            if (letterInfo.def.validDefinition)
+            {
+                ssize_t& firstQuad = firstQuads[letterInfo.def.textureID];
+                if (firstQuad < 0 || letterInfo.atlasIndex < firstQuad)
+                    firstQuad = letterInfo.atlasIndex;
+            }
         }
-        else if(tag >= 0)
+        for (size_t index = 0; index < _batchNodes.size(); ++index)
         {
-            letterSprite = dynamic_cast<Sprite*>(child);
-            if (letterSprite)
+            auto textureAtlas = _batchNodes[index]->getTextureAtlas();
+            if (firstQuads[index] >= 0)
             {
-                uvRect.size.height = _lettersInfo[tag].def.height;
-                uvRect.size.width  = _lettersInfo[tag].def.width;
-                uvRect.origin.x    = _lettersInfo[tag].def.U;
-                uvRect.origin.y    = _lettersInfo[tag].def.V;
+                textureAtlas->removeQuadsAtIndex(firstQuads[index], textureAtlas->getTotalQuads() - firstQuads[index]);
+            }
+            firstQuads[index] = textureAtlas->getTotalQuads();
+        }
+
+        LabelTextFormatter::createStringSprites(this, firstLetter);
+        updateQuads(firstLetter);
+
+        for (size_t index = 0; index < _batchNodes.size(); ++index)
+        {
+            auto textureAtlas = _batchNodes[index]->getTextureAtlas();
+            updateQuadsColor(textureAtlas, firstQuads[index], textureAtlas->getTotalQuads());
+        }
+    }
+    else
+    {
+        for (const auto& batchNode:_batchNodes)
+        {
+            batchNode->getTextureAtlas()->removeAllQuads();
+        }
+
+        LabelTextFormatter::createStringSprites(this);    
+        if(_maxLineWidth > 0 && _contentSize.width > _maxLineWidth && LabelTextFormatter::multilineText(this) )      
+            LabelTextFormatter::createStringSprites(this);
+
+        if(_labelWidth > 0 || (_currNumLines > 1 && _hAlignment != TextHAlignment::LEFT))
+            LabelTextFormatter::alignText(this);
 
-                letterSprite->setTexture(textures.at(_lettersInfo[tag].def.textureID));
-                letterSprite->setTextureRect(uvRect);
+        int strLen = static_cast<int>(_currentUTF16String.length());
+        Rect uvRect;
+        Sprite* letterSprite;
+        for(const auto &child : _children) {
+            int tag = child->getTag();
+            if(tag >= strLen)
+            {
+                SpriteBatchNode::removeChild(child, true);
+            }
+            else if(tag >= 0)
+            {
+                letterSprite = dynamic_cast<Sprite*>(child);
+                if (letterSprite)
+                {
+                    uvRect.size.height = _lettersInfo[tag].def.height;
+                    uvRect.size.width  = _lettersInfo[tag].def.width;
+                    uvRect.origin.x    = _lettersInfo[tag].def.U;
+                    uvRect.origin.y    = _lettersInfo[tag].def.V;
+
+                    letterSprite->setTexture(textures.at(_lettersInfo[tag].def.textureID));
+                    letterSprite->setTextureRect(uvRect);
+                }
             }
         }
+
+        updateQuads();
+
+        updateColor();
     }
 
-    updateQuads();
+    if (continuable)
+    {
+        _layoutString = _currentUTF16String;
+    }
+    else
+    {
+        _layoutString.clear();
+    }
+}
 
-    updateColor();
+bool Label::isLayoutContinuable() const
+{
+    if (_labelWidth > 0 || _labelHeight > 0 || _maxLineWidth > 0)
+        return false;
+    if (_currentLabelType == LabelType::TTF && _clipEnabled)
+        return false;
+    // the children are the batch nodes of the other textures, or the letter sprites
+    if (_children.size() + 1 != _batchNodes.size())
+        return false;
+    return _currentUTF16String.find('\n') == std::u16string::npos;
+}
+
+int Label::getUnchangedLetterCount() const
+{
+    if (_layoutString.empty())
+        return 0;
+
+    int length = static_cast<int>(std::min(_layoutString.length(), _currentUTF16String.length()));
+    int sameLetters = 0;
+    while (sameLetters < length && _layoutString[sameLetters] == _currentUTF16String[sameLetters])
+    {
+        ++sameLetters;
+    }
+
+    // the kerning of a letter may depend on the next one
+    int unchanged = std::min(std::max(sameLetters - 1, 0), _limitShowCount);
+
+    // the letters that were missing from the atlas may be there now
+    for (int ctr = 0; ctr < unchanged; ++ctr)
+    {
+        if (!_lettersInfo[ctr].def.validDefinition)
+            return ctr;
+    }
+    return unchanged;
+}
+
+bool Label::updateDigits()
+{
+    size_t length = _currentUTF16String.length();
+    if (length == 0 || _layoutString.length() != length || !isLayoutContinuable())
+        return false;
+
+    for (size_t ctr = 0; ctr < length; ++ctr)
+    {
+        char16_t oldLetter = _layoutString[ctr];
+        char16_t newLetter = _currentUTF16String[ctr];
+        if (oldLetter < '0' || oldLetter > '9' || newLetter < '0' || newLetter > '9')
+            return false;
+    }
+    if (static_cast<size_t>(_limitShowCount) != length || !_fontAtlas->hasTabularDigits())
+        return false;
+
+    // the letters still rasterizing have no quad, and the changed digits must stay on their texture
+    FontLetterDefinition letterDef;
+    for (size_t ctr = 0; ctr < length; ++ctr)
+    {
+        if (!_lettersInfo[ctr].def.validDefinition)
+            return false;
+        
+        if (_layoutString[ctr] != _currentUTF16String[ctr])
+        {
+            if (!_fontAtlas->getLetterDefinitionForChar(_currentUTF16String[ctr], letterDef)
+                || !letterDef.validDefinition || letterDef.textureID != _lettersInfo[ctr].def.textureID)
+                return false;
+        }
+    }
+
+    auto contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
+    for (size_t ctr = 0; ctr < length; ++ctr)
+    {
+        if (_layoutString[ctr] == _currentUTF16String[ctr])
+            continue;
+
+        auto& letterInfo = _lettersInfo[ctr];
+        _fontAtlas->getLetterDefinitionForChar(_currentUTF16String[ctr], letterDef);
+        letterInfo.position.x += (letterDef.offsetX - letterInfo.def.offsetX) / contentScaleFactor;
+        letterInfo.position.y -= (letterDef.offsetY - letterInfo.def.offsetY) / contentScaleFactor;
+        letterInfo.def = letterDef;
+        letterInfo.contentSize.width = letterDef.width;
+        letterInfo.contentSize.height = letterDef.height;
+
+        _reusedRect.size.height = letterDef.height;
+        _reusedRect.size.width  = letterDef.width;
+        _reusedRect.origin.x    = letterDef.U;
+        _reusedRect.origin.y    = letterDef.V;
+        _reusedLetter->setTextureRect(_reusedRect,false,_reusedRect.size);
+        _reusedLetter->setPosition(letterInfo.position);
+
+        // updateTransform rewrites the quad of the letter in place
+        auto batchNode = _batchNodes[letterDef.textureID];
+        _reusedLetter->setBatchNode(batchNode);
+        _reusedLetter->setAtlasIndex(letterInfo.atlasIndex);
+        _reusedLetter->setDirty(true);
+        _reusedLetter->updateTransform();
+        updateQuadsColor(batchNode->getTextureAtlas(), letterInfo.atlasIndex, letterInfo.atlasIndex + 1);
+    }
+
+    // the width only depends on the last letter, like in LabelTextFormatter::createStringSprites
+    if (_layoutString[length - 1] != _currentUTF16String[length - 1])
+    {
+        const auto& lastLetter = _lettersInfo[length - 1];
+        float charAdvance = lastLetter.def.xAdvance;
+        float longestLine = std::max(lastLetter.longestLine, lastLetter.penPositionX + charAdvance + _horizontalKernings[length - 1]);
+        float lastCharWidth = lastLetter.def.width * contentScaleFactor;
+        float width = charAdvance < lastCharWidth ? longestLine - charAdvance + lastCharWidth : longestLine;
+        setContentSize(Size(width / contentScaleFactor, _contentSize.height));
+    }
+
+    _layoutString = _currentUTF16String;
+    _kerningsString = _currentUTF16String;
+    return true;
 }
 
 bool Label::computeHorizontalKernings(const std::u16string& stringToRender)
 {
+    int length = static_cast<int>(stringToRender.length());
+
+    // the kernings of the unchanged beginning of the string are kept
+    int firstLetter = 0;
     if (_horizontalKernings)
     {
-        delete [] _horizontalKernings;
-        _horizontalKernings = nullptr;
+        int sameLength = static_cast<int>(std::min(_kerningsString.length(), stringToRender.length()));
+        while (firstLetter < sameLength && _kerningsString[firstLetter] == stringToRender[firstLetter])
+        {
+            ++firstLetter;
+        }
+        // the kerning of a letter may depend on the next one
+        firstLetter = std::max(firstLetter - 1, 0);
     }
 
-    int letterCount = 0;
-    _horizontalKernings = _fontAtlas->getFont()->getHorizontalKerningForTextUTF16(stringToRender, letterCount);
+    if (static_cast<int>(_kerningsString.length()) != length || !_horizontalKernings)
+    {
+        int* kernings = length > 0 ? new int[length] : nullptr;
+        if (firstLetter > 0)
+        {
+            memcpy(kernings, _horizontalKernings, firstLetter * sizeof(int));
+        }
+        delete [] _horizontalKernings;
+        _horizontalKernings = kernings;
+    }
 
     if(!_horizontalKernings)
+    {
+        _kerningsString.clear();
         return false;
-    else
-        return true;
+    }
+
+    _fontAtlas->getFont()->computeHorizontalKernings(stringToRender, _horizontalKernings, firstLetter);
+    _kerningsString = stringToRender;
+    return true;
 }
 
-void Label::updateQuads()
+void Label::updateQuads(int firstLetter)
 {
     int index;
-    for (int ctr = 0; ctr < _limitShowCount; ++ctr)
+    for (int ctr = firstLetter; ctr < _limitShowCount; ++ctr)
     {
         auto &letterDef = _lettersInfo[ctr].def;
 
@@ -946,10 +1174,14 @@ void Label::setFontDefinition(const FontDefinition& textDefinition)
 
 void Label::updateContent()
 {
-    std::u16string utf16String;
-    if (StringUtils::UTF8ToUTF16(_originalUTF8String, utf16String))
+    // the multiline layout breaks the lines of _currentUTF16String
+    convertToUTF16(_originalUTF8String, _currentUTF16String);
+
+    // a counter only replaces its changed digits
+    if (_fontAtlas && !_textSprite && updateDigits())
     {
-        _currentUTF16String  = utf16String;
+        _contentDirty = false;
+        return;
     }
 
     computeStringNumLines();
@@ -1194,6 +1426,7 @@ void Label::setLineHeight(float height)
     if (_commonLineHeight != height)
     {
         _commonLineHeight = height;
+        _layoutString.clear();
         _contentDirty = true;
     }
 }
@@ -1210,6 +1443,7 @@ void Label::setAdditionalKerning(float space)
     if (_additionalKerning != space)
     {
         _additionalKerning = space;
+        _layoutString.clear();
         _contentDirty = true;
     }
 }
@@ -1323,6 +1557,15 @@ void Label::updateColor()
         return;
     }
 
+    for (const auto& batchNode:_batchNodes)
+    {
+        auto textureAtlas = batchNode->getTextureAtlas();
+        updateQuadsColor(textureAtlas, 0, textureAtlas->getTotalQuads());
+    }
+}
+
+void Label::updateQuadsColor(TextureAtlas* textureAtlas, ssize_t firstQuad, ssize_t lastQuad)
+{
     Color4B color4( _displayedColor.r, _displayedColor.g, _displayedColor.b, _displayedOpacity );
 
     // special opacity for premultiplied textures
@@ -1333,22 +1576,14 @@ void Label::updateColor()
         color4.b *= _displayedOpacity/255.0f;
     }
 
-    cocos2d::TextureAtlas* textureAtlas;
-    V3F_C4B_T2F_Quad *quads;
-    for (const auto& batchNode:_batchNodes)
+    V3F_C4B_T2F_Quad *quads = textureAtlas->getQuads();
+    for (ssize_t index = firstQuad; index < lastQuad; ++index)
     {
-        textureAtlas = batchNode->getTextureAtlas();
-        quads = textureAtlas->getQuads();
-        auto count = textureAtlas->getTotalQuads();
-
-        for (int index = 0; index < count; ++index)
-        {
-            quads[index].bl.colors = color4;
-            quads[index].br.colors = color4;
-            quads[index].tl.colors = color4;
-            quads[index].tr.colors = color4;
-            textureAtlas->updateQuad(&quads[index], index);
-        }
+        quads[index].bl.colors = color4;
+        quads[index].br.colors = color4;
+        quads[index].tl.colors = color4;
+        quads[index].tr.colors = color4;
+        textureAtlas->updateQuad(&quads[index], index);
     }
 }
 
@@ -33,6 +33,8 @@
 
 NS_CC_BEGIN
 
+class EventListenerCustom;
+
 enum class GlyphCollection {
     
     DYNAMIC,
@@ -77,6 +79,8 @@ typedef struct _ttfConfig
 class CC_DLL Label : public SpriteBatchNode, public LabelProtocol
 {
 public:
+    CC_USE_OBJECT_POOL(Label);
+
     static const int DistanceFieldFontSize;
 
     static Label* create();
@@ -288,6 +292,9 @@ CC_CONSTRUCTOR_ACCESS:
     virtual ~Label();
 
 protected:
+    // visit() may update the content before computing the transform
+    virtual bool prepareTransform(const Mat4& parentTransform, uint32_t parentFlags) override { return false; }
+
     void onDraw(const Mat4& transform, bool transformUpdated);
 
     struct LetterInfo
@@ -297,6 +304,10 @@ protected:
         Vec2 position;
         Size  contentSize;
         int   atlasIndex;
+
+        // the line before the letter, in pixels: the layout can continue from there
+        float penPositionX;
+        float longestLine;
     };
     enum class LabelType {
 
@@ -317,11 +328,20 @@ protected:
     
     bool computeHorizontalKernings(const std::u16string& stringToRender);
 
+    /* Whether the next layout can keep the letters of the unchanged beginning of the string:
+     a single line without dimensions, clipping or letter sprites */
+    bool isLayoutContinuable() const;
+    /* The number of letters at the beginning of the string whose layout and quads are unchanged */
+    int getUnchangedLetterCount() const;
+    /* Replaces the changed digits of a counter in place, see FontAtlas::hasTabularDigits */
+    bool updateDigits();
+
     void computeStringNumLines();
 
-    void updateQuads();
+    void updateQuads(int firstLetter = 0);
 
     virtual void updateColor() override;
+    void updateQuadsColor(TextureAtlas* textureAtlas, ssize_t firstQuad, ssize_t lastQuad);
 
     virtual void updateShaderProgram();
 
@@ -355,6 +375,9 @@ protected:
     FontDefinition _fontDefinition;
     bool  _compatibleMode;
 
+    // fixed priority, so that the labels outside of the running scene are laid out again too
+    EventListenerCustom* _updateTextureListener;
+
     //! used for optimization
     Sprite *_reusedLetter;
     Rect _reusedRect;
@@ -364,6 +387,10 @@ protected:
     float _commonLineHeight;
     bool  _lineBreakWithoutSpaces;
     int * _horizontalKernings;
+    // the string of _horizontalKernings
+    std::u16string _kerningsString;
+    // the string of the last layout when it can be continued, see isLayoutContinuable
+    std::u16string _layoutString;
 
     float _maxLineWidth;
     Size  _labelDimensions;
@@ -267,9 +267,9 @@ bool LabelTextFormatter::alignText(Label *theLabel)
     return true;
 }
 
-bool LabelTextFormatter::createStringSprites(Label *theLabel)
+bool LabelTextFormatter::createStringSprites(Label *theLabel, int firstLetter)
 {
-    theLabel->_limitShowCount = 0;
+    theLabel->_limitShowCount = firstLetter;
     // check for string
     int stringLen = theLabel->getStringLength();
     if (stringLen <= 0)
@@ -325,8 +325,15 @@ bool LabelTextFormatter::createStringSprites(Label *theLabel)
     {
         clipBlank = true;
     }
+
+    // continue the line after the kept letters
+    if (firstLetter > 0)
+    {
+        nextFontPositionX = theLabel->_lettersInfo[firstLetter].penPositionX;
+        longestLine = theLabel->_lettersInfo[firstLetter].longestLine;
+    }
     
-    for (int i = 0; i < stringLen; i++)
+    for (int i = firstLetter; i < stringLen; i++)
     {
         char16_t c    = strWhole[i];
         if (fontAtlas->getLetterDefinitionForChar(c, tempDefinition))
@@ -380,9 +387,15 @@ bool LabelTextFormatter::createStringSprites(Label *theLabel)
         letterPosition.x = (nextFontPositionX + charXOffset + kernings[i]) / contentScaleFactor;
         letterPosition.y = (nextFontPositionY - charYOffset) / contentScaleFactor;
                
-        if( theLabel->recordLetterInfo(letterPosition, tempDefinition, i) == false)
+        bool validLetter = theLabel->recordLetterInfo(letterPosition, tempDefinition, i);
+        theLabel->_lettersInfo[i].penPositionX = nextFontPositionX;
+        theLabel->_lettersInfo[i].longestLine = longestLine;
+        if (validLetter == false)
         {
-            log("WARNING: can't find letter definition in font file for letter: %c", c);
+            if (!fontAtlas->isLetterPending(c))
+            {
+                log("WARNING: can't find letter definition in font file for letter: %c", c);
+            }
             continue;
         }
         
@@ -38,7 +38,8 @@ public:
     
     static bool multilineText(Label *theLabel);
     static bool alignText(Label *theLabel);
-    static bool createStringSprites(Label *theLabel);
+    /** Lays out the letters of a label. The letters before firstLetter are kept, see Label::alignText */
+    static bool createStringSprites(Label *theLabel, int firstLetter = 0);
 
 };
 
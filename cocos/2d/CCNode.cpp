@@ -33,10 +33,12 @@ THE SOFTWARE.
 #include <algorithm>
 #include <string>
 #include <regex>
+#include <atomic>
 
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
 #include "base/CCEventDispatcher.h"
+#include "base/CCJobSystem.h"
 #include "base/ccUTF8.h"
 #include "2d/CCCamera.h"
 #include "2d/CCActionManager.h"
@@ -62,6 +64,8 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+CC_IMPLEMENT_OBJECT_POOL(Node, 128)
+
 bool nodeComparisonLess(Node* n1, Node* n2)
 {
     return( n1->getLocalZOrder() < n2->getLocalZOrder() ||
@@ -71,6 +75,7 @@ bool nodeComparisonLess(Node* n1, Node* n2)
 
 // FIXME:: Yes, nodes might have a sort problem once every 15 days if the game runs at 60 FPS and each frame sprites are reordered.
 int Node::s_globalOrderOfArrival = 1;
+unsigned int Node::s_transformPrepareStamp = 1;
 
 // MARK: Constructor, Destructor, Init
 
@@ -96,6 +101,9 @@ Node::Node(void)
 , _inverseDirty(true)
 , _useAdditionalTransform(false)
 , _transformUpdated(true)
+, _preparedFlags(0)
+, _preparedStamp(0)
+, _transformVersion(0)
 // children (lazy allocs)
 // lazy alloc
 , _localZOrder(0)
@@ -295,10 +303,13 @@ void Node::setLocalZOrder(int z)
     _localZOrder = z;
     if (_parent)
     {
+        // the new order of arrival marks the listeners of the node dirty
         _parent->reorderChild(this, z);
     }
-
-    _eventDispatcher->setDirtyForNode(this);
+    else
+    {
+        _eventDispatcher->setDirtyForNode(this);
+    }
 }
 
 /// zOrder setter : private method
@@ -333,8 +344,8 @@ void Node::setRotation(float rotation)
     _rotationZ_X = _rotationZ_Y = rotation;
     _transformUpdated = _transformDirty = _inverseDirty = true;
 #if CC_USE_PHYSICS
-    if (_physicsBody && _physicsBody->getWorld()) {
-        _physicsBody->getWorld()->_updateBodyTransform = true;
+    if (_updateTransformFromPhysics) {
+        setPhysicsBodiesDirty(PhysicsBody::TRANSFORM_DIRTY_ROTATION);
     }
 #endif
     
@@ -474,8 +485,8 @@ void Node::setScale(float scale)
     _scaleX = _scaleY = _scaleZ = scale;
     _transformUpdated = _transformDirty = _inverseDirty = true;
 #if CC_USE_PHYSICS
-    if (_physicsBody && _physicsBody->getWorld()) {
-        _physicsBody->getWorld()->_updateBodyTransform = true;
+    if (_updateTransformFromPhysics) {
+        setPhysicsBodiesDirty(PhysicsBody::TRANSFORM_DIRTY_SCALE);
     }
 #endif
 }
@@ -496,8 +507,8 @@ void Node::setScale(float scaleX,float scaleY)
     _scaleY = scaleY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
 #if CC_USE_PHYSICS
-    if (_physicsBody && _physicsBody->getWorld()) {
-        _physicsBody->getWorld()->_updateBodyTransform = true;
+    if (_updateTransformFromPhysics) {
+        setPhysicsBodiesDirty(PhysicsBody::TRANSFORM_DIRTY_SCALE);
     }
 #endif
 }
@@ -511,8 +522,8 @@ void Node::setScaleX(float scaleX)
     _scaleX = scaleX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
 #if CC_USE_PHYSICS
-    if (_physicsBody && _physicsBody->getWorld()) {
-        _physicsBody->getWorld()->_updateBodyTransform = true;
+    if (_updateTransformFromPhysics) {
+        setPhysicsBodiesDirty(PhysicsBody::TRANSFORM_DIRTY_SCALE);
     }
 #endif
 }
@@ -555,8 +566,8 @@ void Node::setScaleY(float scaleY)
     _scaleY = scaleY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
 #if CC_USE_PHYSICS
-    if (_physicsBody && _physicsBody->getWorld()) {
-        _physicsBody->getWorld()->_updateBodyTransform = true;
+    if (_updateTransformFromPhysics) {
+        setPhysicsBodiesDirty(PhysicsBody::TRANSFORM_DIRTY_SCALE);
     }
 #endif
 }
@@ -591,8 +602,8 @@ void Node::setPosition(float x, float y)
     _transformUpdated = _transformDirty = _inverseDirty = true;
     _usingNormalizedPosition = false;
 #if CC_USE_PHYSICS
-    if (_physicsBody && _physicsBody->getWorld()) {
-        _physicsBody->getWorld()->_updateBodyTransform = true;
+    if (_updateTransformFromPhysics) {
+        setPhysicsBodiesDirty(PhysicsBody::TRANSFORM_DIRTY_POSITION);
     }
 #endif
 }
@@ -660,8 +671,8 @@ void Node::setNormalizedPosition(const Vec2& position)
     _normalizedPositionDirty = true;
     _transformUpdated = _transformDirty = _inverseDirty = true;
 #if CC_USE_PHYSICS
-    if (_physicsBody && _physicsBody->getWorld()) {
-        _physicsBody->getWorld()->_updateBodyTransform = true;
+    if (_updateTransformFromPhysics) {
+        setPhysicsBodiesDirty(PhysicsBody::TRANSFORM_DIRTY_POSITION);
     }
 #endif
 }
@@ -801,6 +812,9 @@ void Node::setOrderOfArrival(int orderOfArrival)
 {
     CCASSERT(orderOfArrival >=0, "Invalid orderOfArrival");
     _orderOfArrival = orderOfArrival;
+
+    // the scene graph priority of the listeners depends on the order of arrival too
+    _eventDispatcher->setDirtyForNode(this);
 }
 
 void Node::setUserObject(Ref *userObject)
@@ -1277,6 +1291,19 @@ void Node::visit()
 
 uint32_t Node::processParentFlags(const Mat4& parentTransform, uint32_t parentFlags)
 {
+    if (_preparedStamp == s_transformPrepareStamp)
+    {
+        // The transform was computed by prepareTransform(). It can be reused unless the node or its parent
+        // were changed after that, e.g. by the draw() of a node visited before.
+        _preparedStamp = 0;
+        bool changed = _transformUpdated || _contentSizeDirty || (_usingNormalizedPosition && _normalizedPositionDirty);
+        if (!changed && !(parentFlags & FLAGS_DIRTY_MASK & ~_preparedFlags))
+        {
+            return parentFlags | (_preparedFlags & FLAGS_DIRTY_MASK);
+        }
+        invalidatePreparedTransforms();
+    }
+
 #if CC_USE_PHYSICS
     if (_physicsBody && _updateTransformFromPhysics)
     {
@@ -1302,7 +1329,10 @@ uint32_t Node::processParentFlags(const Mat4& parentTransform, uint32_t parentFl
     
 
     if(flags & FLAGS_DIRTY_MASK)
+    {
         _modelViewTransform = this->transform(parentTransform);
+        ++_transformVersion;
+    }
     
 #if CC_USE_PHYSICS
     if (_updateTransformFromPhysics) {
@@ -1317,6 +1347,113 @@ uint32_t Node::processParentFlags(const Mat4& parentTransform, uint32_t parentFl
     return flags;
 }
 
+bool Node::prepareTransform(const Mat4& parentTransform, uint32_t parentFlags)
+{
+    if (!_visible)
+    {
+        return false;
+    }
+#if CC_USE_PHYSICS
+    // physics bodies are synchronized on the main thread
+    if (_physicsBody)
+    {
+        return false;
+    }
+#endif
+
+    _preparedFlags = processParentFlags(parentTransform, parentFlags);
+    _preparedStamp = s_transformPrepareStamp;
+    return true;
+}
+
+void Node::prepareTransformRecursively(const Mat4& parentTransform, uint32_t parentFlags)
+{
+    if (prepareTransform(parentTransform, parentFlags))
+    {
+        for (const auto& child : _children)
+        {
+            child->prepareTransformRecursively(_modelViewTransform, _preparedFlags);
+        }
+    }
+}
+
+void Node::prepareTransformsInParallel(const Mat4& transform, int threadCount)
+{
+    newTransformPrepareStamp();
+
+    if (!prepareTransform(transform, 0))
+    {
+        return;
+    }
+
+    // Split the graph in subtrees, breadth first, until there are enough of them to balance the threads.
+    // The nodes above the subtrees are prepared on the calling thread.
+    static const int SUBTREES_PER_THREAD = 4;
+    static const int MAX_SPLIT_DEPTH = 4;
+    const size_t wantedSubtrees = threadCount * SUBTREES_PER_THREAD;
+    std::vector<Node*> subtrees(_children.begin(), _children.end());
+    std::vector<Node*> nextSubtrees;
+    for (int depth = 0; depth < MAX_SPLIT_DEPTH && subtrees.size() < wantedSubtrees; ++depth)
+    {
+        bool split = false;
+        nextSubtrees.clear();
+        for (const auto& node : subtrees)
+        {
+            if (node->_children.empty())
+            {
+                nextSubtrees.push_back(node);
+            }
+            else if (node->prepareTransform(node->_parent->_modelViewTransform, node->_parent->_preparedFlags))
+            {
+                nextSubtrees.insert(nextSubtrees.end(), node->_children.begin(), node->_children.end());
+                split = true;
+            }
+        }
+        subtrees.swap(nextSubtrees);
+        if (!split)
+            break;
+    }
+
+    std::atomic<size_t> nextSubtree(0);
+    auto worker = [&subtrees, &nextSubtree]() {
+        for (size_t index = nextSubtree++; index < subtrees.size(); index = nextSubtree++)
+        {
+            Node* node = subtrees[index];
+            node->prepareTransformRecursively(node->_parent->_modelViewTransform, node->_parent->_preparedFlags);
+        }
+    };
+
+    auto jobSystem = JobSystem::getInstance();
+    std::vector<JobSystem::JobHandle> jobs;
+    for (int i = 1; i < threadCount && static_cast<size_t>(i) < subtrees.size(); ++i)
+    {
+        jobs.push_back(jobSystem->schedule(worker, JobSystem::Priority::HIGH));
+    }
+    worker();
+    jobSystem->wait(jobs);
+}
+
+void Node::newTransformPrepareStamp()
+{
+    // a new stamp invalidates all the transforms prepared before
+    if (++s_transformPrepareStamp == 0)
+    {
+        ++s_transformPrepareStamp;
+    }
+}
+
+void Node::invalidatePreparedTransforms()
+{
+    for (const auto& child : _children)
+    {
+        if (child->_preparedStamp == s_transformPrepareStamp)
+        {
+            child->_preparedStamp = 0;
+            child->invalidatePreparedTransforms();
+        }
+    }
+}
+
 bool Node::isVisitableByVisitingCamera() const
 {
     auto camera = Camera::getVisitingCamera();
@@ -2090,9 +2227,79 @@ void Node::updatePhysicsBodyTransform(const Mat4& parentTransform, uint32_t pare
     }
 }
 
+void Node::setPhysicsBodiesDirty(int flags)
+{
+    if (_physicsBody && _physicsBody->getWorld())
+    {
+        _physicsBody->getWorld()->addDirtyBody(_physicsBody, flags);
+    }
+
+    // the bodies of the children are moved by the node too, whether it has a body or not
+    if (PhysicsWorld::s_bodyCount > 0)
+    {
+        int childFlags = flags | PhysicsBody::TRANSFORM_DIRTY_POSITION;
+        for (const auto& child : _children)
+        {
+            child->setPhysicsBodiesDirty(childFlags);
+        }
+    }
+}
+
+// the rotation of the parents of a body, the scene excluded, like in updatePhysicsBodyTransform()
+static float getParentPhysicsRotation(Node* parent)
+{
+    float rotation = 0.0f;
+    for (auto node = parent; node && node->getParent(); node = node->getParent())
+    {
+        rotation += node->getRotationSkewX();
+    }
+    return rotation;
+}
+
+void Node::syncPhysicsBodyTransform(int flags)
+{
+    // with the interpolation the node holds a blend of the last two steps, only the
+    // components set on the node by the user are copied back, not the interpolated ones
+    _physicsTransformDirty = false;
+    if (flags & PhysicsBody::TRANSFORM_DIRTY_POSITION)
+    {
+        _physicsBody->setPosition(_parent ? _parent->convertToWorldSpace(_position) : _position);
+    }
+    if (flags & PhysicsBody::TRANSFORM_DIRTY_SCALE)
+    {
+        float scaleX = _scaleX;
+        float scaleY = _scaleY;
+        for (auto node = _parent; node; node = node->_parent)
+        {
+            scaleX *= node->_scaleX;
+            scaleY *= node->_scaleY;
+        }
+        _physicsBody->setScale(scaleX / _physicsScaleStartX, scaleY / _physicsScaleStartY);
+    }
+    if (flags & PhysicsBody::TRANSFORM_DIRTY_ROTATION)
+    {
+        if (_parent)
+        {
+            _physicsRotation = getParentPhysicsRotation(_parent) + _rotationZ_X;
+        }
+        _physicsBody->setRotation(_physicsRotation);
+    }
+}
+
 void Node::updateTransformFromPhysics(const Mat4& parentTransform, uint32_t parentFlags)
 {
-    auto& newPosition = _physicsBody->getPosition();
+    Vec2 newPosition = _physicsBody->getPosition();
+    float newRotation = _physicsBody->getRotation();
+    auto world = _physicsBody->getWorld();
+    if (world && world->_interpolationEnabled && world->_fixedTimestep > 0.0f)
+    {
+        float alpha = world->_interpolationAlpha;
+        newPosition = _physicsBody->_previousPosition.lerp(newPosition, alpha);
+        newRotation = _physicsBody->_previousRotation + (newRotation - _physicsBody->_previousRotation) * alpha;
+    }
+
+    // the node follows its body, it doesn't make the body dirty
+    _updateTransformFromPhysics = false;
     auto& recordedPosition = _physicsBody->_recordedPosition;
     if (parentFlags || recordedPosition.x != newPosition.x || recordedPosition.y != newPosition.y)
     {
@@ -2102,8 +2309,9 @@ void Node::updateTransformFromPhysics(const Mat4& parentTransform, uint32_t pare
         parentTransform.getInversed().transformPoint(vec3, &ret);
         setPosition(ret.x, ret.y);
     }
-    _physicsRotation = _physicsBody->getRotation();
-    setRotation(_physicsRotation - _parent->_physicsRotation);
+    _physicsRotation = newRotation;
+    setRotation(_physicsRotation - getParentPhysicsRotation(_parent));
+    _updateTransformFromPhysics = true;
 }
 
 #endif //CC_USE_PHYSICS
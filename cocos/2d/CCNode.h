@@ -35,6 +35,7 @@
 #include "base/CCScriptSupport.h"
 #include "math/CCAffineTransform.h"
 #include "math/CCMath.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 NS_CC_BEGIN
 
@@ -102,6 +103,8 @@ class EventListener;
 class CC_DLL Node : public Ref
 {
 public:
+    CC_USE_OBJECT_POOL(Node);
+
     /// Default tag used for all the nodes
     static const int INVALID_TAG = -1;
 
@@ -1435,6 +1438,14 @@ public:
     /** @deprecated Use getNodeToWorldTransform() instead */
     CC_DEPRECATED_ATTRIBUTE inline virtual AffineTransform nodeToWorldTransform() const { return getNodeToWorldAffineTransform(); }
 
+    /**
+     * Returns a number that changes every time the transform used to draw the node is computed again,
+     * because the node or one of its parents was moved or resized. Cheaper than comparing the transforms.
+     * @js NA
+     * @lua NA
+     */
+    unsigned int getTransformVersion() const { return _transformVersion; }
+
     /**
      * Returns the inverse world affine transform matrix. The matrix is in Pixels.
      */
@@ -1543,6 +1554,12 @@ public:
     
     void updateTransformFromPhysics(const Mat4& parentTransform, uint32_t parentFlags);
 
+    /** Marks the given PhysicsBody::TRANSFORM_DIRTY_* components of the bodies of the node and of its children dirty, when the transform of the node changes */
+    void setPhysicsBodiesDirty(int flags);
+
+    /** Copies the given PhysicsBody::TRANSFORM_DIRTY_* components of the node transform in the scene to its physics body, without visiting the other nodes */
+    void syncPhysicsBodyTransform(int flags);
+
     virtual void updatePhysicsBodyTransform(const Mat4& parentTransform, uint32_t parentFlags, float parentScaleX, float parentScaleY);
 #endif
     
@@ -1600,6 +1617,21 @@ protected:
     Mat4 transform(const Mat4 &parentTransform);
     uint32_t processParentFlags(const Mat4& parentTransform, uint32_t parentFlags);
 
+    /** Computes the model view transform of the node ahead of `visit()`, so `visit()` can reuse it.
+     * Override it and return false when the children of the node are not traversed with `visit()`:
+     * the node and its children will then be processed by `visit()` as usual.
+     * It may be called from a worker thread.
+     */
+    virtual bool prepareTransform(const Mat4& parentTransform, uint32_t parentFlags);
+    /// Calls prepareTransform() on the node and its visible children
+    void prepareTransformRecursively(const Mat4& parentTransform, uint32_t parentFlags);
+    /// Computes the transforms of the node and its children on `threadCount` threads, one task per subtree
+    void prepareTransformsInParallel(const Mat4& transform, int threadCount);
+    /// Drops the transforms computed ahead of visit() for the children of the node
+    void invalidatePreparedTransforms();
+    /// Drops all the transforms computed ahead of visit()
+    static void newTransformPrepareStamp();
+
     virtual void updateCascadeOpacity();
     virtual void disableCascadeOpacity();
     virtual void updateCascadeColor();
@@ -1660,6 +1692,9 @@ protected:
     mutable Mat4 _additionalTransform; ///< transform
     bool _useAdditionalTransform;   ///< The flag to check whether the additional transform is dirty
     bool _transformUpdated;         ///< Whether or not the Transform object was updated since the last frame
+    uint32_t _preparedFlags;        ///< flags computed by prepareTransform()
+    unsigned int _preparedStamp;    ///< s_transformPrepareStamp when prepareTransform() was called
+    unsigned int _transformVersion; ///< incremented when _modelViewTransform is computed
 
     int _localZOrder;               ///< Local order (relative to its siblings) used to sort the node
     float _globalZOrder;            ///< Global order used to sort the node
@@ -1721,6 +1756,7 @@ protected:
     bool        _cascadeOpacityEnabled;
 
     static int s_globalOrderOfArrival;
+    static unsigned int s_transformPrepareStamp;
     
     // camera mask, it is visible only when _cameraMask & current camera' camera flag is true
     unsigned short _cameraMask;
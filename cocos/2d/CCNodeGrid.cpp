@@ -88,7 +88,10 @@ void NodeGrid::visit(Renderer *renderer, const Mat4 &parentTransform, uint32_t p
 
     bool dirty = (parentFlags & FLAGS_TRANSFORM_DIRTY) || _transformUpdated;
     if(dirty)
+    {
         _modelViewTransform = this->transform(parentTransform);
+        ++_transformVersion;
+    }
     _transformUpdated = false;
     
     _groupCommand.init(_globalZOrder);
@@ -61,6 +61,9 @@ CC_CONSTRUCTOR_ACCESS:
     virtual ~NodeGrid();
 
 protected:
+    // visit() doesn't use processParentFlags()
+    virtual bool prepareTransform(const Mat4& parentTransform, uint32_t parentFlags) override { return false; }
+
     void onGridBeginDraw();
     void onGridEndDraw();
 
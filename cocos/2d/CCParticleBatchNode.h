@@ -132,6 +132,10 @@ CC_CONSTRUCTOR_ACCESS:
     /** initializes the particle system with the name of a file on disk (for a list of supported formats look at the Texture2D class), a capacity of particles */
     bool initWithFile(const std::string& fileImage, int capacity);
     
+protected:
+    // the children are not visited, they are updated by draw()
+    virtual bool prepareTransform(const Mat4& parentTransform, uint32_t parentFlags) override { return false; }
+
 private:
     void updateAllAtlasIndexes();
     void increaseAtlasCapacityTo(ssize_t quantity);
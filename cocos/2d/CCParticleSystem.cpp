@@ -47,6 +47,7 @@ THE SOFTWARE.
 #include <string>
 
 #include "2d/CCParticleBatchNode.h"
+#include "math/CCSIMD.h"
 #include "renderer/CCTextureAtlas.h"
 #include "base/base64.h"
 #include "base/ZipUtils.h"
@@ -77,12 +78,110 @@ NS_CC_BEGIN
 //  cocos2d uses a another approach, but the results are almost identical. 
 //
 
+ParticleData::ParticleData()
+: atlasIndex(nullptr)
+, _buffer(nullptr)
+, _maxCount(0)
+, _capacity(0)
+{
+    float** arrays[FLOAT_ARRAY_COUNT];
+    getFloatArrays(arrays);
+    for (int i = 0; i < FLOAT_ARRAY_COUNT; ++i)
+    {
+        *arrays[i] = nullptr;
+    }
+}
+
+ParticleData::~ParticleData()
+{
+    release();
+}
+
+void ParticleData::getFloatArrays(float** arrays[FLOAT_ARRAY_COUNT])
+{
+    float** all[FLOAT_ARRAY_COUNT] = {
+        &posx, &posy, &startPosX, &startPosY,
+        &colorR, &colorG, &colorB, &colorA,
+        &deltaColorR, &deltaColorG, &deltaColorB, &deltaColorA,
+        &size, &deltaSize, &rotation, &deltaRotation, &timeToLive,
+        &modeA.dirX, &modeA.dirY, &modeA.radialAccel, &modeA.tangentialAccel,
+        &modeB.angle, &modeB.degreesPerSecond, &modeB.radius, &modeB.deltaRadius,
+    };
+    memcpy(arrays, all, sizeof(all));
+}
+
+bool ParticleData::init(int count)
+{
+    // padded so the last particles can be loaded 4 at a time
+    int capacity = (count + 3) & ~3;
+    if (capacity == 0)
+        capacity = 4;
+
+    // the float arrays, then the atlas indices
+    void* buffer = calloc((FLOAT_ARRAY_COUNT + 1) * capacity, sizeof(float));
+    if (!buffer)
+        return false;
+
+    float** arrays[FLOAT_ARRAY_COUNT];
+    getFloatArrays(arrays);
+
+    int kept = MIN(count, _maxCount);
+    for (int i = 0; i < FLOAT_ARRAY_COUNT; ++i)
+    {
+        float* array = static_cast<float*>(buffer) + i * capacity;
+        if (kept > 0)
+        {
+            memcpy(array, *arrays[i], kept * sizeof(float));
+        }
+        *arrays[i] = array;
+    }
+    unsigned int* indices = reinterpret_cast<unsigned int*>(static_cast<float*>(buffer) + FLOAT_ARRAY_COUNT * capacity);
+    if (kept > 0)
+    {
+        memcpy(indices, atlasIndex, kept * sizeof(unsigned int));
+    }
+    atlasIndex = indices;
+
+    free(_buffer);
+    _buffer = buffer;
+    _maxCount = count;
+    _capacity = capacity;
+    return true;
+}
+
+void ParticleData::release()
+{
+    CC_SAFE_FREE(_buffer);
+
+    float** arrays[FLOAT_ARRAY_COUNT];
+    getFloatArrays(arrays);
+    for (int i = 0; i < FLOAT_ARRAY_COUNT; ++i)
+    {
+        *arrays[i] = nullptr;
+    }
+    atlasIndex = nullptr;
+    _maxCount = 0;
+    _capacity = 0;
+}
+
+void ParticleData::copyParticle(int dst, int src)
+{
+    float** arrays[FLOAT_ARRAY_COUNT];
+    getFloatArrays(arrays);
+
+    for (int i = 0; i < FLOAT_ARRAY_COUNT; ++i)
+    {
+        float* array = *arrays[i];
+        array[dst] = array[src];
+    }
+    atlasIndex[dst] = atlasIndex[src];
+}
+
 ParticleSystem::ParticleSystem()
 : _isBlendAdditive(false)
 , _isAutoRemoveOnFinish(false)
 , _plistFile("")
 , _elapsed(0)
-, _particles(nullptr)
 , _configName("")
 , _emitCounter(0)
 , _particleIdx(0)
@@ -405,11 +504,9 @@ bool ParticleSystem::initWithTotalParticles(int numberOfParticles)
 {
     _totalParticles = numberOfParticles;
 
-    CC_SAFE_FREE(_particles);
-    
-    _particles = (tParticle*)calloc(_totalParticles, sizeof(tParticle));
+    _particleData.release();
 
-    if( ! _particles )
+    if( !_particleData.init(_totalParticles) )
     {
         CCLOG("Particle system: not enough memory");
         this->release();
@@ -421,7 +518,7 @@ bool ParticleSystem::initWithTotalParticles(int numberOfParticles)
     {
         for (int i = 0; i < _totalParticles; i++)
         {
-            _particles[i].atlasIndex=i;
+            _particleData.atlasIndex[i] = i;
         }
     }
     // default, active
@@ -454,7 +551,7 @@ ParticleSystem::~ParticleSystem()
     // Since the scheduler retains the "target (in this case the ParticleSystem)
 	// it is not needed to call "unscheduleUpdate" here. In fact, it will be called in "cleanup"
     //unscheduleUpdate();
-    CC_SAFE_FREE(_particles);
+    _particleData.release();
     CC_SAFE_RELEASE(_texture);
 }
 
@@ -465,24 +562,24 @@ bool ParticleSystem::addParticle()
         return false;
     }
 
-    tParticle * particle = &_particles[ _particleCount ];
-    this->initParticle(particle);
+    this->initParticle(_particleCount);
     ++_particleCount;
 
     return true;
 }
 
-void ParticleSystem::initParticle(tParticle* particle)
+void ParticleSystem::initParticle(int index)
 {
     // timeToLive
     // no negative life. prevent division by 0
-    particle->timeToLive = _life + _lifeVar * CCRANDOM_MINUS1_1();
-    particle->timeToLive = MAX(0, particle->timeToLive);
+    float timeToLive = _life + _lifeVar * CCRANDOM_MINUS1_1();
+    timeToLive = MAX(0, timeToLive);
+    _particleData.timeToLive[index] = timeToLive;
 
     // position
-    particle->pos.x = _sourcePosition.x + _posVar.x * CCRANDOM_MINUS1_1();
+    _particleData.posx[index] = _sourcePosition.x + _posVar.x * CCRANDOM_MINUS1_1();
 
-    particle->pos.y = _sourcePosition.y + _posVar.y * CCRANDOM_MINUS1_1();
+    _particleData.posy[index] = _sourcePosition.y + _posVar.y * CCRANDOM_MINUS1_1();
 
 
     // Color
@@ -498,43 +595,49 @@ void ParticleSystem::initParticle(tParticle* particle)
     end.b = clampf(_endColor.b + _endColorVar.b * CCRANDOM_MINUS1_1(), 0, 1);
     end.a = clampf(_endColor.a + _endColorVar.a * CCRANDOM_MINUS1_1(), 0, 1);
 
-    particle->color = start;
-    particle->deltaColor.r = (end.r - start.r) / particle->timeToLive;
-    particle->deltaColor.g = (end.g - start.g) / particle->timeToLive;
-    particle->deltaColor.b = (end.b - start.b) / particle->timeToLive;
-    particle->deltaColor.a = (end.a - start.a) / particle->timeToLive;
+    _particleData.colorR[index] = start.r;
+    _particleData.colorG[index] = start.g;
+    _particleData.colorB[index] = start.b;
+    _particleData.colorA[index] = start.a;
+    _particleData.deltaColorR[index] = (end.r - start.r) / timeToLive;
+    _particleData.deltaColorG[index] = (end.g - start.g) / timeToLive;
+    _particleData.deltaColorB[index] = (end.b - start.b) / timeToLive;
+    _particleData.deltaColorA[index] = (end.a - start.a) / timeToLive;
 
     // size
     float startS = _startSize + _startSizeVar * CCRANDOM_MINUS1_1();
     startS = MAX(0, startS); // No negative value
 
-    particle->size = startS;
+    _particleData.size[index] = startS;
 
     if (_endSize == START_SIZE_EQUAL_TO_END_SIZE)
     {
-        particle->deltaSize = 0;
+        _particleData.deltaSize[index] = 0;
     }
     else
     {
         float endS = _endSize + _endSizeVar * CCRANDOM_MINUS1_1();
         endS = MAX(0, endS); // No negative values
-        particle->deltaSize = (endS - startS) / particle->timeToLive;
+        _particleData.deltaSize[index] = (endS - startS) / timeToLive;
     }
 
     // rotation
     float startA = _startSpin + _startSpinVar * CCRANDOM_MINUS1_1();
     float endA = _endSpin + _endSpinVar * CCRANDOM_MINUS1_1();
-    particle->rotation = startA;
-    particle->deltaRotation = (endA - startA) / particle->timeToLive;
+    _particleData.rotation[index] = startA;
+    _particleData.deltaRotation[index] = (endA - startA) / timeToLive;
 
     // position
     if (_positionType == PositionType::FREE)
     {
-        particle->startPos = this->convertToWorldSpace(Vec2::ZERO);
+        Vec2 startPos = this->convertToWorldSpace(Vec2::ZERO);
+        _particleData.startPosX[index] = startPos.x;
+        _particleData.startPosY[index] = startPos.y;
     }
     else if (_positionType == PositionType::RELATIVE)
     {
-        particle->startPos = _position;
+        _particleData.startPosX[index] = _position.x;
+        _particleData.startPosY[index] = _position.y;
     }
 
     // direction
@@ -547,18 +650,20 @@ void ParticleSystem::initParticle(tParticle* particle)
         float s = modeA.speed + modeA.speedVar * CCRANDOM_MINUS1_1();
 
         // direction
-        particle->modeA.dir = v * s ;
+        Vec2 dir = v * s;
+        _particleData.modeA.dirX[index] = dir.x;
+        _particleData.modeA.dirY[index] = dir.y;
 
         // radial accel
-        particle->modeA.radialAccel = modeA.radialAccel + modeA.radialAccelVar * CCRANDOM_MINUS1_1();
+        _particleData.modeA.radialAccel[index] = modeA.radialAccel + modeA.radialAccelVar * CCRANDOM_MINUS1_1();
  
 
         // tangential accel
-        particle->modeA.tangentialAccel = modeA.tangentialAccel + modeA.tangentialAccelVar * CCRANDOM_MINUS1_1();
+        _particleData.modeA.tangentialAccel[index] = modeA.tangentialAccel + modeA.tangentialAccelVar * CCRANDOM_MINUS1_1();
 
         // rotation is dir
         if(modeA.rotationIsDir)
-            particle->rotation = -CC_RADIANS_TO_DEGREES(particle->modeA.dir.getAngle());
+            _particleData.rotation[index] = -CC_RADIANS_TO_DEGREES(dir.getAngle());
     }
 
     // Mode Radius: B
@@ -568,19 +673,19 @@ void ParticleSystem::initParticle(tParticle* particle)
         float startRadius = modeB.startRadius + modeB.startRadiusVar * CCRANDOM_MINUS1_1();
         float endRadius = modeB.endRadius + modeB.endRadiusVar * CCRANDOM_MINUS1_1();
 
-        particle->modeB.radius = startRadius;
+        _particleData.modeB.radius[index] = startRadius;
 
         if (modeB.endRadius == START_RADIUS_EQUAL_TO_END_RADIUS)
         {
-            particle->modeB.deltaRadius = 0;
+            _particleData.modeB.deltaRadius[index] = 0;
         }
         else
         {
-            particle->modeB.deltaRadius = (endRadius - startRadius) / particle->timeToLive;
+            _particleData.modeB.deltaRadius[index] = (endRadius - startRadius) / timeToLive;
         }
 
-        particle->modeB.angle = a;
-        particle->modeB.degreesPerSecond = CC_DEGREES_TO_RADIANS(modeB.rotatePerSecond + modeB.rotatePerSecondVar * CCRANDOM_MINUS1_1());
+        _particleData.modeB.angle[index] = a;
+        _particleData.modeB.degreesPerSecond[index] = CC_DEGREES_TO_RADIANS(modeB.rotatePerSecond + modeB.rotatePerSecondVar * CCRANDOM_MINUS1_1());
     }    
 }
 
@@ -619,8 +724,7 @@ void ParticleSystem::resetSystem()
     _elapsed = 0;
     for (_particleIdx = 0; _particleIdx < _particleCount; ++_particleIdx)
     {
-        tParticle *p = &_particles[_particleIdx];
-        p->timeToLive = 0;
+        _particleData.timeToLive[_particleIdx] = 0;
     }
 }
 bool ParticleSystem::isFull()
@@ -655,154 +759,137 @@ void ParticleSystem::update(float dt)
         }
     }
 
-    _particleIdx = 0;
+    using namespace SIMD;
 
-    Vec2 currentPosition = Vec2::ZERO;
-    if (_positionType == PositionType::FREE)
-    {
-        currentPosition = this->convertToWorldSpace(Vec2::ZERO);
-    }
-    else if (_positionType == PositionType::RELATIVE)
+    const float4 delta = splat(dt);
+
+    // life
+    float* timeToLive = _particleData.timeToLive;
+    for (int i = 0; i < _particleCount; i += 4)
     {
-        currentPosition = _position;
+        store(timeToLive + i, sub(load(timeToLive + i), delta));
     }
 
+    // remove the dead particles, the last particle takes the place of a dead one
+    for (int i = 0; i < _particleCount; )
     {
-        Mat4 worldToNodeTM = getWorldToNodeTransform();
-        
-        while (_particleIdx < _particleCount)
+        if (timeToLive[i] > 0)
         {
-            tParticle *p = &_particles[_particleIdx];
-
-            // life
-            p->timeToLive -= dt;
-
-            if (p->timeToLive > 0) 
-            {
-                // Mode A: gravity, direction, tangential accel & radial accel
-                if (_emitterMode == Mode::GRAVITY)
-                {
-                    Vec2 tmp, radial, tangential;
-
-                    radial = Vec2::ZERO;
-                    // radial acceleration
-                    if (p->pos.x || p->pos.y)
-                    {
-                        radial = p->pos.getNormalized();
-                    }
-                    tangential = radial;
-                    radial = radial * p->modeA.radialAccel;
-
-                    // tangential acceleration
-                    float newy = tangential.x;
-                    tangential.x = -tangential.y;
-                    tangential.y = newy;
-                    tangential = tangential * p->modeA.tangentialAccel;
-
-                    // (gravity + radial + tangential) * dt
-                    tmp = radial + tangential + modeA.gravity;
-                    tmp = tmp * dt;
-                    p->modeA.dir = p->modeA.dir + tmp;
-                    
-                    // this is cocos2d-x v3.0
-//                    if (_configName.length()>0 && _yCoordFlipped != -1)
-
-                    // this is cocos2d-x v3.0
-                    tmp = p->modeA.dir * dt * _yCoordFlipped;
-                    p->pos = p->pos + tmp;
-                }
-
-                // Mode B: radius movement
-                else 
-                {                
-                    // Update the angle and radius of the particle.
-                    p->modeB.angle += p->modeB.degreesPerSecond * dt;
-                    p->modeB.radius += p->modeB.deltaRadius * dt;
-
-                    p->pos.x = - cosf(p->modeB.angle) * p->modeB.radius;
-                    p->pos.y = - sinf(p->modeB.angle) * p->modeB.radius;
-                    p->pos.y *= _yCoordFlipped;
-				}
-
-                // color
-                p->color.r += (p->deltaColor.r * dt);
-                p->color.g += (p->deltaColor.g * dt);
-                p->color.b += (p->deltaColor.b * dt);
-                p->color.a += (p->deltaColor.a * dt);
+            ++i;
+            continue;
+        }
 
-                // size
-                p->size += (p->deltaSize * dt);
-                p->size = MAX( 0, p->size );
+        int currentIndex = _particleData.atlasIndex[i];
+        if( i != _particleCount-1 )
+        {
+            _particleData.copyParticle(i, _particleCount-1);
+        }
+        if (_batchNode)
+        {
+            //disable the switched particle
+            _batchNode->disableParticle(_atlasIndex+currentIndex);
 
-                // angle
-                p->rotation += (p->deltaRotation * dt);
+            //switch indexes
+            _particleData.atlasIndex[_particleCount-1] = currentIndex;
+        }
 
-                //
-                // update values in quad
-                //
+        --_particleCount;
 
-                Vec2    newPos;
+        if( _particleCount == 0 && _isAutoRemoveOnFinish )
+        {
+            this->unscheduleUpdate();
+            _parent->removeChild(this, true);
+            return;
+        }
+    }
 
-                if (_positionType == PositionType::FREE)
-                {
-                    Vec3 p1(currentPosition.x,currentPosition.y,0),p2(p->startPos.x,p->startPos.y,0);
-                    worldToNodeTM.transformPoint(&p1);
-                    worldToNodeTM.transformPoint(&p2);
-                    p1 = p1 - p2;
-                    newPos = p->pos - Vec2(p1.x,p1.y);
-                }
-                else if(_positionType == PositionType::RELATIVE)
-                {
-                    Vec2 diff = currentPosition - p->startPos;
-                    newPos = p->pos - diff;
-                } 
-                else
-                {
-                    newPos = p->pos;
-                }
+    // The arrays are padded to a multiple of 4, the lanes after the last living particle
+    // are computed too and ignored.
+    if (_emitterMode == Mode::GRAVITY)
+    {
+        // Mode A: gravity, direction, tangential accel & radial accel
+        const float4 one = splat(1.0f);
+        const float4 tolerance = splat(MATH_TOLERANCE);
+        const float4 gravityX = splat(modeA.gravity.x);
+        const float4 gravityY = splat(modeA.gravity.y);
+        const float4 flip = splat((float)_yCoordFlipped);
+
+        for (int i = 0; i < _particleCount; i += 4)
+        {
+            float4 x = load(_particleData.posx + i);
+            float4 y = load(_particleData.posy + i);
+
+            // radial = pos.getNormalized(), Vec2::normalize() doesn't scale a unit or a null vector
+            float4 n = add(mul(x, x), mul(y, y));
+            float4 length = sqrt4(n);
+            mask4 scaled = both(notEqual(n, one), notLess(length, tolerance));
+            float4 inverse = div(one, length);
+            float4 radialX = select(scaled, mul(x, inverse), x);
+            float4 radialY = select(scaled, mul(y, inverse), y);
+
+            // tangential is radial rotated by 90 degrees
+            float4 radialAccel = load(_particleData.modeA.radialAccel + i);
+            float4 tangentialAccel = load(_particleData.modeA.tangentialAccel + i);
+
+            // (gravity + radial + tangential) * dt
+            float4 tmpX = mul(add(add(mul(radialX, radialAccel), mul(neg(radialY), tangentialAccel)), gravityX), delta);
+            float4 tmpY = mul(add(add(mul(radialY, radialAccel), mul(radialX, tangentialAccel)), gravityY), delta);
+
+            float4 dirX = add(load(_particleData.modeA.dirX + i), tmpX);
+            float4 dirY = add(load(_particleData.modeA.dirY + i), tmpY);
+            store(_particleData.modeA.dirX + i, dirX);
+            store(_particleData.modeA.dirY + i, dirY);
+
+            // this is cocos2d-x v3.0
+            store(_particleData.posx + i, add(x, mul(mul(dirX, delta), flip)));
+            store(_particleData.posy + i, add(y, mul(mul(dirY, delta), flip)));
+        }
+    }
+    else
+    {
+        // Mode B: radius movement
+        // Update the angle and radius of the particles.
+        for (int i = 0; i < _particleCount; i += 4)
+        {
+            float4 angle = add(load(_particleData.modeB.angle + i), mul(load(_particleData.modeB.degreesPerSecond + i), delta));
+            float4 radius = add(load(_particleData.modeB.radius + i), mul(load(_particleData.modeB.deltaRadius + i), delta));
+            store(_particleData.modeB.angle + i, angle);
+            store(_particleData.modeB.radius + i, radius);
+        }
 
-                // translate newPos to correct position, since matrix transform isn't performed in batchnode
-                // don't update the particle with the new position information, it will interfere with the radius and tangential calculations
-                if (_batchNode)
-                {
-                    newPos.x+=_position.x;
-                    newPos.y+=_position.y;
-                }
+        for (int i = 0; i < _particleCount; ++i)
+        {
+            _particleData.posx[i] = - cosf(_particleData.modeB.angle[i]) * _particleData.modeB.radius[i];
+            _particleData.posy[i] = - sinf(_particleData.modeB.angle[i]) * _particleData.modeB.radius[i];
+            _particleData.posy[i] *= _yCoordFlipped;
+        }
+    }
 
-                updateQuadWithParticle(p, newPos);
+    {
+        const float4 zero = splat(0.0f);
+        for (int i = 0; i < _particleCount; i += 4)
+        {
+            // color
+            store(_particleData.colorR + i, add(load(_particleData.colorR + i), mul(load(_particleData.deltaColorR + i), delta)));
+            store(_particleData.colorG + i, add(load(_particleData.colorG + i), mul(load(_particleData.deltaColorG + i), delta)));
+            store(_particleData.colorB + i, add(load(_particleData.colorB + i), mul(load(_particleData.deltaColorB + i), delta)));
+            store(_particleData.colorA + i, add(load(_particleData.colorA + i), mul(load(_particleData.deltaColorA + i), delta)));
 
-                // update particle counter
-                ++_particleIdx;
-            } 
-            else 
-            {
-                // life < 0
-                int currentIndex = p->atlasIndex;
-                if( _particleIdx != _particleCount-1 )
-                {
-                    _particles[_particleIdx] = _particles[_particleCount-1];
-                }
-                if (_batchNode)
-                {
-                    //disable the switched particle
-                    _batchNode->disableParticle(_atlasIndex+currentIndex);
+            // size
+            float4 size = add(load(_particleData.size + i), mul(load(_particleData.deltaSize + i), delta));
+            store(_particleData.size + i, maximum(size, zero));
 
-                    //switch indexes
-                    _particles[_particleCount-1].atlasIndex = currentIndex;
-                }
+            // angle
+            store(_particleData.rotation + i, add(load(_particleData.rotation + i), mul(load(_particleData.deltaRotation + i), delta)));
+        }
+    }
 
-                --_particleCount;
+    //
+    // update values in quads
+    //
+    _particleIdx = _particleCount;
+    updateParticleQuads();
 
-                if( _particleCount == 0 && _isAutoRemoveOnFinish )
-                {
-                    this->unscheduleUpdate();
-                    _parent->removeChild(this, true);
-                    return;
-                }
-            }
-        } //while
-    }
-    
     // only update gl buffer when visible
     if (_visible && ! _batchNode)
     {
@@ -1106,7 +1193,7 @@ void ParticleSystem::setBatchNode(ParticleBatchNode* batchNode)
             //each particle needs a unique index
             for (int i = 0; i < _totalParticles; i++)
             {
-                _particles[i].atlasIndex=i;
+                _particleData.atlasIndex[i] = i;
             }
         }
     }
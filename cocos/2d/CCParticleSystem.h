@@ -40,44 +40,81 @@ NS_CC_BEGIN
 
 class ParticleBatchNode;
 
-/**
-Structure that contains the values of each particle
-*/
-typedef struct sParticle {
-    Vec2     pos;
-    Vec2     startPos;
-
-    Color4F    color;
-    Color4F    deltaColor;
-
-    float        size;
-    float        deltaSize;
-
-    float        rotation;
-    float        deltaRotation;
+/** @brief The values of the particles of a particle system, stored as a structure of arrays.
 
-    float        timeToLive;
-
-    unsigned int    atlasIndex;
+The values of the particle i are the i-th elements of the arrays. The arrays are allocated
+in one block and padded to a multiple of 4 particles, so the update of the particle system
+can process the particles 4 at a time with SIMD instructions.
+*/
+class CC_DLL ParticleData
+{
+public:
+    float* posx;
+    float* posy;
+    float* startPosX;
+    float* startPosY;
+
+    float* colorR;
+    float* colorG;
+    float* colorB;
+    float* colorA;
+
+    float* deltaColorR;
+    float* deltaColorG;
+    float* deltaColorB;
+    float* deltaColorA;
+
+    float* size;
+    float* deltaSize;
+    float* rotation;
+    float* deltaRotation;
+    float* timeToLive;
+    unsigned int* atlasIndex;
 
     //! Mode A: gravity, direction, radial accel, tangential accel
     struct {
-        Vec2        dir;
-        float        radialAccel;
-        float        tangentialAccel;
+        float* dirX;
+        float* dirY;
+        float* radialAccel;
+        float* tangentialAccel;
     } modeA;
 
     //! Mode B: radius mode
     struct {
-        float        angle;
-        float        degreesPerSecond;
-        float        radius;
-        float        deltaRadius;
+        float* angle;
+        float* degreesPerSecond;
+        float* radius;
+        float* deltaRadius;
     } modeB;
 
-}tParticle;
+    ParticleData();
+    ~ParticleData();
 
-//typedef void (*CC_UPDATE_PARTICLE_IMP)(id, SEL, tParticle*, Vec2);
+    /** Allocates the arrays for count particles. The values of the particles already allocated are kept.
+     Returns false if there is not enough memory, the arrays are unchanged then.
+     */
+    bool init(int count);
+    /** Frees the arrays */
+    void release();
+
+    /** The number of particles the arrays can hold */
+    int getMaxCount() const { return _maxCount; }
+
+    /** Copies the values of the particle src to the particle dst */
+    void copyParticle(int dst, int src);
+
+private:
+    ParticleData(const ParticleData&);
+    ParticleData& operator=(const ParticleData&);
+
+    enum { FLOAT_ARRAY_COUNT = 25 };
+    void getFloatArrays(float** arrays[FLOAT_ARRAY_COUNT]);
+
+    void* _buffer;
+    int _maxCount;
+    // the padded size of the arrays
+    int _capacity;
+};
 
 class Texture2D;
 
@@ -179,8 +216,8 @@ public:
 
     //! Add a particle to the emitter
     bool addParticle();
-    //! Initializes a particle
-    void initParticle(tParticle* particle);
+    //! Initializes the particle at index
+    void initParticle(int index);
     //! stop emitting particles. Running particles will continue to run until they die
     void stopSystem();
     //! Kill all living particles.
@@ -188,8 +225,8 @@ public:
     //! whether or not the system is full
     bool isFull();
 
-    //! should be overridden by subclasses
-    virtual void updateQuadWithParticle(tParticle* particle, const Vec2& newPosition) {CCASSERT(false, "override me");}
+    //! should be overridden by subclasses, updates the quads of the living particles
+    virtual void updateParticleQuads() {CCASSERT(false, "override me");}
     //! should be overridden by subclasses
     virtual void postStep() {CCASSERT(false, "override me");}
 
@@ -457,8 +494,8 @@ protected:
         float rotatePerSecondVar;
     } modeB;
 
-    //! Array of particles
-    tParticle *_particles;
+    //! The values of the particles
+    ParticleData _particleData;
 
     //Emitter name
     std::string _configName;
@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "2d/CCParticleSystemQuad.h"
 #include "2d/CCSpriteFrame.h"
 #include "2d/CCParticleBatchNode.h"
+#include "math/CCSIMD.h"
 #include "renderer/CCVertexIndexData.h"
 #include "renderer/CCVertexIndexBuffer.h"
 #include "renderer/CCGLProgram.h"
@@ -278,86 +279,174 @@ void ParticleSystemQuad::setupVertices(size_t count)
     CC_SAFE_RETAIN(_ibParticles);
 }
 
-void ParticleSystemQuad::updateQuadWithParticle(tParticle* particle, const Vec2& newPosition)
+void ParticleSystemQuad::updateParticleQuads()
 {
-    V3F_C4B_T2F_Quad* quad;
+    if (_particleCount <= 0)
+    {
+        return;
+    }
+
+    using namespace SIMD;
 
+    V3F_C4B_T2F_Quad* quads;
     if (_batchNode)
     {
-        V3F_C4B_T2F_Quad* batchQuads = _batchNode->getTextureAtlas()->getQuads();
-        quad = &(batchQuads[_atlasIndex+particle->atlasIndex]);
+        quads = &(_batchNode->getTextureAtlas()->getQuads()[_atlasIndex]);
     }
     else
     {
-        auto quads = _vbParticles->getElementsOfType<V3F_C4B_T2F_Quad>();
-        quad = &(quads[_particleIdx]);
+        quads = _vbParticles->getElementsOfType<V3F_C4B_T2F_Quad>();
+    }
+
+    // newPos = pos - (current position - start position), in the node space for the FREE particles
+    Vec2 currentPosition = Vec2::ZERO;
+    Mat4 worldToNodeTM;
+    if (_positionType == PositionType::FREE)
+    {
+        currentPosition = this->convertToWorldSpace(Vec2::ZERO);
+        worldToNodeTM = getWorldToNodeTransform();
+        Vec3 p1(currentPosition.x, currentPosition.y, 0);
+        worldToNodeTM.transformPoint(&p1);
+        currentPosition.set(p1.x, p1.y);
     }
-    Color4B color = (_opacityModifyRGB)
-        ? Color4B( particle->color.r*particle->color.a*255, particle->color.g*particle->color.a*255, particle->color.b*particle->color.a*255, particle->color.a*255)
-        : Color4B( particle->color.r*255, particle->color.g*255, particle->color.b*255, particle->color.a*255);
-
-    quad->bl.colors = color;
-    quad->br.colors = color;
-    quad->tl.colors = color;
-    quad->tr.colors = color;
-
-    // vertices
-    float size_2 = particle->size/2;
-    if (particle->rotation) 
+    else if (_positionType == PositionType::RELATIVE)
     {
-        float x1 = -size_2;
-        float y1 = -size_2;
-
-        float x2 = size_2;
-        float y2 = size_2;
-        float x = newPosition.x;
-        float y = newPosition.y;
-
-        float r = (float)-CC_DEGREES_TO_RADIANS(particle->rotation);
-        float cr = cosf(r);
-        float sr = sinf(r);
-        float ax = x1 * cr - y1 * sr + x;
-        float ay = x1 * sr + y1 * cr + y;
-        float bx = x2 * cr - y1 * sr + x;
-        float by = x2 * sr + y1 * cr + y;
-        float cx = x2 * cr - y2 * sr + x;
-        float cy = x2 * sr + y2 * cr + y;
-        float dx = x1 * cr - y2 * sr + x;
-        float dy = x1 * sr + y2 * cr + y;
-
-        // bottom-left
-        quad->bl.vertices.x = ax;
-        quad->bl.vertices.y = ay;
+        currentPosition = _position;
+    }
 
-        // bottom-right vertex:
-        quad->br.vertices.x = bx;
-        quad->br.vertices.y = by;
+    // translate newPos to correct position, since matrix transform isn't performed in batchnode
+    // don't update the particle with the new position information, it will interfere with the radius and tangential calculations
+    Vec2 batchOffset = _batchNode ? _position : Vec2::ZERO;
+
+    const float4 currentX = splat(currentPosition.x);
+    const float4 currentY = splat(currentPosition.y);
+    const float4 m0 = splat(worldToNodeTM.m[0]);
+    const float4 m1 = splat(worldToNodeTM.m[1]);
+    const float4 m4 = splat(worldToNodeTM.m[4]);
+    const float4 m5 = splat(worldToNodeTM.m[5]);
+    const float4 m12 = splat(worldToNodeTM.m[12]);
+    const float4 m13 = splat(worldToNodeTM.m[13]);
+    const float4 offsetX = splat(batchOffset.x);
+    const float4 offsetY = splat(batchOffset.y);
+    const float4 half = splat(0.5f);
+    const float4 scale = splat(255.0f);
+
+    float newX[4], newY[4], halfSize[4];
+    uint32_t colors[4];
+
+    for (int i = 0; i < _particleCount; i += 4)
+    {
+        float4 x = load(_particleData.posx + i);
+        float4 y = load(_particleData.posy + i);
 
-        // top-left vertex:
-        quad->tl.vertices.x = dx;
-        quad->tl.vertices.y = dy;
+        if (_positionType == PositionType::FREE)
+        {
+            float4 startX = load(_particleData.startPosX + i);
+            float4 startY = load(_particleData.startPosY + i);
+            float4 p2x = add(add(mul(startX, m0), mul(startY, m4)), m12);
+            float4 p2y = add(add(mul(startX, m1), mul(startY, m5)), m13);
+            x = sub(x, sub(currentX, p2x));
+            y = sub(y, sub(currentY, p2y));
+        }
+        else if (_positionType == PositionType::RELATIVE)
+        {
+            x = sub(x, sub(currentX, load(_particleData.startPosX + i)));
+            y = sub(y, sub(currentY, load(_particleData.startPosY + i)));
+        }
 
-        // top-right vertex:
-        quad->tr.vertices.x = cx;
-        quad->tr.vertices.y = cy;
-    } 
-    else 
-    {
-        // bottom-left vertex:
-        quad->bl.vertices.x = newPosition.x - size_2;
-        quad->bl.vertices.y = newPosition.y - size_2;
+        if (_batchNode)
+        {
+            x = add(x, offsetX);
+            y = add(y, offsetY);
+        }
 
-        // bottom-right vertex:
-        quad->br.vertices.x = newPosition.x + size_2;
-        quad->br.vertices.y = newPosition.y - size_2;
+        store(newX, x);
+        store(newY, y);
+        store(halfSize, mul(load(_particleData.size + i), half));
 
-        // top-left vertex:
-        quad->tl.vertices.x = newPosition.x - size_2;
-        quad->tl.vertices.y = newPosition.y + size_2;
+        float4 r = load(_particleData.colorR + i);
+        float4 g = load(_particleData.colorG + i);
+        float4 b = load(_particleData.colorB + i);
+        float4 a = load(_particleData.colorA + i);
+        if (_opacityModifyRGB)
+        {
+            r = mul(r, a);
+            g = mul(g, a);
+            b = mul(b, a);
+        }
+        toColors(mul(r, scale), mul(g, scale), mul(b, scale), mul(a, scale), colors);
 
-        // top-right vertex:
-        quad->tr.vertices.x = newPosition.x + size_2;
-        quad->tr.vertices.y = newPosition.y + size_2;                
+        int count = MIN(4, _particleCount - i);
+        for (int j = 0; j < count; ++j)
+        {
+            int index = i + j;
+            V3F_C4B_T2F_Quad* quad = &(quads[_batchNode ? _particleData.atlasIndex[index] : index]);
+
+            memcpy(&quad->bl.colors, &colors[j], sizeof(Color4B));
+            memcpy(&quad->br.colors, &colors[j], sizeof(Color4B));
+            memcpy(&quad->tl.colors, &colors[j], sizeof(Color4B));
+            memcpy(&quad->tr.colors, &colors[j], sizeof(Color4B));
+
+            // vertices
+            float size_2 = halfSize[j];
+            float x = newX[j];
+            float y = newY[j];
+            float rotation = _particleData.rotation[index];
+            if (rotation)
+            {
+                float x1 = -size_2;
+                float y1 = -size_2;
+
+                float x2 = size_2;
+                float y2 = size_2;
+
+                float r = (float)-CC_DEGREES_TO_RADIANS(rotation);
+                float cr = cosf(r);
+                float sr = sinf(r);
+                float ax = x1 * cr - y1 * sr + x;
+                float ay = x1 * sr + y1 * cr + y;
+                float bx = x2 * cr - y1 * sr + x;
+                float by = x2 * sr + y1 * cr + y;
+                float cx = x2 * cr - y2 * sr + x;
+                float cy = x2 * sr + y2 * cr + y;
+                float dx = x1 * cr - y2 * sr + x;
+                float dy = x1 * sr + y2 * cr + y;
+
+                // bottom-left
+                quad->bl.vertices.x = ax;
+                quad->bl.vertices.y = ay;
+
+                // bottom-right vertex:
+                quad->br.vertices.x = bx;
+                quad->br.vertices.y = by;
+
+                // top-left vertex:
+                quad->tl.vertices.x = dx;
+                quad->tl.vertices.y = dy;
+
+                // top-right vertex:
+                quad->tr.vertices.x = cx;
+                quad->tr.vertices.y = cy;
+            }
+            else
+            {
+                // bottom-left vertex:
+                quad->bl.vertices.x = x - size_2;
+                quad->bl.vertices.y = y - size_2;
+
+                // bottom-right vertex:
+                quad->br.vertices.x = x + size_2;
+                quad->br.vertices.y = y - size_2;
+
+                // top-left vertex:
+                quad->tl.vertices.x = x - size_2;
+                quad->tl.vertices.y = y + size_2;
+
+                // top-right vertex:
+                quad->tr.vertices.x = x + size_2;
+                quad->tr.vertices.y = y + size_2;
+            }
+        }
     }
 }
 
@@ -386,6 +475,12 @@ void ParticleSystemQuad::setTotalParticles(int tp)
     // than what is allocated, we need to expand the vertex buffer
     if (tp > _allocatedParticles)
     {
+        if (!_particleData.init(tp))
+        {
+            CCLOG("Particle system: out of memory");
+            return;
+        }
+
         auto amount = tp - _allocatedParticles;
         if (amount > 0)
         {
@@ -401,9 +496,8 @@ void ParticleSystemQuad::setTotalParticles(int tp)
         // Init particles
         if (_batchNode)
         {
-            auto p = _particles;
-            for (int i = 0; i < _totalParticles; ++i, ++p)
-                p->atlasIndex = i;
+            for (int i = 0; i < _totalParticles; ++i)
+                _particleData.atlasIndex[i] = i;
         }
 
         // fixed http://www.cocos2d-x.org/issues/3990
@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "base/CCEventListenerCustom.h"
 #include "base/ccUTF8.h"
 #include "renderer/CCRenderer.h"
+#include "base/CCFrameProfiler.h"
 
 #if CC_USE_PHYSICS
 #include "physics/CCPhysicsWorld.h"
@@ -128,6 +129,8 @@ static bool camera_cmp(const Camera* a, const Camera* b)
 
 void Scene::render(Renderer* renderer)
 {
+    CC_PROFILE_ZONE("Scene::render");
+    
     auto director = Director::getInstance();
     Camera* defaultCamera = nullptr;
     const auto& transform = getNodeToParentTransform();
@@ -159,6 +162,14 @@ void Scene::render(Renderer* renderer)
     }
 
     Camera::_visitingCamera = nullptr;
+
+    // the prepared transforms of the nodes which were not visited can't be used in the next frame
+    newTransformPrepareStamp();
+}
+
+void Scene::prepareTransforms(int threadCount)
+{
+    prepareTransformsInParallel(getNodeToParentTransform(), threadCount);
 }
 
 #if CC_USE_PHYSICS
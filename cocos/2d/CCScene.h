@@ -79,6 +79,11 @@ public:
     
     /** render the scene */
     void render(Renderer* renderer);
+
+    /** Computes the world transforms of the scene graph on `threadCount` threads.
+     The next render() reuses them instead of computing them while visiting the scene.
+     */
+    void prepareTransforms(int threadCount);
     
 CC_CONSTRUCTOR_ACCESS:
     Scene();
@@ -41,6 +41,8 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+CC_IMPLEMENT_OBJECT_POOL(Sprite, 128)
+
 #if CC_SPRITEBATCHNODE_RENDER_SUBPIXEL
 #define RENDER_IN_SUBPIXEL
 #else
@@ -182,6 +182,9 @@ CC_CONSTRUCTOR_ACCESS:
     bool init();
     
 protected:
+    // the children are not visited, they are updated by draw()
+    virtual bool prepareTransform(const Mat4& parentTransform, uint32_t parentFlags) override { return false; }
+
     /** Updates a quad at a certain index into the texture atlas. The Sprite won't be added into the children array.
      This method should be called only when you are dealing with very big AtlasSrite and when most of the Sprite won't be updated.
      For example: a tile map (TMXMap) or a label with lots of characters (LabelBMFont)
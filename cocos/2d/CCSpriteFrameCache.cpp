@@ -29,15 +29,17 @@ THE SOFTWARE.
 
 #include "2d/CCSpriteFrameCache.h"
 
+#include <algorithm>
+#include <unordered_set>
 #include <vector>
 
-
 #include "2d/CCSprite.h"
 #include "platform/CCFileUtils.h"
 #include "base/CCNS.h"
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
 #include "base/ccUTF8.h"
+#include "base/CCJobSystem.h"
 #include "renderer/CCTexture2D.h"
 #include "renderer/CCTextureCache.h"
 
@@ -47,6 +49,66 @@ NS_CC_BEGIN
 
 static SpriteFrameCache *_sharedSpriteFrameCache = nullptr;
 
+// The dictionaries are only read: the non const accessors would copy them if they are shared, see Value
+static const Value& valueForKey(const ValueMap& dict, const std::string& key)
+{
+    auto iter = dict.find(key);
+    return iter != dict.end() ? iter->second : Value::Null;
+}
+
+struct SpriteFrameCache::FrameDef
+{
+    std::string name;
+    Rect rect;
+    bool rotated;
+    Vec2 offset;
+    Size originalSize;
+    std::vector<std::string> aliases;
+};
+
+struct SpriteFrameCache::AsyncSheet
+{
+    AsyncSheet() : parsed(false), cancelled(false) {}
+
+    std::string plist;
+    std::string fullPath;
+
+    // set by the worker
+    std::vector<FrameDef> frames;
+    std::string textureFileName;
+    bool parsed;
+
+    // set on the main thread
+    bool cancelled;
+    std::vector<std::function<void(bool)>> callbacks;
+};
+
+// the versions are never reused, so the handles stay valid when the cache is destroyed and created again
+static unsigned int s_spriteFrameCacheVersion = 0;
+
+// the texture of a plist: the textureFileName of its metadata, or the plist with a .png extension
+static std::string getTexturePath(const std::string& plist, const std::string& textureFileName)
+{
+    if (!textureFileName.empty())
+    {
+        // build texture path relative to plist file
+        return FileUtils::getInstance()->fullPathFromRelativeFile(textureFileName, plist);
+    }
+
+    // build texture path by replacing file extension
+    std::string texturePath = plist;
+
+    // remove .xxx
+    size_t startPos = texturePath.find_last_of(".");
+    texturePath = texturePath.erase(startPos);
+
+    // append .png
+    texturePath = texturePath.append(".png");
+
+    CCLOG("cocos2d: SpriteFrameCache: Trying to use file %s as texture", texturePath.c_str());
+    return texturePath;
+}
+
 SpriteFrameCache* SpriteFrameCache::getInstance()
 {
     if (! _sharedSpriteFrameCache)
@@ -68,15 +130,26 @@ bool SpriteFrameCache::init()
     _spriteFrames.reserve(20);
     _spriteFramesAliases.reserve(20);
     _loadedFileNames = new std::set<std::string>();
+    _version = ++s_spriteFrameCacheVersion;
     return true;
 }
 
 SpriteFrameCache::~SpriteFrameCache()
 {
+    // the pending loads finish without the cache
+    for (auto& pending : _asyncSheets)
+    {
+        pending.second->cancelled = true;
+    }
     CC_SAFE_DELETE(_loadedFileNames);
 }
 
-void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dictionary, Texture2D* texture)
+void SpriteFrameCache::updateVersion()
+{
+    _version = ++s_spriteFrameCacheVersion;
+}
+
+void SpriteFrameCache::parseSpriteFrames(const ValueMap& dictionary, std::vector<FrameDef>& frames)
 {
     /*
     Supported Zwoptex Formats:
@@ -88,39 +161,37 @@ void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dictionary, Textu
     */
 
     
-    ValueMap& framesDict = dictionary["frames"].asValueMap();
+    const ValueMap& framesDict = valueForKey(dictionary, "frames").asValueMap();
     int format = 0;
 
     // get the format
     if (dictionary.find("metadata") != dictionary.end())
     {
-        ValueMap& metadataDict = dictionary["metadata"].asValueMap();
-        format = metadataDict["format"].asInt();
+        const ValueMap& metadataDict = valueForKey(dictionary, "metadata").asValueMap();
+        format = valueForKey(metadataDict, "format").asInt();
     }
 
     // check the format
     CCASSERT(format >=0 && format <= 3, "format is not supported for SpriteFrameCache addSpriteFramesWithDictionary:textureFilename:");
 
+    frames.reserve(frames.size() + framesDict.size());
     for (auto iter = framesDict.begin(); iter != framesDict.end(); ++iter)
     {
-        ValueMap& frameDict = iter->second.asValueMap();
-        std::string spriteFrameName = iter->first;
-        SpriteFrame* spriteFrame = _spriteFrames.at(spriteFrameName);
-        if (spriteFrame)
-        {
-            continue;
-        }
+        const ValueMap& frameDict = iter->second.asValueMap();
+        FrameDef def;
+        def.name = iter->first;
+        def.rotated = false;
         
         if(format == 0) 
         {
-            float x = frameDict["x"].asFloat();
-            float y = frameDict["y"].asFloat();
-            float w = frameDict["width"].asFloat();
-            float h = frameDict["height"].asFloat();
-            float ox = frameDict["offsetX"].asFloat();
-            float oy = frameDict["offsetY"].asFloat();
-            int ow = frameDict["originalWidth"].asInt();
-            int oh = frameDict["originalHeight"].asInt();
+            float x = valueForKey(frameDict, "x").asFloat();
+            float y = valueForKey(frameDict, "y").asFloat();
+            float w = valueForKey(frameDict, "width").asFloat();
+            float h = valueForKey(frameDict, "height").asFloat();
+            float ox = valueForKey(frameDict, "offsetX").asFloat();
+            float oy = valueForKey(frameDict, "offsetY").asFloat();
+            int ow = valueForKey(frameDict, "originalWidth").asInt();
+            int oh = valueForKey(frameDict, "originalHeight").asInt();
             // check ow/oh
             if(!ow || !oh)
             {
@@ -129,69 +200,114 @@ void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dictionary, Textu
             // abs ow/oh
             ow = abs(ow);
             oh = abs(oh);
-            // create frame
-            spriteFrame = SpriteFrame::createWithTexture(texture,
-                                                         Rect(x, y, w, h),
-                                                         false,
-                                                         Vec2(ox, oy),
-                                                         Size((float)ow, (float)oh)
-                                                         );
+
+            def.rect = Rect(x, y, w, h);
+            def.offset = Vec2(ox, oy);
+            def.originalSize = Size((float)ow, (float)oh);
         } 
         else if(format == 1 || format == 2) 
         {
-            Rect frame = RectFromString(frameDict["frame"].asString());
-            bool rotated = false;
+            def.rect = RectFromString(valueForKey(frameDict, "frame").asString());
 
             // rotation
             if (format == 2)
             {
-                rotated = frameDict["rotated"].asBool();
+                def.rotated = valueForKey(frameDict, "rotated").asBool();
             }
 
-            Vec2 offset = PointFromString(frameDict["offset"].asString());
-            Size sourceSize = SizeFromString(frameDict["sourceSize"].asString());
-
-            // create frame
-            spriteFrame = SpriteFrame::createWithTexture(texture,
-                                                         frame,
-                                                         rotated,
-                                                         offset,
-                                                         sourceSize
-                                                         );
+            def.offset = PointFromString(valueForKey(frameDict, "offset").asString());
+            def.originalSize = SizeFromString(valueForKey(frameDict, "sourceSize").asString());
         } 
         else if (format == 3)
         {
             // get values
-            Size spriteSize = SizeFromString(frameDict["spriteSize"].asString());
-            Vec2 spriteOffset = PointFromString(frameDict["spriteOffset"].asString());
-            Size spriteSourceSize = SizeFromString(frameDict["spriteSourceSize"].asString());
-            Rect textureRect = RectFromString(frameDict["textureRect"].asString());
-            bool textureRotated = frameDict["textureRotated"].asBool();
+            Size spriteSize = SizeFromString(valueForKey(frameDict, "spriteSize").asString());
+            Rect textureRect = RectFromString(valueForKey(frameDict, "textureRect").asString());
+
+            def.rect = Rect(textureRect.origin.x, textureRect.origin.y, spriteSize.width, spriteSize.height);
+            def.rotated = valueForKey(frameDict, "textureRotated").asBool();
+            def.offset = PointFromString(valueForKey(frameDict, "spriteOffset").asString());
+            def.originalSize = SizeFromString(valueForKey(frameDict, "spriteSourceSize").asString());
 
             // get aliases
-            ValueVector& aliases = frameDict["aliases"].asValueVector();
+            const Value& aliasesValue = valueForKey(frameDict, "aliases");
+            const ValueVector& aliases = aliasesValue.getType() == Value::Type::VECTOR ? aliasesValue.asValueVector() : ValueVectorNull;
 
             for(const auto &value : aliases) {
-                std::string oneAlias = value.asString();
-                if (_spriteFramesAliases.find(oneAlias) != _spriteFramesAliases.end())
-                {
-                    CCLOGWARN("cocos2d: WARNING: an alias with name %s already exists", oneAlias.c_str());
-                }
+                def.aliases.push_back(value.asString());
+            }
+        }
+
+        frames.push_back(std::move(def));
+    }
+}
 
-                _spriteFramesAliases[oneAlias] = Value(spriteFrameName);
+void SpriteFrameCache::addSpriteFrames(const std::string& plist, const std::vector<FrameDef>& frames, Texture2D* texture)
+{
+    SpriteSheet* sheet = nullptr;
+    if (!plist.empty())
+    {
+        sheet = &_spriteSheets[plist];
+        sheet->frames.clear();
+        sheet->frames.reserve(frames.size());
+        sheet->texture = texture;
+    }
+
+    for (const auto& def : frames)
+    {
+        if (_spriteFrames.at(def.name))
+        {
+            continue;
+        }
+
+        for (const auto& oneAlias : def.aliases)
+        {
+            if (_spriteFramesAliases.find(oneAlias) != _spriteFramesAliases.end())
+            {
+                CCLOGWARN("cocos2d: WARNING: an alias with name %s already exists", oneAlias.c_str());
             }
-            
-            // create frame
-            spriteFrame = SpriteFrame::createWithTexture(texture,
-                                                         Rect(textureRect.origin.x, textureRect.origin.y, spriteSize.width, spriteSize.height),
-                                                         textureRotated,
-                                                         spriteOffset,
-                                                         spriteSourceSize);
+
+            _spriteFramesAliases[oneAlias] = Value(def.name);
         }
 
+        // create frame
+        SpriteFrame* spriteFrame = SpriteFrame::createWithTexture(texture,
+                                                                  def.rect,
+                                                                  def.rotated,
+                                                                  def.offset,
+                                                                  def.originalSize);
+
         // add sprite frame
-        _spriteFrames.insert(spriteFrameName, spriteFrame);
+        _spriteFrames.insert(def.name, spriteFrame);
+
+        // the frames already in the cache belong to their own sheet
+        if (sheet)
+        {
+            sheet->frames.push_back(def.name);
+        }
     }
+
+    if (sheet)
+    {
+        sheet->memory = sheet->frames.size() * sizeof(SpriteFrame);
+        if (texture)
+        {
+            sheet->memory += (size_t)texture->getPixelsWide() * texture->getPixelsHigh() * texture->getBitsPerPixelForFormat() / 8;
+        }
+        _loadedFileNames->insert(plist);
+    }
+}
+
+void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dictionary, Texture2D* texture)
+{
+    addSpriteFramesWithDictionary("", dictionary, texture);
+}
+
+void SpriteFrameCache::addSpriteFramesWithDictionary(const std::string& plist, const ValueMap& dictionary, Texture2D* texture)
+{
+    std::vector<FrameDef> frames;
+    parseSpriteFrames(dictionary, frames);
+    addSpriteFrames(plist, frames, texture);
 }
 
 void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist, Texture2D *texture)
@@ -204,8 +320,7 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist, Texture
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
     ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
 
-    addSpriteFramesWithDictionary(dict, texture);
-    _loadedFileNames->insert(plist);
+    addSpriteFramesWithDictionary(plist, dict, texture);
 }
 
 void SpriteFrameCache::addSpriteFramesWithFileContent(const std::string& plist_content, Texture2D *texture)
@@ -246,51 +361,128 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist)
         
         ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
 
-        string texturePath("");
+        string textureFileName;
 
         if (dict.find("metadata") != dict.end())
         {
-            ValueMap& metadataDict = dict["metadata"].asValueMap();
+            const ValueMap& metadataDict = valueForKey(dict, "metadata").asValueMap();
             // try to read  texture file name from meta data
-            texturePath = metadataDict["textureFileName"].asString();
+            textureFileName = valueForKey(metadataDict, "textureFileName").asString();
         }
 
-        if (!texturePath.empty())
+        std::string texturePath = getTexturePath(plist, textureFileName);
+        Texture2D *texture = Director::getInstance()->getTextureCache()->addImage(texturePath.c_str());
+
+        if (texture)
         {
-            // build texture path relative to plist file
-            texturePath = FileUtils::getInstance()->fullPathFromRelativeFile(texturePath.c_str(), plist);
+            addSpriteFramesWithDictionary(plist, dict, texture);
         }
         else
         {
-            // build texture path by replacing file extension
-            texturePath = plist;
+            CCLOG("cocos2d: SpriteFrameCache: Couldn't load texture");
+        }
+    }
+}
 
-            // remove .xxx
-            size_t startPos = texturePath.find_last_of("."); 
-            texturePath = texturePath.erase(startPos);
+void SpriteFrameCache::addSpriteFramesWithFileAsync(const std::string& plist, const std::function<void(bool)>& callback)
+{
+    CCASSERT(plist.size()>0, "plist filename should not be nullptr");
 
-            // append .png
-            texturePath = texturePath.append(".png");
+    if (_loadedFileNames->find(plist) != _loadedFileNames->end())
+    {
+        if (callback)
+            callback(true);
+        return;
+    }
 
-            CCLOG("cocos2d: SpriteFrameCache: Trying to use file %s as texture", texturePath.c_str());
-        }
+    // the plist is already being loaded
+    auto pending = _asyncSheets.find(plist);
+    if (pending != _asyncSheets.end())
+    {
+        pending->second->callbacks.push_back(callback);
+        return;
+    }
 
-        Texture2D *texture = Director::getInstance()->getTextureCache()->addImage(texturePath.c_str());
+    // the workers only get full paths, the cache of the full paths isn't thread safe
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
+    if (fullPath.size() == 0)
+    {
+        CCLOG("cocos2d: SpriteFrameCache: can not find %s", plist.c_str());
+        if (callback)
+            callback(false);
+        return;
+    }
 
-        if (texture)
-        {
-            addSpriteFramesWithDictionary(dict, texture);
-            _loadedFileNames->insert(plist);
-        }
-        else
+    auto sheet = std::make_shared<AsyncSheet>();
+    sheet->plist = plist;
+    sheet->fullPath = fullPath;
+    sheet->callbacks.push_back(callback);
+    _asyncSheets.insert(std::make_pair(plist, sheet));
+
+    JobSystem::getInstance()->schedule([sheet]() {
+        ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(sheet->fullPath);
+        sheet->parsed = !dict.empty();
+
+        if (dict.find("metadata") != dict.end())
         {
-            CCLOG("cocos2d: SpriteFrameCache: Couldn't load texture");
+            const ValueMap& metadataDict = valueForKey(dict, "metadata").asValueMap();
+            sheet->textureFileName = valueForKey(metadataDict, "textureFileName").asString();
         }
+        parseSpriteFrames(dict, sheet->frames);
+    }, [this, sheet]() {
+        if (!sheet->cancelled)
+            asyncSheetParsed(sheet);
+    });
+}
+
+void SpriteFrameCache::asyncSheetParsed(const std::shared_ptr<AsyncSheet>& sheet)
+{
+    std::string texturePath;
+    if (sheet->parsed)
+    {
+        texturePath = getTexturePath(sheet->plist, sheet->textureFileName);
+    }
+
+    // the callbacks of the texture cache aren't called for the missing images
+    if (texturePath.empty() || !FileUtils::getInstance()->isFileExist(texturePath))
+    {
+        CCLOG("cocos2d: SpriteFrameCache: Couldn't load %s", sheet->plist.c_str());
+        asyncSheetLoaded(sheet, nullptr);
+        return;
+    }
+
+    Director::getInstance()->getTextureCache()->addImageAsync(texturePath, [this, sheet](Texture2D* texture) {
+        if (!sheet->cancelled)
+            asyncSheetLoaded(sheet, texture);
+    });
+}
+
+void SpriteFrameCache::asyncSheetLoaded(const std::shared_ptr<AsyncSheet>& sheet, Texture2D* texture)
+{
+    _asyncSheets.erase(sheet->plist);
+
+    // loaded synchronously in the meantime
+    bool loaded = _loadedFileNames->find(sheet->plist) != _loadedFileNames->end();
+    if (!loaded && texture)
+    {
+        addSpriteFrames(sheet->plist, sheet->frames, texture);
+        loaded = true;
+    }
+
+    for (const auto& callback : sheet->callbacks)
+    {
+        if (callback)
+            callback(loaded);
     }
 }
 
 void SpriteFrameCache::addSpriteFrame(SpriteFrame* frame, const std::string& frameName)
 {
+    if (_spriteFrames.at(frameName))
+    {
+        // replaced
+        updateVersion();
+    }
     _spriteFrames.insert(frameName, frame);
 }
 
@@ -299,30 +491,59 @@ void SpriteFrameCache::removeSpriteFrames()
     _spriteFrames.clear();
     _spriteFramesAliases.clear();
     _loadedFileNames->clear();
+    _spriteSheets.clear();
+    updateVersion();
 }
 
 void SpriteFrameCache::removeUnusedSpriteFrames()
 {
-    bool removed = false;
     std::vector<std::string> toRemoveFrames;
-    
+    std::unordered_set<std::string> usedSheetFrames;
+
+    // the frames of a sheet are removed together, once none of them is used
+    for (auto iter = _spriteSheets.begin(); iter != _spriteSheets.end();)
+    {
+        const SpriteSheet& sheet = iter->second;
+        bool used = false;
+        for (const auto& name : sheet.frames)
+        {
+            SpriteFrame* spriteFrame = _spriteFrames.at(name);
+            if (spriteFrame && spriteFrame->getReferenceCount() > 1)
+            {
+                used = true;
+                break;
+            }
+        }
+
+        if (used)
+        {
+            usedSheetFrames.insert(sheet.frames.begin(), sheet.frames.end());
+            ++iter;
+        }
+        else
+        {
+            CCLOG("cocos2d: SpriteFrameCache: removing unused sheet: %s", iter->first.c_str());
+            toRemoveFrames.insert(toRemoveFrames.end(), sheet.frames.begin(), sheet.frames.end());
+            _loadedFileNames->erase(iter->first);
+            iter = _spriteSheets.erase(iter);
+        }
+    }
+
+    // the frames that don't belong to a sheet
     for (auto iter = _spriteFrames.begin(); iter != _spriteFrames.end(); ++iter)
     {
         SpriteFrame* spriteFrame = iter->second;
-        if( spriteFrame->getReferenceCount() == 1 )
+        if( spriteFrame->getReferenceCount() == 1 && usedSheetFrames.find(iter->first) == usedSheetFrames.end() )
         {
             toRemoveFrames.push_back(iter->first);
             CCLOG("cocos2d: SpriteFrameCache: removing unused frame: %s", iter->first.c_str());
-            removed = true;
         }
     }
 
-    _spriteFrames.erase(toRemoveFrames);
-    
-    // FIXME:. Since we don't know the .plist file that originated the frame, we must remove all .plist from the cache
-    if( removed )
+    if (!toRemoveFrames.empty())
     {
-        _loadedFileNames->clear();
+        _spriteFrames.erase(toRemoveFrames);
+        updateVersion();
     }
 }
 
@@ -334,24 +555,46 @@ void SpriteFrameCache::removeSpriteFrameByName(const std::string& name)
         return;
 
     // Is this an alias ?
-    std::string key = _spriteFramesAliases[name].asString();
+    auto alias = _spriteFramesAliases.find(name);
+    std::string key = alias != _spriteFramesAliases.end() ? alias->second.asString() : name;
 
-    if (!key.empty())
+    if (alias != _spriteFramesAliases.end())
     {
         _spriteFrames.erase(key);
-        _spriteFramesAliases.erase(key);
+        _spriteFramesAliases.erase(alias);
     }
     else
     {
         _spriteFrames.erase(name);
     }
+    updateVersion();
 
-    // FIXME:. Since we don't know the .plist file that originated the frame, we must remove all .plist from the cache
-    _loadedFileNames->clear();
+    // the plist of the frame is loaded again by the next addSpriteFramesWithFile
+    for (auto iter = _spriteSheets.begin(); iter != _spriteSheets.end(); ++iter)
+    {
+        const auto& frames = iter->second.frames;
+        if (std::find(frames.begin(), frames.end(), key) != frames.end())
+        {
+            _loadedFileNames->erase(iter->first);
+            _spriteSheets.erase(iter);
+            break;
+        }
+    }
 }
 
 void SpriteFrameCache::removeSpriteFramesFromFile(const std::string& plist)
 {
+    auto sheet = _spriteSheets.find(plist);
+    if (sheet != _spriteSheets.end())
+    {
+        // no need to parse the plist again
+        _spriteFrames.erase(sheet->second.frames);
+        _spriteSheets.erase(sheet);
+        _loadedFileNames->erase(plist);
+        updateVersion();
+        return;
+    }
+
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
     ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
     if (dict.empty())
@@ -382,7 +625,7 @@ void SpriteFrameCache::removeSpriteFramesFromFileContent(const std::string& plis
 
 void SpriteFrameCache::removeSpriteFramesFromDictionary(ValueMap& dictionary)
 {
-    ValueMap framesDict = dictionary["frames"].asValueMap();
+    const ValueMap& framesDict = valueForKey(dictionary, "frames").asValueMap();
     std::vector<std::string> keysToRemove;
 
     for (auto iter = framesDict.cbegin(); iter != framesDict.cend(); ++iter)
@@ -394,6 +637,7 @@ void SpriteFrameCache::removeSpriteFramesFromDictionary(ValueMap& dictionary)
     }
 
     _spriteFrames.erase(keysToRemove);
+    updateVersion();
 }
 
 void SpriteFrameCache::removeSpriteFramesFromTexture(Texture2D* texture)
@@ -411,6 +655,20 @@ void SpriteFrameCache::removeSpriteFramesFromTexture(Texture2D* texture)
     }
 
     _spriteFrames.erase(keysToRemove);
+    updateVersion();
+
+    for (auto iter = _spriteSheets.begin(); iter != _spriteSheets.end();)
+    {
+        if (iter->second.texture == texture)
+        {
+            _loadedFileNames->erase(iter->first);
+            iter = _spriteSheets.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
 }
 
 SpriteFrame* SpriteFrameCache::getSpriteFrameByName(const std::string& name)
@@ -419,10 +677,10 @@ SpriteFrame* SpriteFrameCache::getSpriteFrameByName(const std::string& name)
     if (!frame)
     {
         // try alias dictionary
-        std::string key = _spriteFramesAliases[name].asString();
-        if (!key.empty())
+        auto alias = _spriteFramesAliases.find(name);
+        if (alias != _spriteFramesAliases.end())
         {
-            frame = _spriteFrames.at(key);
+            frame = _spriteFrames.at(alias->second.asString());
             if (!frame)
             {
                 CCLOG("cocos2d: SpriteFrameCache: Frame '%s' not found", name.c_str());
@@ -432,4 +690,30 @@ SpriteFrame* SpriteFrameCache::getSpriteFrameByName(const std::string& name)
     return frame;
 }
 
+SpriteFrame* SpriteFrameCache::getSpriteFrame(Handle& handle)
+{
+    if (handle.version != _version || !handle.frame)
+    {
+        handle.frame = getSpriteFrameByName(handle.name);
+        handle.version = _version;
+    }
+    return handle.frame;
+}
+
+size_t SpriteFrameCache::getSpriteSheetMemory(const std::string& plist) const
+{
+    auto sheet = _spriteSheets.find(plist);
+    return sheet != _spriteSheets.end() ? sheet->second.memory : 0;
+}
+
+size_t SpriteFrameCache::getSpriteSheetsMemory() const
+{
+    size_t memory = 0;
+    for (const auto& sheet : _spriteSheets)
+    {
+        memory += sheet.second.memory;
+    }
+    return memory;
+}
+
 NS_CC_END
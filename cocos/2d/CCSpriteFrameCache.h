@@ -34,8 +34,12 @@ THE SOFTWARE.
  * To create sprite frames and texture atlas, use this tool:
  * http://zwoptex.zwopple.com/
  */
+#include <functional>
+#include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include "2d/CCSpriteFrame.h"
 #include "base/CCRef.h"
 #include "base/CCValue.h"
@@ -104,6 +108,15 @@ public:
      */
     void addSpriteFramesWithFileContent(const std::string& plist_content, Texture2D *texture);
 
+    /** Adds multiple Sprite Frames from a plist file, asynchronously.
+     * The plist is parsed and its texture is decoded by the JobSystem workers, then the frames are added on the main thread
+     * and the callback is called with true. It is called with false if the plist or its texture can't be found.
+     * The texture is found like in addSpriteFramesWithFile(const std::string& plist).
+     * @js NA
+     * @lua NA
+     */
+    void addSpriteFramesWithFileAsync(const std::string& plist, const std::function<void(bool)>& callback);
+
     /** Adds an sprite frame with a given name.
      If the name already exists, then the contents of the old name will be replaced with the new one.
      */
@@ -119,6 +132,7 @@ public:
 
     /** Removes unused sprite frames.
      * Sprite Frames that have a retain count of 1 will be deleted.
+     * The frames loaded from a plist file are deleted by sheet: once none of the frames of the plist is used.
      * It is convenient to call this method after when starting a new Scene.
      */
     void removeUnusedSpriteFrames();
@@ -156,13 +170,66 @@ public:
     /** @deprecated use getSpriteFrameByName() instead */
     CC_DEPRECATED_ATTRIBUTE SpriteFrame* spriteFrameByName(const std::string&name) { return getSpriteFrameByName(name); }
 
+    /** @brief The name of a sprite frame, with the result of its last lookup.
+     Keep a handle for the frames looked up every frame: the name is only looked up again once frames were removed
+     from the cache or replaced.
+     * @js NA
+     * @lua NA
+     */
+    struct Handle
+    {
+        Handle() : frame(nullptr), version(0) {}
+        explicit Handle(const std::string& frameName) : name(frameName), frame(nullptr), version(0) {}
+
+        std::string name;
+        SpriteFrame* frame;     ///< the frame found by the last lookup, not retained
+        unsigned int version;   ///< the version of the cache at the last lookup
+    };
+
+    /** Returns the sprite frame of a handle, like getSpriteFrameByName(handle.name)
+     * @js NA
+     * @lua NA
+     */
+    SpriteFrame* getSpriteFrame(Handle& handle);
+
+    /** Returns the approximate memory used by the sheet of a plist file: its texture and its frames. 0 if it isn't loaded */
+    size_t getSpriteSheetMemory(const std::string& plist) const;
+
+    /** Returns the approximate memory used by all the loaded sheets */
+    size_t getSpriteSheetsMemory() const;
+
 protected:
     // MARMALADE: Made this protected not private, as deriving from this class is pretty useful
-    SpriteFrameCache(){}
+    SpriteFrameCache() : _loadedFileNames(nullptr), _version(0) {}
+
+    // a frame of a plist, parsed on any thread
+    struct FrameDef;
+    // a plist being loaded by addSpriteFramesWithFileAsync
+    struct AsyncSheet;
+
+    // the frames loaded from a plist
+    struct SpriteSheet
+    {
+        std::vector<std::string> frames;
+        Texture2D* texture;     ///< not retained, the frames retain it
+        size_t memory;
+    };
+
+    static void parseSpriteFrames(const ValueMap& dictionary, std::vector<FrameDef>& frames);
+
+    /* Adds the parsed frames. If plist isn't empty, the frames are recorded as the sheet of the plist */
+    void addSpriteFrames(const std::string& plist, const std::vector<FrameDef>& frames, Texture2D* texture);
+
+    void asyncSheetParsed(const std::shared_ptr<AsyncSheet>& sheet);
+    void asyncSheetLoaded(const std::shared_ptr<AsyncSheet>& sheet, Texture2D* texture);
+
+    /* Invalidates the handles, after frames are removed or replaced */
+    void updateVersion();
 
     /*Adds multiple Sprite Frames with a dictionary. The texture will be associated with the created sprite frames.
      */
     void addSpriteFramesWithDictionary(ValueMap& dictionary, Texture2D *texture);
+    void addSpriteFramesWithDictionary(const std::string& plist, const ValueMap& dictionary, Texture2D *texture);
 
     /** Removes multiple Sprite Frames from Dictionary.
     * @since v0.99.5
@@ -173,6 +240,10 @@ protected:
     Map<std::string, SpriteFrame*> _spriteFrames;
     ValueMap _spriteFramesAliases;
     std::set<std::string>*  _loadedFileNames;
+
+    std::unordered_map<std::string, SpriteSheet> _spriteSheets;
+    std::unordered_map<std::string, std::shared_ptr<AsyncSheet>> _asyncSheets;
+    unsigned int _version;
 };
 
 // end of sprite_nodes group
@@ -64,7 +64,7 @@ ValueMap& TMXLayerInfo::getProperties()
 }
 void TMXLayerInfo::setProperties(ValueMap var)
 {
-    _properties = var;
+    _properties = std::move(var);
 }
 
 // implementation TMXTilesetInfo
@@ -214,9 +214,7 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
     {
         for(int i = 0; atts[i]; i += 2) 
         {
-            std::string key = (char*)atts[i];
-            std::string value = (char*)atts[i+1];
-            attributeDict.insert(std::make_pair(key, Value(value)));
+            attributeDict.insert(std::make_pair(std::string((char*)atts[i]), Value((char*)atts[i+1])));
         }
     }
     if (elementName == "map")
@@ -443,8 +441,7 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         for(size_t i = 0; i < sizeof(array)/sizeof(array[0]); ++i )
         {
             const char* key = array[i];
-            Value value = attributeDict[key];
-            dict[key] = value;
+            dict[key] = attributeDict[key];
         }
 
         // But X and Y since they need special treatment
@@ -466,7 +463,7 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
         dict["height"] = Value(s.height);
 
         // Add the object to the objectGroup
-        objectGroup->getObjects().push_back(Value(dict));
+        objectGroup->getObjects().push_back(Value(std::move(dict)));
 
          // The parent element is now "object"
          tmxMapInfo->setParentElement(TMXPropertyObject);
@@ -484,7 +481,7 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
             // The parent element is the map
             Value value = attributeDict["value"];
             std::string key = attributeDict["name"].asString();
-            tmxMapInfo->getProperties().insert(std::make_pair(key, value));
+            tmxMapInfo->getProperties().insert(std::make_pair(std::move(key), std::move(value)));
         }
         else if ( tmxMapInfo->getParentElement() == TMXPropertyLayer )
         {
@@ -493,7 +490,7 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
             Value value = attributeDict["value"];
             std::string key = attributeDict["name"].asString();
             // Add the property to the layer
-            layer->getProperties().insert(std::make_pair(key, value));
+            layer->getProperties().insert(std::make_pair(std::move(key), std::move(value)));
         }
         else if ( tmxMapInfo->getParentElement() == TMXPropertyObjectGroup ) 
         {
@@ -501,7 +498,7 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
             TMXObjectGroup* objectGroup = tmxMapInfo->getObjectGroups().back();
             Value value = attributeDict["value"];
             std::string key = attributeDict["name"].asString();
-            objectGroup->getProperties().insert(std::make_pair(key, value));
+            objectGroup->getProperties().insert(std::make_pair(std::move(key), std::move(value)));
         }
         else if ( tmxMapInfo->getParentElement() == TMXPropertyObject )
         {
@@ -559,10 +556,10 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
                 }
                 
                 // add to points array
-                pointsArray.push_back(Value(pointDict));
+                pointsArray.push_back(Value(std::move(pointDict)));
             }
             
-            dict["points"] = Value(pointsArray);
+            dict["points"] = Value(std::move(pointsArray));
         }
     } 
     else if (elementName == "polyline")
@@ -604,10 +601,10 @@ void TMXMapInfo::startElement(void *ctx, const char *name, const char **atts)
                 }
                 
                 // add to points array
-                pointsArray.push_back(Value(pointDict));
+                pointsArray.push_back(Value(std::move(pointDict)));
             }
             
-            dict["polylinePoints"] = Value(pointsArray);
+            dict["polylinePoints"] = Value(std::move(pointsArray));
         }
     }
 }
@@ -690,6 +687,20 @@ void TMXMapInfo::endElement(void *ctx, const char *name)
     {
         // The object element has ended
         tmxMapInfo->setParentElement(TMXPropertyNone);
+
+        // Its properties were added through a reference to its dictionary,
+        // move them to a dictionary the copies of the objects can share, see Value
+        Value& object = tmxMapInfo->getObjectGroups().back()->getObjects().back();
+        object = Value(std::move(object.asValueMap()));
+    }
+    else if (elementName == "tile")
+    {
+        // Same for the properties of the tile
+        auto iter = _tileProperties.find(_parentGID);
+        if (tmxMapInfo->getParentElement() == TMXPropertyTile && iter != _tileProperties.end())
+        {
+            iter->second = Value(std::move(iter->second.asValueMap()));
+        }
     }
     else if (elementName == "tileset")
     {
@@ -705,9 +716,7 @@ void TMXMapInfo::textHandler(void *ctx, const char *ch, int len)
 
     if (tmxMapInfo->isStoringCharacters())
     {
-        std::string currentString = tmxMapInfo->getCurrentString();
-        currentString += text;
-        tmxMapInfo->setCurrentString(currentString.c_str());
+        _currentString += text;
     }
 }
 
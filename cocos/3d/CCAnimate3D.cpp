@@ -25,6 +25,7 @@
 #include "3d/CCAnimate3D.h"
 #include "3d/CCSprite3D.h"
 #include "3d/CCSkeleton3D.h"
+#include "3d/CCMeshSkin.h"
 #include "platform/CCFileUtils.h"
 
 NS_CC_BEGIN
@@ -107,15 +108,17 @@ void Animate3D::startWithTarget(Node *target)
     
     ActionInterval::startWithTarget(target);
     
-    _boneCurves.clear();
+    // the bones by the index of their curve, the names are only looked up once
+    _bones.assign(_animation->getBakedCurveCount(), nullptr);
+    _samples.resize(10 * _animation->getBakedStride());
     auto skin = sprite->getSkeleton();
     bool hasCurve = false;
     for (int  i = 0; i < skin->getBoneCount(); i++) {
         auto bone = skin->getBoneByIndex(static_cast<unsigned int>(i));
-        auto curve = _animation->getBoneCurveByName(bone->getName());
-        if (curve)
+        int index = _animation->getBakedCurveIndex(bone->getName());
+        if (index >= 0)
         {
-            _boneCurves[bone] = curve;
+            _bones[index] = bone;
             hasCurve = true;
         }
     }
@@ -200,38 +203,51 @@ void Animate3D::update(float t)
         }
         _lastTime = t;
         
-        if (_weight > 0.0f)
+        if (_weight > 0.0f && !_bones.empty())
         {
-            float transDst[3], rotDst[4], scaleDst[3];
-            float* trans = nullptr, *rot = nullptr, *scale = nullptr;
             if (_playReverse)
                 t = 1 - t;
             
             t = _start + t * _last;
-            for (const auto& it : _boneCurves) {
-                auto bone = it.first;
-                auto curve = it.second;
-                if (curve->translateCurve)
-                {
-                    curve->translateCurve->evaluate(t, transDst, EvaluateType::INT_LINEAR);
-                    trans = &transDst[0];
-                }
-                if (curve->rotCurve)
-                {
-                    curve->rotCurve->evaluate(t, rotDst, EvaluateType::INT_QUAT_SLERP);
-                    rot = &rotDst[0];
-                }
-                if (curve->scaleCurve)
-                {
-                    curve->scaleCurve->evaluate(t, scaleDst, EvaluateType::INT_LINEAR);
-                    scale = &scaleDst[0];
-                }
-                bone->setAnimationValue(trans, rot, scale, this, _weight);
+            
+            Sprite3D* sprite = static_cast<Sprite3D*>(_target);
+            if (MeshSkin::getPaletteMode() == MeshSkin::PaletteMode::SHARED && _state == Animate3D::Animate3DState::Running
+                && s_fadeOutAnimates.find(sprite) == s_fadeOutAnimates.end())
+            {
+                // playing alone, on the nearest baked frame: the bones are set once for the sprites in this pose
+                int frame = static_cast<int>(t * (_animation->getBakedFrameCount() - 1) + 0.5f);
+                sprite->getSkeleton()->setSharedPose(_animation, frame);
+                return;
             }
+            
+            sprite->getSkeleton()->setSharedPose(nullptr, 0);
+            applyPose(t);
         }
     }
 }
 
+void Animate3D::applyPose(float t)
+{
+    // all the curves at once, then each bone takes its values
+    _animation->sampleBakedCurves(t, &_samples[0]);
+    const int stride = _animation->getBakedStride();
+    const float* samples = &_samples[0];
+    for (int i = 0; i < static_cast<int>(_bones.size()); ++i) {
+        auto bone = _bones[i];
+        if (bone == nullptr)
+            continue;
+        
+        float trans[3] = { samples[i], samples[stride + i], samples[2 * stride + i] };
+        float rot[4] = { samples[3 * stride + i], samples[4 * stride + i], samples[5 * stride + i], samples[6 * stride + i] };
+        float scale[3] = { samples[7 * stride + i], samples[8 * stride + i], samples[9 * stride + i] };
+        unsigned char channels = _animation->getBakedChannels(i);
+        bone->setAnimationValue((channels & Animation3D::BAKED_TRANSLATION) ? trans : nullptr,
+                                (channels & Animation3D::BAKED_ROTATION) ? rot : nullptr,
+                                (channels & Animation3D::BAKED_SCALE) ? scale : nullptr,
+                                this, _weight);
+    }
+}
+
 float Animate3D::getSpeed() const
 {
     return _playReverse ? -_absSpeed : _absSpeed;
@@ -27,6 +27,7 @@
 
 #include <map>
 #include <unordered_map>
+#include <vector>
 
 #include "3d/CCAnimation3D.h"
 #include "base/ccMacros.h"
@@ -104,6 +105,9 @@ CC_CONSTRUCTOR_ACCESS:
     void removeFromMap();
     
 protected:
+    /**set the bones to the animation at time t (0 - 1)*/
+    void applyPose(float t);
+    
     enum class Animate3DState
     {
         FadeIn,
@@ -122,7 +126,8 @@ protected:
     float      _accTransTime; // acculate transition time
     float      _lastTime;     // last t (0 - 1)
     float      _originInterval;// save origin interval time
-    std::unordered_map<Bone3D*, Animation3D::Curve*> _boneCurves; //weak ref
+    std::vector<Bone3D*> _bones; //weak ref, bone of each baked curve of the animation, nullptr if the skeleton doesn't have it
+    std::vector<float> _samples; //samples of the baked curves
 
     //sprite animates
     static std::unordered_map<Sprite3D*, Animate3D*> s_fadeInAnimates;
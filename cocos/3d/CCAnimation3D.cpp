@@ -23,11 +23,26 @@
  ****************************************************************************/
 
 #include "3d/CCAnimation3D.h"
+
+#include <algorithm>
+#include <math.h>
+
 #include "3d/CCBundle3D.h"
+#include "math/CCSIMD.h"
 #include "platform/CCFileUtils.h"
 
 NS_CC_BEGIN
 
+namespace
+{
+    // the curves are baked at the frame rate of their keys, within these bounds
+    const float MIN_BAKE_FRAME_RATE = 30.0f;
+    const float MAX_BAKE_FRAME_RATE = 120.0f;
+    // the values of a baked frame: translation x y z, rotation x y z w, scale x y z
+    const int BAKED_VALUE_COUNT = 10;
+    const int BAKED_ROTATION_X = 3;
+}
+
 Animation3D* Animation3D::create(const std::string& fileName, const std::string& animationName)
 {
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(fileName);
@@ -64,8 +79,128 @@ Animation3D::Curve* Animation3D::getBoneCurveByName(const std::string& name) con
     return nullptr;
 }
 
+int Animation3D::getBakedCurveIndex(const std::string& name) const
+{
+    auto it = _bakedCurveIndices.find(name);
+    if (it != _bakedCurveIndices.end())
+        return it->second;
+    
+    return -1;
+}
+
+void Animation3D::sampleBakedCurves(float time, float* dst) const
+{
+    // the 4 floats operations of the particle systems, SSE2 or NEON
+    using namespace SIMD;
+    
+    if (_bakedFrameCount < 2)
+        return;
+    
+    // the frames are uniformly spaced, the frame of a time is found without searching the keys
+    float position = std::min(std::max(time, 0.0f), 1.0f) * (_bakedFrameCount - 1);
+    int frame = std::min(static_cast<int>(position), _bakedFrameCount - 2);
+    const float* from = &_bakedFrames[frame * BAKED_VALUE_COUNT * _bakedStride];
+    const float* to = from + BAKED_VALUE_COUNT * _bakedStride;
+    const float4 alpha = splat(position - frame);
+    const float4 zero = splat(0.0f);
+    
+    for (int i = 0; i < _bakedStride; i += 4)
+    {
+        // translations and scales
+        static const int linearValues[] = { 0, 1, 2, 7, 8, 9 };
+        for (int value : linearValues)
+        {
+            int offset = value * _bakedStride + i;
+            float4 a = load(from + offset);
+            store(dst + offset, add(a, mul(sub(load(to + offset), a), alpha)));
+        }
+        
+        // rotations, the shortest way then normalized
+        const int x = BAKED_ROTATION_X * _bakedStride + i, y = x + _bakedStride, z = y + _bakedStride, w = z + _bakedStride;
+        float4 ax = load(from + x), ay = load(from + y), az = load(from + z), aw = load(from + w);
+        float4 bx = load(to + x), by = load(to + y), bz = load(to + z), bw = load(to + w);
+        
+        float4 dot = add(add(mul(ax, bx), mul(ay, by)), add(mul(az, bz), mul(aw, bw)));
+        mask4 sameSide = notLess(dot, zero);
+        bx = select(sameSide, bx, neg(bx));
+        by = select(sameSide, by, neg(by));
+        bz = select(sameSide, bz, neg(bz));
+        bw = select(sameSide, bw, neg(bw));
+        
+        float4 rx = add(ax, mul(sub(bx, ax), alpha));
+        float4 ry = add(ay, mul(sub(by, ay), alpha));
+        float4 rz = add(az, mul(sub(bz, az), alpha));
+        float4 rw = add(aw, mul(sub(bw, aw), alpha));
+        float4 length = sqrt4(add(add(mul(rx, rx), mul(ry, ry)), add(mul(rz, rz), mul(rw, rw))));
+        store(dst + x, div(rx, length));
+        store(dst + y, div(ry, length));
+        store(dst + z, div(rz, length));
+        store(dst + w, div(rw, length));
+    }
+}
+
+void Animation3D::bakeCurves(int frameCount)
+{
+    _bakedCurveNames.clear();
+    _bakedCurveIndices.clear();
+    _bakedChannels.clear();
+    
+    std::vector<Curve*> curves;
+    for (const auto& it : _boneCurves)
+    {
+        const Curve* curve = it.second;
+        unsigned char channels = (curve->translateCurve ? BAKED_TRANSLATION : 0) | (curve->rotCurve ? BAKED_ROTATION : 0) | (curve->scaleCurve ? BAKED_SCALE : 0);
+        if (channels == 0)
+            continue;
+        
+        _bakedCurveIndices[it.first] = static_cast<int>(_bakedCurveNames.size());
+        _bakedCurveNames.push_back(it.first);
+        _bakedChannels.push_back(channels);
+        curves.push_back(it.second);
+    }
+    
+    int count = static_cast<int>(curves.size());
+    _bakedStride = (count + 3) & ~3;
+    _bakedFrameCount = frameCount;
+    _bakedFrames.assign(frameCount * BAKED_VALUE_COUNT * _bakedStride, 0.0f);
+    
+    for (int frame = 0; frame < frameCount; ++frame)
+    {
+        float* values = &_bakedFrames[frame * BAKED_VALUE_COUNT * _bakedStride];
+        float time = frame / (frameCount - 1.0f);
+        
+        // the missing channels and the padding are identities
+        std::fill(values + 6 * _bakedStride, values + 10 * _bakedStride, 1.0f);
+        
+        float value[4];
+        for (int i = 0; i < count; ++i)
+        {
+            if (curves[i]->translateCurve)
+            {
+                curves[i]->translateCurve->evaluate(time, value, EvaluateType::INT_LINEAR);
+                for (int c = 0; c < 3; ++c)
+                    values[c * _bakedStride + i] = value[c];
+            }
+            if (curves[i]->rotCurve)
+            {
+                curves[i]->rotCurve->evaluate(time, value, EvaluateType::INT_QUAT_SLERP);
+                for (int c = 0; c < 4; ++c)
+                    values[(BAKED_ROTATION_X + c) * _bakedStride + i] = value[c];
+            }
+            if (curves[i]->scaleCurve)
+            {
+                curves[i]->scaleCurve->evaluate(time, value, EvaluateType::INT_LINEAR);
+                for (int c = 0; c < 3; ++c)
+                    values[(7 + c) * _bakedStride + i] = value[c];
+            }
+        }
+    }
+}
+
 Animation3D::Animation3D()
 : _duration(0)
+, _bakedStride(0)
+, _bakedFrameCount(0)
 {
     
 }
@@ -168,6 +303,27 @@ bool Animation3D::init(const Animation3DData &data)
         if(curve->scaleCurve) curve->scaleCurve->retain();
     }
     
+    // one frame per key at the shortest interval between two keys
+    float minKeyInterval = 1.0f;
+    auto findMinKeyInterval = [&minKeyInterval](float previous, float time)
+    {
+        if (time > previous)
+            minKeyInterval = std::min(minKeyInterval, time - previous);
+    };
+    for (const auto& iter : data._translationKeys)
+        for (size_t i = 1; i < iter.second.size(); ++i)
+            findMinKeyInterval(iter.second[i - 1]._time, iter.second[i]._time);
+    for (const auto& iter : data._rotationKeys)
+        for (size_t i = 1; i < iter.second.size(); ++i)
+            findMinKeyInterval(iter.second[i - 1]._time, iter.second[i]._time);
+    for (const auto& iter : data._scaleKeys)
+        for (size_t i = 1; i < iter.second.size(); ++i)
+            findMinKeyInterval(iter.second[i - 1]._time, iter.second[i]._time);
+    
+    float frames = ceilf(1.0f / minKeyInterval);
+    frames = std::min(std::max(frames, _duration * MIN_BAKE_FRAME_RATE), _duration * MAX_BAKE_FRAME_RATE);
+    bakeCurves(std::max(static_cast<int>(ceilf(frames)), 1) + 1);
+    
     return true;
 }
 
@@ -26,6 +26,7 @@
 #define __CCANIMATION3D_H__
 
 #include <unordered_map>
+#include <vector>
 
 #include "3d/CCAnimationCurve.h"
 
@@ -69,6 +70,43 @@ public:
     /**get bone curve*/
     Curve* getBoneCurveByName(const std::string& name) const;
     
+    /**
+     * The channels of a baked curve
+     */
+    enum BakedChannel
+    {
+        BAKED_TRANSLATION = 1,
+        BAKED_ROTATION = 2,
+        BAKED_SCALE = 4,
+    };
+    
+    /**
+     * get the number of baked curves.
+     * The curves are baked once loaded: they are sampled at a uniform frame rate, and the samples of all the bones
+     * are stored frame after frame, each value of the bones in a flat array. The bones are then sampled 4 at a time.
+     */
+    int getBakedCurveCount() const { return static_cast<int>(_bakedCurveNames.size()); }
+    
+    /**get the index of the baked curve of a bone, -1 if the bone isn't animated*/
+    int getBakedCurveIndex(const std::string& name) const;
+    
+    /**get the channels of a baked curve, a combination of BakedChannel*/
+    unsigned char getBakedChannels(int index) const { return _bakedChannels[index]; }
+    
+    /**get the number of floats of a value in the samples, the number of baked curves rounded up to a multiple of 4*/
+    int getBakedStride() const { return _bakedStride; }
+    
+    /**get the number of baked frames, the first at time 0 and the last at time 1*/
+    int getBakedFrameCount() const { return _bakedFrameCount; }
+    
+    /**
+     * samples the baked curves
+     * @param time Time to be sampled (0 - 1)
+     * @param dst 10 * getBakedStride() floats: the translation x, y, z, the rotation x, y, z, w and the scale x, y, z of the curves.
+     * The rotations are normalized linear interpolations of the baked rotations.
+     */
+    void sampleBakedCurves(float time, float* dst) const;
+    
 CC_CONSTRUCTOR_ACCESS:
     Animation3D();
     virtual ~Animation3D();  
@@ -76,7 +114,17 @@ CC_CONSTRUCTOR_ACCESS:
     bool init(const Animation3DData& data);
     
 protected:
+    /**sample the curves at a uniform frame rate*/
+    void bakeCurves(int frameCount);
+    
     std::unordered_map<std::string, Curve*> _boneCurves;//bone curves map, key bone name, value AnimationCurve
+    
+    std::vector<std::string> _bakedCurveNames; //name of the bone of each baked curve
+    std::unordered_map<std::string, int> _bakedCurveIndices; //index of the baked curve of each bone
+    std::vector<unsigned char> _bakedChannels; //channels of each baked curve
+    std::vector<float> _bakedFrames; //10 values of _bakedStride floats for each frame
+    int _bakedStride; //number of baked curves rounded up to a multiple of 4
+    int _bakedFrameCount; //number of frames, the first at time 0 and the last at time 1
 
     float _duration; //animation duration
 };
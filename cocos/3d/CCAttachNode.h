@@ -60,6 +60,9 @@ CC_CONSTRUCTOR_ACCESS:
     
 
 protected:
+    // getNodeToParentTransform() updates the bones of the skeleton, it can't run on the workers
+    virtual bool prepareTransform(const Mat4& parentTransform, uint32_t parentFlags) override { return false; }
+
     Bone3D* _attachBone;
     mutable Mat4    _transformToParent;
 };
@@ -101,6 +101,8 @@ CC_CONSTRUCTOR_ACCESS:
     virtual ~BillBoard();
 
 protected:
+    // visit() replaces the transform computed by processParentFlags() with the billboard one
+    virtual bool prepareTransform(const Mat4& parentTransform, uint32_t parentFlags) override { return false; }
 
     bool calculateBillbaordTransform();
     
@@ -27,6 +27,7 @@
 
 #include "3d/CCBundle3DData.h"
 #include "3d/CCBundleReader.h"
+#include "platform/CCMappedData.h"
 #include "json/document.h"
 
 NS_CC_BEGIN
@@ -165,7 +166,7 @@ protected:
     rapidjson::Document _jsonReader;
 
     // for binary reading
-    Data* _binaryBuffer;
+    MappedData* _binaryBuffer;
     BundleReader _binaryReader;
     unsigned int _referenceCount;
     Reference* _references;
@@ -26,15 +26,78 @@
 #include "3d/CCSkeleton3D.h"
 #include "3d/CCBundle3D.h"
 #include "3d/CCSkeleton3D.h"
+#include "3d/CCAnimation3D.h"
+#include "base/CCDirector.h"
+#include "base/CCFrameProfiler.h"
+#include "base/CCJobSystem.h"
+#include "renderer/CCCustomCommand.h"
+#include "renderer/CCMeshCommand.h"
+#include "renderer/CCRenderer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <unordered_map>
 
 NS_CC_BEGIN
 
 static int PALETTE_ROWS = 3;
 
+// a palette queued in the batched modes
+struct QueuedPalette
+{
+    MeshSkin* skin;
+    MeshCommand* command;
+    Animation3D* poseAnimation; // the shared pose of the skeleton, nullptr if none
+    int poseFrame;
+    size_t offset;      // offset of the palette in the buffer
+    bool computed;      // false if the palette of another skin in the same pose is reused
+};
+
+// the skins with the same layout, in the same frame of the same animation, have the same palette
+struct SharedPaletteKey
+{
+    Animation3D* animation;
+    int frame;
+    uint64_t layout;
+    
+    bool operator==(const SharedPaletteKey& other) const
+    {
+        return animation == other.animation && frame == other.frame && layout == other.layout;
+    }
+};
+
+struct SharedPaletteKeyHash
+{
+    size_t operator()(const SharedPaletteKey& key) const
+    {
+        return std::hash<void*>()(key.animation) ^ static_cast<size_t>(key.layout * 31 + key.frame);
+    }
+};
+
+static MeshSkin::PaletteMode s_paletteMode = MeshSkin::PaletteMode::IMMEDIATE;
+static std::vector<QueuedPalette> s_queuedPalettes;
+static unsigned int s_queuedFrame = 0;
+static CustomCommand s_flushPalettesCommand;
+static std::vector<Vec4> s_paletteBuffer; // the palettes of the last flush, one after the other
+static std::vector<size_t> s_skeletonRanges; // first queued palette of each skeleton to update
+static std::unordered_map<SharedPaletteKey, size_t, SharedPaletteKeyHash> s_sharedPalettes;
+
+// 64 bits FNV-1a
+static uint64_t hashLayout(uint64_t hash, const void* data, size_t length)
+{
+    auto bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
 MeshSkin::MeshSkin()
 : _rootBone(nullptr)
 , _skeleton(nullptr)
 , _matrixPalette(nullptr)
+, _layoutKey(0)
 {
     
 }
@@ -57,6 +120,22 @@ MeshSkin* MeshSkin::create(Skeleton3D* skeleton, const std::vector<std::string>&
         skin->addSkinBone(bone);
     }
     skin->_invBindPoses = invBindPose;
+    
+    // the palette only depends on the pose of the skeleton, on its bones and on the inverse bind poses
+    uint64_t key = 14695981039346656037ULL;
+    for (const auto& it : boneNames) {
+        key = hashLayout(key, it.c_str(), it.length() + 1);
+    }
+    if (!invBindPose.empty())
+        key = hashLayout(key, &invBindPose[0], invBindPose.size() * sizeof(Mat4));
+    for (int i = 0; i < skeleton->getBoneCount(); i++) {
+        auto bone = skeleton->getBoneByIndex(static_cast<unsigned int>(i));
+        const std::string& parentName = bone->getParentBone() ? bone->getParentBone()->getName() : "";
+        key = hashLayout(key, bone->getName().c_str(), bone->getName().length() + 1);
+        key = hashLayout(key, parentName.c_str(), parentName.length() + 1);
+        key = hashLayout(key, bone->_oriPose.m, sizeof(bone->_oriPose.m));
+    }
+    skin->_layoutKey = key;
     skin->autorelease();
     
     return skin;
@@ -103,17 +182,117 @@ Vec4* MeshSkin::getMatrixPalette()
     {
         _matrixPalette = new (std::nothrow) Vec4[_skinBones.size() * PALETTE_ROWS];
     }
+    computeMatrixPalette(_matrixPalette);
+    
+    return _matrixPalette;
+}
+
+void MeshSkin::computeMatrixPalette(Vec4* dst)
+{
     int i = 0, paletteIndex = 0;
-    static Mat4 t;
+    Mat4 t;
     for (auto it : _skinBones )
     {
         Mat4::multiply(it->getWorldMat(), _invBindPoses[i++], &t);
-        _matrixPalette[paletteIndex++].set(t.m[0], t.m[4], t.m[8], t.m[12]);
-        _matrixPalette[paletteIndex++].set(t.m[1], t.m[5], t.m[9], t.m[13]);
-        _matrixPalette[paletteIndex++].set(t.m[2], t.m[6], t.m[10], t.m[14]);
+        dst[paletteIndex++].set(t.m[0], t.m[4], t.m[8], t.m[12]);
+        dst[paletteIndex++].set(t.m[1], t.m[5], t.m[9], t.m[13]);
+        dst[paletteIndex++].set(t.m[2], t.m[6], t.m[10], t.m[14]);
     }
+}
+
+void MeshSkin::setPaletteMode(PaletteMode mode)
+{
+    s_paletteMode = mode;
+}
+
+MeshSkin::PaletteMode MeshSkin::getPaletteMode()
+{
+    return s_paletteMode;
+}
+
+void MeshSkin::queueMatrixPalette(Renderer* renderer, MeshCommand* command)
+{
+    command->setMatrixPaletteSize((int)getMatrixPaletteSize());
+    command->setMatrixPalette(nullptr);
+    if (_skinBones.empty())
+        return;
     
-    return _matrixPalette;
+    // the first palette of the frame or of the camera adds the command computing them, before all the other commands
+    auto frame = Director::getInstance()->getTotalFrames();
+    if (s_queuedPalettes.empty() || s_queuedFrame != frame)
+    {
+        s_queuedPalettes.clear();
+        s_queuedFrame = frame;
+        s_flushPalettesCommand.init(-FLT_MAX);
+        s_flushPalettesCommand.func = MeshSkin::flushMatrixPalettes;
+        renderer->addCommand(&s_flushPalettesCommand, 0);
+    }
+    
+    QueuedPalette queued = { this, command, _skeleton->getSharedPoseAnimation(), _skeleton->getSharedPoseFrame(), 0, true };
+    s_queuedPalettes.push_back(queued);
+}
+
+void MeshSkin::flushMatrixPalettes()
+{
+    CC_PROFILE_ZONE("MeshSkin::flushMatrixPalettes");
+    
+    // one palette after the other, the skins in the same shared pose use the palette of the first one
+    size_t size = 0;
+    for (auto& queued : s_queuedPalettes)
+    {
+        if (queued.poseAnimation)
+        {
+            SharedPaletteKey key = { queued.poseAnimation, queued.poseFrame, queued.skin->_layoutKey };
+            auto result = s_sharedPalettes.insert(std::make_pair(key, size));
+            if (!result.second)
+            {
+                queued.offset = result.first->second;
+                queued.computed = false;
+                continue;
+            }
+        }
+        queued.offset = size;
+        size += queued.skin->getMatrixPaletteSize();
+    }
+    s_sharedPalettes.clear();
+    s_paletteBuffer.resize(size);
+    
+    // the palettes to compute grouped by skeleton, each skeleton is posed and updated once, by one worker
+    auto computedEnd = std::partition(s_queuedPalettes.begin(), s_queuedPalettes.end(), [](const QueuedPalette& queued) {
+        return queued.computed;
+    });
+    std::sort(s_queuedPalettes.begin(), computedEnd, [](const QueuedPalette& a, const QueuedPalette& b) {
+        return a.skin->_skeleton < b.skin->_skeleton;
+    });
+    size_t computedCount = computedEnd - s_queuedPalettes.begin();
+    s_skeletonRanges.clear();
+    for (size_t i = 0; i < computedCount; ++i)
+    {
+        if (i == 0 || s_queuedPalettes[i].skin->_skeleton != s_queuedPalettes[i - 1].skin->_skeleton)
+            s_skeletonRanges.push_back(i);
+    }
+    s_skeletonRanges.push_back(computedCount);
+    
+    JobSystem::getInstance()->parallelFor(s_skeletonRanges.size() - 1, 4, [](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            auto skeleton = s_queuedPalettes[s_skeletonRanges[i]].skin->_skeleton;
+            skeleton->applySharedPose();
+            skeleton->updateBoneMatrix();
+            
+            for (size_t j = s_skeletonRanges[i]; j < s_skeletonRanges[i + 1]; ++j)
+            {
+                auto& queued = s_queuedPalettes[j];
+                queued.skin->computeMatrixPalette(&s_paletteBuffer[queued.offset]);
+            }
+        }
+    });
+    
+    for (const auto& queued : s_queuedPalettes)
+    {
+        queued.command->setMatrixPalette(&s_paletteBuffer[queued.offset]);
+    }
+    s_queuedPalettes.clear();
 }
 
 ssize_t MeshSkin::getMatrixPaletteSize() const
@@ -35,6 +35,8 @@ NS_CC_BEGIN
 
 class Bone3D;
 class Skeleton3D;
+class MeshCommand;
+class Renderer;
 
 /**
  * MeshSkin, A class maintain a collection of bones that affect Mesh vertex.
@@ -69,6 +71,29 @@ public:
     /**get root bone of the skin*/
     Bone3D* getRootBone() const;
     
+    /** How the matrix palettes of the skins are computed */
+    enum class PaletteMode
+    {
+        IMMEDIATE, ///< each skin computes its palette on the main thread, when its sprite is drawn
+        BATCHED,   ///< the palettes of the skins drawn are computed together on the JobSystem workers, before the commands are rendered
+        SHARED,    ///< batched, and the sprites playing the same frame of the same animation alone share one palette
+    };
+    
+    /**
+     * Sets how the palettes are computed, IMMEDIATE by default.
+     * In SHARED mode the animations playing alone are sampled at their baked frames, and the bones of the sprites
+     * which reuse the palette of another sprite are not animated: the nodes attached to them don't follow.
+     */
+    static void setPaletteMode(PaletteMode mode);
+    static PaletteMode getPaletteMode();
+    
+    /**
+     * Queues the palette of the skin for a command, used by the batched modes.
+     * The palette is computed with the other palettes queued in the frame, in one buffer, and set on the command
+     * before the commands are executed.
+     */
+    void queueMatrixPalette(Renderer* renderer, MeshCommand* command);
+    
 CC_CONSTRUCTOR_ACCESS:
     
     MeshSkin();
@@ -86,6 +111,13 @@ CC_CONSTRUCTOR_ACCESS:
     
 protected:
     
+    /** writes the palette to dst, getMatrixPaletteSize() Vec4 */
+    void computeMatrixPalette(Vec4* dst);
+    
+    /** computes the queued palettes, run by a command before the other commands of the frame */
+    static void flushMatrixPalettes();
+    
+    
     Vector<Bone3D*>    _skinBones; // bones with skin
     std::vector<Mat4>  _invBindPoses; //inverse bind pose of bone
 
@@ -97,6 +129,9 @@ protected:
     // Each 4x3 row-wise matrix is represented as 3 Vec4's.
     // The number of Vec4's is (_skinBones.size() * 3).
     Vec4* _matrixPalette;
+    
+    // hash of the inverse bind poses and of the skeleton, the skins with the same one have the same palette in the same pose
+    uint64_t _layoutKey;
 };
 
 NS_CC_END
@@ -23,6 +23,7 @@
  ****************************************************************************/
 
 #include "3d/CCSkeleton3D.h"
+#include "3d/CCAnimation3D.h"
 
 
 NS_CC_BEGIN
@@ -141,7 +142,7 @@ Bone3D* Bone3D::create(const std::string& id)
 void Bone3D::updateJointMatrix(Vec4* matrixPalette)
 {
     {
-        static Mat4 t;
+        Mat4 t;
         Mat4::multiply(_world, getInverseBindPose(), &t);
 
         matrixPalette[0].set(t.m[0], t.m[4], t.m[8], t.m[12]);
@@ -246,6 +247,9 @@ void Bone3D::updateLocalMat()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 Skeleton3D::Skeleton3D()
+: _sharedPoseAnimation(nullptr)
+, _sharedPoseFrame(0)
+, _sharedPoseApplied(false)
 {
     
 }
@@ -321,10 +325,72 @@ void Skeleton3D::updateBoneMatrix()
     }
 }
 
+void Skeleton3D::setBoneMatrixDirty()
+{
+    for (const auto& it : _rootBones) {
+        it->setWorldMatDirty(true);
+    }
+}
+
+void Skeleton3D::setSharedPose(Animation3D* animation, int frame)
+{
+    if (animation == _sharedPoseAnimation && frame == _sharedPoseFrame)
+        return;
+    
+    if (animation != _sharedPoseAnimation)
+    {
+        CC_SAFE_RETAIN(animation);
+        CC_SAFE_RELEASE(_sharedPoseAnimation);
+        _sharedPoseAnimation = animation;
+        
+        // the bones by the index of their curve, like Animate3D
+        _sharedPoseBones.clear();
+        if (animation)
+        {
+            _sharedPoseBones.assign(animation->getBakedCurveCount(), nullptr);
+            _sharedPoseSamples.resize(10 * animation->getBakedStride());
+            for (const auto& bone : _bones) {
+                int index = animation->getBakedCurveIndex(bone->getName());
+                if (index >= 0)
+                    _sharedPoseBones[index] = bone;
+            }
+        }
+    }
+    _sharedPoseFrame = frame;
+    _sharedPoseApplied = false;
+}
+
+void Skeleton3D::applySharedPose()
+{
+    if (_sharedPoseAnimation == nullptr || _sharedPoseApplied || _sharedPoseBones.empty())
+        return;
+    
+    _sharedPoseApplied = true;
+    auto animation = _sharedPoseAnimation;
+    animation->sampleBakedCurves(static_cast<float>(_sharedPoseFrame) / (animation->getBakedFrameCount() - 1), &_sharedPoseSamples[0]);
+    const int stride = animation->getBakedStride();
+    const float* samples = &_sharedPoseSamples[0];
+    for (int i = 0; i < static_cast<int>(_sharedPoseBones.size()); ++i) {
+        auto bone = _sharedPoseBones[i];
+        if (bone == nullptr)
+            continue;
+        
+        float trans[3] = { samples[i], samples[stride + i], samples[2 * stride + i] };
+        float rot[4] = { samples[3 * stride + i], samples[4 * stride + i], samples[5 * stride + i], samples[6 * stride + i] };
+        float scale[3] = { samples[7 * stride + i], samples[8 * stride + i], samples[9 * stride + i] };
+        unsigned char channels = animation->getBakedChannels(i);
+        bone->setAnimationValue((channels & Animation3D::BAKED_TRANSLATION) ? trans : nullptr,
+                                (channels & Animation3D::BAKED_ROTATION) ? rot : nullptr,
+                                (channels & Animation3D::BAKED_SCALE) ? scale : nullptr,
+                                this);
+    }
+}
+
 void Skeleton3D::removeAllBones()
 {
     _bones.clear();
     _rootBones.clear();
+    setSharedPose(nullptr, 0);
 }
 
 void Skeleton3D::addBone(Bone3D* bone)
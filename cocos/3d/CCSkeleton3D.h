@@ -32,6 +32,8 @@
 
 NS_CC_BEGIN
 
+class Animation3D;
+
 /**
  * Defines a basic hierachial structure of transformation spaces.
  */
@@ -201,6 +203,25 @@ public:
     /**refresh bone world matrix*/
     void updateBoneMatrix();
     
+    /**mark the bone world matrices dirty, they are computed again when they are read*/
+    void setBoneMatrixDirty();
+    
+    /**
+     * set the pose of the skeleton to a baked frame of an animation playing alone, nullptr to clear it.
+     * In the shared palette mode the animates don't move the bones, the pose is kept until it is replaced,
+     * and the bones are only set to it when the palette of the skeleton is computed.
+     */
+    void setSharedPose(Animation3D* animation, int frame);
+    
+    /**get the animation of the shared pose, nullptr if none*/
+    Animation3D* getSharedPoseAnimation() const { return _sharedPoseAnimation; }
+    
+    /**get the baked frame of the shared pose*/
+    int getSharedPoseFrame() const { return _sharedPoseFrame; }
+    
+    /**set the bones to the shared pose, if it changed since they were last set*/
+    void applySharedPose();
+    
 CC_CONSTRUCTOR_ACCESS:
     
     Skeleton3D();
@@ -221,6 +242,12 @@ protected:
     Vector<Bone3D*> _bones; // bones
 
     Vector<Bone3D*> _rootBones;
+    
+    Animation3D* _sharedPoseAnimation; //animation of the shared pose, retained
+    int _sharedPoseFrame;
+    bool _sharedPoseApplied; //whether the bones are in the shared pose
+    std::vector<Bone3D*> _sharedPoseBones; //weak ref, bone of each baked curve of the animation
+    std::vector<float> _sharedPoseSamples;
 };
 
 NS_CC_END
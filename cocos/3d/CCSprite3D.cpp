@@ -678,8 +678,19 @@ void Sprite3D::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
         return;
 #endif
     
+    // in the batched palette modes the bones are updated on the workers, with the palettes, before the commands are rendered
+    bool batchedPalettes = MeshSkin::getPaletteMode() != MeshSkin::PaletteMode::IMMEDIATE;
     if (_skeleton)
-        _skeleton->updateBoneMatrix();
+    {
+        if (batchedPalettes)
+            _skeleton->setBoneMatrixDirty();
+        else
+        {
+            // the pose left by the shared palette mode, if the bones weren't set to it
+            _skeleton->applySharedPose();
+            _skeleton->updateBoneMatrix();
+        }
+    }
     
     Color4F color(getDisplayedColor());
     color.a = getDisplayedOpacity() / 255.0f;
@@ -737,8 +748,15 @@ void Sprite3D::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
         auto skin = mesh->getSkin();
         if (skin)
         {
-            meshCommand.setMatrixPaletteSize((int)skin->getMatrixPaletteSize());
-            meshCommand.setMatrixPalette(skin->getMatrixPalette());
+            if (batchedPalettes)
+            {
+                skin->queueMatrixPalette(renderer, &meshCommand);
+            }
+            else
+            {
+                meshCommand.setMatrixPaletteSize((int)skin->getMatrixPaletteSize());
+                meshCommand.setMatrixPalette(skin->getMatrixPalette());
+            }
         }
         //support tint and fade
         meshCommand.setDisplayColor(Vec4(color.r, color.g, color.b, color.a));
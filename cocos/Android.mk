@@ -92,6 +92,8 @@ cocos2d.cpp \
 platform/CCGLView.cpp \
 platform/CCFileUtils.cpp \
 platform/CCSAXParser.cpp \
+platform/CCMappedData.cpp \
+platform/CCResourcePack.cpp \
 platform/CCThread.cpp \
 platform/CCImage.cpp \
 math/CCAffineTransform.cpp \
@@ -105,10 +107,12 @@ math/Vec2.cpp \
 math/Vec3.cpp \
 math/Vec4.cpp \
 base/CCAsyncTaskPool.cpp \
+base/CCJobSystem.cpp \
 base/CCAutoreleasePool.cpp \
 base/CCConfiguration.cpp \
 base/CCConsole.cpp \
 base/CCData.cpp \
+base/CCBinaryValue.cpp \
 base/CCDataVisitor.cpp \
 base/CCDirector.cpp \
 base/CCEvent.cpp \
@@ -126,11 +130,13 @@ base/CCEventListenerFocus.cpp \
 base/CCEventListenerKeyboard.cpp \
 base/CCEventListenerMouse.cpp \
 base/CCEventListenerTouch.cpp \
+base/CCTouchHitTestGrid.cpp \
 base/CCEventMouse.cpp \
 base/CCEventTouch.cpp \
 base/CCIMEDispatcher.cpp \
 base/CCNS.cpp \
 base/CCProfiling.cpp \
+base/CCFrameProfiler.cpp \
 base/ccRandom.cpp \
 base/CCRef.cpp \
 base/CCScheduler.cpp \
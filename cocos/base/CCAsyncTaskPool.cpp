@@ -46,10 +46,31 @@ void AsyncTaskPool::destoryInstance()
 
 AsyncTaskPool::AsyncTaskPool()
 {
+    for (auto& generation : _generations)
+    {
+        generation = std::make_shared<std::atomic<unsigned int>>(0);
+    }
 }
 
 AsyncTaskPool::~AsyncTaskPool()
 {
+    // drop the tasks still queued in the JobSystem
+    for (auto& generation : _generations)
+    {
+        ++*generation;
+    }
+}
+
+JobSystem::Priority AsyncTaskPool::getPriority(TaskType type) const
+{
+    switch (type)
+    {
+        case TaskType::TASK_IO:
+        case TaskType::TASK_NETWORK:
+            return JobSystem::Priority::LOW;
+        default:
+            return JobSystem::Priority::NORMAL;
+    }
 }
 
 NS_CC_END
@@ -29,11 +29,13 @@ THE SOFTWARE.
 #include "platform/CCPlatformMacros.h"
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
+#include "base/CCJobSystem.h"
 #include <vector>
 #include <queue>
 #include <memory>
 #include <thread>
 #include <mutex>
+#include <atomic>
 #include <condition_variable>
 #include <future>
 #include <functional>
@@ -71,7 +73,7 @@ public:
     
     /**
      * enqueue a asynchronous task
-     * @param type task type is io task, network task or others, each type of task has a thread to deal with it.
+     * @param type task type is io task, network task or others. The tasks run on the JobSystem workers, io and network tasks with a low priority.
      * @param callback callback when the task is finished. The callback is called in the main thread instead of task thread
      * @param callbackParam parameter used by the callback
      * @param f task can be lambda function
@@ -86,119 +88,40 @@ CC_CONSTRUCTOR_ACCESS:
     
 protected:
     
-    // thread tasks internally used
-    class ThreadTasks {
-        struct AsyncTaskCallBack
-        {
-            TaskCallBack          callback;
-            void*                 callbackParam;
-        };
-    public:
-        ThreadTasks()
-        : _stop(false)
-        {
-            _thread = std::thread(
-                                  [this]
-                                  {
-                                      for(;;)
-                                      {
-                                          std::function<void()> task;
-                                          AsyncTaskCallBack callback;
-                                          {
-                                              std::unique_lock<std::mutex> lock(this->_queueMutex);
-                                              this->_condition.wait(lock,
-                                                                    [this]{ return this->_stop || !this->_tasks.empty(); });
-                                              if(this->_stop && this->_tasks.empty())
-                                                  return;
-                                              task = std::move(this->_tasks.front());
-                                              callback = std::move(this->_taskCallBacks.front());
-                                              this->_tasks.pop();
-                                              this->_taskCallBacks.pop();
-                                          }
-                                          
-                                          task();
-                                          Director::getInstance()->getScheduler()->performFunctionInCocosThread([&, callback]{ callback.callback(callback.callbackParam); });
-                                      }
-                                  }
-                                  );
-        }
-        ~ThreadTasks()
-        {
-            {
-                std::unique_lock<std::mutex> lock(_queueMutex);
-                _stop = true;
-                
-                while(_tasks.size())
-                    _tasks.pop();
-                while (_taskCallBacks.size())
-                    _taskCallBacks.pop();
-            }
-            _condition.notify_all();
-            _thread.join();
-        }
-        void clear()
-        {
-            std::unique_lock<std::mutex> lock(_queueMutex);
-            while(_tasks.size())
-                _tasks.pop();
-            while (_taskCallBacks.size())
-                _taskCallBacks.pop();
-        }
-        template<class F>
-        void enqueue(const TaskCallBack& callback, void* callbackParam, F&& f)
-        {
-            auto task = f;//std::bind(std::forward<F>(f), std::forward<Args>(args)...);
-            
-            {
-                std::unique_lock<std::mutex> lock(_queueMutex);
-                
-                // don't allow enqueueing after stopping the pool
-                if(_stop)
-                {
-                    CC_ASSERT(0 && "already stop");
-                    return;
-                }
-                
-                AsyncTaskCallBack taskCallBack;
-                taskCallBack.callback = callback;
-                taskCallBack.callbackParam = callbackParam;
-                _tasks.emplace([task](){ task(); });
-                _taskCallBacks.emplace(taskCallBack);
-            }
-            _condition.notify_one();
-        }
-    private:
-        
-        // need to keep track of thread so we can join them
-        std::thread _thread;
-        // the task queue
-        std::queue< std::function<void()> > _tasks;
-        std::queue<AsyncTaskCallBack>            _taskCallBacks;
-        
-        // synchronization
-        std::mutex _queueMutex;
-        std::condition_variable _condition;
-        bool _stop;
-    };
+    // the tasks run on the shared JobSystem, a task is dropped if its type was stopped after it was enqueued
+    JobSystem::Priority getPriority(TaskType type) const;
     
-    //tasks
-    ThreadTasks _threadTasks[int(TaskType::TASK_MAX_TYPE)];
+    // shared with the queued tasks, they may outlive the pool
+    std::shared_ptr<std::atomic<unsigned int>> _generations[int(TaskType::TASK_MAX_TYPE)];
     
     static AsyncTaskPool* s_asyncTaskPool;
 };
 
 inline void AsyncTaskPool::stopTasks(TaskType type)
 {
-    auto& threadTask = _threadTasks[(int)type];
-    threadTask.clear();
+    ++*_generations[(int)type];
 }
 
 template<class F>
 inline void AsyncTaskPool::enqueue(AsyncTaskPool::TaskType type, const TaskCallBack& callback, void* callbackParam, F&& f)
 {
-    auto& threadTask = _threadTasks[(int)type];
+    auto generation = _generations[(int)type];
+    unsigned int enqueuedGeneration = *generation;
+    auto task = f;
+    auto stopped = std::make_shared<bool>(false);
     
-    threadTask.enqueue(callback, callbackParam, f);
+    JobSystem::getInstance()->schedule([task, stopped, generation, enqueuedGeneration]()
+    {
+        *stopped = (*generation != enqueuedGeneration);
+        if (!*stopped)
+            task();
+    },
+    [callback, callbackParam, stopped]()
+    {
+        if (!*stopped)
+            callback(callbackParam);
+    },
+    getPriority(type));
 }
 
 NS_CC_END
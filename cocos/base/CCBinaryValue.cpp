@@ -0,0 +1,481 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "base/CCBinaryValue.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+namespace
+{
+    const char BINARY_VALUE_MAGIC[4] = { 'C', 'C', 'B', 'V' };
+    const uint32_t BINARY_VALUE_VERSION = 1;
+    const size_t HEADER_SIZE = 20;
+    
+    // deeper trees are rejected rather than overflowing the stack
+    const int MAX_DEPTH = 64;
+    
+    // the format is little endian, like all our platforms
+    class Reader
+    {
+    public:
+        Reader(const unsigned char* bytes, size_t size)
+        : _bytes(bytes)
+        , _size(size)
+        , _offset(0)
+        , _failed(false)
+        {
+        }
+        
+        template <typename T> T read()
+        {
+            T value = T();
+            if (_size - _offset < sizeof(T))
+            {
+                _failed = true;
+                return value;
+            }
+            memcpy(&value, _bytes + _offset, sizeof(T));
+            _offset += sizeof(T);
+            return value;
+        }
+        
+        const unsigned char* skip(size_t size)
+        {
+            if (_size - _offset < size)
+            {
+                _failed = true;
+                return nullptr;
+            }
+            const unsigned char* ret = _bytes + _offset;
+            _offset += size;
+            return ret;
+        }
+        
+        // a container can't have more values than there are bytes left, reserving more would only waste memory
+        uint32_t readCount()
+        {
+            uint32_t count = read<uint32_t>();
+            if (count > _size - _offset)
+            {
+                _failed = true;
+                return 0;
+            }
+            return count;
+        }
+        
+        size_t remaining() const { return _size - _offset; }
+        bool failed() const { return _failed; }
+        void fail() { _failed = true; }
+        
+    private:
+        const unsigned char* _bytes;
+        size_t _size;
+        size_t _offset;
+        bool _failed;
+    };
+    
+    class TreeReader
+    {
+    public:
+        explicit TreeReader(Reader& reader)
+        : _reader(reader)
+        {
+        }
+        
+        bool readStrings(uint32_t count)
+        {
+            // each string takes at least its length
+            if (count > _reader.remaining() / sizeof(uint32_t))
+                return false;
+            
+            _strings.reserve(count);
+            _stringValues.resize(count);
+            for (uint32_t i = 0; i < count && !_reader.failed(); ++i)
+            {
+                uint32_t length = _reader.read<uint32_t>();
+                const unsigned char* chars = _reader.skip(length);
+                if (chars)
+                {
+                    _strings.push_back(std::string(reinterpret_cast<const char*>(chars), length));
+                }
+            }
+            return !_reader.failed();
+        }
+        
+        Value::Type readType()
+        {
+            uint8_t type = _reader.read<uint8_t>();
+            if (type > static_cast<uint8_t>(Value::Type::INT_KEY_MAP))
+            {
+                _reader.fail();
+                return Value::Type::NONE;
+            }
+            return static_cast<Value::Type>(type);
+        }
+        
+        const std::string& readString()
+        {
+            uint32_t index = _reader.read<uint32_t>();
+            if (index >= _strings.size())
+            {
+                _reader.fail();
+                return _empty;
+            }
+            return _strings[index];
+        }
+        
+        // the string values share the payload of the long strings
+        const Value& readStringValue()
+        {
+            uint32_t index = _reader.read<uint32_t>();
+            if (index >= _strings.size())
+            {
+                _reader.fail();
+                return Value::Null;
+            }
+            if (_stringValues[index].isNull())
+            {
+                _stringValues[index] = _strings[index];
+            }
+            return _stringValues[index];
+        }
+        
+        void readValue(Value& value, int depth)
+        {
+            readValue(readType(), value, depth);
+        }
+        
+        void readValue(Value::Type type, Value& value, int depth)
+        {
+            if (depth > MAX_DEPTH)
+            {
+                _reader.fail();
+                return;
+            }
+            
+            switch (type)
+            {
+                case Value::Type::NONE:
+                    value = Value::Null;
+                    break;
+                case Value::Type::BYTE:
+                    value = _reader.read<uint8_t>();
+                    break;
+                case Value::Type::INTEGER:
+                    value = _reader.read<int32_t>();
+                    break;
+                case Value::Type::FLOAT:
+                    value = _reader.read<float>();
+                    break;
+                case Value::Type::DOUBLE:
+                    value = _reader.read<double>();
+                    break;
+                case Value::Type::BOOLEAN:
+                    value = _reader.read<uint8_t>() != 0;
+                    break;
+                case Value::Type::STRING:
+                    value = readStringValue();
+                    break;
+                // the containers are moved into the values, so their copies can share them
+                case Value::Type::VECTOR:
+                {
+                    ValueVector vector;
+                    readValueVector(vector, depth);
+                    value = std::move(vector);
+                    break;
+                }
+                case Value::Type::MAP:
+                {
+                    ValueMap map;
+                    readValueMap(map, depth);
+                    value = std::move(map);
+                    break;
+                }
+                case Value::Type::INT_KEY_MAP:
+                {
+                    ValueMapIntKey map;
+                    readValueMapIntKey(map, depth);
+                    value = std::move(map);
+                    break;
+                }
+            }
+        }
+        
+        void readValueVector(ValueVector& vector, int depth)
+        {
+            uint32_t count = _reader.readCount();
+            vector.resize(count);
+            for (uint32_t i = 0; i < count && !_reader.failed(); ++i)
+            {
+                readValue(vector[i], depth + 1);
+            }
+        }
+        
+        void readValueMap(ValueMap& map, int depth)
+        {
+            uint32_t count = _reader.readCount();
+            map.reserve(count);
+            for (uint32_t i = 0; i < count && !_reader.failed(); ++i)
+            {
+                const std::string& key = readString();
+                readValue(map[key], depth + 1);
+            }
+        }
+        
+        void readValueMapIntKey(ValueMapIntKey& map, int depth)
+        {
+            uint32_t count = _reader.readCount();
+            map.reserve(count);
+            for (uint32_t i = 0; i < count && !_reader.failed(); ++i)
+            {
+                int32_t key = _reader.read<int32_t>();
+                readValue(map[key], depth + 1);
+            }
+        }
+        
+    private:
+        Reader& _reader;
+        std::vector<std::string> _strings;
+        std::vector<Value> _stringValues;
+        std::string _empty;
+    };
+    
+    // reads the header and the strings
+    bool readHeader(Reader& reader, TreeReader& treeReader)
+    {
+        const unsigned char* magic = reader.skip(sizeof(BINARY_VALUE_MAGIC));
+        if (!magic || memcmp(magic, BINARY_VALUE_MAGIC, sizeof(BINARY_VALUE_MAGIC)) != 0)
+            return false;
+        
+        uint32_t version = reader.read<uint32_t>();
+        uint32_t stringCount = reader.read<uint32_t>();
+        reader.read<uint32_t>();    // size of the strings
+        reader.read<uint32_t>();    // size of the tree
+        if (reader.failed() || version != BINARY_VALUE_VERSION)
+            return false;
+        
+        return treeReader.readStrings(stringCount);
+    }
+    
+    class Writer
+    {
+    public:
+        void writeValue(const Value& value)
+        {
+            Value::Type type = value.getType();
+            write<uint8_t>(static_cast<uint8_t>(type));
+            switch (type)
+            {
+                case Value::Type::NONE:
+                    break;
+                case Value::Type::BYTE:
+                    write<uint8_t>(value.asByte());
+                    break;
+                case Value::Type::INTEGER:
+                    write<int32_t>(value.asInt());
+                    break;
+                case Value::Type::FLOAT:
+                    write<float>(value.asFloat());
+                    break;
+                case Value::Type::DOUBLE:
+                    write<double>(value.asDouble());
+                    break;
+                case Value::Type::BOOLEAN:
+                    write<uint8_t>(value.asBool() ? 1 : 0);
+                    break;
+                case Value::Type::STRING:
+                    writeString(value.asString());
+                    break;
+                case Value::Type::VECTOR:
+                    write<uint32_t>(static_cast<uint32_t>(value.asValueVector().size()));
+                    for (auto& element : value.asValueVector())
+                    {
+                        writeValue(element);
+                    }
+                    break;
+                case Value::Type::MAP:
+                    write<uint32_t>(static_cast<uint32_t>(value.asValueMap().size()));
+                    for (auto& element : value.asValueMap())
+                    {
+                        writeString(element.first);
+                        writeValue(element.second);
+                    }
+                    break;
+                case Value::Type::INT_KEY_MAP:
+                    write<uint32_t>(static_cast<uint32_t>(value.asIntKeyMap().size()));
+                    for (auto& element : value.asIntKeyMap())
+                    {
+                        write<int32_t>(element.first);
+                        writeValue(element.second);
+                    }
+                    break;
+            }
+        }
+        
+        Data finish()
+        {
+            std::string header;
+            append(header, BINARY_VALUE_MAGIC, sizeof(BINARY_VALUE_MAGIC));
+            uint32_t fields[4] = { BINARY_VALUE_VERSION, static_cast<uint32_t>(_strings.size()), static_cast<uint32_t>(_stringBytes.size()), static_cast<uint32_t>(_tree.size()) };
+            append(header, fields, sizeof(fields));
+            
+            size_t size = header.size() + _stringBytes.size() + _tree.size();
+            unsigned char* bytes = static_cast<unsigned char*>(malloc(size));
+            memcpy(bytes, header.data(), header.size());
+            memcpy(bytes + header.size(), _stringBytes.data(), _stringBytes.size());
+            memcpy(bytes + header.size() + _stringBytes.size(), _tree.data(), _tree.size());
+            
+            Data ret;
+            ret.fastSet(bytes, size);
+            return ret;
+        }
+        
+    private:
+        template <typename T> void write(T value)
+        {
+            append(_tree, &value, sizeof(T));
+        }
+        
+        void writeString(const std::string& str)
+        {
+            auto found = _strings.find(str);
+            uint32_t index = 0;
+            if (found != _strings.end())
+            {
+                index = found->second;
+            }
+            else
+            {
+                index = static_cast<uint32_t>(_strings.size());
+                _strings[str] = index;
+                uint32_t length = static_cast<uint32_t>(str.length());
+                append(_stringBytes, &length, sizeof(length));
+                append(_stringBytes, str.data(), str.length());
+            }
+            write<uint32_t>(index);
+        }
+        
+        static void append(std::string& bytes, const void* data, size_t size)
+        {
+            bytes.append(static_cast<const char*>(data), size);
+        }
+        
+        std::unordered_map<std::string, uint32_t> _strings;
+        std::string _stringBytes;
+        std::string _tree;
+    };
+}
+
+bool BinaryValue::isBinaryValue(const unsigned char* bytes, ssize_t size)
+{
+    return bytes && size >= static_cast<ssize_t>(HEADER_SIZE) && memcmp(bytes, BINARY_VALUE_MAGIC, sizeof(BINARY_VALUE_MAGIC)) == 0;
+}
+
+bool BinaryValue::read(const unsigned char* bytes, ssize_t size, Value& value)
+{
+    if (!isBinaryValue(bytes, size))
+        return false;
+    
+    Reader reader(bytes, size);
+    TreeReader treeReader(reader);
+    if (!readHeader(reader, treeReader))
+        return false;
+    
+    treeReader.readValue(value, 0);
+    if (reader.failed())
+    {
+        value = Value::Null;
+        return false;
+    }
+    return true;
+}
+
+bool BinaryValue::readValueMap(const unsigned char* bytes, ssize_t size, ValueMap& valueMap)
+{
+    if (!isBinaryValue(bytes, size))
+        return false;
+    
+    Reader reader(bytes, size);
+    TreeReader treeReader(reader);
+    if (!readHeader(reader, treeReader) || treeReader.readType() != Value::Type::MAP)
+        return false;
+    
+    treeReader.readValueMap(valueMap, 0);
+    if (reader.failed())
+    {
+        valueMap.clear();
+        return false;
+    }
+    return true;
+}
+
+bool BinaryValue::readValueVector(const unsigned char* bytes, ssize_t size, ValueVector& valueVector)
+{
+    if (!isBinaryValue(bytes, size))
+        return false;
+    
+    Reader reader(bytes, size);
+    TreeReader treeReader(reader);
+    if (!readHeader(reader, treeReader) || treeReader.readType() != Value::Type::VECTOR)
+        return false;
+    
+    treeReader.readValueVector(valueVector, 0);
+    if (reader.failed())
+    {
+        valueVector.clear();
+        return false;
+    }
+    return true;
+}
+
+Data BinaryValue::write(const Value& value)
+{
+    Writer writer;
+    writer.writeValue(value);
+    return writer.finish();
+}
+
+bool BinaryValue::writeToFile(const Value& value, const std::string& fullPath)
+{
+    Data data = write(value);
+    FILE* fp = fopen(fullPath.c_str(), "wb");
+    if (!fp)
+    {
+        CCLOG("cocos2d: BinaryValue: can not write %s", fullPath.c_str());
+        return false;
+    }
+    
+    bool ok = fwrite(data.getBytes(), 1, data.getSize(), fp) == static_cast<size_t>(data.getSize());
+    fclose(fp);
+    return ok;
+}
+
+NS_CC_END
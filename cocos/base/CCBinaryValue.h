@@ -0,0 +1,84 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __CC_BINARY_VALUE_H__
+#define __CC_BINARY_VALUE_H__
+
+#include <string>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/CCValue.h"
+#include "base/CCData.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup data_structures
+ * @{
+ */
+
+/** @brief Compact binary form of the Value trees, made from the plists by tools/binary-plist/convert_plists.py
+
+ FileUtils::getValueMapFromFile and FileUtils::getValueVectorFromFile detect the binary form by its magic,
+ so a plist can be replaced by its binary form without changing its name or the code that loads it.
+ The strings are stored once, the containers are created with their final size and filled in place,
+ there is nothing to parse.
+
+ Layout, little endian:
+     header   magic "CCBV", version, string count, size of the strings, size of the tree  (20 bytes)
+     strings  the keys and the strings: length (uint32) then the UTF-8 bytes, not terminated
+     tree     the root value, each value is its Value::Type (uint8) followed by:
+              BYTE uint8, INTEGER int32, FLOAT float, DOUBLE double, BOOLEAN uint8, STRING string index (uint32),
+              VECTOR count (uint32) then the values, MAP count then the key string index and the value of each pair,
+              INT_KEY_MAP count then the int32 key and the value of each pair
+ */
+class CC_DLL BinaryValue
+{
+public:
+    /** Whether or not the bytes start with the magic of the binary form */
+    static bool isBinaryValue(const unsigned char* bytes, ssize_t size);
+    
+    /** Reads a binary form. Returns false if the bytes are not a valid binary form */
+    static bool read(const unsigned char* bytes, ssize_t size, Value& value);
+    
+    /** Reads a binary form whose root is a map, in place. Returns false if it isn't */
+    static bool readValueMap(const unsigned char* bytes, ssize_t size, ValueMap& valueMap);
+    
+    /** Reads a binary form whose root is a vector, in place. Returns false if it isn't */
+    static bool readValueVector(const unsigned char* bytes, ssize_t size, ValueVector& valueVector);
+    
+    /** Returns the binary form of a value */
+    static Data write(const Value& value);
+    
+    /** Writes the binary form of a value to a file */
+    static bool writeToFile(const Value& value, const std::string& fullPath);
+};
+
+// end of data_structures group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_BINARY_VALUE_H__
@@ -65,6 +65,7 @@
 #include "base/base64.h"
 #include "base/ccUtils.h"
 #include "base/allocator/CCAllocatorDiagnostics.h"
+#include "base/CCFrameProfiler.h"
 NS_CC_BEGIN
 
 extern const char* cocos2dVersion(void);
@@ -310,6 +311,7 @@ Console::Console()
             }
         } },
         { "help", "Print this message", std::bind(&Console::commandHelp, this, std::placeholders::_1, std::placeholders::_2) },
+        { "profiler", "Record frames and write them as a Chrome trace in the writable path. Args: [frame_count [filename] | ]", std::bind(&Console::commandProfiler, this, std::placeholders::_1, std::placeholders::_2) },
         { "projection", "Change or print the current projection. Args: [2d | 3d]", std::bind(&Console::commandProjection, this, std::placeholders::_1, std::placeholders::_2) },
         { "resolution", "Change or print the window resolution. Args: [width height resolution_policy | ]", std::bind(&Console::commandResolution, this, std::placeholders::_1, std::placeholders::_2) },
         { "scenegraph", "Print the scene graph", std::bind(&Console::commandSceneGraph, this, std::placeholders::_1, std::placeholders::_2) },
@@ -821,6 +823,32 @@ void Console::commandAllocator(int fd, const std::string& args)
 #endif
 }
 
+void Console::commandProfiler(int fd, const std::string& args)
+{
+#if CC_ENABLE_FRAME_PROFILER
+    auto profiler = FrameProfiler::getInstance();
+    if (args.length() == 0)
+    {
+        mydprintf(fd, "Profiler is: %s\n", profiler->isCapturing() ? "capturing" : "idle");
+        return;
+    }
+    
+    auto argv = split(args, ' ');
+    int frameCount = atoi(argv[0].c_str());
+    if (frameCount <= 0)
+    {
+        mydprintf(fd, "Unsupported argument: '%s'. Supported arguments: frame_count [filename] or nothing\n", args.c_str());
+        return;
+    }
+    
+    std::string filename = argv.size() > 1 ? argv[1] : "profile.json";
+    profiler->captureFrames(frameCount, filename);
+    mydprintf(fd, "Recording %d frames to %s%s\n", frameCount, _writablePath.c_str(), filename.c_str());
+#else
+    mydprintf(fd, "frame profiler not available. CC_ENABLE_FRAME_PROFILER must be set to 1 in ccConfig.h\n");
+#endif
+}
+
 static char invalid_filename_char[] = {':', '/', '\\', '?', '%', '*', '<', '>', '"', '|', '\r', '\n', '\t'};
 
 void Console::commandUpload(int fd)
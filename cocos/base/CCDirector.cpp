@@ -30,6 +30,7 @@ THE SOFTWARE.
 
 // standard includes
 #include <string>
+#include <thread>
 
 #include "2d/CCDrawingPrimitives.h"
 #include "2d/CCSpriteFrameCache.h"
@@ -58,6 +59,8 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCJobSystem.h"
+#include "base/CCFrameProfiler.h"
 #include "platform/CCApplication.h"
 //#include "platform/CCGLViewImpl.h"
 
@@ -122,6 +125,10 @@ bool Director::init(void)
 
     _scenesStack.reserve(15);
 
+    // transforms are computed by visit() by default
+    _parallelTransformUpdate = false;
+    setTransformUpdateThreadCount(0);
+
     // FPS
     _accumDt = 0.0f;
     _frameRate = 0.0f;
@@ -206,6 +213,15 @@ Director::~Director(void)
     s_SharedDirector = nullptr;
 }
 
+void Director::setTransformUpdateThreadCount(int threadCount)
+{
+    if (threadCount <= 0)
+    {
+        threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    _transformUpdateThreadCount = threadCount;
+}
+
 void Director::setDefaultValues(void)
 {
     Configuration *conf = Configuration::getInstance();
@@ -257,6 +273,8 @@ void Director::setGLDefaultValues()
 // Draw the Scene
 void Director::drawScene()
 {
+    CC_PROFILE_ZONE("Director::drawScene");
+    
     // calculate "global" dt
     calculateDeltaTime();
     
@@ -295,17 +313,17 @@ void Director::drawScene()
 #endif
         //clear draw stats
         _renderer->clearDrawStats();
+
+        //compute the world transforms ahead of the visit
+        if (_parallelTransformUpdate)
+        {
+            _runningScene->prepareTransforms(_transformUpdateThreadCount);
+        }
         
         //render the scene
         _runningScene->render(_renderer);
         
         _eventDispatcher->dispatchEvent(_eventAfterVisit);
-#if CC_USE_PHYSICS
-        if(physicsWorld)
-        {
-            physicsWorld->_updateBodyTransform = false;
-        }
-#endif
     }
 
     // draw the notifications node
@@ -973,6 +991,9 @@ void Director::reset()
     GL::invalidateStateCache();
     
     destroyTextureCache();
+
+    // after the texture cache, it waits for its decode jobs
+    JobSystem::destroyInstance();
 }
 
 void Director::purgeDirector()
@@ -1306,10 +1327,14 @@ void DisplayLinkDirector::mainLoop()
     }
     else if (! _invalid)
     {
+        CC_PROFILE_BEGIN_FRAME();
+        
         drawScene();
      
         // release the objects
         PoolManager::getInstance()->getCurrentPool()->clear();
+        
+        CC_PROFILE_END_FRAME();
     }
 }
 
@@ -148,6 +148,17 @@ public:
     /** seconds per frame */
     inline float getSecondsPerFrame() { return _secondsPerFrame; }
 
+    /** Whether or not the world transforms of the running scene are computed on worker threads before it is visited */
+    inline bool isParallelTransformUpdate() const { return _parallelTransformUpdate; }
+    /** Computes the world transforms of the running scene on worker threads, one task per subtree,
+     before the scene is visited and drawn. The transforms are the same as the ones computed by visit().
+     */
+    inline void setParallelTransformUpdate(bool enabled) { _parallelTransformUpdate = enabled; }
+    /** Number of threads used to compute the world transforms, the calling thread included */
+    inline int getTransformUpdateThreadCount() const { return _transformUpdateThreadCount; }
+    /** Sets the number of threads used to compute the world transforms. 0 uses one thread per core */
+    void setTransformUpdateThreadCount(int threadCount);
+
     /** Get the GLView, where everything is rendered
     * @js NA
     * @lua NA
@@ -461,6 +472,8 @@ protected:
     bool _landscape;
     
     bool _displayStats;
+    bool _parallelTransformUpdate;
+    int _transformUpdateThreadCount;
     float _accumDt;
     float _frameRate;
     
@@ -26,6 +26,7 @@
 
 #include "base/CCEventCustom.h"
 #include "base/CCEventListenerTouch.h"
+#include "base/CCTouchHitTestGrid.h"
 #include "base/CCEventListenerAcceleration.h"
 #include "base/CCEventListenerMouse.h"
 #include "base/CCEventListenerKeyboard.h"
@@ -201,7 +202,7 @@ void EventDispatcher::EventListenerVector::clear()
 EventDispatcher::EventDispatcher()
 : _inDispatch(0)
 , _isEnabled(false)
-, _nodePriorityIndex(0)
+, _touchHitTestGrid(new (std::nothrow) TouchHitTestGrid())
 {
     _toAddedListeners.reserve(50);
     
@@ -218,73 +219,56 @@ EventDispatcher::~EventDispatcher()
     // so removeAllEventListeners would clean internal custom listeners.
     _internalCustomListenerIDs.clear();
     removeAllEventListeners();
+    delete _touchHitTestGrid;
 }
 
-void EventDispatcher::visitTarget(Node* node, bool isRootNode)
-{    
-    int i = 0;
-    auto& children = node->getChildren();
+const EventDispatcher::NodePriority& EventDispatcher::getNodePriority(Node* node)
+{
+    auto found = _nodePriorityMap.find(node);
+    if (found != _nodePriorityMap.end())
+        return found->second;
     
-    auto childrenCount = children.size();
+    auto& priority = _nodePriorityMap[node];
+    priority.globalZOrder = node->getGlobalZOrder();
     
-    if(childrenCount > 0)
+    // the children are visited in the order of their local z order, then of their arrival
+    for (; node->getParent(); node = node->getParent())
     {
-        Node* child = nullptr;
-        // visit children zOrder < 0
-        for( ; i < childrenCount; i++ )
-        {
-            child = children.at(i);
-            
-            if ( child && child->getLocalZOrder() < 0 )
-                visitTarget(child, false);
-            else
-                break;
-        }
-        
-        if (_nodeListenersMap.find(node) != _nodeListenersMap.end())
-        {
-            _globalZOrderNodeMap[node->getGlobalZOrder()].push_back(node);
-        }
-        
-        for( ; i < childrenCount; i++ )
-        {
-            child = children.at(i);
-            if (child)
-                visitTarget(child, false);
-        }
-    }
-    else
-    {
-        if (_nodeListenersMap.find(node) != _nodeListenersMap.end())
-        {
-            _globalZOrderNodeMap[node->getGlobalZOrder()].push_back(node);
-        }
+        priority.path.push_back(std::make_pair(node->getLocalZOrder(), node->getOrderOfArrival()));
     }
+    std::reverse(priority.path.begin(), priority.path.end());
+    priority.root = node;
+    
+    return priority;
+}
+
+bool EventDispatcher::isLowerPriority(const NodePriority& p1, const NodePriority& p2, Node* rootNode)
+{
+    // the nodes that are not in the running scene come last
+    bool inScene1 = p1.root == rootNode;
+    bool inScene2 = p2.root == rootNode;
+    if (inScene1 != inScene2)
+        return !inScene1;
+    if (!inScene1)
+        return false;
     
-    if (isRootNode)
+    if (p1.globalZOrder != p2.globalZOrder)
+        return p1.globalZOrder < p2.globalZOrder;
+    
+    // compare the first parents that are not shared, they are siblings
+    auto depth = std::min(p1.path.size(), p2.path.size());
+    for (size_t i = 0; i < depth; ++i)
     {
-        std::vector<float> globalZOrders;
-        globalZOrders.reserve(_globalZOrderNodeMap.size());
-        
-        for (const auto& e : _globalZOrderNodeMap)
-        {
-            globalZOrders.push_back(e.first);
-        }
-        
-        std::sort(globalZOrders.begin(), globalZOrders.end(), [](const float a, const float b){
-            return a < b;
-        });
-        
-        for (const auto& globalZ : globalZOrders)
-        {
-            for (const auto& n : _globalZOrderNodeMap[globalZ])
-            {
-                _nodePriorityMap[n] = ++_nodePriorityIndex;
-            }
-        }
-        
-        _globalZOrderNodeMap.clear();
+        if (p1.path[i] != p2.path[i])
+            return p1.path[i] < p2.path[i];
     }
+    
+    // a node is visited after its children with a negative local z order
+    if (p1.path.size() < p2.path.size())
+        return p2.path[depth].first >= 0;
+    if (p2.path.size() < p1.path.size())
+        return p1.path[depth].first < 0;
+    return false;
 }
 
 void EventDispatcher::pauseEventListenersForTarget(Node* target, bool recursive/* = false */)
@@ -337,7 +321,12 @@ void EventDispatcher::resumeEventListenersForTarget(Node* target, bool recursive
         }
     }
 
-    setDirtyForNode(target);
+    // the target may have been moved while it was paused,
+    // its children are resumed by their own onEnter, or below
+    if (_nodeListenersMap.find(target) != _nodeListenersMap.end())
+    {
+        _dirtyNodes.insert(target);
+    }
     
     if (recursive)
     {
@@ -432,6 +421,7 @@ void EventDispatcher::dissociateNodeAndEventListener(Node* node, EventListener*
         if (listeners->empty())
         {
             _nodeListenersMap.erase(found);
+            _nodePriorityMap.erase(node);
             delete listeners;
         }
     }
@@ -614,6 +604,10 @@ void EventDispatcher::removeEventListener(EventListener* listener)
                     dissociateNodeAndEventListener(l->getAssociatedNode(), l);
                     l->setAssociatedNode(nullptr);  // nullptr out the node pointer so we don't have any dangling pointers to destroyed nodes.
                 }
+                if (l->getType() == EventListener::Type::TOUCH_ONE_BY_ONE)
+                {
+                    _touchHitTestGrid->remove(static_cast<EventListenerTouchOneByOne*>(l));
+                }
                 
                 if (_inDispatch == 0)
                 {
@@ -854,9 +848,20 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
         auto mutableTouchesIter = mutableTouches.begin();
         auto touchesIter = originalTouches.begin();
         
+        bool isBegan = event->getEventCode() == EventTouch::EventCode::BEGAN;
+        if (isBegan)
+        {
+            auto sceneGraphListeners = oneByOneListeners->getSceneGraphPriorityListeners();
+            if (sceneGraphListeners && !sceneGraphListeners->empty())
+                _touchHitTestGrid->update(*sceneGraphListeners);
+            else
+                _touchHitTestGrid->clear();
+        }
+        
         for (; touchesIter != originalTouches.end(); ++touchesIter)
         {
             bool isSwallowed = false;
+            unsigned int hitTestStamp = isBegan ? _touchHitTestGrid->query((*touchesIter)->getLocation()) : 0;
 
             auto onTouchEvent = [&](EventListener* l) -> bool { // Return true to break
                 EventListenerTouchOneByOne* listener = static_cast<EventListenerTouchOneByOne*>(l);
@@ -874,7 +879,9 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
                 
                 if (eventCode == EventTouch::EventCode::BEGAN)
                 {
-                    if (listener->onTouchBegan)
+                    // With hit test, the listeners whose node is not under the touch are skipped
+                    if (listener->onTouchBegan
+                        && (!listener->_hitTestEnabled || !listener->_node || listener->_hitTestStamp == hitTestStamp))
                     {
                         isClaimed = listener->onTouchBegan(*touchesIter, event);
                         if (isClaimed && listener->_isRegistered)
@@ -1126,6 +1133,8 @@ void EventDispatcher::updateDirtyFlagForSceneGraph()
     {
         for (auto& node : _dirtyNodes)
         {
+            _nodePriorityMap.erase(node);
+            
             auto iter = _nodeListenersMap.find(node);
             if (iter != _nodeListenersMap.end())
             {
@@ -1186,22 +1195,36 @@ void EventDispatcher::sortEventListenersOfSceneGraphPriority(const EventListener
     if (sceneGraphListeners == nullptr)
         return;
 
-    // Reset priority index
-    _nodePriorityIndex = 0;
-    _nodePriorityMap.clear();
-
-    visitTarget(rootNode, true);
+    // The listeners were sorted the last time, except those of the nodes that were moved,
+    // and those that were added at the end. Only these are sorted, then merged with the others.
+    std::vector<std::pair<const NodePriority*, EventListener*>> sorted;
+    sorted.reserve(sceneGraphListeners->size());
+    for (auto& l : *sceneGraphListeners)
+    {
+        sorted.push_back(std::make_pair(&getNodePriority(l->getAssociatedNode()), l));
+    }
     
     // After sort: priority < 0, > 0
-    std::sort(sceneGraphListeners->begin(), sceneGraphListeners->end(), [this](const EventListener* l1, const EventListener* l2) {
-        return _nodePriorityMap[l1->getAssociatedNode()] > _nodePriorityMap[l2->getAssociatedNode()];
-    });
+    auto higherPriority = [rootNode](const std::pair<const NodePriority*, EventListener*>& l1, const std::pair<const NodePriority*, EventListener*>& l2) {
+        return isLowerPriority(*l2.first, *l1.first, rootNode);
+    };
+    auto sortedEnd = std::is_sorted_until(sorted.begin(), sorted.end(), higherPriority);
+    if (sortedEnd != sorted.end())
+    {
+        std::stable_sort(sortedEnd, sorted.end(), higherPriority);
+        std::inplace_merge(sorted.begin(), sortedEnd, sorted.end(), higherPriority);
+        
+        for (size_t i = 0; i < sorted.size(); ++i)
+        {
+            (*sceneGraphListeners)[i] = sorted[i].second;
+        }
+    }
     
 #if DUMP_LISTENER_ITEM_PRIORITY_INFO
     log("-----------------------------------");
-    for (auto& l : *sceneGraphListeners)
+    for (auto& l : sorted)
     {
-        log("listener priority: node ([%s]%p), priority (%d)", typeid(*l->_node).name(), l->_node, _nodePriorityMap[l->_node]);
+        log("listener priority: node ([%s]%p), global z (%f), depth (%d)", typeid(*l.second->_node).name(), l.second->_node, l.first->globalZOrder, (int)l.first->path.size());
     }
 #endif
 }
@@ -1276,6 +1299,10 @@ void EventDispatcher::removeEventListenersForListenerID(const EventListener::Lis
                     dissociateNodeAndEventListener(l->getAssociatedNode(), l);
                     l->setAssociatedNode(nullptr);  // nullptr out the node pointer so we don't have any dangling pointers to destroyed nodes.
                 }
+                if (l->getType() == EventListener::Type::TOUCH_ONE_BY_ONE)
+                {
+                    _touchHitTestGrid->remove(static_cast<EventListenerTouchOneByOne*>(l));
+                }
                 
                 if (_inDispatch == 0)
                 {
@@ -1390,6 +1417,25 @@ bool EventDispatcher::isEnabled() const
     return _isEnabled;
 }
 
+bool EventDispatcher::hasEventListener(const EventListener::ListenerID& listenerID) const
+{
+    auto iter = _listenerMap.find(listenerID);
+    if (iter != _listenerMap.end() && !iter->second->empty())
+    {
+        return true;
+    }
+
+    // the listeners added while dispatching an event
+    for (auto listener : _toAddedListeners)
+    {
+        if (listener->getListenerID() == listenerID)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 void EventDispatcher::setDirtyForNode(Node* node)
 {
     // Mark the node dirty only when there is an eventlistener associated with it. 
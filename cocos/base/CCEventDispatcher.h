@@ -43,6 +43,7 @@ class EventTouch;
 class Node;
 class EventCustom;
 class EventListenerCustom;
+class TouchHitTestGrid;
 
 /**
 This class manages event listener subscriptions
@@ -122,6 +123,9 @@ public:
     /** Checks whether dispatching events is enabled */
     bool isEnabled() const;
 
+    /** Checks whether a listener was added for the event listener type, to skip building the events nobody listens to */
+    bool hasEventListener(const EventListener::ListenerID& listenerID) const;
+
     /////////////////////////////////////////////
     
     /** Dispatches the event
@@ -242,8 +246,24 @@ protected:
     /** Sets the dirty flag for a specified listener ID */
     void setDirty(const EventListener::ListenerID& listenerID, DirtyFlag flag);
     
-    /** Walks though scene graph to get the draw order for each node, it's called before sorting event listener with scene graph priority */
-    void visitTarget(Node* node, bool isRootNode);
+    /** The place of a node in the scene graph, the listeners with scene graph priority are sorted by it.
+     It is kept until the node, or one of its parents, changes its z order or is added to a parent,
+     so sorting the listeners doesn't walk the scene graph.
+     */
+    struct NodePriority
+    {
+        /** The top most parent of the node */
+        Node* root;
+        float globalZOrder;
+        /** The local z order and the order of arrival of the node and its parents, starting below the root */
+        std::vector<std::pair<int, int>> path;
+    };
+    
+    /** Gets the place of a node in the scene graph, computes it if the node was moved */
+    const NodePriority& getNodePriority(Node* node);
+    
+    /** Whether the listeners of the first node are called after the listeners of the second one in the scene of rootNode */
+    static bool isLowerPriority(const NodePriority& p1, const NodePriority& p2, Node* rootNode);
     
     /** Listeners map */
     std::unordered_map<EventListener::ListenerID, EventListenerVector*> _listenerMap;
@@ -254,11 +274,8 @@ protected:
     /** The map of node and event listeners */
     std::unordered_map<Node*, std::vector<EventListener*>*> _nodeListenersMap;
     
-    /** The map of node and its event priority */
-    std::unordered_map<Node*, int> _nodePriorityMap;
-    
-    /** key: Global Z Order, value: Sorted Nodes */
-    std::unordered_map<float, std::vector<Node*>> _globalZOrderNodeMap;
+    /** The map of node and its place in the scene graph */
+    std::unordered_map<Node*, NodePriority> _nodePriorityMap;
     
     /** The listeners to be added after dispatching event */
     std::vector<EventListener*> _toAddedListeners;
@@ -272,7 +289,8 @@ protected:
     /** Whether to enable dispatching event */
     bool _isEnabled;
     
-    int _nodePriorityIndex;
+    /** The nodes of the touch listeners with hit test, see EventListenerTouchOneByOne::setHitTestEnabled */
+    TouchHitTestGrid* _touchHitTestGrid;
     
     std::set<std::string> _internalCustomListenerIDs;
 };
@@ -39,6 +39,10 @@ EventListenerTouchOneByOne::EventListenerTouchOneByOne()
 , onTouchEnded(nullptr)
 , onTouchCancelled(nullptr)
 , _needSwallow(false)
+, _hitTestEnabled(false)
+, _hitTestNode(nullptr)
+, _hitTestVersion(0)
+, _hitTestStamp(0)
 {
 }
 
@@ -67,6 +71,17 @@ bool EventListenerTouchOneByOne::isSwallowTouches()
     return _needSwallow;
 }
 
+void EventListenerTouchOneByOne::setHitTestEnabled(bool enabled)
+{
+    _hitTestEnabled = enabled;
+    _hitTestNode = nullptr;
+}
+
+bool EventListenerTouchOneByOne::isHitTestEnabled() const
+{
+    return _hitTestEnabled;
+}
+
 EventListenerTouchOneByOne* EventListenerTouchOneByOne::create()
 {
     auto ret = new (std::nothrow) EventListenerTouchOneByOne();
@@ -108,6 +123,7 @@ EventListenerTouchOneByOne* EventListenerTouchOneByOne::clone()
         
         ret->_claimedTouches = _claimedTouches;
         ret->_needSwallow = _needSwallow;
+        ret->_hitTestEnabled = _hitTestEnabled;
     }
     else
     {
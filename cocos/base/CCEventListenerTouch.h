@@ -27,12 +27,14 @@
 #define __cocos2d_libs__CCTouchEventListener__
 
 #include "base/CCEventListener.h"
+#include "math/CCGeometry.h"
 
 #include <vector>
 
 NS_CC_BEGIN
 
 class Touch;
+class Node;
 
 class CC_DLL EventListenerTouchOneByOne : public EventListener
 {
@@ -46,6 +48,15 @@ public:
     void setSwallowTouches(bool needSwallow);
     bool isSwallowTouches();
     
+    /** Whether onTouchBegan is only called for the touches that begin inside the node of the listener.
+     When it is enabled, the dispatcher keeps the bounding boxes of the nodes, in world space, in a grid
+     and only calls the listeners whose node is under the touch, and is visible.
+     The bounding box is the one of the content size of the node, so rotated nodes can still be called for
+     touches near their corners. Only for the listeners with scene graph priority. Disabled by default.
+     */
+    void setHitTestEnabled(bool enabled);
+    bool isHitTestEnabled() const;
+    
     /// Overrides
     virtual EventListenerTouchOneByOne* clone() override;
     virtual bool checkAvailable() override;
@@ -69,7 +80,16 @@ private:
     std::vector<Touch*> _claimedTouches;
     bool _needSwallow;
     
+    bool _hitTestEnabled;
+    /** The node and bounds in the hit test grid */
+    Node* _hitTestNode;
+    Rect _hitTestBounds;
+    unsigned int _hitTestVersion;
+    /** The last touch the listener was found under */
+    unsigned int _hitTestStamp;
+    
     friend class EventDispatcher;
+    friend class TouchHitTestGrid;
 };
 
 
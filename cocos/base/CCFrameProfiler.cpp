@@ -0,0 +1,325 @@
+/****************************************************************************
+ Copyright (c) 2013-2014 Chukong Technologies Inc.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/CCFrameProfiler.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "base/ccMacros.h"
+#include "base/allocator/CCAllocatorThreadLocal.h"
+#include "platform/CCFileUtils.h"
+
+NS_CC_BEGIN
+
+struct FrameProfiler::ThreadBuffer
+{
+    // power of 2, 512KB per thread
+    static const size_t CAPACITY = 1 << 15;
+    
+    ThreadBuffer()
+    : head(0)
+    , tail(0)
+    , dropped(0)
+    , exited(false)
+    {
+    }
+    
+    Event events[CAPACITY];
+    std::atomic<size_t> head;       ///< written by the thread
+    std::atomic<size_t> tail;       ///< written by the main thread
+    std::atomic<uint32_t> dropped;  ///< events that didn't fit
+    std::atomic<bool> exited;
+    std::string name;
+};
+
+namespace
+{
+    int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
+    void writeString(FILE* fp, const char* str)
+    {
+        fputc('"', fp);
+        for (; *str; ++str)
+        {
+            if (*str == '"' || *str == '\\')
+                fputc('\\', fp);
+            fputc(*str, fp);
+        }
+        fputc('"', fp);
+    }
+    
+#if CC_ALLOCATOR_HAS_THREAD_LOCAL
+    // the buffer can be reused by a new thread once its events are drained
+    TLS_CALLBACK(onThreadExit, buffer)
+    {
+        static_cast<FrameProfiler::ThreadBuffer*>(buffer)->exited = true;
+    }
+    
+    class ThreadBufferKey : public allocator::AllocatorThreadLocal
+    {
+    public:
+        ThreadBufferKey()
+        {
+            init(onThreadExit);
+        }
+    };
+#endif
+}
+
+std::atomic<bool> FrameProfiler::s_recording(false);
+
+FrameProfiler::Site::Site(const char* name_, const char* file_, int line_)
+: name(name_)
+, file(file_)
+, line(line_)
+{
+    auto profiler = FrameProfiler::getInstance();
+    std::lock_guard<std::mutex> lock(profiler->_mutex);
+    id = static_cast<uint32_t>(profiler->_sites.size());
+    profiler->_sites.push_back(this);
+}
+
+FrameProfiler* FrameProfiler::getInstance()
+{
+    // never destroyed: the zones can run until the threads exit
+    static FrameProfiler* s_sharedProfiler = new (std::nothrow) FrameProfiler();
+    return s_sharedProfiler;
+}
+
+FrameProfiler::FrameProfiler()
+: _requestedFrames(0)
+, _recordedFrames(0)
+{
+}
+
+FrameProfiler::ThreadBuffer* FrameProfiler::getThreadBuffer()
+{
+#if CC_ALLOCATOR_HAS_THREAD_LOCAL
+    static ThreadBufferKey s_key;
+    
+    auto buffer = static_cast<ThreadBuffer*>(s_key.get());
+    if (buffer || !s_key.valid())
+        return buffer;
+    
+    auto profiler = getInstance();
+    std::lock_guard<std::mutex> lock(profiler->_mutex);
+    for (auto& thread : profiler->_threads)
+    {
+        if (thread->exited && thread->head.load() == thread->tail.load())
+        {
+            buffer = thread;
+            buffer->exited = false;
+            buffer->name.clear();
+            break;
+        }
+    }
+    if (!buffer)
+    {
+        buffer = new (std::nothrow) ThreadBuffer();
+        profiler->_threads.push_back(buffer);
+    }
+    s_key.set(buffer);
+    return buffer;
+#else
+    // without thread local storage, only the main thread is recorded
+    static std::thread::id s_mainThread = std::this_thread::get_id();
+    static ThreadBuffer* s_mainBuffer = nullptr;
+    if (std::this_thread::get_id() != s_mainThread)
+        return nullptr;
+    
+    if (!s_mainBuffer)
+    {
+        auto profiler = getInstance();
+        std::lock_guard<std::mutex> lock(profiler->_mutex);
+        s_mainBuffer = new (std::nothrow) ThreadBuffer();
+        profiler->_threads.push_back(s_mainBuffer);
+    }
+    return s_mainBuffer;
+#endif
+}
+
+void FrameProfiler::record(uint32_t site, bool begin)
+{
+    ThreadBuffer* buffer = getThreadBuffer();
+    if (!buffer)
+        return;
+    
+    size_t head = buffer->head.load(std::memory_order_relaxed);
+    if (head - buffer->tail.load(std::memory_order_acquire) >= ThreadBuffer::CAPACITY)
+    {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    
+    Event& event = buffer->events[head & (ThreadBuffer::CAPACITY - 1)];
+    event.time = now();
+    event.site = site;
+    event.begin = begin;
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void FrameProfiler::setThreadName(const char* name)
+{
+    ThreadBuffer* buffer = getThreadBuffer();
+    if (buffer)
+    {
+        std::lock_guard<std::mutex> lock(getInstance()->_mutex);
+        buffer->name = name;
+    }
+}
+
+void FrameProfiler::captureFrames(int frameCount, const std::string& filename)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _filename = filename;
+    _requestedFrames = frameCount;
+}
+
+void FrameProfiler::drainThreadBuffers(bool keep)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (uint32_t i = 0; i < _threads.size(); ++i)
+    {
+        ThreadBuffer* buffer = _threads[i];
+        size_t head = buffer->head.load(std::memory_order_acquire);
+        size_t tail = buffer->tail.load(std::memory_order_relaxed);
+        if (keep)
+        {
+            for (; tail != head; ++tail)
+            {
+                _events.push_back(std::make_pair(i, buffer->events[tail & (ThreadBuffer::CAPACITY - 1)]));
+            }
+        }
+        buffer->tail.store(head, std::memory_order_release);
+    }
+}
+
+void FrameProfiler::beginFrame()
+{
+    if (s_recording || _requestedFrames <= 0)
+        return;
+    
+    // the events recorded after the end of the previous capture
+    drainThreadBuffers(false);
+    _events.clear();
+    _recordedFrames = 0;
+    
+    ThreadBuffer* buffer = getThreadBuffer();
+    if (buffer)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        buffer->name = "main";
+        buffer->dropped = 0;
+    }
+    
+    s_recording = true;
+}
+
+void FrameProfiler::endFrame()
+{
+    if (!s_recording)
+        return;
+    
+    drainThreadBuffers(true);
+    if (++_recordedFrames < _requestedFrames)
+        return;
+    
+    s_recording = false;
+    
+    std::string filename;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        filename = _filename;
+    }
+    std::string fullPath = FileUtils::getInstance()->getWritablePath() + filename;
+    if (writeTrace(fullPath))
+    {
+        CCLOG("cocos2d: FrameProfiler: %d frames written to %s", _recordedFrames, fullPath.c_str());
+    }
+    else
+    {
+        CCLOG("cocos2d: FrameProfiler: can not write %s", fullPath.c_str());
+    }
+    
+    _events.clear();
+    _requestedFrames = 0;
+}
+
+bool FrameProfiler::writeTrace(const std::string& fullPath)
+{
+    FILE* fp = fopen(fullPath.c_str(), "w");
+    if (!fp)
+        return false;
+    
+    std::lock_guard<std::mutex> lock(_mutex);
+    
+    fputs("{\"traceEvents\":[\n", fp);
+    bool first = true;
+    for (uint32_t i = 0; i < _threads.size(); ++i)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "thread %u", i);
+        
+        fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",\n", i);
+        writeString(fp, _threads[i]->name.empty() ? name : _threads[i]->name.c_str());
+        fputs("}}", fp);
+        first = false;
+        
+        uint32_t dropped = _threads[i]->dropped.exchange(0);
+        if (dropped > 0)
+        {
+            CCLOG("cocos2d: FrameProfiler: %u events of thread %u were dropped, its buffer is full", dropped, i);
+        }
+    }
+    
+    int64_t start = _events.empty() ? 0 : _events.front().second.time;
+    for (auto& event : _events)
+    {
+        start = std::min(start, event.second.time);
+    }
+    
+    for (auto& event : _events)
+    {
+        const Site* site = _sites[event.second.site];
+        fputs(first ? "{\"name\":" : ",\n{\"name\":", fp);
+        writeString(fp, site->name);
+        fprintf(fp, ",\"cat\":\"cocos2d\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+                event.second.begin ? 'B' : 'E', (event.second.time - start) / 1000.0, event.first);
+        first = false;
+    }
+    fputs("\n]}\n", fp);
+    
+    bool ok = ferror(fp) == 0;
+    fclose(fp);
+    return ok;
+}
+
+NS_CC_END
@@ -0,0 +1,182 @@
+/****************************************************************************
+ Copyright (c) 2013-2014 Chukong Technologies Inc.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ****************************************************************************/
+
+#ifndef __CC_FRAME_PROFILER_H__
+#define __CC_FRAME_PROFILER_H__
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/ccConfig.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief Hierarchical profiler of the frames.
+
+ The code to measure is put in zones with CC_PROFILE_ZONE, which measures the time until the end of the scope.
+ The zones are registered once, the first time they run, and then only write their begin and end
+ to a ring buffer of their thread: no lookup and no lock.
+
+ Nothing is recorded until a capture is requested with captureFrames(), then the frames are recorded
+ and written to a file in the Chrome trace format, which can be opened with chrome://tracing.
+ A zone that runs while nothing is recorded only reads an atomic flag.
+
+ To use it, set CC_ENABLE_FRAME_PROFILER to 1 in ccConfig.h, the zones are removed otherwise.
+ */
+class CC_DLL FrameProfiler
+{
+public:
+    /** A zone in the code, registered the first time the zone runs */
+    class CC_DLL Site
+    {
+    public:
+        Site(const char* name, const char* file, int line);
+        
+        const char* name;
+        const char* file;
+        int line;
+        uint32_t id;
+    };
+    
+    /** Records the time between its construction and its destruction */
+    class Zone
+    {
+    public:
+        explicit Zone(const Site& site)
+        : _site(nullptr)
+        {
+            if (s_recording.load(std::memory_order_relaxed))
+            {
+                _site = &site;
+                record(site.id, true);
+            }
+        }
+        
+        ~Zone()
+        {
+            if (_site)
+            {
+                record(_site->id, false);
+            }
+        }
+        
+    private:
+        Zone(const Zone&);
+        Zone& operator=(const Zone&);
+        
+        const Site* _site;
+    };
+    
+    /** Returns the shared profiler
+     * @js NA
+     * @lua NA
+     */
+    static FrameProfiler* getInstance();
+    
+    /** Records the next frames and writes them to a file once they are recorded. Can be called from any thread.
+     @param frameCount the number of frames to record
+     @param filename the file, relative to the writable path, see FileUtils::getWritablePath
+     */
+    void captureFrames(int frameCount, const std::string& filename);
+    
+    /** Whether or not frames are being recorded or are waiting to be recorded */
+    bool isCapturing() const { return _requestedFrames.load() > 0; }
+    
+    /** Starts a frame. Called by the Director on the main thread */
+    void beginFrame();
+    
+    /** Ends a frame, and writes the capture when it's the last frame. Called by the Director on the main thread */
+    void endFrame();
+    
+    /** Names the thread that calls it in the captures */
+    static void setThreadName(const char* name);
+    
+    /** The ring buffer of the events of a thread, only written by its thread */
+    struct ThreadBuffer;
+    
+protected:
+    struct Event
+    {
+        int64_t time;   ///< nanoseconds
+        uint32_t site;
+        uint32_t begin;
+    };
+    
+    FrameProfiler();
+    
+    static void record(uint32_t site, bool begin);
+    static ThreadBuffer* getThreadBuffer();
+    
+    /** Moves the events of the threads to _events, or throws them away */
+    void drainThreadBuffers(bool keep);
+    bool writeTrace(const std::string& fullPath);
+    
+    static std::atomic<bool> s_recording;
+    
+    std::mutex _mutex;
+    std::vector<const Site*> _sites;
+    std::vector<ThreadBuffer*> _threads;
+    
+    std::atomic<int> _requestedFrames;
+    int _recordedFrames;
+    std::string _filename;
+    
+    /** The events of the capture, with the index of their thread */
+    std::vector<std::pair<uint32_t, Event>> _events;
+};
+
+#if CC_ENABLE_FRAME_PROFILER
+#define CC_PROFILE_CONCAT_(__a__, __b__) __a__##__b__
+#define CC_PROFILE_CONCAT(__a__, __b__) CC_PROFILE_CONCAT_(__a__, __b__)
+
+/** Measures the time until the end of the scope. The name must be a string literal */
+#define CC_PROFILE_ZONE(__name__) \
+    static const NS_CC::FrameProfiler::Site CC_PROFILE_CONCAT(__ccProfileSite, __LINE__)(__name__, __FILE__, __LINE__); \
+    NS_CC::FrameProfiler::Zone CC_PROFILE_CONCAT(__ccProfileZone, __LINE__)(CC_PROFILE_CONCAT(__ccProfileSite, __LINE__))
+#define CC_PROFILE_BEGIN_FRAME() NS_CC::FrameProfiler::getInstance()->beginFrame()
+#define CC_PROFILE_END_FRAME() NS_CC::FrameProfiler::getInstance()->endFrame()
+#define CC_PROFILE_THREAD_NAME(__name__) NS_CC::FrameProfiler::setThreadName(__name__)
+#else
+#define CC_PROFILE_ZONE(__name__) do {} while (0)
+#define CC_PROFILE_BEGIN_FRAME() do {} while (0)
+#define CC_PROFILE_END_FRAME() do {} while (0)
+#define CC_PROFILE_THREAD_NAME(__name__) do {} while (0)
+#endif
+
+// end of global group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_FRAME_PROFILER_H__
@@ -0,0 +1,491 @@
+/****************************************************************************
+Copyright (c) 2013-2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/CCJobSystem.h"
+
+#include <algorithm>
+
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+#include "base/CCFrameProfiler.h"
+
+NS_CC_BEGIN
+
+class JobSystem::Job
+{
+public:
+    Job(const JobFunction& function, const JobFunction& callback, Priority priority)
+    : _function(function)
+    , _callback(callback)
+    , _priority(priority)
+    , _pendingDependencies(1)
+    , _finished(false)
+    {
+    }
+
+    JobFunction _function;
+    JobFunction _callback;
+    Priority _priority;
+
+    // dependencies not finished yet, plus one released once the job is scheduled
+    std::atomic<int> _pendingDependencies;
+    std::atomic<bool> _finished;
+
+    // jobs waiting for this one
+    std::mutex _mutex;
+    std::vector<JobHandle> _continuations;
+};
+
+JobSystem* JobSystem::s_jobSystem = nullptr;
+
+// the worker running on the current thread, set once by the worker itself
+static thread_local JobSystem* s_currentJobSystem = nullptr;
+static thread_local int s_currentWorkerIndex = -1;
+
+JobSystem* JobSystem::getInstance()
+{
+    if (s_jobSystem == nullptr)
+    {
+        s_jobSystem = new (std::nothrow) JobSystem();
+    }
+    return s_jobSystem;
+}
+
+void JobSystem::destroyInstance()
+{
+    delete s_jobSystem;
+    s_jobSystem = nullptr;
+}
+
+JobSystem::JobSystem()
+: _queuedJobs(0)
+, _nextWorker(0)
+, _stop(false)
+, _pushCount(0)
+, _scheduler(Director::getInstance()->getScheduler())
+{
+    CC_SAFE_RETAIN(_scheduler);
+    std::lock_guard<std::mutex> lock(_workersMutex);
+    startWorkers(0);
+}
+
+JobSystem::~JobSystem()
+{
+    stopWorkers();
+    std::vector<JobHandle> jobs;
+    {
+        // the jobs pushed from now on are cancelled, see push()
+        std::lock_guard<std::mutex> lock(_workersMutex);
+        jobs = removeWorkers();
+    }
+    for (const auto& job : jobs)
+    {
+        cancel(job);
+    }
+    CC_SAFE_RELEASE(_scheduler);
+}
+
+void JobSystem::setWorkerCount(int count)
+{
+    stopWorkers();
+
+    // the other threads don't push or pop while the workers are replaced
+    std::lock_guard<std::mutex> lock(_workersMutex);
+    auto jobs = removeWorkers();
+    startWorkers(count);
+    for (const auto& job : jobs)
+    {
+        pushToWorker(job, static_cast<int>(_nextWorker++ % _workers.size()));
+    }
+}
+
+int JobSystem::getWorkerCount() const
+{
+    std::lock_guard<std::mutex> lock(_workersMutex);
+    return static_cast<int>(_workers.size());
+}
+
+void JobSystem::startWorkers(int count)
+{
+    if (count <= 0)
+    {
+        count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    }
+
+    _stop = false;
+    for (int i = 0; i < count; ++i)
+    {
+        _workers.push_back(new (std::nothrow) Worker());
+    }
+    // the workers are started once all of them exist, they steal from each other
+    for (int i = 0; i < count; ++i)
+    {
+        _workers[i]->thread = std::thread(&JobSystem::workerLoop, this, i);
+    }
+}
+
+void JobSystem::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _stop = true;
+    }
+    _wakeCondition.notify_all();
+
+    // the workers still pop until they see _stop, the vector isn't changed before they are joined
+    std::vector<std::thread*> threads;
+    {
+        std::lock_guard<std::mutex> lock(_workersMutex);
+        for (auto worker : _workers)
+        {
+            threads.push_back(&worker->thread);
+        }
+    }
+    for (auto thread : threads)
+    {
+        thread->join();
+    }
+}
+
+std::vector<JobSystem::JobHandle> JobSystem::removeWorkers()
+{
+    std::vector<JobHandle> jobs;
+    for (auto worker : _workers)
+    {
+        for (auto& queue : worker->jobs)
+        {
+            jobs.insert(jobs.end(), queue.begin(), queue.end());
+        }
+        delete worker;
+    }
+    _workers.clear();
+    _queuedJobs = 0;
+    return jobs;
+}
+
+int JobSystem::getCurrentWorkerIndex() const
+{
+    return s_currentJobSystem == this ? s_currentWorkerIndex : -1;
+}
+
+void JobSystem::workerLoop(int index)
+{
+    CC_PROFILE_THREAD_NAME("JobSystem worker");
+    s_currentJobSystem = this;
+    s_currentWorkerIndex = index;
+    
+    // the jobs left when the workers stop are given back to setWorkerCount, or cancelled
+    while (!_stop)
+    {
+        auto job = pop(index, static_cast<int>(Priority::COUNT) - 1);
+        if (job)
+        {
+            run(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _wakeCondition.wait(lock, [this]{ return _stop || _queuedJobs > 0; });
+    }
+    s_currentJobSystem = nullptr;
+    s_currentWorkerIndex = -1;
+}
+
+JobSystem::JobHandle JobSystem::schedule(const JobFunction& job, Priority priority, const std::vector<JobHandle>& dependencies)
+{
+    return schedule(job, nullptr, priority, dependencies);
+}
+
+JobSystem::JobHandle JobSystem::schedule(const JobFunction& job, const JobFunction& mainThreadCallback, Priority priority, const std::vector<JobHandle>& dependencies)
+{
+    auto handle = std::make_shared<Job>(job, mainThreadCallback, priority);
+
+    for (const auto& dependency : dependencies)
+    {
+        if (!dependency)
+            continue;
+
+        std::lock_guard<std::mutex> lock(dependency->_mutex);
+        if (!dependency->_finished)
+        {
+            ++handle->_pendingDependencies;
+            dependency->_continuations.push_back(handle);
+        }
+    }
+
+    jobReady(handle);
+    return handle;
+}
+
+JobSystem::JobHandle JobSystem::then(const JobHandle& job, const JobFunction& continuation, Priority priority)
+{
+    return schedule(continuation, priority, std::vector<JobHandle>(1, job));
+}
+
+bool JobSystem::isFinished(const JobHandle& job) const
+{
+    return !job || job->_finished;
+}
+
+void JobSystem::wait(const JobHandle& job)
+{
+    if (isFinished(job))
+        return;
+
+    // Only help with the jobs as urgent as this one: a long background job would block the calling thread
+    int workerIndex = getCurrentWorkerIndex();
+    int lowestPriority = (workerIndex < 0) ? static_cast<int>(job->_priority) : static_cast<int>(Priority::COUNT) - 1;
+    while (!isFinished(job))
+    {
+        unsigned int pushCount = _pushCount;
+        auto other = pop(workerIndex, lowestPriority);
+        if (other)
+        {
+            run(other);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_waitMutex);
+        _waitCondition.wait(lock, [this, &job, pushCount]{ return isFinished(job) || _pushCount != pushCount; });
+    }
+}
+
+void JobSystem::wait(const std::vector<JobHandle>& jobs)
+{
+    for (const auto& job : jobs)
+    {
+        wait(job);
+    }
+}
+
+void JobSystem::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& func)
+{
+    if (count == 0)
+        return;
+
+    grainSize = std::max<size_t>(grainSize, 1);
+    size_t rangeCount = std::min<size_t>((count + grainSize - 1) / grainSize, getWorkerCount() + 1);
+    size_t rangeSize = (count + rangeCount - 1) / rangeCount;
+
+    std::vector<JobHandle> jobs;
+    for (size_t begin = rangeSize; begin < count; begin += rangeSize)
+    {
+        size_t end = std::min(begin + rangeSize, count);
+        jobs.push_back(schedule([&func, begin, end]() { func(begin, end); }, Priority::HIGH));
+    }
+    func(0, std::min(rangeSize, count));
+    wait(jobs);
+}
+
+void JobSystem::jobReady(const JobHandle& job)
+{
+    if (--job->_pendingDependencies == 0)
+    {
+        push(job);
+    }
+}
+
+void JobSystem::push(const JobHandle& job)
+{
+    bool pushed = false;
+    {
+        std::lock_guard<std::mutex> lock(_workersMutex);
+        if (!_workers.empty())
+        {
+            // jobs queued by a worker stay on it, the other ones are spread over the workers
+            int index = getCurrentWorkerIndex();
+            if (index < 0)
+            {
+                index = static_cast<int>(_nextWorker++ % _workers.size());
+            }
+            pushToWorker(job, index);
+            pushed = true;
+        }
+    }
+
+    // the job system is being destroyed, the job won't run
+    if (!pushed)
+    {
+        cancel(job);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+    }
+    _wakeCondition.notify_one();
+
+    {
+        std::lock_guard<std::mutex> lock(_waitMutex);
+        ++_pushCount;
+    }
+    _waitCondition.notify_all();
+}
+
+void JobSystem::pushToWorker(const JobHandle& job, int index)
+{
+    auto worker = _workers[index];
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    worker->jobs[static_cast<int>(job->_priority)].push_back(job);
+    ++_queuedJobs;
+}
+
+JobSystem::JobHandle JobSystem::pop(int workerIndex, int lowestPriority)
+{
+    if (_queuedJobs <= 0)
+        return nullptr;
+
+    std::lock_guard<std::mutex> workersLock(_workersMutex);
+    const int workerCount = static_cast<int>(_workers.size());
+    for (int priority = 0; priority <= lowestPriority; ++priority)
+    {
+        // own jobs first, newest first since their data is hot in the cache
+        if (workerIndex >= 0)
+        {
+            auto worker = _workers[workerIndex];
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            auto& queue = worker->jobs[priority];
+            if (!queue.empty())
+            {
+                auto job = queue.back();
+                queue.pop_back();
+                --_queuedJobs;
+                return job;
+            }
+        }
+
+        // then steal the oldest jobs of the other workers
+        for (int i = 1; i <= workerCount; ++i)
+        {
+            int victimIndex = (workerIndex + i + workerCount) % workerCount;
+            if (victimIndex == workerIndex)
+                continue;
+
+            auto victim = _workers[victimIndex];
+            std::lock_guard<std::mutex> lock(victim->mutex);
+            auto& queue = victim->jobs[priority];
+            if (!queue.empty())
+            {
+                auto job = queue.front();
+                queue.pop_front();
+                --_queuedJobs;
+                return job;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::run(const JobHandle& job)
+{
+    CC_PROFILE_ZONE("JobSystem::run");
+    
+    if (job->_function)
+    {
+        job->_function();
+    }
+    finish(job);
+}
+
+void JobSystem::finish(const JobHandle& job)
+{
+    std::vector<JobHandle> continuations;
+    {
+        std::lock_guard<std::mutex> lock(job->_mutex);
+        job->_finished = true;
+        continuations.swap(job->_continuations);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_waitMutex);
+    }
+    _waitCondition.notify_all();
+
+    if (job->_callback)
+    {
+        postMainThreadCallback(job->_callback);
+    }
+
+    for (const auto& continuation : continuations)
+    {
+        jobReady(continuation);
+    }
+}
+
+void JobSystem::cancel(const JobHandle& job)
+{
+    // the job doesn't run but is finished, and so are the jobs waiting for it
+    std::vector<JobHandle> continuations;
+    {
+        std::lock_guard<std::mutex> lock(job->_mutex);
+        job->_finished = true;
+        continuations.swap(job->_continuations);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_waitMutex);
+    }
+    _waitCondition.notify_all();
+
+    for (const auto& continuation : continuations)
+    {
+        cancel(continuation);
+    }
+}
+
+void JobSystem::postMainThreadCallback(const JobFunction& callback)
+{
+    bool firstOfBatch = false;
+    {
+        std::lock_guard<std::mutex> lock(_callbackMutex);
+        firstOfBatch = _mainThreadCallbacks.empty();
+        _mainThreadCallbacks.push_back(callback);
+    }
+
+    // one function per batch is enough: it delivers all the callbacks posted until it runs
+    if (firstOfBatch)
+    {
+        _scheduler->performFunctionInCocosThread(&JobSystem::flushMainThreadCallbacks);
+    }
+}
+
+void JobSystem::flushMainThreadCallbacks()
+{
+    // the job system may have been destroyed since the batch was posted
+    if (s_jobSystem == nullptr)
+        return;
+
+    std::vector<JobFunction> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(s_jobSystem->_callbackMutex);
+        callbacks.swap(s_jobSystem->_mainThreadCallbacks);
+    }
+
+    for (const auto& callback : callbacks)
+    {
+        callback();
+    }
+}
+
+NS_CC_END
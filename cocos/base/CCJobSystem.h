@@ -0,0 +1,178 @@
+/****************************************************************************
+Copyright (c) 2013-2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CC_JOB_SYSTEM_H__
+#define __CC_JOB_SYSTEM_H__
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+class Scheduler;
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+/** @brief Work-stealing job system.
+
+ Every worker thread owns one deque per priority. A worker pops its own jobs from the back,
+ and steals from the front of the other workers' deques when it runs out of jobs.
+ Jobs can depend on other jobs: they are queued once all their dependencies are finished.
+ Main thread callbacks of the finished jobs are delivered in batches through the `Scheduler`.
+ */
+class CC_DLL JobSystem
+{
+public:
+    enum class Priority
+    {
+        HIGH,       ///< jobs the main thread is waiting for, e.g. the jobs of a frame
+        NORMAL,
+        LOW,        ///< background jobs, e.g. io or network
+        COUNT,
+    };
+
+    class Job;
+    typedef std::shared_ptr<Job> JobHandle;
+    typedef std::function<void()> JobFunction;
+
+    /** Returns the shared job system, the workers are started the first time. Must be called on the cocos thread the first time */
+    static JobSystem* getInstance();
+
+    /** Stops the workers and destroys the shared job system. Queued jobs are cancelled: they don't run,
+     but they are finished, so waiting for them returns. Must be called on the cocos thread.
+     */
+    static void destroyInstance();
+
+    /** Sets the number of worker threads. 0 means one per core, minus the main thread.
+     Queued jobs are kept and run by the new workers. Must not be called from a job.
+     */
+    void setWorkerCount(int count);
+    /** Returns the number of worker threads */
+    int getWorkerCount() const;
+
+    /** Queues a job. It runs on a worker thread once all its dependencies are finished.
+     @param job the function to run
+     @param priority workers run the jobs of higher priority first
+     @param dependencies jobs that must be finished before this one starts
+     @return a handle to wait for the job or to use it as a dependency
+     */
+    JobHandle schedule(const JobFunction& job, Priority priority = Priority::NORMAL, const std::vector<JobHandle>& dependencies = std::vector<JobHandle>());
+
+    /** Queues a job with a callback. The callback is called on the main thread once the job is finished.
+     The callbacks of the jobs that finish during the same frame are delivered in one batch.
+     */
+    JobHandle schedule(const JobFunction& job, const JobFunction& mainThreadCallback, Priority priority = Priority::NORMAL, const std::vector<JobHandle>& dependencies = std::vector<JobHandle>());
+
+    /** Queues a continuation: a job that runs once `job` is finished */
+    JobHandle then(const JobHandle& job, const JobFunction& continuation, Priority priority = Priority::NORMAL);
+
+    /** Returns whether or not the job is finished */
+    bool isFinished(const JobHandle& job) const;
+
+    /** Waits until the job is finished. The calling thread runs the queued jobs in the meantime: a worker any of them,
+     another thread the ones of the priority of the job or higher, so that it isn't blocked by a long background job.
+     It sleeps when there is nothing to run.
+     */
+    void wait(const JobHandle& job);
+
+    /** Waits until all the jobs are finished */
+    void wait(const std::vector<JobHandle>& jobs);
+
+    /** Calls `func(begin, end)` on ranges of [0, count), in parallel, and waits for all of them.
+     The calling thread processes ranges too.
+     @param grainSize minimum number of elements in a range
+     */
+    void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& func);
+
+CC_CONSTRUCTOR_ACCESS:
+    JobSystem();
+    ~JobSystem();
+
+protected:
+    struct Worker
+    {
+        std::thread thread;
+        std::mutex mutex;
+        std::deque<JobHandle> jobs[static_cast<int>(Priority::COUNT)];
+    };
+
+    // startWorkers() and removeWorkers() are called with _workersMutex locked
+    void startWorkers(int count);
+    void stopWorkers();
+    std::vector<JobHandle> removeWorkers();
+    void workerLoop(int index);
+    int getCurrentWorkerIndex() const;
+
+    void push(const JobHandle& job);
+    void pushToWorker(const JobHandle& job, int index);
+    JobHandle pop(int workerIndex, int lowestPriority);
+    void run(const JobHandle& job);
+    void finish(const JobHandle& job);
+    void jobReady(const JobHandle& job);
+
+    void cancel(const JobHandle& job);
+
+    void postMainThreadCallback(const JobFunction& callback);
+    static void flushMainThreadCallbacks();
+
+    // the workers are replaced by setWorkerCount() while the other threads push and pop
+    mutable std::mutex _workersMutex;
+    std::vector<Worker*> _workers;
+    std::atomic<int> _queuedJobs;
+    std::atomic<unsigned int> _nextWorker;
+    std::atomic<bool> _stop;
+    std::mutex _sleepMutex;
+    std::condition_variable _wakeCondition;
+
+    // the threads waiting for a job sleep until a job finishes or is pushed
+    std::mutex _waitMutex;
+    std::condition_variable _waitCondition;
+    std::atomic<unsigned int> _pushCount;
+
+    // main thread callbacks of the finished jobs
+    std::mutex _callbackMutex;
+    std::vector<JobFunction> _mainThreadCallbacks;
+    // the scheduler of the cocos thread, got when the job system is created since the workers can't use the Director
+    Scheduler* _scheduler;
+
+    static JobSystem* s_jobSystem;
+};
+
+// end of base group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_JOB_SYSTEM_H__
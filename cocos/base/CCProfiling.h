@@ -45,6 +45,7 @@ class ProfilingTimer;
  cocos2d builtin profiler.
 
  To use it, enable set the CC_ENABLE_PROFILERS=1 in the ccConfig.h file
+ For the timeline of the frames, and the zones of the worker threads, use FrameProfiler instead.
  */
 
 class CC_DLL Profiler : public Ref
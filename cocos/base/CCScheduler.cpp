@@ -31,6 +31,9 @@ THE SOFTWARE.
 #include "base/utlist.h"
 #include "base/ccCArray.h"
 #include "base/CCScriptSupport.h"
+#include "base/CCFrameProfiler.h"
+
+#include <chrono>
 
 NS_CC_BEGIN
 
@@ -61,13 +64,32 @@ typedef struct _hashSelectorEntry
 {
     ccArray             *timers;
     void                *target;
-    int                 timerIndex;
-    Timer               *currentTimer;
-    bool                currentTimerSalvaged;
     bool                paused;
     UT_hash_handle      hh;
 } tHashTimerEntry;
 
+// _heapIndex of the timers that are not in the heap
+static const int TIMER_IDLE = -1;
+// _heapIndex of the timers popped from the heap and not updated yet
+static const int TIMER_DUE = -2;
+
+// A timer is popped from the heap slightly before it is due:
+// the float arithmetic of Timer::update must never see it late.
+static const double TIMER_DUE_EPSILON = 0.0001;
+
+// A function posted by performFunctionInCocosThread
+struct Scheduler::PerformNode
+{
+    explicit PerformNode(const std::function<void()>& f)
+    : function(f)
+    , next(nullptr)
+    {
+    }
+
+    std::function<void()> function;
+    PerformNode *next;
+};
+
 // implementation Timer
 
 Timer::Timer()
@@ -79,6 +101,9 @@ Timer::Timer()
 , _repeat(0)
 , _delay(0.0f)
 , _interval(0.0f)
+, _entry(nullptr)
+, _lastUpdateTime(0)
+, _heapIndex(TIMER_IDLE)
 {
 }
 
@@ -146,6 +171,16 @@ void Timer::update(float dt)
 }
 
 
+float Timer::getTimeToTrigger() const
+{
+    // the first update only starts the timer
+    if (_elapsed == -1)
+    {
+        return 0;
+    }
+    return (_useDelay ? _delay : _interval) - _elapsed;
+}
+
 // TimerTargetSelector
 
 TimerTargetSelector::TimerTargetSelector()
@@ -252,20 +287,35 @@ Scheduler::Scheduler(void)
 , _updatesPosList(nullptr)
 , _hashForUpdates(nullptr)
 , _hashForTimers(nullptr)
-, _currentTarget(nullptr)
-, _currentTargetSalvaged(false)
+, _currentTime(0)
 , _updateHashLocked(false)
 #if CC_ENABLE_SCRIPT_BINDING
 , _scriptHandlerEntries(20)
 #endif
+, _functionsToPerform(nullptr)
+, _pendingFunctionsHead(nullptr)
+, _pendingFunctionsTail(nullptr)
+, _performTimeBudget(0)
 {
-    // I don't expect to have more than 30 functions to all per frame
-    _functionsToPerform.reserve(30);
 }
 
 Scheduler::~Scheduler(void)
 {
     unscheduleAll();
+
+    // the functions not performed yet are dropped
+    for (PerformNode *node = _functionsToPerform.exchange(nullptr); node; )
+    {
+        PerformNode *next = node->next;
+        delete node;
+        node = next;
+    }
+    for (PerformNode *node = _pendingFunctionsHead; node; )
+    {
+        PerformNode *next = node->next;
+        delete node;
+        node = next;
+    }
 }
 
 void Scheduler::removeHashElement(_hashSelectorEntry *element)
@@ -317,6 +367,12 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
             {
                 CCLOG("CCScheduler#scheduleSelector. Selector already scheduled. Updating interval from: %.4f to %.4f", timer->getInterval(), interval);
                 timer->setInterval(interval);
+                // the timer is due at another time
+                if (timer->_heapIndex >= 0)
+                {
+                    popTimer(timer);
+                    pushTimer(timer);
+                }
                 return;
             }        
         }
@@ -325,7 +381,7 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
 
     TimerTargetCallback *timer = new (std::nothrow) TimerTargetCallback();
     timer->initWithCallback(this, callback, target, key, interval, repeat, delay);
-    ccArrayAppendObject(element->timers, timer);
+    addTimer(element, timer);
     timer->release();
 }
 
@@ -351,30 +407,13 @@ void Scheduler::unschedule(const std::string &key, void *target)
 
             if (key == timer->getKey())
             {
-                if (timer == element->currentTimer && (! element->currentTimerSalvaged))
-                {
-                    element->currentTimer->retain();
-                    element->currentTimerSalvaged = true;
-                }
-
+                // a timer being updated is retained by _dueTimers
+                removeTimer(timer);
                 ccArrayRemoveObjectAtIndex(element->timers, i, true);
 
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
-
                 if (element->timers->num == 0)
                 {
-                    if (_currentTarget == element)
-                    {
-                        _currentTargetSalvaged = true;
-                    }
-                    else
-                    {
-                        removeHashElement(element);
-                    }
+                    removeHashElement(element);
                 }
 
                 return;
@@ -647,22 +686,12 @@ void Scheduler::unscheduleAllForTarget(void *target)
 
     if (element)
     {
-        if (ccArrayContainsObject(element->timers, element->currentTimer)
-            && (! element->currentTimerSalvaged))
+        for (int i = 0; i < element->timers->num; ++i)
         {
-            element->currentTimer->retain();
-            element->currentTimerSalvaged = true;
+            removeTimer(static_cast<Timer*>(element->timers->arr[i]));
         }
         ccArrayRemoveAllObjects(element->timers);
-
-        if (_currentTarget == element)
-        {
-            _currentTargetSalvaged = true;
-        }
-        else
-        {
-            removeHashElement(element);
-        }
+        removeHashElement(element);
     }
 
     // update selector
@@ -701,7 +730,7 @@ void Scheduler::resumeTarget(void *target)
     HASH_FIND_PTR(_hashForTimers, &target, element);
     if (element)
     {
-        element->paused = false;
+        resumeTimers(element);
     }
 
     // update selector
@@ -723,7 +752,7 @@ void Scheduler::pauseTarget(void *target)
     HASH_FIND_PTR(_hashForTimers, &target, element);
     if (element)
     {
-        element->paused = true;
+        pauseTimers(element);
     }
 
     // update selector
@@ -772,7 +801,7 @@ std::set<void*> Scheduler::pauseAllTargetsWithMinPriority(int minPriority)
     for(tHashTimerEntry *element = _hashForTimers; element != nullptr;
         element = (tHashTimerEntry*)element->hh.next)
     {
-        element->paused = true;
+        pauseTimers(element);
         idsWithSelectors.insert(element->target);
     }
 
@@ -818,18 +847,261 @@ void Scheduler::resumeTargets(const std::set<void*>& targetsToResume)
     }
 }
 
+void Scheduler::addTimer(tHashTimerEntry *element, Timer *timer)
+{
+    timer->_entry = element;
+    ccArrayAppendObject(element->timers, timer);
+
+    if (!element->paused)
+    {
+        // the first update of a timer starts it. It is done now for the timers scheduled by a timer callback,
+        // the other ones are started by the next pass over the due timers.
+        if (!_dueTimers.empty())
+        {
+            timer->_lastUpdateTime = _currentTime;
+            timer->update(0);
+        }
+        pushTimer(timer);
+    }
+}
+
+void Scheduler::removeTimer(Timer *timer)
+{
+    if (timer->_heapIndex >= 0)
+    {
+        popTimer(timer);
+    }
+    // a due timer is skipped by updateTimers
+    timer->_heapIndex = TIMER_IDLE;
+}
+
+void Scheduler::pauseTimers(tHashTimerEntry *element)
+{
+    if (element->paused)
+        return;
+
+    element->paused = true;
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        Timer *timer = static_cast<Timer*>(element->timers->arr[i]);
+        if (timer->_heapIndex >= 0)
+        {
+            popTimer(timer);
+            timer->_heapIndex = TIMER_IDLE;
+
+            // the elapsed time of a paused timer doesn't change
+            if (timer->_elapsed != -1)
+            {
+                timer->_elapsed += static_cast<float>(_currentTime - timer->_lastUpdateTime);
+            }
+            timer->_lastUpdateTime = _currentTime;
+        }
+    }
+}
+
+void Scheduler::resumeTimers(tHashTimerEntry *element)
+{
+    if (!element->paused)
+        return;
+
+    element->paused = false;
+    for (int i = 0; i < element->timers->num; ++i)
+    {
+        Timer *timer = static_cast<Timer*>(element->timers->arr[i]);
+        // the due timers are still updated in this frame
+        if (timer->_heapIndex == TIMER_IDLE)
+        {
+            timer->_lastUpdateTime = _currentTime;
+            pushTimer(timer);
+        }
+    }
+}
+
+void Scheduler::updateTimers()
+{
+    // pop all the due timers before updating any: a timer triggers once per frame at most,
+    // and the timers scheduled by a callback are not updated before the next frame
+    while (!_timerHeap.empty() && _timerHeap[0].time <= _currentTime)
+    {
+        Timer *timer = _timerHeap[0].timer;
+        popTimer(timer);
+        timer->_heapIndex = TIMER_DUE;
+        // a callback may unschedule the timer
+        timer->retain();
+        _dueTimers.push_back(timer);
+    }
+
+    for (size_t i = 0; i < _dueTimers.size(); ++i)
+    {
+        Timer *timer = _dueTimers[i];
+        if (timer->_heapIndex == TIMER_DUE)
+        {
+            float dt = static_cast<float>(_currentTime - timer->_lastUpdateTime);
+            timer->_lastUpdateTime = _currentTime;
+
+            // paused by a callback of this frame
+            if (timer->_entry->paused)
+            {
+                if (timer->_elapsed != -1)
+                {
+                    timer->_elapsed += dt;
+                }
+                timer->_heapIndex = TIMER_IDLE;
+            }
+            else
+            {
+                timer->update(dt);
+
+                // still scheduled: the timer has a new due time
+                if (timer->_heapIndex == TIMER_DUE)
+                {
+                    timer->_heapIndex = TIMER_IDLE;
+                    if (!timer->_entry->paused)
+                    {
+                        pushTimer(timer);
+                    }
+                }
+            }
+        }
+        timer->release();
+    }
+    _dueTimers.clear();
+}
+
+void Scheduler::pushTimer(Timer *timer)
+{
+    TimerHeapNode node;
+    node.time = timer->_lastUpdateTime + timer->getTimeToTrigger() - TIMER_DUE_EPSILON;
+    node.timer = timer;
+
+    timer->_heapIndex = static_cast<int>(_timerHeap.size());
+    _timerHeap.push_back(node);
+    siftTimerUp(timer->_heapIndex);
+}
+
+void Scheduler::popTimer(Timer *timer)
+{
+    int index = timer->_heapIndex;
+    int last = static_cast<int>(_timerHeap.size()) - 1;
+    if (index != last)
+    {
+        Timer *moved = _timerHeap[last].timer;
+        _timerHeap[index] = _timerHeap[last];
+        _timerHeap.pop_back();
+        siftTimerUp(index);
+        siftTimerDown(moved->_heapIndex);
+    }
+    else
+    {
+        _timerHeap.pop_back();
+    }
+    timer->_heapIndex = TIMER_IDLE;
+}
+
+void Scheduler::siftTimerUp(int index)
+{
+    TimerHeapNode node = _timerHeap[index];
+    while (index > 0)
+    {
+        int parent = (index - 1) / 2;
+        if (_timerHeap[parent].time <= node.time)
+            break;
+
+        _timerHeap[index] = _timerHeap[parent];
+        _timerHeap[index].timer->_heapIndex = index;
+        index = parent;
+    }
+    _timerHeap[index] = node;
+    node.timer->_heapIndex = index;
+}
+
+void Scheduler::siftTimerDown(int index)
+{
+    const int count = static_cast<int>(_timerHeap.size());
+    TimerHeapNode node = _timerHeap[index];
+    for (;;)
+    {
+        int child = index * 2 + 1;
+        if (child >= count)
+            break;
+        if (child + 1 < count && _timerHeap[child + 1].time < _timerHeap[child].time)
+            ++child;
+        if (node.time <= _timerHeap[child].time)
+            break;
+
+        _timerHeap[index] = _timerHeap[child];
+        _timerHeap[index].timer->_heapIndex = index;
+        index = child;
+    }
+    _timerHeap[index] = node;
+    node.timer->_heapIndex = index;
+}
+
 void Scheduler::performFunctionInCocosThread(const std::function<void ()> &function)
 {
-    _performMutex.lock();
+    PerformNode *node = new (std::nothrow) PerformNode(function);
+    if (node == nullptr)
+    {
+        CCLOG("cocos2d: Scheduler: can not post a function to the cocos thread, out of memory");
+        return;
+    }
+
+    node->next = _functionsToPerform.load(std::memory_order_relaxed);
+    while (!_functionsToPerform.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+}
+
+void Scheduler::performFunctions()
+{
+    // Take all the functions posted since the last update, the stack is newest first: reverse it.
+    // The functions are called outside of any lock, they can post new functions (fixed #4123).
+    PerformNode *posted = _functionsToPerform.exchange(nullptr, std::memory_order_acquire);
+    if (posted)
+    {
+        PerformNode *batchHead = nullptr;
+        PerformNode *batchTail = posted;
+        while (posted)
+        {
+            PerformNode *next = posted->next;
+            posted->next = batchHead;
+            batchHead = posted;
+            posted = next;
+        }
 
-    _functionsToPerform.push_back(function);
+        if (_pendingFunctionsTail)
+            _pendingFunctionsTail->next = batchHead;
+        else
+            _pendingFunctionsHead = batchHead;
+        _pendingFunctionsTail = batchTail;
+    }
+
+    if (_pendingFunctionsHead == nullptr)
+        return;
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(_performTimeBudget));
+    while (_pendingFunctionsHead)
+    {
+        PerformNode *node = _pendingFunctionsHead;
+        _pendingFunctionsHead = node->next;
+        if (_pendingFunctionsHead == nullptr)
+        {
+            _pendingFunctionsTail = nullptr;
+        }
+
+        node->function();
+        delete node;
 
-    _performMutex.unlock();
+        if (_performTimeBudget > 0 && std::chrono::steady_clock::now() >= deadline)
+            break;
+    }
 }
 
 // main loop
 void Scheduler::update(float dt)
 {
+    CC_PROFILE_ZONE("Scheduler::update");
+    
     _updateHashLocked = true;
 
     if (_timeScale != 1.0f)
@@ -837,6 +1109,8 @@ void Scheduler::update(float dt)
         dt *= _timeScale;
     }
 
+    _currentTime += dt;
+
     //
     // Selector callbacks
     //
@@ -871,44 +1145,8 @@ void Scheduler::update(float dt)
         }
     }
 
-    // Iterate over all the custom selectors
-    for (tHashTimerEntry *elt = _hashForTimers; elt != nullptr; )
-    {
-        _currentTarget = elt;
-        _currentTargetSalvaged = false;
-
-        if (! _currentTarget->paused)
-        {
-            // The 'timers' array may change while inside this loop
-            for (elt->timerIndex = 0; elt->timerIndex < elt->timers->num; ++(elt->timerIndex))
-            {
-                elt->currentTimer = (Timer*)(elt->timers->arr[elt->timerIndex]);
-                elt->currentTimerSalvaged = false;
-
-                elt->currentTimer->update(dt);
-
-                if (elt->currentTimerSalvaged)
-                {
-                    // The currentTimer told the remove itself. To prevent the timer from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    elt->currentTimer->release();
-                }
-
-                elt->currentTimer = nullptr;
-            }
-        }
-
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashTimerEntry *)elt->hh.next;
-
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->timers->num == 0)
-        {
-            removeHashElement(_currentTarget);
-        }
-    }
+    // Update the custom selectors that are due
+    updateTimers();
 
     // delete all updates that are marked for deletion
     // updates with priority < 0
@@ -939,7 +1177,6 @@ void Scheduler::update(float dt)
     }
 
     _updateHashLocked = false;
-    _currentTarget = nullptr;
 
 #if CC_ENABLE_SCRIPT_BINDING
     //
@@ -967,18 +1204,11 @@ void Scheduler::update(float dt)
     // Functions allocated from another thread
     //
 
-    // Testing size is faster than locking / unlocking.
+    // Testing the stack is faster than taking it.
     // And almost never there will be functions scheduled to be called.
-    if( !_functionsToPerform.empty() ) {
-        _performMutex.lock();
-        // fixed #4123: Save the callback functions, they must be invoked after '_performMutex.unlock()', otherwise if new functions are added in callback, it will cause thread deadlock.
-        auto temp = _functionsToPerform;
-        _functionsToPerform.clear();
-        _performMutex.unlock();
-        for( const auto &function : temp ) {
-            function();
-        }
-        
+    if (_pendingFunctionsHead || _functionsToPerform.load(std::memory_order_relaxed))
+    {
+        performFunctions();
     }
 }
 
@@ -1018,6 +1248,12 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
             {
                 CCLOG("CCScheduler#scheduleSelector. Selector already scheduled. Updating interval from: %.4f to %.4f", timer->getInterval(), interval);
                 timer->setInterval(interval);
+                // the timer is due at another time
+                if (timer->_heapIndex >= 0)
+                {
+                    popTimer(timer);
+                    pushTimer(timer);
+                }
                 return;
             }
         }
@@ -1026,7 +1262,7 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
     
     TimerTargetSelector *timer = new (std::nothrow) TimerTargetSelector();
     timer->initWithSelector(this, selector, target, interval, repeat, delay);
-    ccArrayAppendObject(element->timers, timer);
+    addTimer(element, timer);
     timer->release();
 }
 
@@ -1092,30 +1328,13 @@ void Scheduler::unschedule(SEL_SCHEDULE selector, Ref *target)
             
             if (selector == timer->getSelector())
             {
-                if (timer == element->currentTimer && (! element->currentTimerSalvaged))
-                {
-                    element->currentTimer->retain();
-                    element->currentTimerSalvaged = true;
-                }
-                
+                // a timer being updated is retained by _dueTimers
+                removeTimer(timer);
                 ccArrayRemoveObjectAtIndex(element->timers, i, true);
                 
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
-                
                 if (element->timers->num == 0)
                 {
-                    if (_currentTarget == element)
-                    {
-                        _currentTargetSalvaged = true;
-                    }
-                    else
-                    {
-                        removeHashElement(element);
-                    }
+                    removeHashElement(element);
                 }
                 
                 return;
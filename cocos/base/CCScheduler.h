@@ -28,6 +28,7 @@ THE SOFTWARE.
 #ifndef __CCSCHEDULER_H__
 #define __CCSCHEDULER_H__
 
+#include <atomic>
 #include <functional>
 #include <mutex>
 #include <set>
@@ -44,6 +45,7 @@ NS_CC_BEGIN
  */
 
 class Scheduler;
+struct _hashSelectorEntry;
 
 typedef std::function<void(float)> ccSchedulerFunc;
 //
@@ -79,6 +81,14 @@ protected:
     unsigned int _repeat; //0 = once, 1 is 2 x executed
     float _delay;
     float _interval;
+
+    // bookkeeping of the scheduler, which only updates the timers that are due
+    friend class Scheduler;
+    /** the time until the timer triggers, from its last update */
+    float getTimeToTrigger() const;
+    struct _hashSelectorEntry* _entry;
+    double _lastUpdateTime;
+    int _heapIndex;
 };
 
 
@@ -146,7 +156,6 @@ private:
 // Scheduler
 //
 struct _listEntry;
-struct _hashSelectorEntry;
 struct _hashUpdateEntry;
 
 #if CC_ENABLE_SCRIPT_BINDING
@@ -163,6 +172,9 @@ There are 2 different types of callbacks (selectors):
 
 The 'custom selectors' should be avoided when possible. It is faster, and consumes less memory to use the 'update selector'.
 
+The timers of the custom selectors are kept in a min-heap ordered by the time they are due:
+a frame only updates the timers that trigger during it, whatever the number of scheduled timers.
+
 */
 class CC_DLL Scheduler : public Ref
 {
@@ -359,10 +371,18 @@ public:
     void resumeTargets(const std::set<void*>& targetsToResume);
 
     /** calls a function on the cocos2d thread. Useful when you need to call a cocos2d function from another thread.
-     This function is thread safe.
+     This function is thread safe and lock free. The functions are called in the order they were posted.
      @since v3.0
      */
     void performFunctionInCocosThread( const std::function<void()> &function);
+
+    /** Sets the time that each update may spend calling the functions posted by performFunctionInCocosThread.
+     The functions left are called by the next updates, so a burst of functions is spread over several frames.
+     At least one function is called per update.
+     @param seconds The time budget, 0 (the default) calls all the posted functions in every update.
+     */
+    void setPerformFunctionsTimeBudget(float seconds) { _performTimeBudget = seconds; }
+    float getPerformFunctionsTimeBudget() const { return _performTimeBudget; }
     
     /////////////////////////////////////
     
@@ -431,6 +451,20 @@ protected:
     void removeHashElement(struct _hashSelectorEntry *element);
     void removeUpdateFromHash(struct _listEntry *entry);
 
+    // timers specific
+
+    void addTimer(struct _hashSelectorEntry *element, Timer *timer);
+    void removeTimer(Timer *timer);
+    void pauseTimers(struct _hashSelectorEntry *element);
+    void resumeTimers(struct _hashSelectorEntry *element);
+    void updateTimers();
+    void pushTimer(Timer *timer);
+    void popTimer(Timer *timer);
+    void siftTimerUp(int index);
+    void siftTimerDown(int index);
+
+    void performFunctions();
+
     // update specific
 
     void priorityIn(struct _listEntry **list, const ccSchedulerFunc& callback, void *target, int priority, bool paused);
@@ -449,8 +483,18 @@ protected:
 
     // Used for "selectors with interval"
     struct _hashSelectorEntry *_hashForTimers;
-    struct _hashSelectorEntry *_currentTarget;
-    bool _currentTargetSalvaged;
+
+    // the timers of the targets that are not paused, min-heap on the time they are due
+    struct TimerHeapNode
+    {
+        double time;
+        Timer *timer;
+    };
+    std::vector<TimerHeapNode> _timerHeap;
+    // the timers due in the current frame, retained while they are updated
+    std::vector<Timer*> _dueTimers;
+    // the time of the scheduler, the sum of the scaled delta times
+    double _currentTime;
     // If true unschedule will not remove anything from a hash. Elements will only be marked for deletion.
     bool _updateHashLocked;
     
@@ -458,9 +502,13 @@ protected:
     Vector<SchedulerScriptHandlerEntry*> _scriptHandlerEntries;
 #endif
     
-    // Used for "perform Function"
-    std::vector<std::function<void()>> _functionsToPerform;
-    std::mutex _performMutex;
+    // Used for "perform Function": a lock free stack the other threads push to, newest first.
+    // The cocos2d thread takes all of it at once and queues it, oldest first, after the functions left by the time budget.
+    struct PerformNode;
+    std::atomic<PerformNode*> _functionsToPerform;
+    PerformNode *_pendingFunctionsHead;
+    PerformNode *_pendingFunctionsTail;
+    float _performTimeBudget;
 };
 
 // end of global group
@@ -0,0 +1,198 @@
+/****************************************************************************
+ Copyright (c) 2013-2014 Chukong Technologies Inc.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/CCTouchHitTestGrid.h"
+#include "base/CCEventListenerTouch.h"
+#include "base/CCDirector.h"
+#include "2d/CCNode.h"
+#include "math/CCAffineTransform.h"
+
+#include <algorithm>
+
+NS_CC_BEGIN
+
+TouchHitTestGrid::TouchHitTestGrid()
+: _cellSize(1, 1)
+, _count(0)
+, _stamp(0)
+{
+}
+
+bool TouchHitTestGrid::updateBounds(EventListenerTouchOneByOne* listener)
+{
+    Node* node = listener->getAssociatedNode();
+    if (listener->_hitTestNode == node && listener->_hitTestVersion == node->getTransformVersion())
+        return false;
+    
+    const Size& size = node->getContentSize();
+    listener->_hitTestBounds = RectApplyTransform(Rect(0, 0, size.width, size.height), node->getNodeToWorldTransform());
+    listener->_hitTestNode = node;
+    listener->_hitTestVersion = node->getTransformVersion();
+    return true;
+}
+
+void TouchHitTestGrid::getCells(const Rect& bounds, int cells[4]) const
+{
+    float x[2] = { bounds.getMinX(), bounds.getMaxX() };
+    float y[2] = { bounds.getMinY(), bounds.getMaxY() };
+    for (int i = 0; i < 2; ++i)
+    {
+        cells[i] = clampf(floorf((x[i] - _visibleRect.origin.x) / _cellSize.x), 0, GRID_SIZE - 1);
+        cells[i + 2] = clampf(floorf((y[i] - _visibleRect.origin.y) / _cellSize.y), 0, GRID_SIZE - 1);
+    }
+}
+
+void TouchHitTestGrid::update(const std::vector<EventListener*>& listeners)
+{
+    auto director = Director::getInstance();
+    Vec2 origin = director->getVisibleOrigin();
+    Size size = director->getVisibleSize();
+    Rect visibleRect(origin.x, origin.y, size.width, size.height);
+    
+    bool dirty = !visibleRect.equals(_visibleRect);
+    size_t count = 0;
+    for (auto& l : listeners)
+    {
+        auto listener = static_cast<EventListenerTouchOneByOne*>(l);
+        if (!listener->_hitTestEnabled || !listener->getAssociatedNode())
+            continue;
+        
+        ++count;
+        if (dirty)
+            continue;
+        
+        if (listener->_hitTestNode != listener->getAssociatedNode())
+        {
+            // added since the last update
+            dirty = true;
+            continue;
+        }
+        
+        int oldCells[4];
+        getCells(listener->_hitTestBounds, oldCells);
+        if (updateBounds(listener))
+        {
+            int newCells[4];
+            getCells(listener->_hitTestBounds, newCells);
+            dirty = !std::equal(oldCells, oldCells + 4, newCells);
+        }
+    }
+    
+    if (dirty || count != _count)
+    {
+        rebuild(listeners, visibleRect);
+        _count = count;
+    }
+}
+
+void TouchHitTestGrid::rebuild(const std::vector<EventListener*>& listeners, const Rect& visibleRect)
+{
+    _visibleRect = visibleRect;
+    _cellSize.x = std::max(visibleRect.size.width / GRID_SIZE, 1.0f);
+    _cellSize.y = std::max(visibleRect.size.height / GRID_SIZE, 1.0f);
+    
+    _cells.resize(GRID_SIZE * GRID_SIZE);
+    for (auto& cell : _cells)
+    {
+        cell.clear();
+    }
+    
+    for (auto& l : listeners)
+    {
+        auto listener = static_cast<EventListenerTouchOneByOne*>(l);
+        if (!listener->_hitTestEnabled || !listener->getAssociatedNode())
+            continue;
+        
+        updateBounds(listener);
+        
+        int cells[4];
+        getCells(listener->_hitTestBounds, cells);
+        for (int y = cells[2]; y <= cells[3]; ++y)
+        {
+            for (int x = cells[0]; x <= cells[1]; ++x)
+            {
+                _cells[y * GRID_SIZE + x].push_back(listener);
+            }
+        }
+    }
+}
+
+void TouchHitTestGrid::remove(EventListenerTouchOneByOne* listener)
+{
+    if (listener->_hitTestNode && !_cells.empty())
+    {
+        // the cells of a listener are the ones of its bounds, the grid is rebuilt when they change
+        int cells[4];
+        getCells(listener->_hitTestBounds, cells);
+        for (int y = cells[2]; y <= cells[3]; ++y)
+        {
+            for (int x = cells[0]; x <= cells[1]; ++x)
+            {
+                auto& cell = _cells[y * GRID_SIZE + x];
+                cell.erase(std::remove(cell.begin(), cell.end(), listener), cell.end());
+            }
+        }
+    }
+    listener->_hitTestNode = nullptr;
+}
+
+void TouchHitTestGrid::clear()
+{
+    _cells.clear();
+    _count = 0;
+}
+
+unsigned int TouchHitTestGrid::query(const Vec2& location)
+{
+    // 0 is the stamp of the listeners that were never found
+    if (++_stamp == 0)
+        ++_stamp;
+    
+    if (_cells.empty())
+        return _stamp;
+    
+    int cells[4];
+    getCells(Rect(location.x, location.y, 0, 0), cells);
+    for (auto& listener : _cells[cells[2] * GRID_SIZE + cells[0]])
+    {
+        // the listeners whose hit test was disabled since the update have no node
+        if (!listener->_hitTestNode || !listener->_hitTestBounds.containsPoint(location))
+            continue;
+        
+        bool visible = true;
+        for (Node* node = listener->_hitTestNode; node && visible; node = node->getParent())
+        {
+            visible = node->isVisible();
+        }
+        
+        if (visible)
+        {
+            listener->_hitTestStamp = _stamp;
+        }
+    }
+    return _stamp;
+}
+
+NS_CC_END
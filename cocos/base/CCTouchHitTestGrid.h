@@ -0,0 +1,86 @@
+/****************************************************************************
+ Copyright (c) 2013-2014 Chukong Technologies Inc.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ 
+ ****************************************************************************/
+
+#ifndef __cocos2d_libs__CCTouchHitTestGrid__
+#define __cocos2d_libs__CCTouchHitTestGrid__
+
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+#include "math/CCGeometry.h"
+
+NS_CC_BEGIN
+
+class EventListener;
+class EventListenerTouchOneByOne;
+
+/** Grid of the bounding boxes, in world space, of the nodes of the touch listeners that only want the touches
+ that begin inside their node. Used by EventDispatcher to find the listeners under a touch without calling all of them.
+ The grid covers the visible area, the nodes outside of it are kept in the cells of its borders.
+ @see EventListenerTouchOneByOne::setHitTestEnabled
+ */
+class TouchHitTestGrid
+{
+public:
+    TouchHitTestGrid();
+    
+    /** Updates the bounding boxes of the nodes that were moved, and the grid if they changed cells
+     or if listeners were added or removed. Called before touches begin.
+     @param listeners the EventListenerTouchOneByOne listeners with scene graph priority
+     */
+    void update(const std::vector<EventListener*>& listeners);
+    
+    /** Marks the listeners whose node is visible and under a location.
+     @return the mark, see EventListenerTouchOneByOne::_hitTestStamp
+     */
+    unsigned int query(const Vec2& location);
+    
+    /** Removes a listener from the cells, before it is released */
+    void remove(EventListenerTouchOneByOne* listener);
+    
+    /** Removes all the listeners, when there are no more listeners with scene graph priority */
+    void clear();
+    
+protected:
+    static const int GRID_SIZE = 16;
+    
+    void rebuild(const std::vector<EventListener*>& listeners, const Rect& visibleRect);
+    
+    /** Updates the bounding box of the node of a listener, returns false if it didn't change */
+    static bool updateBounds(EventListenerTouchOneByOne* listener);
+    
+    /** The first and last columns and rows of the cells covered by a bounding box */
+    void getCells(const Rect& bounds, int cells[4]) const;
+    
+    Rect _visibleRect;
+    Vec2 _cellSize;
+    std::vector<std::vector<EventListenerTouchOneByOne*>> _cells;
+    size_t _count;
+    unsigned int _stamp;
+};
+
+NS_CC_END
+
+#endif /* defined(__cocos2d_libs__CCTouchHitTestGrid__) */
@@ -23,8 +23,10 @@
 ****************************************************************************/
 
 #include "base/CCValue.h"
+#include <atomic>
 #include <sstream>
 #include <iomanip>
+#include <string.h>
 #include "base/ccUtils.h"
 
 NS_CC_BEGIN
@@ -35,111 +37,233 @@ CC_DLL const ValueMapIntKey ValueMapIntKeyNull;
 
 const Value Value::Null;
 
+template <typename T>
+struct Value::Shared
+{
+    explicit Shared(const T& v)
+    : refs(1)
+    , shareable(true)
+    , data(v)
+    {}
+
+    explicit Shared(T&& v)
+    : refs(1)
+    , shareable(true)
+    , data(std::move(v))
+    {}
+
+    // Another reference to the payload, or a copy of it once a reference to it was given out
+    static Shared* retain(Shared* p)
+    {
+        if (!p->shareable)
+            return new (std::nothrow) Shared(p->data);
+
+        p->refs.fetch_add(1, std::memory_order_relaxed);
+        return p;
+    }
+
+    static void release(Shared* p)
+    {
+        if (p->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete p;
+    }
+
+    // The payload, copied first if other values share it. It can't be shared anymore,
+    // since the caller may keep a reference to it and change it later.
+    static T& mutate(Shared*& p)
+    {
+        if (p->refs.load(std::memory_order_acquire) != 1)
+        {
+            Shared* copy = new (std::nothrow) Shared(p->data);
+            release(p);
+            p = copy;
+        }
+        p->shareable = false;
+        return p->data;
+    }
+
+    std::atomic<int> refs;
+    bool shareable;
+    T data;
+};
+
+// The strings never change, they are always shared. The characters follow the header in the same block.
+struct Value::SharedString
+{
+    static SharedString* create(const char* v, size_t length)
+    {
+        auto p = static_cast<SharedString*>(malloc(sizeof(SharedString) + length));
+        if (p)
+        {
+            new (&p->refs) std::atomic<int>(1);
+            p->length = length;
+            memcpy(p->chars, v, length);
+            p->chars[length] = '\0';
+        }
+        return p;
+    }
+
+    static SharedString* retain(SharedString* p)
+    {
+        p->refs.fetch_add(1, std::memory_order_relaxed);
+        return p;
+    }
+
+    static void release(SharedString* p)
+    {
+        if (p->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            free(p);
+    }
+
+    std::atomic<int> refs;
+    size_t length;
+    char chars[1];
+};
+
 Value::Value()
 : _type(Type::NONE)
+, _strLength(0)
 {
     memset(&_field, 0, sizeof(_field));
 }
 
 Value::Value(unsigned char v)
 : _type(Type::BYTE)
+, _strLength(0)
 {
     _field.byteVal = v;
 }
 
 Value::Value(int v)
 : _type(Type::INTEGER)
+, _strLength(0)
 {
     _field.intVal = v;
 }
 
 Value::Value(float v)
 : _type(Type::FLOAT)
+, _strLength(0)
 {
     _field.floatVal = v;
 }
 
 Value::Value(double v)
 : _type(Type::DOUBLE)
+, _strLength(0)
 {
     _field.doubleVal = v;
 }
 
 Value::Value(bool v)
 : _type(Type::BOOLEAN)
+, _strLength(0)
 {
     _field.boolVal = v;
 }
 
 Value::Value(const char* v)
-: _type(Type::STRING)
+: _type(Type::NONE)
+, _strLength(0)
 {
-    _field.strVal = new std::string();
     if (v)
     {
-        *_field.strVal = v;
+        setString(v, strlen(v));
+    }
+    else
+    {
+        setString("", 0);
     }
 }
 
 Value::Value(const std::string& v)
-: _type(Type::STRING)
+: _type(Type::NONE)
+, _strLength(0)
 {
-    _field.strVal = new std::string();
-    *_field.strVal = v;
+    setString(v.c_str(), v.length());
 }
 
 Value::Value(const ValueVector& v)
 : _type(Type::VECTOR)
+, _strLength(0)
 {
-    _field.vectorVal = new (std::nothrow) ValueVector();
-    *_field.vectorVal = v;
+    _field.vectorVal = new (std::nothrow) Shared<ValueVector>(v);
 }
 
 Value::Value(ValueVector&& v)
 : _type(Type::VECTOR)
+, _strLength(0)
 {
-    _field.vectorVal = new (std::nothrow) ValueVector();
-    *_field.vectorVal = std::move(v);
+    _field.vectorVal = new (std::nothrow) Shared<ValueVector>(std::move(v));
 }
 
 Value::Value(const ValueMap& v)
 : _type(Type::MAP)
+, _strLength(0)
 {
-    _field.mapVal = new (std::nothrow) ValueMap();
-    *_field.mapVal = v;
+    _field.mapVal = new (std::nothrow) Shared<ValueMap>(v);
 }
 
 Value::Value(ValueMap&& v)
 : _type(Type::MAP)
+, _strLength(0)
 {
-    _field.mapVal = new (std::nothrow) ValueMap();
-    *_field.mapVal = std::move(v);
+    _field.mapVal = new (std::nothrow) Shared<ValueMap>(std::move(v));
 }
 
 Value::Value(const ValueMapIntKey& v)
 : _type(Type::INT_KEY_MAP)
+, _strLength(0)
 {
-    _field.intKeyMapVal = new (std::nothrow) ValueMapIntKey();
-    *_field.intKeyMapVal = v;
+    _field.intKeyMapVal = new (std::nothrow) Shared<ValueMapIntKey>(v);
 }
 
 Value::Value(ValueMapIntKey&& v)
 : _type(Type::INT_KEY_MAP)
+, _strLength(0)
 {
-    _field.intKeyMapVal = new (std::nothrow) ValueMapIntKey();
-    *_field.intKeyMapVal = std::move(v);
+    _field.intKeyMapVal = new (std::nothrow) Shared<ValueMapIntKey>(std::move(v));
 }
 
 Value::Value(const Value& other)
-: _type(Type::NONE)
+: _type(other._type)
+, _strLength(other._strLength)
 {
-    *this = other;
+    switch (other._type)
+    {
+        case Type::STRING:
+            if (_strLength == LONG_STRING)
+            {
+                _field.strVal = SharedString::retain(other._field.strVal);
+            }
+            else
+            {
+                memcpy(&_field, &other._field, sizeof(_field));
+            }
+            break;
+        case Type::VECTOR:
+            _field.vectorVal = Shared<ValueVector>::retain(other._field.vectorVal);
+            break;
+        case Type::MAP:
+            _field.mapVal = Shared<ValueMap>::retain(other._field.mapVal);
+            break;
+        case Type::INT_KEY_MAP:
+            _field.intKeyMapVal = Shared<ValueMapIntKey>::retain(other._field.intKeyMapVal);
+            break;
+        default:
+            memcpy(&_field, &other._field, sizeof(_field));
+            break;
+    }
 }
 
 Value::Value(Value&& other)
-: _type(Type::NONE)
+: _type(other._type)
+, _strLength(other._strLength)
 {
-    *this = std::move(other);
+    memcpy(&_field, &other._field, sizeof(_field));
+
+    memset(&other._field, 0, sizeof(other._field));
+    other._type = Type::NONE;
 }
 
 Value::~Value()
@@ -149,56 +273,10 @@ Value::~Value()
 
 Value& Value::operator= (const Value& other)
 {
-    if (this != &other) {
-        reset(other._type);
-
-        switch (other._type) {
-            case Type::BYTE:
-                _field.byteVal = other._field.byteVal;
-                break;
-            case Type::INTEGER:
-                _field.intVal = other._field.intVal;
-                break;
-            case Type::FLOAT:
-                _field.floatVal = other._field.floatVal;
-                break;
-            case Type::DOUBLE:
-                _field.doubleVal = other._field.doubleVal;
-                break;
-            case Type::BOOLEAN:
-                _field.boolVal = other._field.boolVal;
-                break;
-            case Type::STRING:
-                if (_field.strVal == nullptr)
-                {
-                    _field.strVal = new std::string();
-                }
-                *_field.strVal = *other._field.strVal;
-                break;
-            case Type::VECTOR:
-                if (_field.vectorVal == nullptr)
-                {
-                    _field.vectorVal = new (std::nothrow) ValueVector();
-                }
-                *_field.vectorVal = *other._field.vectorVal;
-                break;
-            case Type::MAP:
-                if (_field.mapVal == nullptr)
-                {
-                    _field.mapVal = new (std::nothrow) ValueMap();
-                }
-                *_field.mapVal = *other._field.mapVal;
-                break;
-            case Type::INT_KEY_MAP:
-                if (_field.intKeyMapVal == nullptr)
-                {
-                    _field.intKeyMapVal = new (std::nothrow) ValueMapIntKey();
-                }
-                *_field.intKeyMapVal = *other._field.intKeyMapVal;
-                break;
-            default:
-                break;
-        }
+    if (this != &other)
+    {
+        // other may be an element of a container of this value, copy it before releasing the container
+        *this = Value(other);
     }
     return *this;
 }
@@ -207,43 +285,19 @@ Value& Value::operator= (Value&& other)
 {
     if (this != &other)
     {
-        clear();
-        switch (other._type)
-        {
-            case Type::BYTE:
-                _field.byteVal = other._field.byteVal;
-                break;
-            case Type::INTEGER:
-                _field.intVal = other._field.intVal;
-                break;
-            case Type::FLOAT:
-                _field.floatVal = other._field.floatVal;
-                break;
-            case Type::DOUBLE:
-                _field.doubleVal = other._field.doubleVal;
-                break;
-            case Type::BOOLEAN:
-                _field.boolVal = other._field.boolVal;
-                break;
-            case Type::STRING:
-                _field.strVal = other._field.strVal;
-                break;
-            case Type::VECTOR:
-                _field.vectorVal = other._field.vectorVal;
-                break;
-            case Type::MAP:
-                _field.mapVal = other._field.mapVal;
-                break;
-            case Type::INT_KEY_MAP:
-                _field.intKeyMapVal = other._field.intKeyMapVal;
-                break;
-            default:
-                break;
-        }
-        _type = other._type;
+        // take the payload of other first, it may be an element of a container of this value
+        Type type = other._type;
+        unsigned char strLength = other._strLength;
+        char field[sizeof(_field)];
+        memcpy(field, &other._field, sizeof(_field));
 
         memset(&other._field, 0, sizeof(other._field));
         other._type = Type::NONE;
+
+        clear();
+        memcpy(&_field, field, sizeof(_field));
+        _type = type;
+        _strLength = strLength;
     }
 
     return *this;
@@ -286,57 +340,78 @@ Value& Value::operator= (bool v)
 
 Value& Value::operator= (const char* v)
 {
-    reset(Type::STRING);
-    *_field.strVal = v ? v : "";
+    clear();
+    if (v)
+    {
+        setString(v, strlen(v));
+    }
+    else
+    {
+        setString("", 0);
+    }
     return *this;
 }
 
 Value& Value::operator= (const std::string& v)
 {
-    reset(Type::STRING);
-    *_field.strVal = v;
+    clear();
+    setString(v.c_str(), v.length());
     return *this;
 }
 
+// The new payload is made before the old one is released, v may be the old one
+
 Value& Value::operator= (const ValueVector& v)
 {
-    reset(Type::VECTOR);
-    *_field.vectorVal = v;
+    auto payload = new (std::nothrow) Shared<ValueVector>(v);
+    clear();
+    _field.vectorVal = payload;
+    _type = Type::VECTOR;
     return *this;
 }
 
 Value& Value::operator= (ValueVector&& v)
 {
-    reset(Type::VECTOR);
-    *_field.vectorVal = std::move(v);
+    auto payload = new (std::nothrow) Shared<ValueVector>(std::move(v));
+    clear();
+    _field.vectorVal = payload;
+    _type = Type::VECTOR;
     return *this;
 }
 
 Value& Value::operator= (const ValueMap& v)
 {
-    reset(Type::MAP);
-    *_field.mapVal = v;
+    auto payload = new (std::nothrow) Shared<ValueMap>(v);
+    clear();
+    _field.mapVal = payload;
+    _type = Type::MAP;
     return *this;
 }
 
 Value& Value::operator= (ValueMap&& v)
 {
-    reset(Type::MAP);
-    *_field.mapVal = std::move(v);
+    auto payload = new (std::nothrow) Shared<ValueMap>(std::move(v));
+    clear();
+    _field.mapVal = payload;
+    _type = Type::MAP;
     return *this;
 }
 
 Value& Value::operator= (const ValueMapIntKey& v)
 {
-    reset(Type::INT_KEY_MAP);
-    *_field.intKeyMapVal = v;
+    auto payload = new (std::nothrow) Shared<ValueMapIntKey>(v);
+    clear();
+    _field.intKeyMapVal = payload;
+    _type = Type::INT_KEY_MAP;
     return *this;
 }
 
 Value& Value::operator= (ValueMapIntKey&& v)
 {
-    reset(Type::INT_KEY_MAP);
-    *_field.intKeyMapVal = std::move(v);
+    auto payload = new (std::nothrow) Shared<ValueMapIntKey>(std::move(v));
+    clear();
+    _field.intKeyMapVal = payload;
+    _type = Type::INT_KEY_MAP;
     return *this;
 }
 
@@ -364,13 +439,13 @@ bool Value::operator== (const Value& v) const
     case Type::BYTE:    return v._field.byteVal   == this->_field.byteVal;
     case Type::INTEGER: return v._field.intVal    == this->_field.intVal;
     case Type::BOOLEAN: return v._field.boolVal   == this->_field.boolVal;
-    case Type::STRING:  return *v._field.strVal   == *this->_field.strVal;
+    case Type::STRING:  return v.getStringLength() == this->getStringLength() && memcmp(v.getCString(), this->getCString(), this->getStringLength()) == 0;
     case Type::FLOAT:   return fabs(v._field.floatVal  - this->_field.floatVal)  <= FLT_EPSILON;
     case Type::DOUBLE:  return fabs(v._field.doubleVal - this->_field.doubleVal) <= FLT_EPSILON;
     case Type::VECTOR:
     {
-        const auto &v1 = *(this->_field.vectorVal);
-        const auto &v2 = *(v._field.vectorVal);
+        const auto &v1 = this->_field.vectorVal->data;
+        const auto &v2 = v._field.vectorVal->data;
         const auto size = v1.size();
         if (size == v2.size())
         {
@@ -383,8 +458,8 @@ bool Value::operator== (const Value& v) const
     }
     case Type::MAP:
     {
-        const auto &map1 = *(this->_field.mapVal);
-        const auto &map2 = *(v._field.mapVal);
+        const auto &map1 = this->_field.mapVal->data;
+        const auto &map2 = v._field.mapVal->data;
         for (const auto &kvp : map1)
         {
             auto it = map2.find(kvp.first);
@@ -397,8 +472,8 @@ bool Value::operator== (const Value& v) const
     }
     case Type::INT_KEY_MAP:
     {
-        const auto &map1 = *(this->_field.intKeyMapVal);
-        const auto &map2 = *(v._field.intKeyMapVal);
+        const auto &map1 = this->_field.intKeyMapVal->data;
+        const auto &map2 = v._field.intKeyMapVal->data;
         for (const auto &kvp : map1)
         {
             auto it = map2.find(kvp.first);
@@ -433,7 +508,7 @@ unsigned char Value::asByte() const
 
     if (_type == Type::STRING)
     {
-        return static_cast<unsigned char>(atoi(_field.strVal->c_str()));
+        return static_cast<unsigned char>(atoi(getCString()));
     }
 
     if (_type == Type::FLOAT)
@@ -469,7 +544,7 @@ int Value::asInt() const
 
     if (_type == Type::STRING)
     {
-        return atoi(_field.strVal->c_str());
+        return atoi(getCString());
     }
 
     if (_type == Type::FLOAT)
@@ -505,7 +580,7 @@ float Value::asFloat() const
 
     if (_type == Type::STRING)
     {
-        return utils::atof(_field.strVal->c_str());
+        return utils::atof(getCString());
     }
 
     if (_type == Type::INTEGER)
@@ -541,7 +616,7 @@ double Value::asDouble() const
 
     if (_type == Type::STRING)
     {
-        return static_cast<double>(utils::atof(_field.strVal->c_str()));
+        return static_cast<double>(utils::atof(getCString()));
     }
 
     if (_type == Type::INTEGER)
@@ -577,7 +652,8 @@ bool Value::asBool() const
 
     if (_type == Type::STRING)
     {
-        return (*_field.strVal == "0" || *_field.strVal == "false") ? false : true;
+        const char* str = getCString();
+        return (strcmp(str, "0") == 0 || strcmp(str, "false") == 0) ? false : true;
     }
 
     if (_type == Type::INTEGER)
@@ -604,7 +680,11 @@ std::string Value::asString() const
 
     if (_type == Type::STRING)
     {
-        return *_field.strVal;
+        if (_strLength == LONG_STRING)
+        {
+            return std::string(_field.strVal->chars, _field.strVal->length);
+        }
+        return std::string(_field.smallStrVal, _strLength);
     }
 
     std::stringstream ret;
@@ -635,37 +715,37 @@ std::string Value::asString() const
 ValueVector& Value::asValueVector()
 {
     CCASSERT(_type == Type::VECTOR, "The value type isn't Type::VECTOR");
-    return *_field.vectorVal;
+    return Shared<ValueVector>::mutate(_field.vectorVal);
 }
 
 const ValueVector& Value::asValueVector() const
 {
     CCASSERT(_type == Type::VECTOR, "The value type isn't Type::VECTOR");
-    return *_field.vectorVal;
+    return _field.vectorVal->data;
 }
 
 ValueMap& Value::asValueMap()
 {
     CCASSERT(_type == Type::MAP, "The value type isn't Type::MAP");
-    return *_field.mapVal;
+    return Shared<ValueMap>::mutate(_field.mapVal);
 }
 
 const ValueMap& Value::asValueMap() const
 {
     CCASSERT(_type == Type::MAP, "The value type isn't Type::MAP");
-    return *_field.mapVal;
+    return _field.mapVal->data;
 }
 
 ValueMapIntKey& Value::asIntKeyMap()
 {
     CCASSERT(_type == Type::INT_KEY_MAP, "The value type isn't Type::INT_KEY_MAP");
-    return *_field.intKeyMapVal;
+    return Shared<ValueMapIntKey>::mutate(_field.intKeyMapVal);
 }
 
 const ValueMapIntKey& Value::asIntKeyMap() const
 {
     CCASSERT(_type == Type::INT_KEY_MAP, "The value type isn't Type::INT_KEY_MAP");
-    return *_field.intKeyMapVal;
+    return _field.intKeyMapVal->data;
 }
 
 static std::string getTabs(int depth)
@@ -765,41 +845,31 @@ std::string Value::getDescription()
 
 void Value::clear()
 {
-    // Free memory the old value allocated
+    // Release the payload of the old value
     switch (_type)
     {
-        case Type::BYTE:
-            _field.byteVal = 0;
-            break;
-        case Type::INTEGER:
-            _field.intVal = 0;
-            break;
-        case Type::FLOAT:
-            _field.floatVal = 0.0f;
-            break;
-        case Type::DOUBLE:
-            _field.doubleVal = 0.0;
-            break;
-        case Type::BOOLEAN:
-            _field.boolVal = false;
-            break;
         case Type::STRING:
-            CC_SAFE_DELETE(_field.strVal);
+            if (_strLength == LONG_STRING)
+            {
+                SharedString::release(_field.strVal);
+            }
             break;
         case Type::VECTOR:
-            CC_SAFE_DELETE(_field.vectorVal);
+            Shared<ValueVector>::release(_field.vectorVal);
             break;
         case Type::MAP:
-            CC_SAFE_DELETE(_field.mapVal);
+            Shared<ValueMap>::release(_field.mapVal);
             break;
         case Type::INT_KEY_MAP:
-            CC_SAFE_DELETE(_field.intKeyMapVal);
+            Shared<ValueMapIntKey>::release(_field.intKeyMapVal);
             break;
         default:
             break;
     }
-    
+
+    memset(&_field, 0, sizeof(_field));
     _type = Type::NONE;
+    _strLength = 0;
 }
 
 void Value::reset(Type type)
@@ -808,27 +878,33 @@ void Value::reset(Type type)
         return;
 
     clear();
+    _type = type;
+}
 
-    // Allocate memory for the new value
-    switch (type)
+void Value::setString(const char* v, size_t length)
+{
+    if (length < sizeof(_field.smallStrVal))
     {
-        case Type::STRING:
-            _field.strVal = new std::string();
-            break;
-        case Type::VECTOR:
-            _field.vectorVal = new (std::nothrow) ValueVector();
-            break;
-        case Type::MAP:
-            _field.mapVal = new (std::nothrow) ValueMap();
-            break;
-        case Type::INT_KEY_MAP:
-            _field.intKeyMapVal = new (std::nothrow) ValueMapIntKey();
-            break;
-        default:
-            break;
+        memcpy(_field.smallStrVal, v, length);
+        _field.smallStrVal[length] = '\0';
+        _strLength = static_cast<unsigned char>(length);
+    }
+    else
+    {
+        _field.strVal = SharedString::create(v, length);
+        _strLength = LONG_STRING;
     }
+    _type = Type::STRING;
+}
 
-    _type = type;
+const char* Value::getCString() const
+{
+    return _strLength == LONG_STRING ? _field.strVal->chars : _field.smallStrVal;
+}
+
+size_t Value::getStringLength() const
+{
+    return _strLength == LONG_STRING ? _field.strVal->length : _strLength;
 }
 
 NS_CC_END
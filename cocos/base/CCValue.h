@@ -43,6 +43,16 @@ CC_DLL extern const ValueVector ValueVectorNull;
 CC_DLL extern const ValueMap ValueMapNull;
 CC_DLL extern const ValueMapIntKey ValueMapIntKeyNull;
 
+/** @brief A variant of the basic types, the strings and the containers of values.
+
+ The strings of up to 15 characters are stored in the value itself. The longer strings, the vectors and the maps
+ are shared by the copies of a value and copied on write: copying a value, or a container of values, doesn't
+ copy the nested containers. The non const `asValueVector()`, `asValueMap()` and `asIntKeyMap()` return
+ a container only this value owns, copying it first if it's shared; from then on, the copies of this value get
+ their own copy of the container, since it may be changed through the returned reference.
+ Call the const accessors to read a container without copying it. The references they return are valid
+ as long as the value isn't changed.
+ */
 class CC_DLL Value
 {
 public:
@@ -134,9 +144,17 @@ public:
     std::string getDescription();
 
 private:
+    // reference counted payloads, shared by the copies of a value
+    template <typename T> struct Shared;
+    struct SharedString;
+
     void clear();
     void reset(Type type);
 
+    void setString(const char* v, size_t length);
+    const char* getCString() const;
+    size_t getStringLength() const;
+
     union
     {
         unsigned char byteVal;
@@ -145,13 +163,18 @@ private:
         double doubleVal;
         bool boolVal;
 
-        std::string* strVal;
-        ValueVector* vectorVal;
-        ValueMap* mapVal;
-        ValueMapIntKey* intKeyMapVal;
+        char smallStrVal[16];
+        SharedString* strVal;
+        Shared<ValueVector>* vectorVal;
+        Shared<ValueMap>* mapVal;
+        Shared<ValueMapIntKey>* intKeyMapVal;
     }_field;
 
     Type _type;
+
+    // the length of a string stored in _field.smallStrVal, or LONG_STRING if it is in _field.strVal
+    unsigned char _strLength;
+    static const unsigned char LONG_STRING = 0xff;
 };
 
 NS_CC_END
@@ -34,6 +34,7 @@
  ****************************************************************************/
 
 #include <stdint.h>
+#include <atomic>
 #include <vector>
 #include <typeinfo>
 #include <sstream>
@@ -89,14 +90,15 @@ public:
         AllocatorDiagnostics::instance()->untrackAllocator(this);
 #endif
 
-        do
+        void* pages = _pages.load(std::memory_order_relaxed);
+        while (pages)
         {
-            intptr_t* page = (intptr_t*)_pages;
+            intptr_t* page = (intptr_t*)pages;
             intptr_t* next = (intptr_t*)*page;
             ccAllocatorGlobal.deallocate(page);
-            _pages = (void*)next;
+            pages = (void*)next;
         }
-        while (_pages);
+        _pages.store(nullptr, std::memory_order_relaxed);
     }
     
     // @brief
@@ -129,29 +131,76 @@ public:
 #endif
     }
     
+    // @brief Allocate count blocks with a single lock.
+    // The blocks are linked together through their first word, the last one links to nullptr.
+    // @return the first block of the list.
+    CC_ALLOCATOR_INLINE void* allocateBatch(size_t count)
+    {
+        void* list = nullptr;
+#ifdef FALLBACK_TO_GLOBAL
+        for (size_t i = 0; i < count; ++i)
+        {
+            void* block = ccAllocatorGlobal.allocate(block_size);
+            *(uintptr_t*)block = (uintptr_t)list;
+            list = block;
+        }
+#else
+        lock_traits::lock();
+        for (size_t i = 0; i < count; ++i)
+        {
+            void* block = pop_front();
+            *(uintptr_t*)block = (uintptr_t)list;
+            list = block;
+        }
+        lock_traits::unlock();
+#endif
+        return list;
+    }
+    
+    // @brief Deallocate a list of blocks linked through their first word with a single lock.
+    // @see allocateBatch
+    CC_ALLOCATOR_INLINE void deallocateBatch(void* list)
+    {
+#ifdef FALLBACK_TO_GLOBAL
+        while (list)
+        {
+            void* next = (void*)*(uintptr_t*)list;
+            ccAllocatorGlobal.deallocate(list);
+            list = next;
+        }
+#else
+        lock_traits::lock();
+        while (list)
+        {
+            void* next = (void*)*(uintptr_t*)list;
+            push_front(list);
+            list = next;
+        }
+        lock_traits::unlock();
+#endif
+    }
+    
     // @brief Checks allocated pages to determine whether or not a block
     // is owned by this allocator. This should be reasonably fast
     // for properly configured allocators with few large pages.
-    CC_ALLOCATOR_INLINE bool owns(const void* const address)
+    // Pages are only ever added at the head of the list, and freed when the allocator
+    // is destroyed, so the list is walked without taking the lock.
+    CC_ALLOCATOR_INLINE bool owns(const void* const address) const
     {
 #ifdef FALLBACK_TO_GLOBAL
         return true; // since everything uses the global allocator, we can just lie and say we own this address.
 #else
-        lock_traits::lock();
-        
         const uint8_t* const a = (const uint8_t* const)address;
-        const uint8_t* p = (uint8_t*)_pages;
+        const uint8_t* p = (uint8_t*)_pages.load(std::memory_order_acquire);
         const size_t pSize = pageSize();
         while (p)
         {
             if (a >= p && a < (p + pSize))
             {
-                lock_traits::unlock();
                 return true;
             }
             p = (uint8_t*)(*(uintptr_t*)p);
         }
-        lock_traits::unlock();
         return false;
 #endif
     }
@@ -233,16 +282,9 @@ protected:
     {
         uint8_t* p = (uint8_t*)AllocatorBase::aligned(ccAllocatorGlobal.allocate(pageSize()));
         intptr_t* page = (intptr_t*)p;
-        if (nullptr == _pages)
-        {
-            _pages = page;
-            *page = 0;
-        }
-        else
-        {
-            *page = (intptr_t)_pages;
-            _pages = page;
-        }
+        // link the page before publishing it, owns() reads the list without the lock
+        *page = (intptr_t)_pages.load(std::memory_order_relaxed);
+        _pages.store(page, std::memory_order_release);
         
         p += AllocatorBase::kDefaultAlignment; // step past the linked list node
         
@@ -261,7 +303,7 @@ protected:
     void* _list;
     
     // @brief Linked list of allocated pages.
-    void* _pages;
+    std::atomic<void*> _pages;
     
     // @brief number of blocks per page.
     size_t _pageSize;
@@ -37,17 +37,38 @@
 #include "base/allocator/CCAllocatorBase.h"
 #include "base/allocator/CCAllocatorGlobal.h"
 #include "base/allocator/CCAllocatorStrategyFixedBlock.h"
+#include "base/allocator/CCAllocatorThreadLocal.h"
+
+#if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
+#include <atomic>
+#endif
+
+// @brief thread caches are only available where the platform has thread local storage.
+#if CC_ENABLE_ALLOCATOR_THREAD_CACHE && CC_ALLOCATOR_HAS_THREAD_LOCAL
+#define CC_ALLOCATOR_USE_THREAD_CACHE 1
+#else
+#define CC_ALLOCATOR_USE_THREAD_CACHE 0
+#endif
 
 NS_CC_BEGIN
 NS_CC_ALLOCATOR_BEGIN
 
 #if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
 #define TRACK(slot, size, op) _smallBlockAllocations[slot] op size
+#define TRACK_CACHED(slot, count, op) _smallBlockCached[slot] op count
 #else
 #define TRACK(...)
+#define TRACK_CACHED(...)
 #endif
 
 // @brief
+// Allocator for global new/delete. Blocks up to 8kb are allocated from fixed block allocators,
+// one per power of two size, larger blocks from the global allocator.
+// When CC_ENABLE_ALLOCATOR_THREAD_CACHE is on, each thread keeps a magazine of free blocks
+// per size in front of the fixed block allocators, so most allocations do not take a lock.
+// An empty magazine is refilled, and a full one is half emptied, with a single lock.
+// All the blocks of a size are interchangeable, so a block freed by another thread than the
+// one that allocated it simply goes to the magazine of the thread that frees it.
 class AllocatorStrategyGlobalSmallBlock
     : public AllocatorBase
 {
@@ -59,6 +80,12 @@ public:
     // default max small block size pool.
 	static const size_t kMaxSmallBlockPower = 13; // 2^13 8kb
     
+    // the free blocks each thread keeps per size, for the small sizes.
+    // the big sizes keep at least kMinMagazineSize blocks, about kMagazineBytes bytes.
+    static const size_t kMaxMagazineSize = 64;
+    static const size_t kMinMagazineSize = 4;
+    static const size_t kMagazineBytes = 32768;
+    
     // @brief define for allocator strategy, cannot be typedef because we want to eval at use
 #define SType(size) AllocatorStrategyFixedBlock<size>
     
@@ -95,7 +122,15 @@ public:
             
             memset(_smallBlockAllocators, 0, sizeof(_smallBlockAllocators));
 #if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
-            memset(_smallBlockAllocations, 0, sizeof(_smallBlockAllocations));
+            for (int i = 0; i <= kMaxSmallBlockPower; ++i)
+            {
+                _smallBlockAllocations[i] = 0;
+                _smallBlockCached[i] = 0;
+            }
+#endif
+#if CC_ALLOCATOR_USE_THREAD_CACHE
+            _threadCache.init(&AllocatorStrategyGlobalSmallBlock::threadExit);
+            _destroyed = false;
 #endif
             // cannot call new on the allocator here because it will recurse
             // so instead we allocate from the global allocator and construct in place.
@@ -125,6 +160,16 @@ public:
     
     virtual ~AllocatorStrategyGlobalSmallBlock()
     {
+#if CC_ALLOCATOR_USE_THREAD_CACHE
+        // the threads still running keep their caches, the blocks go away with the pages
+        _destroyed = true;
+        ThreadCache* cache = (ThreadCache*)_threadCache.get();
+        if (cache)
+        {
+            _threadCache.set(nullptr);
+            ccAllocatorGlobal.deallocate(cache);
+        }
+#endif
         for (int i = 0; i <= kMaxSmallBlockPower; ++i)
             if (_smallBlockAllocators[i])
                 ccAllocatorGlobal.deallocate(_smallBlockAllocators[i]);
@@ -156,10 +201,7 @@ public:
         #define ALLOCATE(slot, size) \
             case size: \
             { \
-                void* v = _smallBlockAllocators[slot]; \
-                CC_ASSERT(nullptr != v); \
-                auto a = (SType(size)*)v; \
-                address = a->allocate(adjusted_size); \
+                address = allocateBlock<size>(slot); \
                 TRACK(slot, size, +=); \
             } \
             break;
@@ -250,10 +292,7 @@ public:
         #define DEALLOCATE(slot, size, address) \
             case size: \
             { \
-                void* v = _smallBlockAllocators[slot]; \
-                CC_ASSERT(nullptr != v); \
-                auto a = (SType(size)*)v; \
-                a->deallocate(address, size); \
+                deallocateBlock<size>(slot, address); \
                 TRACK(slot, size, -=); \
             } \
             break;
@@ -290,7 +329,7 @@ public:
             if (a)
             {
                 total += _smallBlockAllocations[i];
-                s << a->tag() << " allocated:" << _smallBlockAllocations[i] << "\n";
+                s << a->tag() << " allocated:" << _smallBlockAllocations[i].load() << " cached:" << _smallBlockCached[i].load() << "\n";
             }
         }
         s << "Total:" << total << "\n";
@@ -301,6 +340,155 @@ public:
     
 protected:
     
+    // @brief the number of blocks a thread keeps for a size
+    static size_t magazineSize(size_t blockSize)
+    {
+        size_t count = kMagazineBytes / blockSize;
+        return count > kMaxMagazineSize ? kMaxMagazineSize : (count < kMinMagazineSize ? kMinMagazineSize : count);
+    }
+    
+#if CC_ALLOCATOR_USE_THREAD_CACHE
+    
+    // @brief the magazines of a thread, the free blocks of each size linked through their first word.
+    struct ThreadCache
+    {
+        AllocatorStrategyGlobalSmallBlock* owner;
+        void* blocks[kMaxSmallBlockPower + 1];
+        size_t counts[kMaxSmallBlockPower + 1];
+    };
+    
+    // @brief returns the cache of the calling thread, created on first use.
+    // returns nullptr if the cache can't be used, the fixed block allocators are used directly then.
+    CC_ALLOCATOR_INLINE ThreadCache* threadCache()
+    {
+        ThreadCache* cache = (ThreadCache*)_threadCache.get();
+        if (nullptr == cache && _threadCache.valid() && !_destroyed)
+        {
+            // the global allocator does not use this allocator, so this can't recurse
+            cache = (ThreadCache*)ccAllocatorGlobal.allocate(sizeof(ThreadCache));
+            if (cache)
+            {
+                memset(cache, 0, sizeof(ThreadCache));
+                cache->owner = this;
+                _threadCache.set(cache);
+            }
+        }
+        return cache;
+    }
+    
+    // @brief returns count blocks of a magazine to its fixed block allocator with a single lock
+    template <size_t S>
+    CC_ALLOCATOR_INLINE void flush(ThreadCache* cache, int slot, size_t count)
+    {
+        void* list = cache->blocks[slot];
+        void* last = list;
+        for (size_t i = 1; i < count; ++i)
+            last = (void*)*(uintptr_t*)last;
+        
+        cache->blocks[slot] = (void*)*(uintptr_t*)last;
+        cache->counts[slot] -= count;
+        *(uintptr_t*)last = 0;
+        
+        auto a = (SType(S)*)_smallBlockAllocators[slot];
+        a->deallocateBatch(list);
+        TRACK_CACHED(slot, count, -=);
+    }
+    
+    // @brief returns all the blocks of a thread to the fixed block allocators.
+    void flushAll(ThreadCache* cache)
+    {
+        #define FLUSH(slot, size) \
+            if (cache->counts[slot]) \
+                flush<size>(cache, slot, cache->counts[slot]);
+        
+        FLUSH(2,  4);
+        FLUSH(3,  8);
+        FLUSH(4,  16);
+        FLUSH(5,  32);
+        FLUSH(6,  64);
+        FLUSH(7,  128);
+        FLUSH(8,  256);
+        FLUSH(9,  512);
+        FLUSH(10, 1024);
+        FLUSH(11, 2048);
+        FLUSH(12, 4096);
+        FLUSH(13, 8192);
+        
+        #undef FLUSH
+    }
+    
+    // @brief called by the platform when a thread that has a cache exits
+    static TLS_CALLBACK(threadExit, value)
+    {
+        ThreadCache* cache = (ThreadCache*)value;
+        if (nullptr == cache)
+            return;
+        
+        // pthread clears the value before calling us, FLS doesn't
+        cache->owner->_threadCache.set(nullptr);
+        if (!cache->owner->_destroyed)
+            cache->owner->flushAll(cache);
+        ccAllocatorGlobal.deallocate(cache);
+    }
+    
+#endif//CC_ALLOCATOR_USE_THREAD_CACHE
+    
+    // @brief allocate a block from the magazine of the thread, or from the fixed block allocator
+    template <size_t S>
+    CC_ALLOCATOR_INLINE void* allocateBlock(int slot)
+    {
+        auto a = (SType(S)*)_smallBlockAllocators[slot];
+        CC_ASSERT(nullptr != a);
+        
+#if CC_ALLOCATOR_USE_THREAD_CACHE
+        ThreadCache* cache = threadCache();
+        if (cache)
+        {
+            if (0 == cache->counts[slot])
+            {
+                size_t count = magazineSize(S) / 2;
+                cache->blocks[slot] = a->allocateBatch(count);
+                cache->counts[slot] = count;
+                TRACK_CACHED(slot, count, +=);
+            }
+            
+            void* block = cache->blocks[slot];
+            cache->blocks[slot] = (void*)*(uintptr_t*)block;
+            --cache->counts[slot];
+            TRACK_CACHED(slot, 1, -=);
+            return block;
+        }
+#endif
+        return a->allocate(S);
+    }
+    
+    // @brief deallocate a block to the magazine of the thread, or to the fixed block allocator
+    template <size_t S>
+    CC_ALLOCATOR_INLINE void deallocateBlock(int slot, void* address)
+    {
+        auto a = (SType(S)*)_smallBlockAllocators[slot];
+        CC_ASSERT(nullptr != a);
+        
+#if CC_ALLOCATOR_USE_THREAD_CACHE
+        ThreadCache* cache = threadCache();
+        if (cache)
+        {
+            *(uintptr_t*)address = (uintptr_t)cache->blocks[slot];
+            cache->blocks[slot] = address;
+            ++cache->counts[slot];
+            TRACK_CACHED(slot, 1, +=);
+            
+            // keep half of the magazine, so a thread that allocates and frees
+            // around the limit does not take the lock every time.
+            size_t size = magazineSize(S);
+            if (cache->counts[slot] >= size)
+                flush<S>(cache, slot, size / 2);
+            return;
+        }
+#endif
+        a->deallocate(address, S);
+    }
+    
     // @brief the max size of a block this allocator will pool before using global allocator
     size_t _maxBlockSize;
     
@@ -308,10 +496,20 @@ protected:
     AllocatorBase* _smallBlockAllocators[kMaxSmallBlockPower + 1];
     
 #if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
-    size_t _smallBlockAllocations[kMaxSmallBlockPower + 1];
+    // @brief bytes allocated per size, and blocks kept by the threads per size
+    std::atomic<size_t> _smallBlockAllocations[kMaxSmallBlockPower + 1];
+    std::atomic<size_t> _smallBlockCached[kMaxSmallBlockPower + 1];
+#endif
+    
+#if CC_ALLOCATOR_USE_THREAD_CACHE
+    AllocatorThreadLocal _threadCache;
+    bool _destroyed;
 #endif
 };
 
+#undef TRACK
+#undef TRACK_CACHED
+
 NS_CC_ALLOCATOR_END
 NS_CC_END
 
@@ -27,9 +27,12 @@
  THE SOFTWARE.
  ****************************************************************************/
 #include <vector>
+#include <new>
 #include <typeinfo>
 #include <sstream>
+#include <thread>
 
+#include "base/ccMacros.h"
 #include "base/allocator/CCAllocatorMacros.h"
 #include "base/allocator/CCAllocatorGlobal.h"
 #include "base/allocator/CCAllocatorStrategyFixedBlock.h"
@@ -77,6 +80,24 @@ public:
 };
 
 
+// @brief ObjectTraits for a pool that provides operator new/delete of a class.
+// The new expression constructs the object and the delete expression destroys it,
+// so the pool only provides the memory.
+// @param T Type of object
+// @param _alignment Alignment of object T
+template <typename T, size_t _alignment = 16>
+class PooledObjectTraits
+    : public ObjectTraits<T, _alignment>
+{
+public:
+    
+    void construct(T* address)
+    {}
+    
+    void destroy(T* address)
+    {}
+};
+
 // @brief
 // Fixed sized pool allocator strategy for objects of type T
 // Optionally takes a page size which determines how many objects
@@ -157,4 +178,78 @@ public:
 NS_CC_ALLOCATOR_END
 NS_CC_END
 
+#if CC_ENABLE_ALLOCATOR && CC_ENABLE_ALLOCATOR_OBJECT_POOLS
+
+    // @brief type of the pool of an engine class, see CC_ENABLE_ALLOCATOR_OBJECT_POOLS.
+    // Like the rest of the scene graph, the objects are only created and deleted on the cocos thread.
+    #define CC_OBJECT_POOL_TYPE(T) \
+        cocos2d::allocator::AllocatorStrategyPool<T, cocos2d::allocator::PooledObjectTraits<T>>
+
+    NS_CC_BEGIN
+    NS_CC_ALLOCATOR_BEGIN
+    // @brief whether the caller is on the thread of the first pooled object, the cocos thread.
+    // The pools aren't locked, the operators assert it in debug builds.
+    inline bool isObjectPoolThread()
+    {
+        static const std::thread::id s_poolThread = std::this_thread::get_id();
+        return std::this_thread::get_id() == s_poolThread;
+    }
+    NS_CC_ALLOCATOR_END
+    NS_CC_END
+
+    #define CC_ASSERT_OBJECT_POOL_THREAD(T) \
+        CCASSERT(cocos2d::allocator::isObjectPoolThread(), #T " objects can only be created and deleted on the cocos thread")
+
+    // @brief helper macro for the class declaration of an engine class that uses a pool.
+    // Derived classes that don't use their own pool and have a different size
+    // fall back to the global allocator.
+    // The nothrow and placement forms are declared as well, as the class operators hide the global ones.
+    #define CC_USE_OBJECT_POOL(T) \
+        static CC_OBJECT_POOL_TYPE(T)& objectPool(); \
+        CC_ALLOCATOR_INLINE void* operator new (size_t size) \
+        { \
+            CC_ASSERT_OBJECT_POOL_THREAD(T); \
+            return objectPool().allocate(size); \
+        } \
+        CC_ALLOCATOR_INLINE void* operator new (size_t size, const std::nothrow_t&) throw() \
+        { \
+            CC_ASSERT_OBJECT_POOL_THREAD(T); \
+            return objectPool().allocate(size); \
+        } \
+        CC_ALLOCATOR_INLINE void* operator new (size_t size, void* address) throw() \
+        { \
+            return address; \
+        } \
+        CC_ALLOCATOR_INLINE void operator delete (void* object, size_t size) \
+        { \
+            CC_ASSERT_OBJECT_POOL_THREAD(T); \
+            objectPool().deallocate(object, size); \
+        } \
+        CC_ALLOCATOR_INLINE void operator delete (void* object, const std::nothrow_t&) throw() \
+        { \
+            CC_ASSERT_OBJECT_POOL_THREAD(T); \
+            objectPool().deallocate(object, objectPool().owns(object) ? sizeof(T) : 0); \
+        } \
+        CC_ALLOCATOR_INLINE void operator delete (void* object, void* address) throw() \
+        {}
+
+    // @brief helper macro for the implementation of an engine class that uses a pool.
+    // The pool is created the first time it is used, so it does not depend on the order of
+    // the static constructors, and it is never deleted, so objects can be released at exit.
+    // The number of objects per page can be changed in the configuration with the class name as key.
+    #define CC_IMPLEMENT_OBJECT_POOL(T, pageSize) \
+        CC_OBJECT_POOL_TYPE(T)& T::objectPool() \
+        { \
+            static auto pool = new (std::nothrow) CC_OBJECT_POOL_TYPE(T)(#T, pageSize); \
+            return *pool; \
+        }
+
+#else
+
+    // throw these away if not enabled
+    #define CC_USE_OBJECT_POOL(...)
+    #define CC_IMPLEMENT_OBJECT_POOL(...)
+
+#endif
+
 #endif//CC_ALLOCATOR_STRATEGY_POOL_H
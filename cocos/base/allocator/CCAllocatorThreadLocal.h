@@ -0,0 +1,114 @@
+#ifndef CC_ALLOCATOR_THREAD_LOCAL_H
+#define CC_ALLOCATOR_THREAD_LOCAL_H
+
+/****************************************************************************
+ Copyright (c) 2014 Chukong Technologies Inc.
+ Author: Justin Graham (https://github.com/mannewalis)
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+/****************************************************************************
+ WARNING!
+ Do not use Console::log or any other methods that use NEW inside of this
+ allocator. Failure to do so will result in recursive memory allocation.
+ ****************************************************************************/
+
+#include "platform/CCPlatformMacros.h"
+#include "base/allocator/CCAllocatorMacros.h"
+
+// thread_local is not supported by all our compilers yet, and C++11 thread_local
+// objects may allocate memory. So we use the thread local storage of the platform.
+#if CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_MAC || CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+#include "pthread.h"
+#define CC_ALLOCATOR_HAS_THREAD_LOCAL 1
+#define TLS_KEY pthread_key_t
+#define TLS_CALLBACK_TYPEDEF(name) typedef void (*name)(void*)
+#define TLS_CALLBACK(name, value) void name(void* value)
+#define TLS_INIT(key, callback) (0 == pthread_key_create(&key, callback))
+#define TLS_GET(key) pthread_getspecific(key)
+#define TLS_SET(key, value) pthread_setspecific(key, value)
+#elif CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_WINRT
+#include "windows.h"
+// fiber local storage, unlike TlsAlloc it calls back when the thread exits
+#define CC_ALLOCATOR_HAS_THREAD_LOCAL 1
+#define TLS_KEY DWORD
+#define TLS_CALLBACK_TYPEDEF(name) typedef PFLS_CALLBACK_FUNCTION name
+#define TLS_CALLBACK(name, value) void WINAPI name(void* value)
+#define TLS_INIT(key, callback) (FLS_OUT_OF_INDEXES != (key = FlsAlloc(callback)))
+#define TLS_GET(key) FlsGetValue(key)
+#define TLS_SET(key, value) FlsSetValue(key, value)
+#else
+#define CC_ALLOCATOR_HAS_THREAD_LOCAL 0
+#endif
+
+NS_CC_BEGIN
+NS_CC_ALLOCATOR_BEGIN
+
+#if CC_ALLOCATOR_HAS_THREAD_LOCAL
+
+// @brief A pointer per thread, with a callback when a thread that has set it exits.
+// Unlike std::thread_local it does not allocate memory, so it can be used by the allocators.
+// A thread that never set the pointer gets nullptr.
+// There is no constructor, the allocators construct themselves before the static constructors
+// run and possibly again after, so init() creates the key once.
+class AllocatorThreadLocal
+{
+public:
+    
+    TLS_CALLBACK_TYPEDEF(Callback);
+    
+    // @brief Creates the key. Returns false if the platform ran out of keys, get() always returns nullptr then.
+    // @param callback called with the pointer of the thread when the thread exits, if it isn't null.
+    bool init(Callback callback = nullptr)
+    {
+        _valid = TLS_INIT(_key, callback);
+        return _valid;
+    }
+    
+    bool valid() const
+    {
+        return _valid;
+    }
+    
+    CC_ALLOCATOR_INLINE void* get() const
+    {
+        return _valid ? TLS_GET(_key) : nullptr;
+    }
+    
+    CC_ALLOCATOR_INLINE void set(void* value)
+    {
+        if (_valid)
+            TLS_SET(_key, value);
+    }
+    
+protected:
+    
+    TLS_KEY _key;
+    bool _valid;
+};
+
+#endif//CC_ALLOCATOR_HAS_THREAD_LOCAL
+
+NS_CC_ALLOCATOR_END
+NS_CC_END
+
+#endif//CC_ALLOCATOR_THREAD_LOCAL_H
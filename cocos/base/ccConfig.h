@@ -259,6 +259,17 @@ To enable set it to a value different than 0. Disabled by default.
 #define CC_ENABLE_PROFILERS 0
 #endif
 
+/** @def CC_ENABLE_FRAME_PROFILER
+ If enabled, the CC_PROFILE_ZONE macros measure the main loop, the renderer, the scheduler, the actions,
+ the jobs and the file reads. The frames are only recorded while a capture is requested, see FrameProfiler,
+ and written as a Chrome trace (chrome://tracing). The capture can be started with the "profiler" command of the Console.
+ 
+ To enable set it to a value different than 0. Disabled by default.
+ */
+#ifndef CC_ENABLE_FRAME_PROFILER
+#define CC_ENABLE_FRAME_PROFILER 0
+#endif
+
 /** Enable Lua engine debug log */
 #ifndef CC_LUA_ENGINE_DEBUG
 #define CC_LUA_ENGINE_DEBUG 0
@@ -333,6 +344,28 @@ To enable set it to a value different than 0. Disabled by default.
 # define CC_ENABLE_ALLOCATOR_GLOBAL_NEW_DELETE 0
 # endif//CC_ENABLE_ALLOCATOR_GLOBAL_NEW_DELETE
 
+/** @def CC_ENABLE_ALLOCATOR_THREAD_CACHE
+ Turn on the per thread caches of free blocks of the allocator
+ used for global new and delete. Threads allocate and free small
+ blocks without taking a lock most of the time.
+ */
+#ifndef CC_ENABLE_ALLOCATOR_THREAD_CACHE
+# define CC_ENABLE_ALLOCATOR_THREAD_CACHE 1
+#endif
+
+/** @def CC_ENABLE_ALLOCATOR_OBJECT_POOLS
+ Turn on pooled new and delete for the engine objects that are
+ created and destroyed the most: Node, Sprite, Label, CallFunc and
+ the common ActionInterval subclasses. Each class gets its own pool,
+ see CC_USE_OBJECT_POOL. Only used when CC_ENABLE_ALLOCATOR is set.
+ The pools aren't locked: these objects must be created and deleted
+ on the cocos thread, which is asserted in debug builds.
+ Disabled by default.
+ */
+#ifndef CC_ENABLE_ALLOCATOR_OBJECT_POOLS
+# define CC_ENABLE_ALLOCATOR_OBJECT_POOLS 0
+#endif
+
 /** @def CC_ALLOCATOR_GLOBAL
  Specify allocator to use for global allocator
  */
@@ -46,6 +46,7 @@ THE SOFTWARE.
 #include "base/CCNS.h"
 #include "base/CCData.h"
 #include "base/CCValue.h"
+#include "base/CCBinaryValue.h"
 #include "base/ccConfig.h"
 #include "base/ccMacros.h"
 #include "base/ccTypes.h"
@@ -55,6 +56,7 @@ THE SOFTWARE.
 #include "base/base64.h"
 #include "base/ZipUtils.h"
 #include "base/CCProfiling.h"
+#include "base/CCFrameProfiler.h"
 #include "base/CCConsole.h"
 #include "base/ccUTF8.h"
 #include "base/CCUserDefault.h"
@@ -782,7 +782,8 @@ Node* CSLoader::nodeWithFlatBuffersFile(const std::string &fileName)
     
     CC_ASSERT(FileUtils::getInstance()->isFileExist(fullPath));
     
-    Data buf = FileUtils::getInstance()->getDataFromFile(fullPath);
+    // the flatbuffers are read in place, the buffer must live until the nodes are created
+    MappedData buf = FileUtils::getInstance()->getMappedDataFromFile(fullPath);
     
     auto csparsebinary = GetCSParseBinary(buf.getBytes());
     
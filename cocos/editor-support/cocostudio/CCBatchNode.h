@@ -61,6 +61,9 @@ public:
     virtual void draw(cocos2d::Renderer *renderer, const cocos2d::Mat4 &transform, uint32_t flags) override;
     
 protected:
+    // the children are not visited, they are drawn by draw()
+    virtual bool prepareTransform(const cocos2d::Mat4& parentTransform, uint32_t parentFlags) override { return false; }
+
     void generateGroupCommand();
 
     cocos2d::GroupCommand* _groupCommand;
@@ -0,0 +1,189 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __CC_SIMD_H__
+#define __CC_SIMD_H__
+
+#include <math.h>
+#include <stdint.h>
+
+#include "platform/CCPlatformMacros.h"
+
+// The few operations on 4 floats at a time used by the particle systems and the 3D animations,
+// on SSE2, NEON, or plain C++ elsewhere.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CC_SIMD_USE_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__) || defined(__arm64__)
+#define CC_SIMD_USE_NEON
+#include <arm_neon.h>
+#endif
+
+NS_CC_BEGIN
+
+namespace SIMD
+{
+
+#if defined(CC_SIMD_USE_SSE)
+
+typedef __m128 float4;
+typedef __m128 mask4;
+
+inline float4 load(const float* p) { return _mm_loadu_ps(p); }
+inline void store(float* p, float4 v) { _mm_storeu_ps(p, v); }
+inline float4 splat(float f) { return _mm_set1_ps(f); }
+
+inline float4 add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+inline float4 sub(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+inline float4 mul(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+inline float4 div(float4 a, float4 b) { return _mm_div_ps(a, b); }
+inline float4 sqrt4(float4 a) { return _mm_sqrt_ps(a); }
+inline float4 neg(float4 a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+// a > b ? a : b, like MAX(b, a)
+inline float4 maximum(float4 a, float4 b) { return _mm_max_ps(a, b); }
+
+inline mask4 notEqual(float4 a, float4 b) { return _mm_cmpneq_ps(a, b); }
+inline mask4 notLess(float4 a, float4 b) { return _mm_cmpnlt_ps(a, b); }
+inline mask4 both(mask4 a, mask4 b) { return _mm_and_ps(a, b); }
+inline float4 select(mask4 m, float4 a, float4 b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+
+// packs 4 colors in [0, 255] as Color4B, on little endian CPUs, truncated like the float to GLubyte conversion
+inline void toColors(float4 r, float4 g, float4 b, float4 a, uint32_t* out)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 top = _mm_set1_ps(255.0f);
+    __m128i ir = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(r, zero), top));
+    __m128i ig = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(g, zero), top));
+    __m128i ib = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(b, zero), top));
+    __m128i ia = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(a, zero), top));
+    __m128i rgba = _mm_or_si128(_mm_or_si128(ir, _mm_slli_epi32(ig, 8)), _mm_or_si128(_mm_slli_epi32(ib, 16), _mm_slli_epi32(ia, 24)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), rgba);
+}
+
+#elif defined(CC_SIMD_USE_NEON)
+
+typedef float32x4_t float4;
+typedef uint32x4_t mask4;
+
+inline float4 load(const float* p) { return vld1q_f32(p); }
+inline void store(float* p, float4 v) { vst1q_f32(p, v); }
+inline float4 splat(float f) { return vdupq_n_f32(f); }
+
+inline float4 add(float4 a, float4 b) { return vaddq_f32(a, b); }
+inline float4 sub(float4 a, float4 b) { return vsubq_f32(a, b); }
+inline float4 mul(float4 a, float4 b) { return vmulq_f32(a, b); }
+#if defined(__aarch64__) || defined(__arm64__)
+inline float4 div(float4 a, float4 b) { return vdivq_f32(a, b); }
+inline float4 sqrt4(float4 a) { return vsqrtq_f32(a); }
+#else
+// armv7 has no vector division nor square root, and the reciprocal estimates are not exact
+inline float4 div(float4 a, float4 b)
+{
+    float x[4], y[4];
+    vst1q_f32(x, a);
+    vst1q_f32(y, b);
+    for (int i = 0; i < 4; ++i)
+        x[i] /= y[i];
+    return vld1q_f32(x);
+}
+inline float4 sqrt4(float4 a)
+{
+    float x[4];
+    vst1q_f32(x, a);
+    for (int i = 0; i < 4; ++i)
+        x[i] = sqrtf(x[i]);
+    return vld1q_f32(x);
+}
+#endif
+inline float4 neg(float4 a) { return vnegq_f32(a); }
+inline float4 maximum(float4 a, float4 b) { return vmaxq_f32(a, b); }
+
+inline mask4 notEqual(float4 a, float4 b) { return vmvnq_u32(vceqq_f32(a, b)); }
+inline mask4 notLess(float4 a, float4 b) { return vmvnq_u32(vcltq_f32(a, b)); }
+inline mask4 both(mask4 a, mask4 b) { return vandq_u32(a, b); }
+inline float4 select(mask4 m, float4 a, float4 b) { return vbslq_f32(m, a, b); }
+
+inline void toColors(float4 r, float4 g, float4 b, float4 a, uint32_t* out)
+{
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t top = vdupq_n_f32(255.0f);
+    uint32x4_t ir = vcvtq_u32_f32(vminq_f32(vmaxq_f32(r, zero), top));
+    uint32x4_t ig = vcvtq_u32_f32(vminq_f32(vmaxq_f32(g, zero), top));
+    uint32x4_t ib = vcvtq_u32_f32(vminq_f32(vmaxq_f32(b, zero), top));
+    uint32x4_t ia = vcvtq_u32_f32(vminq_f32(vmaxq_f32(a, zero), top));
+    uint32x4_t rgba = vorrq_u32(vorrq_u32(ir, vshlq_n_u32(ig, 8)), vorrq_u32(vshlq_n_u32(ib, 16), vshlq_n_u32(ia, 24)));
+    vst1q_u32(out, rgba);
+}
+
+#else
+
+struct float4 { float v[4]; };
+struct mask4 { bool v[4]; };
+
+inline float4 load(const float* p) { float4 r = {{ p[0], p[1], p[2], p[3] }}; return r; }
+inline void store(float* p, float4 v) { p[0] = v.v[0]; p[1] = v.v[1]; p[2] = v.v[2]; p[3] = v.v[3]; }
+inline float4 splat(float f) { float4 r = {{ f, f, f, f }}; return r; }
+
+#define CC_SIMD_LANES(result, expression) \
+    result r; \
+    for (int i = 0; i < 4; ++i) r.v[i] = (expression); \
+    return r;
+
+inline float4 add(float4 a, float4 b) { CC_SIMD_LANES(float4, a.v[i] + b.v[i]) }
+inline float4 sub(float4 a, float4 b) { CC_SIMD_LANES(float4, a.v[i] - b.v[i]) }
+inline float4 mul(float4 a, float4 b) { CC_SIMD_LANES(float4, a.v[i] * b.v[i]) }
+inline float4 div(float4 a, float4 b) { CC_SIMD_LANES(float4, a.v[i] / b.v[i]) }
+inline float4 sqrt4(float4 a) { CC_SIMD_LANES(float4, sqrtf(a.v[i])) }
+inline float4 neg(float4 a) { CC_SIMD_LANES(float4, -a.v[i]) }
+inline float4 maximum(float4 a, float4 b) { CC_SIMD_LANES(float4, a.v[i] > b.v[i] ? a.v[i] : b.v[i]) }
+
+inline mask4 notEqual(float4 a, float4 b) { CC_SIMD_LANES(mask4, !(a.v[i] == b.v[i])) }
+inline mask4 notLess(float4 a, float4 b) { CC_SIMD_LANES(mask4, !(a.v[i] < b.v[i])) }
+inline mask4 both(mask4 a, mask4 b) { CC_SIMD_LANES(mask4, a.v[i] && b.v[i]) }
+inline float4 select(mask4 m, float4 a, float4 b) { CC_SIMD_LANES(float4, m.v[i] ? a.v[i] : b.v[i]) }
+
+#undef CC_SIMD_LANES
+
+inline void toColors(float4 r, float4 g, float4 b, float4 a, uint32_t* out)
+{
+    const float* channels[4] = { r.v, g.v, b.v, a.v };
+    for (int i = 0; i < 4; ++i)
+    {
+        unsigned char* color = reinterpret_cast<unsigned char*>(out + i);
+        for (int c = 0; c < 4; ++c)
+        {
+            float value = channels[c][i];
+            color[c] = static_cast<unsigned char>(value > 255.0f ? 255.0f : (value > 0.0f ? value : 0.0f));
+        }
+    }
+}
+
+#endif
+
+} // namespace SIMD
+
+NS_CC_END
+
+#endif // __CC_SIMD_H__
@@ -41,6 +41,15 @@ static inline void cpBodyUpdateVelocityWithoutGravity(cpBody *body, cpVect gravi
     cpBodyUpdateVelocity(body, cpvzero, damping, dt);
 }
 
+static void cpBodyUpdateVelocityWithDamping(cpBody *body, cpVect gravity, cpFloat damping, cpFloat dt)
+{
+    auto physicsBody = static_cast<cocos2d::PhysicsBody*>(body->data);
+    cpBodyUpdateVelocity(body, physicsBody->isGravityEnabled() ? gravity : cpvzero, damping, dt);
+
+    body->v = cpvmult(body->v, cpfclamp(1.0f - dt * physicsBody->getLinearDamping(), 0.0f, 1.0f));
+    body->w *= cpfclamp(1.0f - dt * physicsBody->getAngularDamping(), 0.0f, 1.0f);
+}
+
 NS_CC_BEGIN
 extern const float PHYSICS_INFINITY;
 
@@ -73,6 +82,11 @@ PhysicsBody::PhysicsBody()
 , _rotationOffset(0)
 , _recordedRotation(0.0f)
 , _recordedAngle(0.0)
+, _previousPosition(Vec2::ZERO)
+, _previousRotation(0.0f)
+, _transformDirtyFlags(0)
+, _prevDirtyBody(nullptr)
+, _nextDirtyBody(nullptr)
 {
 }
 
@@ -258,6 +272,7 @@ bool PhysicsBody::init()
         
         CC_BREAK_IF(_cpBody == nullptr);
         
+        _cpBody->data = this;
         return true;
     } while (false);
     
@@ -322,8 +337,22 @@ void PhysicsBody::setRotationEnable(bool enable)
 void PhysicsBody::setGravityEnable(bool enable)
 {
     _gravityEnabled = enable;
+    updateVelocityFunc();
+}
 
-    if (enable)
+void PhysicsBody::updateDamping()
+{
+    _isDamping = _linearDamping != 0.0f ||  _angularDamping != 0.0f;
+    updateVelocityFunc();
+}
+
+void PhysicsBody::updateVelocityFunc()
+{
+    if (_isDamping)
+    {
+        _cpBody->velocity_func = cpBodyUpdateVelocityWithDamping;
+    }
+    else if (_gravityEnabled)
     {
         _cpBody->velocity_func = cpBodyUpdateVelocity;
     }
@@ -337,12 +366,14 @@ void PhysicsBody::setPosition(const Vec2& position)
 {
     _positionInitDirty = false;
     _recordedPosition = position;
+    _previousPosition = position;
     cpBodySetPos(_cpBody, PhysicsHelper::point2cpv(position + _positionOffset));
 }
 
 void PhysicsBody::setRotation(float rotation)
 {
     _recordedRotation = rotation;
+    _previousRotation = rotation;
     _recordedAngle = - (rotation + _rotationOffset) * (M_PI / 180.0);
     cpBodySetAngle(_cpBody, _recordedAngle);
 }
@@ -759,20 +790,6 @@ void PhysicsBody::setResting(bool rest) const
     }
 }
 
-void PhysicsBody::update(float delta)
-{
-    if (_node)
-    {
-        // damping compute
-        if (_isDamping && _dynamic && !isResting())
-        {
-            _cpBody->v.x *= cpfclamp(1.0f - delta * _linearDamping, 0.0f, 1.0f);
-            _cpBody->v.y *= cpfclamp(1.0f - delta * _linearDamping, 0.0f, 1.0f);
-            _cpBody->w *= cpfclamp(1.0f - delta * _angularDamping, 0.0f, 1.0f);
-        }
-    }
-}
-
 void PhysicsBody::setCategoryBitmask(int bitmask)
 {
     for (auto& shape : _shapes)
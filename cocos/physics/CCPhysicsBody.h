@@ -308,10 +308,10 @@ protected:
     virtual void setRotation(float rotation);
     virtual void setScale(float scaleX, float scaleY);
     
-    void update(float delta);
-    
     void removeJoint(PhysicsJoint* joint);
-    inline void updateDamping() { _isDamping = _linearDamping != 0.0f ||  _angularDamping != 0.0f; }
+    void updateDamping();
+    // gravity and damping are applied by the velocity function of the cpBody, during the step
+    void updateVelocityFunc();
     
 protected:
     PhysicsBody();
@@ -345,6 +345,24 @@ protected:
     float _rotationOffset;
     float _recordedRotation;
     double _recordedAngle;
+
+    // the state before the last fixed step, for the interpolation of the node
+    Vec2 _previousPosition;
+    float _previousRotation;
+
+    // the components of the node transform to copy to the body, see Node::syncPhysicsBodyTransform()
+    enum
+    {
+        TRANSFORM_DIRTY_POSITION = 1 << 0,
+        TRANSFORM_DIRTY_ROTATION = 1 << 1,
+        TRANSFORM_DIRTY_SCALE = 1 << 2,
+        TRANSFORM_DIRTY_ALL = TRANSFORM_DIRTY_POSITION | TRANSFORM_DIRTY_ROTATION | TRANSFORM_DIRTY_SCALE,
+    };
+
+    // the intrusive list of the bodies whose node was moved, see PhysicsWorld::updateDirtyBodies()
+    int _transformDirtyFlags;
+    PhysicsBody* _prevDirtyBody;
+    PhysicsBody* _nextDirtyBody;
     
     friend class PhysicsWorld;
     friend class PhysicsShape;
@@ -45,14 +45,13 @@ PhysicsContact::PhysicsContact()
 , _contactInfo(nullptr)
 , _contactData(nullptr)
 , _preContactData(nullptr)
+, _batched(false)
 {
     
 }
 
 PhysicsContact::~PhysicsContact()
 {
-    CC_SAFE_DELETE(_contactData);
-    CC_SAFE_DELETE(_preContactData);
 }
 
 PhysicsContact* PhysicsContact::construct(PhysicsShape* a, PhysicsShape* b)
@@ -73,8 +72,18 @@ bool PhysicsContact::init(PhysicsShape* a, PhysicsShape* b)
     {
         CC_BREAK_IF(a == nullptr || b == nullptr);
         
+        // the world reuses the separated contacts
+        _world = nullptr;
         _shapeA = a;
         _shapeB = b;
+        _eventCode = EventCode::NONE;
+        _notificationEnable = true;
+        _result = true;
+        _data = nullptr;
+        _contactInfo = nullptr;
+        _contactData = nullptr;
+        _preContactData = nullptr;
+        _batched = false;
         
         return true;
     } while(false);
@@ -90,9 +99,8 @@ void PhysicsContact::generateContactData()
     }
     
     cpArbiter* arb = static_cast<cpArbiter*>(_contactInfo);
-    CC_SAFE_DELETE(_preContactData);
     _preContactData = _contactData;
-    _contactData = new (std::nothrow) PhysicsContactData();
+    _contactData = _contactData == &_contactDataStorage[0] ? &_contactDataStorage[1] : &_contactDataStorage[0];
     _contactData->count = cpArbiterGetCount(arb);
     for (int i=0; i<_contactData->count && i<PhysicsContactData::POINT_MAX; ++i)
     {
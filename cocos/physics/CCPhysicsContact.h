@@ -117,6 +117,10 @@ private:
     void* _contactInfo;
     PhysicsContactData* _contactData;
     PhysicsContactData* _preContactData;
+    // the contact data and the previous one point in here, the contacts are reused by the world
+    PhysicsContactData _contactDataStorage[2];
+    // whether the contact was given to the contact batches of the world
+    bool _batched;
     
     friend class EventListenerPhysicsContact;
     friend class PhysicsWorldCallback;
@@ -122,7 +122,16 @@ void PhysicsJoint::setCollisionEnable(bool enable)
 {
     if (_collisionEnable != enable)
     {
+        // the world keeps the pairs of bodies that don't collide
+        if (_world && !_collisionEnable)
+        {
+            _world->removeCollisionDisabledPair(this);
+        }
         _collisionEnable = enable;
+        if (_world && !_collisionEnable)
+        {
+            _world->addCollisionDisabledPair(this);
+        }
     }
 }
 
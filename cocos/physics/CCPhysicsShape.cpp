@@ -137,6 +137,8 @@ void PhysicsShape::addShape(cpShape* shape)
     if (shape)
     {
         cpShapeSetGroup(shape, _group);
+        // the contact callbacks find the shape without a lookup in s_physicsShapeMap
+        shape->data = this;
         _cpShapes.push_back(shape);
         s_physicsShapeMap.insert(std::pair<cpShape*, PhysicsShape*>(shape, this));
     }
@@ -26,6 +26,7 @@
 #if CC_USE_PHYSICS
 #include <algorithm>
 #include <climits>
+#include <cmath>
 
 #include "chipmunk.h"
 #include "CCPhysicsBody.h"
@@ -40,6 +41,8 @@
 #include "base/CCDirector.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventCustom.h"
+#include "base/CCFrameProfiler.h"
+#include "base/CCJobSystem.h"
 
 NS_CC_BEGIN
 const float PHYSICS_INFINITY = INFINITY;
@@ -52,6 +55,8 @@ const int PhysicsWorld::DEBUGDRAW_JOINT = 0x02;
 const int PhysicsWorld::DEBUGDRAW_CONTACT = 0x04;
 const int PhysicsWorld::DEBUGDRAW_ALL = DEBUGDRAW_SHAPE | DEBUGDRAW_JOINT | DEBUGDRAW_CONTACT;
 
+int PhysicsWorld::s_bodyCount = 0;
+
 namespace
 {
     typedef struct RayCastCallbackInfo
@@ -89,6 +94,8 @@ public:
     static void queryRectCallbackFunc(cpShape *shape, RectQueryCallbackInfo *info);
     static void queryPointFunc(cpShape *shape, cpFloat distance, cpVect point, PointQueryCallbackInfo *info);
     static void getShapesAtPointFunc(cpShape *shape, cpFloat distance, cpVect point, Vector<PhysicsShape*>* arr);
+    static cpVect shapeVelocityFunc(cpShape *shape);
+    static void copyShapeFunc(cpShape *shape, cpSpatialIndex *index);
     
 public:
     static bool continues;
@@ -100,11 +107,7 @@ int PhysicsWorldCallback::collisionBeginCallbackFunc(cpArbiter *arb, struct cpSp
 {
     CP_ARBITER_GET_SHAPES(arb, a, b);
     
-    auto ita = s_physicsShapeMap.find(a);
-    auto itb = s_physicsShapeMap.find(b);
-    CC_ASSERT(ita != s_physicsShapeMap.end() && itb != s_physicsShapeMap.end());
-    
-    auto contact = PhysicsContact::construct(ita->second, itb->second);
+    auto contact = world->obtainContact(static_cast<PhysicsShape*>(a->data), static_cast<PhysicsShape*>(b->data));
     arb->data = contact;
     contact->_contactInfo = arb;
     
@@ -127,7 +130,21 @@ void PhysicsWorldCallback::collisionSeparateCallbackFunc(cpArbiter *arb, cpSpace
     
     world->collisionSeparateCallback(*contact);
     
-    delete contact;
+    if (contact->_batched && cpSpaceIsLocked(space))
+    {
+        // given to the batches after the step
+        world->batchContact(contact, false);
+        world->_separatedContacts.push_back(contact);
+    }
+    else
+    {
+        // outside of a step the shapes are being removed and released right after, the separation is given now
+        if (contact->_batched)
+        {
+            world->deliverSeparatedContact(contact);
+        }
+        world->recycleContact(contact);
+    }
 }
 
 void PhysicsWorldCallback::rayCastCallbackFunc(cpShape *shape, cpFloat t, cpVect n, RayCastCallbackInfo *info)
@@ -176,6 +193,16 @@ void PhysicsWorldCallback::getShapesAtPointFunc(cpShape *shape, cpFloat distance
     arr->pushBack(it->second);
 }
 
+cpVect PhysicsWorldCallback::shapeVelocityFunc(cpShape *shape)
+{
+    return shape->body->v;
+}
+
+void PhysicsWorldCallback::copyShapeFunc(cpShape *shape, cpSpatialIndex *index)
+{
+    cpSpatialIndexInsert(index, shape, shape->CP_PRIVATE(hashid));
+}
+
 void PhysicsWorldCallback::queryPointFunc(cpShape *shape, cpFloat distance, cpVect point, PointQueryCallbackInfo *info)
 {
     auto it = s_physicsShapeMap.find(shape);
@@ -185,6 +212,213 @@ void PhysicsWorldCallback::queryPointFunc(cpShape *shape, cpFloat distance, cpVe
     PhysicsWorldCallback::continues = info->func(*info->world, *it->second, info->data);
 }
 
+/**
+ * The bounding boxes of the shapes in a uniform grid. The parallel queries run against it:
+ * the queries of chipmunk lock the space and the spatial hash marks the shapes it visits, they can't run on several threads.
+ * The shapes are only read, the space must not be stepped while the snapshot is used.
+ */
+class PhysicsQuerySnapshot
+{
+public:
+    void build(cpSpace* space, float cellSize);
+    void rayCast(const Vec2& start, const Vec2& end, PhysicsRayCastResult& result) const;
+    void queryRect(const Rect& rect, std::vector<PhysicsShape*>& shapes) const;
+    
+protected:
+    struct Entry
+    {
+        cpBB bb;
+        cpShape* shape;
+    };
+    
+    int cellX(cpFloat x) const { return std::min(std::max(static_cast<int>((x - _bounds.l) / _cellSize), 0), _cols - 1); }
+    int cellY(cpFloat y) const { return std::min(std::max(static_cast<int>((y - _bounds.b) / _cellSize), 0), _rows - 1); }
+    
+    std::vector<Entry> _entries;
+    // the entries of the cell i are _cellEntries[_cellStarts[i]] to _cellEntries[_cellStarts[i + 1] - 1]
+    std::vector<int> _cellStarts;
+    std::vector<int> _cellEntries;
+    cpBB _bounds;
+    cpFloat _cellSize;
+    int _cols;
+    int _rows;
+};
+
+void PhysicsQuerySnapshot::build(cpSpace* space, float cellSize)
+{
+    _entries.clear();
+    cpSpaceEachShape(space, [](cpShape* shape, void* data)
+    {
+        Entry entry = { cpShapeGetBB(shape), shape };
+        static_cast<std::vector<Entry>*>(data)->push_back(entry);
+    }, &_entries);
+    
+    _bounds = cpBBNew(0, 0, 0, 0);
+    cpFloat averageSize = 0;
+    for (size_t i = 0; i < _entries.size(); ++i)
+    {
+        const cpBB& bb = _entries[i].bb;
+        _bounds = i == 0 ? bb : cpBBMerge(_bounds, bb);
+        averageSize += (bb.r - bb.l + bb.t - bb.b) * 0.5f;
+    }
+    
+    // the cells of the spatial hash, or about twice the size of the shapes
+    _cellSize = cellSize > 0 ? cellSize : 2 * averageSize / std::max<size_t>(_entries.size(), 1);
+    cpFloat width = std::max<cpFloat>(_bounds.r - _bounds.l, 1);
+    cpFloat height = std::max<cpFloat>(_bounds.t - _bounds.b, 1);
+    _cellSize = std::max<cpFloat>(_cellSize, std::sqrt(width * height / 65536));
+    _cellSize = std::max<cpFloat>(_cellSize, 1);
+    // the grid is clamped to 1024 cells a side, the cells cover the whole bounds
+    _cellSize = std::max<cpFloat>(_cellSize, std::max(width, height) / 1024);
+    _cols = std::min(static_cast<int>(width / _cellSize) + 1, 1024);
+    _rows = std::min(static_cast<int>(height / _cellSize) + 1, 1024);
+    
+    // counts the entries of each cell, then fills the cells
+    _cellStarts.assign(_cols * _rows + 1, 0);
+    for (const auto& entry : _entries)
+    {
+        for (int y = cellY(entry.bb.b); y <= cellY(entry.bb.t); ++y)
+        {
+            for (int x = cellX(entry.bb.l); x <= cellX(entry.bb.r); ++x)
+            {
+                ++_cellStarts[y * _cols + x + 1];
+            }
+        }
+    }
+    for (size_t i = 1; i < _cellStarts.size(); ++i)
+    {
+        _cellStarts[i] += _cellStarts[i - 1];
+    }
+    
+    _cellEntries.resize(_cellStarts.back());
+    std::vector<int> fill(_cellStarts.begin(), _cellStarts.end() - 1);
+    for (int i = 0; i < static_cast<int>(_entries.size()); ++i)
+    {
+        const cpBB& bb = _entries[i].bb;
+        for (int y = cellY(bb.b); y <= cellY(bb.t); ++y)
+        {
+            for (int x = cellX(bb.l); x <= cellX(bb.r); ++x)
+            {
+                _cellEntries[fill[y * _cols + x]++] = i;
+            }
+        }
+    }
+}
+
+void PhysicsQuerySnapshot::rayCast(const Vec2& start, const Vec2& end, PhysicsRayCastResult& result) const
+{
+    result.shape = nullptr;
+    result.fraction = 1.0f;
+    
+    cpVect a = PhysicsHelper::point2cpv(start);
+    cpVect b = PhysicsHelper::point2cpv(end);
+    cpVect d = cpvsub(b, a);
+    
+    // the part of the ray in the grid
+    cpFloat t0 = 0, t1 = 1;
+    const cpFloat mins[2] = { _bounds.l, _bounds.b };
+    const cpFloat maxs[2] = { _bounds.r, _bounds.t };
+    const cpFloat origins[2] = { a.x, a.y };
+    const cpFloat directions[2] = { d.x, d.y };
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        if (directions[axis] == 0)
+        {
+            if (origins[axis] < mins[axis] || origins[axis] > maxs[axis])
+                return;
+            continue;
+        }
+        cpFloat enter = (mins[axis] - origins[axis]) / directions[axis];
+        cpFloat exit = (maxs[axis] - origins[axis]) / directions[axis];
+        if (enter > exit)
+            std::swap(enter, exit);
+        t0 = std::max(t0, enter);
+        t1 = std::min(t1, exit);
+        if (t0 > t1)
+            return;
+    }
+    
+    // walks the cells along the ray
+    cpVect p = cpvadd(a, cpvmult(d, t0));
+    int x = cellX(p.x);
+    int y = cellY(p.y);
+    int stepX = d.x > 0 ? 1 : -1;
+    int stepY = d.y > 0 ? 1 : -1;
+    cpFloat tMaxX = d.x != 0 ? (_bounds.l + (x + (stepX > 0 ? 1 : 0)) * _cellSize - a.x) / d.x : INFINITY;
+    cpFloat tMaxY = d.y != 0 ? (_bounds.b + (y + (stepY > 0 ? 1 : 0)) * _cellSize - a.y) / d.y : INFINITY;
+    cpFloat tDeltaX = d.x != 0 ? _cellSize / std::abs(d.x) : INFINITY;
+    cpFloat tDeltaY = d.y != 0 ? _cellSize / std::abs(d.y) : INFINITY;
+    
+    cpSegmentQueryInfo best = { nullptr, 1, cpvzero };
+    for (int visited = _cols + _rows; visited >= 0; --visited)
+    {
+        int cell = y * _cols + x;
+        for (int i = _cellStarts[cell]; i < _cellStarts[cell + 1]; ++i)
+        {
+            const Entry& entry = _entries[_cellEntries[i]];
+            cpSegmentQueryInfo info;
+            if (cpBBIntersectsSegment(entry.bb, a, b) && cpShapeSegmentQuery(entry.shape, a, b, &info) && (best.shape == nullptr || info.t < best.t))
+            {
+                best = info;
+            }
+        }
+        
+        // a hit before the end of the cell can't be hidden by the shapes of the next cells
+        cpFloat cellEnd = std::min(tMaxX, tMaxY);
+        if ((best.shape && best.t <= cellEnd) || cellEnd > t1)
+            break;
+        
+        if (tMaxX < tMaxY)
+        {
+            x += stepX;
+            tMaxX += tDeltaX;
+        }
+        else
+        {
+            y += stepY;
+            tMaxY += tDeltaY;
+        }
+        if (x < 0 || x >= _cols || y < 0 || y >= _rows)
+            break;
+    }
+    
+    if (best.shape)
+    {
+        result.shape = static_cast<PhysicsShape*>(best.shape->data);
+        result.contact = PhysicsHelper::cpv2point(cpvadd(a, cpvmult(d, best.t)));
+        result.normal = PhysicsHelper::cpv2point(best.n);
+        result.fraction = static_cast<float>(best.t);
+    }
+}
+
+void PhysicsQuerySnapshot::queryRect(const Rect& rect, std::vector<PhysicsShape*>& shapes) const
+{
+    cpBB bb = PhysicsHelper::rect2cpbb(rect);
+    if (_entries.empty() || !cpBBIntersects(bb, _bounds))
+        return;
+    
+    size_t first = shapes.size();
+    for (int y = cellY(bb.b); y <= cellY(bb.t); ++y)
+    {
+        for (int x = cellX(bb.l); x <= cellX(bb.r); ++x)
+        {
+            int cell = y * _cols + x;
+            for (int i = _cellStarts[cell]; i < _cellStarts[cell + 1]; ++i)
+            {
+                const Entry& entry = _entries[_cellEntries[i]];
+                if (cpBBIntersects(entry.bb, bb))
+                {
+                    shapes.push_back(static_cast<PhysicsShape*>(entry.shape->data));
+                }
+            }
+        }
+    }
+    
+    // a shape is in several cells, and made of several chipmunk shapes
+    std::sort(shapes.begin() + first, shapes.end());
+    shapes.erase(std::unique(shapes.begin() + first, shapes.end()), shapes.end());
+}
+
 void PhysicsWorld::debugDraw()
 {
     if (_debugDraw == nullptr)
@@ -235,26 +469,13 @@ int PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
     PhysicsShape* shapeB = contact.getShapeB();
     PhysicsBody* bodyA = shapeA->getBody();
     PhysicsBody* bodyB = shapeB->getBody();
-    std::vector<PhysicsJoint*> jointsA = bodyA->getJoints();
     
     // check the joint is collision enable or not
-    for (PhysicsJoint* joint : jointsA)
+    if (!_collisionDisabledPairs.empty()
+        && _collisionDisabledPairs.find(std::minmax(bodyA, bodyB)) != _collisionDisabledPairs.end())
     {
-        if (std::find(_joints.begin(), _joints.end(), joint) == _joints.end())
-        {
-            continue;
-        }
-        
-        if (!joint->isCollisionEnabled())
-        {
-            PhysicsBody* body = joint->getBodyA() == bodyA ? joint->getBodyB() : joint->getBodyA();
-            
-            if (body == bodyB)
-            {
-                contact.setNotificationEnable(false);
-                return false;
-            }
-        }
+        contact.setNotificationEnable(false);
+        return false;
     }
     
     // bitmask check
@@ -279,9 +500,17 @@ int PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
     
     if (contact.isNotificationEnabled())
     {
-        contact.setEventCode(PhysicsContact::EventCode::BEGIN);
-        contact.setWorld(this);
-        _scene->getEventDispatcher()->dispatchEvent(&contact);
+        if (!_contactBatches.empty())
+        {
+            batchContact(&contact, true);
+        }
+        
+        if (_contactListenersEnabled)
+        {
+            contact.setEventCode(PhysicsContact::EventCode::BEGIN);
+            contact.setWorld(this);
+            _scene->getEventDispatcher()->dispatchEvent(&contact);
+        }
     }
     
     return ret ? contact.resetResult() : false;
@@ -289,7 +518,7 @@ int PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
 
 int PhysicsWorld::collisionPreSolveCallback(PhysicsContact& contact)
 {
-    if (!contact.isNotificationEnabled())
+    if (!contact.isNotificationEnabled() || !_contactListenersEnabled)
     {
         return true;
     }
@@ -303,7 +532,7 @@ int PhysicsWorld::collisionPreSolveCallback(PhysicsContact& contact)
 
 void PhysicsWorld::collisionPostSolveCallback(PhysicsContact& contact)
 {
-    if (!contact.isNotificationEnabled())
+    if (!contact.isNotificationEnabled() || !_contactListenersEnabled)
     {
         return;
     }
@@ -315,7 +544,7 @@ void PhysicsWorld::collisionPostSolveCallback(PhysicsContact& contact)
 
 void PhysicsWorld::collisionSeparateCallback(PhysicsContact& contact)
 {
-    if (!contact.isNotificationEnabled())
+    if (!contact.isNotificationEnabled() || !_contactListenersEnabled)
     {
         return;
     }
@@ -331,11 +560,7 @@ void PhysicsWorld::rayCast(PhysicsRayCastCallbackFunc func, const Vec2& point1,
     
     if (func != nullptr)
     {
-        if (!_delayAddBodies.empty() || !_delayRemoveBodies.empty())
-        {
-            _scene->updatePhysicsBodyTransform(_scene->getNodeToParentTransform(), 0, 1.0f, 1.0f);
-            updateBodies();
-        }
+        prepareQuery();
         RayCastCallbackInfo info = { this, func, point1, point2, data };
         
         PhysicsWorldCallback::continues = true;
@@ -355,11 +580,7 @@ void PhysicsWorld::queryRect(PhysicsQueryRectCallbackFunc func, const Rect& rect
     
     if (func != nullptr)
     {
-        if (!_delayAddBodies.empty() || !_delayRemoveBodies.empty())
-        {
-            _scene->updatePhysicsBodyTransform(_scene->getNodeToParentTransform(), 0, 1.0f, 1.0f);
-            updateBodies();
-        }
+        prepareQuery();
         RectQueryCallbackInfo info = {this, func, data};
         
         PhysicsWorldCallback::continues = true;
@@ -378,11 +599,7 @@ void PhysicsWorld::queryPoint(PhysicsQueryPointCallbackFunc func, const Vec2& po
     
     if (func != nullptr)
     {
-        if (!_delayAddBodies.empty() || !_delayRemoveBodies.empty())
-        {
-            _scene->updatePhysicsBodyTransform(_scene->getNodeToParentTransform(), 0, 1.0f, 1.0f);
-            updateBodies();
-        }
+        prepareQuery();
         PointQueryCallbackInfo info = {this, func, data};
         
         PhysicsWorldCallback::continues = true;
@@ -396,6 +613,130 @@ void PhysicsWorld::queryPoint(PhysicsQueryPointCallbackFunc func, const Vec2& po
     }
 }
 
+void PhysicsWorld::prepareQuery()
+{
+    if (_dirtyBodies || !_delayAddBodies.empty() || !_delayRemoveBodies.empty())
+    {
+        updateDirtyBodies();
+        updateBodies();
+    }
+}
+
+PhysicsQuerySnapshot* PhysicsWorld::getQuerySnapshot()
+{
+    if (_querySnapshot == nullptr)
+    {
+        _querySnapshot = new (std::nothrow) PhysicsQuerySnapshot();
+        _querySnapshotDirty = true;
+    }
+    
+    if (_querySnapshotDirty)
+    {
+        _querySnapshot->build(_cpSpace, _broadphase == Broadphase::SPATIAL_HASH ? _broadphaseCellSize : 0.0f);
+        _querySnapshotDirty = false;
+    }
+    
+    return _querySnapshot;
+}
+
+void PhysicsWorld::rayCastBatch(const Vec2* starts, const Vec2* ends, size_t count, std::vector<PhysicsRayCastResult>& results, bool parallel/* = false*/)
+{
+    CC_PROFILE_ZONE("PhysicsWorld::rayCastBatch");
+    
+    results.resize(count);
+    if (count == 0)
+        return;
+    
+    prepareQuery();
+    
+    if (parallel)
+    {
+        const PhysicsQuerySnapshot* snapshot = getQuerySnapshot();
+        JobSystem::getInstance()->parallelFor(count, 16, [snapshot, starts, ends, &results](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                snapshot->rayCast(starts[i], ends[i], results[i]);
+            }
+        });
+        return;
+    }
+    
+    for (size_t i = 0; i < count; ++i)
+    {
+        cpVect a = PhysicsHelper::point2cpv(starts[i]);
+        cpVect b = PhysicsHelper::point2cpv(ends[i]);
+        cpSegmentQueryInfo info;
+        cpShape* shape = cpSpaceSegmentQueryFirst(_cpSpace, a, b, CP_ALL_LAYERS, CP_NO_GROUP, &info);
+        
+        PhysicsRayCastResult& result = results[i];
+        result.shape = shape ? static_cast<PhysicsShape*>(shape->data) : nullptr;
+        result.fraction = shape ? static_cast<float>(info.t) : 1.0f;
+        if (shape)
+        {
+            result.contact = PhysicsHelper::cpv2point(cpvlerp(a, b, info.t));
+            result.normal = PhysicsHelper::cpv2point(info.n);
+        }
+    }
+}
+
+void PhysicsWorld::queryRectBatch(const Rect* rects, size_t count, std::vector<PhysicsShape*>& shapes, std::vector<int>& offsets, bool parallel/* = false*/)
+{
+    CC_PROFILE_ZONE("PhysicsWorld::queryRectBatch");
+    
+    shapes.clear();
+    offsets.assign(count + 1, 0);
+    if (count == 0)
+        return;
+    
+    prepareQuery();
+    
+    if (parallel)
+    {
+        // each range of rects fills its own array, they are appended in order afterwards
+        const PhysicsQuerySnapshot* snapshot = getQuerySnapshot();
+        size_t rangeSize = 16;
+        size_t rangeCount = (count + rangeSize - 1) / rangeSize;
+        std::vector<std::vector<PhysicsShape*>> rangeShapes(rangeCount);
+        JobSystem::getInstance()->parallelFor(rangeCount, 1, [&](size_t begin, size_t end)
+        {
+            for (size_t range = begin; range < end; ++range)
+            {
+                for (size_t i = range * rangeSize; i < std::min(count, (range + 1) * rangeSize); ++i)
+                {
+                    snapshot->queryRect(rects[i], rangeShapes[range]);
+                    offsets[i + 1] = static_cast<int>(rangeShapes[range].size());
+                }
+            }
+        });
+        
+        for (size_t range = 0; range < rangeCount; ++range)
+        {
+            int base = static_cast<int>(shapes.size());
+            for (size_t i = range * rangeSize; i < std::min(count, (range + 1) * rangeSize); ++i)
+            {
+                offsets[i + 1] += base;
+            }
+            shapes.insert(shapes.end(), rangeShapes[range].begin(), rangeShapes[range].end());
+        }
+        return;
+    }
+    
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t first = shapes.size();
+        cpSpaceBBQuery(_cpSpace, PhysicsHelper::rect2cpbb(rects[i]), CP_ALL_LAYERS, CP_NO_GROUP, [](cpShape* shape, void* data)
+        {
+            static_cast<std::vector<PhysicsShape*>*>(data)->push_back(static_cast<PhysicsShape*>(shape->data));
+        }, &shapes);
+        
+        // a shape can be made of several chipmunk shapes
+        std::sort(shapes.begin() + first, shapes.end());
+        shapes.erase(std::unique(shapes.begin() + first, shapes.end()), shapes.end());
+        offsets[i + 1] = static_cast<int>(shapes.size());
+    }
+}
+
 Vector<PhysicsShape*> PhysicsWorld::getShapes(const Vec2& point) const
 {
     Vector<PhysicsShape*> arr;
@@ -475,6 +816,8 @@ void PhysicsWorld::addBody(PhysicsBody* body)
     addBodyOrDelay(body);
     _bodies.pushBack(body);
     body->_world = this;
+    ++s_bodyCount;
+    addDirtyBody(body);
 }
 
 void PhysicsWorld::doAddBody(PhysicsBody* body)
@@ -562,8 +905,10 @@ void PhysicsWorld::removeBody(PhysicsBody* body)
     body->_joints.clear();
     
     removeBodyOrDelay(body);
+    removeDirtyBody(body);
     _bodies.eraseObject(body);
     body->_world = nullptr;
+    --s_bodyCount;
 }
 
 
@@ -632,6 +977,10 @@ void PhysicsWorld::updateJoints()
         if (joint->initJoint())
         {
             _joints.push_back(joint);
+            if (!joint->isCollisionEnabled())
+            {
+                addCollisionDisabledPair(joint);
+            }
         }
         else
         {
@@ -658,6 +1007,7 @@ void PhysicsWorld::removeShape(PhysicsShape* shape)
                 cpSpaceRemoveShape(_cpSpace, cps);
             }
         }
+        _querySnapshotDirty = true;
     }
 }
 
@@ -701,6 +1051,7 @@ void PhysicsWorld::addShape(PhysicsShape* physicsShape)
         {
             cpSpaceAddShape(_cpSpace, shape);
         }
+        _querySnapshotDirty = true;
     }
 }
 
@@ -727,6 +1078,10 @@ void PhysicsWorld::doRemoveJoint(PhysicsJoint* joint)
     {
         cpSpaceRemoveConstraint(_cpSpace, constraint);
     }
+    if (joint->_world == this && !joint->isCollisionEnabled())
+    {
+        removeCollisionDisabledPair(joint);
+    }
     _joints.remove(joint);
     joint->_world = nullptr;
 
@@ -751,9 +1106,11 @@ void PhysicsWorld::removeAllBodies()
     for (auto& child : _bodies)
     {
         removeBodyOrDelay(child);
+        removeDirtyBody(child);
         child->_world = nullptr;
     }
     
+    s_bodyCount -= static_cast<int>(_bodies.size());
     _bodies.clear();
 }
 
@@ -803,6 +1160,45 @@ void PhysicsWorld::setSubsteps(int steps)
     }
 }
 
+void PhysicsWorld::setBroadphase(Broadphase broadphase, float cellSize/* = 50.0f*/, int cellCount/* = 1000*/)
+{
+    CCASSERT(!cpSpaceIsLocked(_cpSpace), "the broadphase can't be changed during a step");
+    CCASSERT(cellSize > 0 && cellCount > 0, "the cell size and the cell count should be greater than 0");
+    
+    if (broadphase == Broadphase::SPATIAL_HASH)
+    {
+        // the shapes are moved to the new hash, the size of its cells can be changed at any time
+        cpSpaceUseSpatialHash(_cpSpace, PhysicsHelper::float2cpfloat(cellSize), cellCount);
+    }
+    else if (_broadphase != Broadphase::BB_TREE)
+    {
+        // chipmunk can't go back to its trees, they are built again like cpSpaceInit() does
+        cpSpatialIndex* staticShapes = cpBBTreeNew((cpSpatialIndexBBFunc)cpShapeGetBB, nullptr);
+        cpSpatialIndex* activeShapes = cpBBTreeNew((cpSpatialIndexBBFunc)cpShapeGetBB, staticShapes);
+        cpBBTreeSetVelocityFunc(activeShapes, (cpBBTreeVelocityFunc)PhysicsWorldCallback::shapeVelocityFunc);
+        
+        cpSpatialIndexEach(_cpSpace->CP_PRIVATE(staticShapes), (cpSpatialIndexIteratorFunc)PhysicsWorldCallback::copyShapeFunc, staticShapes);
+        cpSpatialIndexEach(_cpSpace->CP_PRIVATE(activeShapes), (cpSpatialIndexIteratorFunc)PhysicsWorldCallback::copyShapeFunc, activeShapes);
+        cpSpatialIndexFree(_cpSpace->CP_PRIVATE(staticShapes));
+        cpSpatialIndexFree(_cpSpace->CP_PRIVATE(activeShapes));
+        _cpSpace->CP_PRIVATE(staticShapes) = staticShapes;
+        _cpSpace->CP_PRIVATE(activeShapes) = activeShapes;
+    }
+    
+    _broadphase = broadphase;
+    _broadphaseCellSize = cellSize;
+    _broadphaseCellCount = cellCount;
+    _querySnapshotDirty = true;
+}
+
+void PhysicsWorld::setFixedTimestep(float timestep, int maxSteps/* = 5*/)
+{
+    _fixedTimestep = std::max(timestep, 0.0f);
+    _maxFixedSteps = std::max(maxSteps, 1);
+    _accumulatedTime = 0.0f;
+    _interpolationAlpha = 1.0f;
+}
+
 void PhysicsWorld::step(float delta)
 {
     if (_autoStep)
@@ -815,6 +1211,235 @@ void PhysicsWorld::step(float delta)
     }
 }
 
+void PhysicsWorld::addDirtyBody(PhysicsBody* body, int flags)
+{
+    if (body->_transformDirtyFlags == 0)
+    {
+        body->_prevDirtyBody = nullptr;
+        body->_nextDirtyBody = _dirtyBodies;
+        if (_dirtyBodies)
+        {
+            _dirtyBodies->_prevDirtyBody = body;
+        }
+        _dirtyBodies = body;
+    }
+    body->_transformDirtyFlags |= flags;
+}
+
+void PhysicsWorld::removeDirtyBody(PhysicsBody* body)
+{
+    if (body->_transformDirtyFlags != 0)
+    {
+        if (body->_prevDirtyBody)
+        {
+            body->_prevDirtyBody->_nextDirtyBody = body->_nextDirtyBody;
+        }
+        else
+        {
+            _dirtyBodies = body->_nextDirtyBody;
+        }
+        if (body->_nextDirtyBody)
+        {
+            body->_nextDirtyBody->_prevDirtyBody = body->_prevDirtyBody;
+        }
+        body->_transformDirtyFlags = 0;
+        body->_prevDirtyBody = nullptr;
+        body->_nextDirtyBody = nullptr;
+    }
+}
+
+void PhysicsWorld::updateDirtyBodies()
+{
+    while (_dirtyBodies)
+    {
+        PhysicsBody* body = _dirtyBodies;
+        int flags = body->_transformDirtyFlags;
+        removeDirtyBody(body);
+        if (body->_node)
+        {
+            body->_node->syncPhysicsBodyTransform(flags);
+        }
+    }
+}
+
+PhysicsContact* PhysicsWorld::obtainContact(PhysicsShape* shapeA, PhysicsShape* shapeB)
+{
+    if (_contactPool.empty())
+    {
+        return PhysicsContact::construct(shapeA, shapeB);
+    }
+    
+    PhysicsContact* contact = _contactPool.back();
+    _contactPool.pop_back();
+    contact->init(shapeA, shapeB);
+    return contact;
+}
+
+void PhysicsWorld::recycleContact(PhysicsContact* contact)
+{
+    _contactPool.push_back(contact);
+}
+
+void PhysicsWorld::batchContact(PhysicsContact* contact, bool began)
+{
+    int categoryBitmask = contact->getShapeA()->getCategoryBitmask() | contact->getShapeB()->getCategoryBitmask();
+    for (auto& batch : _contactBatches)
+    {
+        if (!batch.removed && (batch.categoryBitmask & categoryBitmask) != 0)
+        {
+            if (began)
+            {
+                batch.began.push_back(contact);
+                contact->_batched = true;
+            }
+            else
+            {
+                batch.separated.push_back(contact);
+            }
+        }
+    }
+    
+    // the arbiter is only valid during the step
+    if (began && contact->_batched)
+    {
+        contact->generateContactData();
+    }
+}
+
+void PhysicsWorld::deliverContactBatches()
+{
+    _deliveringContacts = true;
+    for (auto& batch : _contactBatches)
+    {
+        if (!batch.removed && (!batch.began.empty() || !batch.separated.empty()))
+        {
+            batch.func(*this, batch.began, batch.separated);
+        }
+        batch.began.clear();
+        batch.separated.clear();
+    }
+    _deliveringContacts = false;
+    
+    _contactBatches.remove_if([](const ContactBatch& batch) { return batch.removed; });
+    
+    for (auto contact : _separatedContacts)
+    {
+        recycleContact(contact);
+    }
+    _separatedContacts.clear();
+}
+
+void PhysicsWorld::deliverSeparatedContact(PhysicsContact* contact)
+{
+    int categoryBitmask = contact->getShapeA()->getCategoryBitmask() | contact->getShapeB()->getCategoryBitmask();
+    std::vector<PhysicsContact*> began;
+    std::vector<PhysicsContact*> separated(1, contact);
+    
+    // may happen while the batches are delivered, when a callback removes a body
+    bool delivering = _deliveringContacts;
+    _deliveringContacts = true;
+    for (auto& batch : _contactBatches)
+    {
+        if (!batch.removed && (batch.categoryBitmask & categoryBitmask) != 0)
+        {
+            batch.func(*this, began, separated);
+        }
+    }
+    _deliveringContacts = delivering;
+    
+    if (!_deliveringContacts)
+    {
+        _contactBatches.remove_if([](const ContactBatch& batch) { return batch.removed; });
+    }
+}
+
+int PhysicsWorld::addContactBatchCallback(const PhysicsContactBatchCallbackFunc& func, int categoryBitmask/* = UINT_MAX*/)
+{
+    CCASSERT(func != nullptr, "func shouldn't be nullptr");
+    
+    ContactBatch batch;
+    batch.id = ++_contactBatchId;
+    batch.categoryBitmask = categoryBitmask;
+    batch.removed = false;
+    batch.func = func;
+    _contactBatches.push_back(batch);
+    return batch.id;
+}
+
+void PhysicsWorld::removeContactBatchCallback(int callbackId)
+{
+    for (auto& batch : _contactBatches)
+    {
+        if (batch.id == callbackId)
+        {
+            batch.removed = true;
+        }
+    }
+    
+    if (!_deliveringContacts)
+    {
+        _contactBatches.remove_if([](const ContactBatch& batch) { return batch.removed; });
+    }
+}
+
+void PhysicsWorld::addCollisionDisabledPair(PhysicsJoint* joint)
+{
+    if (joint->getBodyA() && joint->getBodyB())
+    {
+        ++_collisionDisabledPairs[std::minmax(joint->getBodyA(), joint->getBodyB())];
+    }
+}
+
+void PhysicsWorld::removeCollisionDisabledPair(PhysicsJoint* joint)
+{
+    auto it = _collisionDisabledPairs.find(std::minmax(joint->getBodyA(), joint->getBodyB()));
+    if (it != _collisionDisabledPairs.end() && --it->second == 0)
+    {
+        _collisionDisabledPairs.erase(it);
+    }
+}
+
+void PhysicsWorld::stepSpace(float delta)
+{
+    // no event is built when nobody listens to the contacts
+    _contactListenersEnabled = _scene->getEventDispatcher()->hasEventListener(PHYSICSCONTACT_EVENT_NAME);
+    
+    cpSpaceStep(_cpSpace, delta);
+    _querySnapshotDirty = true;
+    
+    if (!_contactBatches.empty() || !_separatedContacts.empty())
+    {
+        deliverContactBatches();
+    }
+}
+
+void PhysicsWorld::stepFixed(float delta)
+{
+    _accumulatedTime += delta * _speed;
+    int steps = static_cast<int>(_accumulatedTime / _fixedTimestep);
+    if (steps > _maxFixedSteps)
+    {
+        // don't spiral: the world falls behind instead of taking longer and longer frames
+        steps = _maxFixedSteps;
+        _accumulatedTime = steps * _fixedTimestep;
+    }
+
+    for (int i = 0; i < steps; ++i)
+    {
+        if (_interpolationEnabled && i == steps - 1)
+        {
+            for (auto& body : _bodies)
+            {
+                body->_previousPosition = body->getPosition();
+                body->_previousRotation = body->getRotation();
+            }
+        }
+        stepSpace(_fixedTimestep);
+    }
+    _accumulatedTime -= steps * _fixedTimestep;
+    _interpolationAlpha = _interpolationEnabled ? std::min(_accumulatedTime / _fixedTimestep, 1.0f) : 1.0f;
+}
+
 void PhysicsWorld::update(float delta, bool userCall/* = false*/)
 {
     if (delta < FLT_EPSILON)
@@ -822,11 +1447,12 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
         return;
     }
 
-    if(_updateBodyTransform || !_delayAddBodies.empty())
+    CC_PROFILE_ZONE("PhysicsWorld::update");
+
+    if(_dirtyBodies || !_delayAddBodies.empty())
     {
-        _scene->updatePhysicsBodyTransform(_scene->getNodeToParentTransform(), 0, 1.0f, 1.0f);
+        updateDirtyBodies();
         updateBodies();
-        _updateBodyTransform = false;
     }
     else if (!_delayRemoveBodies.empty())
     {
@@ -838,13 +1464,14 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
         updateJoints();
     }
     
+    // the damping of the bodies is applied by chipmunk, see PhysicsBody::updateVelocityFunc()
     if (userCall)
     {
-        cpSpaceStep(_cpSpace, delta);
-        for (auto& body : _bodies)
-        {
-            body->update(delta);
-        }
+        stepSpace(delta);
+    }
+    else if (_fixedTimestep > 0.0f)
+    {
+        stepFixed(delta);
     }
     else
     {
@@ -854,11 +1481,7 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
             const float dt = _updateTime * _speed / _substeps;
             for (int i = 0; i < _substeps; ++i)
             {
-                cpSpaceStep(_cpSpace, dt);
-                for (auto& body : _bodies)
-                {
-                    body->update(dt);
-                }
+                stepSpace(dt);
             }
             _updateRateCount = 0;
             _updateTime = 0.0f;
@@ -880,10 +1503,23 @@ PhysicsWorld::PhysicsWorld()
 , _substeps(1)
 , _cpSpace(nullptr)
 , _scene(nullptr)
+, _dirtyBodies(nullptr)
 , _autoStep(true)
+, _fixedTimestep(0.0f)
+, _maxFixedSteps(5)
+, _accumulatedTime(0.0f)
+, _interpolationEnabled(false)
+, _interpolationAlpha(1.0f)
 , _debugDraw(nullptr)
 , _debugDrawMask(DEBUGDRAW_NONE)
-, _updateBodyTransform(false)
+, _contactListenersEnabled(true)
+, _contactBatchId(0)
+, _deliveringContacts(false)
+, _broadphase(Broadphase::BB_TREE)
+, _broadphaseCellSize(50.0f)
+, _broadphaseCellCount(1000)
+, _querySnapshot(nullptr)
+, _querySnapshotDirty(true)
 {
     
 }
@@ -897,6 +1533,16 @@ PhysicsWorld::~PhysicsWorld()
         cpSpaceFree(_cpSpace);
     }
     CC_SAFE_DELETE(_debugDraw);
+    
+    for (auto contact : _separatedContacts)
+    {
+        delete contact;
+    }
+    for (auto contact : _contactPool)
+    {
+        delete contact;
+    }
+    CC_SAFE_DELETE(_querySnapshot);
 }
 
 PhysicsDebugDraw::PhysicsDebugDraw(PhysicsWorld& world)
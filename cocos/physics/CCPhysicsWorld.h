@@ -32,7 +32,9 @@
 #include "base/CCRef.h"
 #include "math/CCGeometry.h"
 #include "physics/CCPhysicsBody.h"
+#include <climits>
 #include <list>
+#include <unordered_map>
 
 struct cpSpace;
 
@@ -51,6 +53,7 @@ class Sprite;
 class Scene;
 class DrawNode;
 class PhysicsDebugDraw;
+class PhysicsQuerySnapshot;
 
 class PhysicsWorld;
 
@@ -65,6 +68,15 @@ typedef struct PhysicsRayCastInfo
     void* data;
 }PhysicsRayCastInfo;
 
+/** The first shape hit by a ray of PhysicsWorld::rayCastBatch() */
+typedef struct PhysicsRayCastResult
+{
+    PhysicsShape* shape;    ///< nullptr when the ray doesn't hit any shape
+    Vec2 contact;
+    Vect normal;
+    float fraction;
+}PhysicsRayCastResult;
+
 /**
  * @brief Called for each fixture found in the query. You control how the ray cast
  * proceeds by returning a float:
@@ -78,6 +90,11 @@ typedef struct PhysicsRayCastInfo
 typedef std::function<bool(PhysicsWorld& world, const PhysicsRayCastInfo& info, void* data)> PhysicsRayCastCallbackFunc;
 typedef std::function<bool(PhysicsWorld&, PhysicsShape&, void*)> PhysicsQueryRectCallbackFunc;
 typedef PhysicsQueryRectCallbackFunc PhysicsQueryPointCallbackFunc;
+/**
+ * @brief Called once after a step with the contacts that began and the contacts that separated during the step.
+ * The contacts stay valid until they are given to the callback as separated.
+ */
+typedef std::function<void(PhysicsWorld& world, const std::vector<PhysicsContact*>& began, const std::vector<PhysicsContact*>& separated)> PhysicsContactBatchCallbackFunc;
 
 /**
  * @brief An PhysicsWorld object simulates collisions and other physical properties. You do not create PhysicsWorld objects directly; instead, you can get it from an Scene object.
@@ -91,6 +108,13 @@ public:
     static const int DEBUGDRAW_CONTACT;     ///< draw contact
     static const int DEBUGDRAW_ALL;         ///< draw all
     
+    /** The broadphase of the space, it finds the pairs of shapes that may collide and the shapes of the queries */
+    enum class Broadphase
+    {
+        BB_TREE,        ///< a bounding box tree, the default. Good for shapes of any size
+        SPATIAL_HASH,   ///< a spatial hash. Faster for many shapes of about the same size
+    };
+    
 public:
     /** Adds a joint to the physics world.*/
     virtual void addJoint(PhysicsJoint* joint);
@@ -112,6 +136,18 @@ public:
     void queryRect(PhysicsQueryRectCallbackFunc func, const Rect& rect, void* data);
     /** Searches for physics shapes that contains the point. */
     void queryPoint(PhysicsQueryPointCallbackFunc func, const Vec2& point, void* data);
+    /**
+     * Casts several rays at once, and finds the first shape hit by each of them.
+     * @param results resized to count, results[i] is the first hit of the ray from starts[i] to ends[i]
+     * @param parallel whether the rays are cast on the JobSystem workers, against a snapshot of the shapes
+     */
+    void rayCastBatch(const Vec2* starts, const Vec2* ends, size_t count, std::vector<PhysicsRayCastResult>& results, bool parallel = false);
+    /**
+     * Searches for the shapes in several rects at once.
+     * The shapes in rects[i] are shapes[offsets[i]] to shapes[offsets[i + 1] - 1], each of them once.
+     * @param parallel whether the rects are searched on the JobSystem workers, against a snapshot of the shapes
+     */
+    void queryRectBatch(const Rect* rects, size_t count, std::vector<PhysicsShape*>& shapes, std::vector<int>& offsets, bool parallel = false);
     /** Get phsyics shapes that contains the point. */
     Vector<PhysicsShape*> getShapes(const Vec2& point) const;
     /** return physics shape that contains the point. */
@@ -121,6 +157,18 @@ public:
     /** Get body by tag */
     PhysicsBody* getBody(int tag) const;
     
+    /**
+     * Adds a callback receiving the contacts of a step at once, instead of an event for each contact.
+     * The contacts are filtered by the contact test bitmasks of their shapes like the contact events,
+     * then by the category bitmask of the callback: a contact is given to it when the category of one of its shapes matches.
+     * The callback is called after the step, it can't reject the contacts. The contacts separated outside of a step,
+     * when a body or a shape is removed, are given right away since their shapes are released after.
+     * @return the id of the callback, for removeContactBatchCallback()
+     */
+    int addContactBatchCallback(const PhysicsContactBatchCallbackFunc& func, int categoryBitmask = UINT_MAX);
+    /** Removes a callback added by addContactBatchCallback() */
+    void removeContactBatchCallback(int callbackId);
+    
     /** Get scene contain this physics world */
     inline Scene& getScene() const { return *_scene; }
     /** get the gravity value */
@@ -152,6 +200,19 @@ public:
     /** get the number of substeps */
     inline int getSubsteps() const { return _substeps; }
 
+    /**
+     * Set the broadphase of the physics world.
+     * @param cellSize the size of the cells of the spatial hash, about the size of the most common shapes
+     * @param cellCount the number of cells in the hash table of the spatial hash, about the number of shapes is a good start
+     */
+    void setBroadphase(Broadphase broadphase, float cellSize = 50.0f, int cellCount = 1000);
+    /** get the broadphase */
+    inline Broadphase getBroadphase() const { return _broadphase; }
+    /** get the size of the cells of the spatial hash */
+    inline float getBroadphaseCellSize() const { return _broadphaseCellSize; }
+    /** get the number of cells of the spatial hash */
+    inline int getBroadphaseCellCount() const { return _broadphaseCellCount; }
+
     /** set the debug draw mask */
     void setDebugDrawMask(int mask);
     /** get the bebug draw mask */
@@ -170,6 +231,30 @@ public:
      * Note: you need to setAutoStep(false) first before it can work.
      */
     void step(float delta);
+
+    /**
+     * Steps the world with a fixed time step, the time of the frames is accumulated and simulated by steps of this length.
+     * The speed still scales the time of the frames, the update rate and the substeps are not used.
+     * 0 disables the fixed step, the default.
+     * @param timestep the length of a step in seconds, 1/60 for example
+     * @param maxSteps the most steps in a frame, the time the world can't catch up with is dropped
+     */
+    void setFixedTimestep(float timestep, int maxSteps = 5);
+    /** Get the fixed time step, 0 when the world isn't stepped with a fixed time step */
+    inline float getFixedTimestep() const { return _fixedTimestep; }
+    /** Get the most fixed steps in a frame */
+    inline int getMaxFixedSteps() const { return _maxFixedSteps; }
+    /**
+     * With a fixed time step, the nodes are shown between the state before the last step and the state after it,
+     * by the fraction of a step the world is behind the frame. The movement is smooth when the frame rate and the step don't match,
+     * the nodes are up to one step late.
+     * Default value is false.
+     */
+    inline void setInterpolationEnabled(bool enabled) { _interpolationEnabled = enabled; }
+    /** Whether the nodes are interpolated between the fixed steps */
+    inline bool isInterpolationEnabled() const { return _interpolationEnabled; }
+    /** The fraction of a fixed step the nodes are interpolated with, from 0 to 1 */
+    inline float getInterpolationAlpha() const { return _interpolationAlpha; }
     
 protected:
     static PhysicsWorld* construct(Scene& scene);
@@ -195,6 +280,30 @@ protected:
     virtual void updateBodies();
     virtual void updateJoints();
     
+    // the bodies whose node was moved, the changed components are copied from the node before the next step
+    void addDirtyBody(PhysicsBody* body, int flags = PhysicsBody::TRANSFORM_DIRTY_ALL);
+    void removeDirtyBody(PhysicsBody* body);
+    void updateDirtyBodies();
+    void stepFixed(float delta);
+    // steps the space and gives the contacts of the step to the batch callbacks
+    void stepSpace(float delta);
+    
+    // the contacts are reused once separated
+    PhysicsContact* obtainContact(PhysicsShape* shapeA, PhysicsShape* shapeB);
+    void recycleContact(PhysicsContact* contact);
+    void batchContact(PhysicsContact* contact, bool began);
+    void deliverContactBatches();
+    void deliverSeparatedContact(PhysicsContact* contact);
+    
+    // the pairs of bodies connected by a joint that doesn't let them collide
+    void addCollisionDisabledPair(PhysicsJoint* joint);
+    void removeCollisionDisabledPair(PhysicsJoint* joint);
+    
+    // the snapshot of the shapes the parallel queries run against, rebuilt once the shapes moved
+    PhysicsQuerySnapshot* getQuerySnapshot();
+    // the delayed bodies and the moved nodes are given to the space before a query
+    void prepareQuery();
+    
 protected:
     Vect _gravity;
     float _speed;
@@ -204,12 +313,19 @@ protected:
     int _substeps;
     cpSpace* _cpSpace;
     
-    bool _updateBodyTransform;
+    PhysicsBody* _dirtyBodies;
+    // the bodies in all the worlds, the nodes don't look for bodies in their children when there are none
+    static int s_bodyCount;
     Vector<PhysicsBody*> _bodies;
     std::list<PhysicsJoint*> _joints;
     Scene* _scene;
     
     bool _autoStep;
+    float _fixedTimestep;
+    int _maxFixedSteps;
+    float _accumulatedTime;
+    bool _interpolationEnabled;
+    float _interpolationAlpha;
     PhysicsDebugDraw* _debugDraw;
     int _debugDrawMask;
     
@@ -219,6 +335,41 @@ protected:
     std::vector<PhysicsJoint*> _delayAddJoints;
     std::vector<PhysicsJoint*> _delayRemoveJoints;
     
+    std::vector<PhysicsContact*> _contactPool;
+    // whether the contacts are dispatched through the event dispatcher, checked before each step
+    bool _contactListenersEnabled;
+    
+    struct ContactBatch
+    {
+        int id;
+        int categoryBitmask;
+        bool removed;
+        PhysicsContactBatchCallbackFunc func;
+        std::vector<PhysicsContact*> began;
+        std::vector<PhysicsContact*> separated;
+    };
+    std::list<ContactBatch> _contactBatches;
+    int _contactBatchId;
+    bool _deliveringContacts;
+    // recycled once given to the batches
+    std::vector<PhysicsContact*> _separatedContacts;
+    
+    struct BodyPairHash
+    {
+        size_t operator()(const std::pair<PhysicsBody*, PhysicsBody*>& pair) const
+        {
+            return std::hash<PhysicsBody*>()(pair.first) ^ (std::hash<PhysicsBody*>()(pair.second) * 31);
+        }
+    };
+    // the number of the joints disabling the collisions of each pair of bodies
+    std::unordered_map<std::pair<PhysicsBody*, PhysicsBody*>, int, BodyPairHash> _collisionDisabledPairs;
+    
+    Broadphase _broadphase;
+    float _broadphaseCellSize;
+    int _broadphaseCellCount;
+    PhysicsQuerySnapshot* _querySnapshot;
+    bool _querySnapshotDirty;
+    
 protected:
     PhysicsWorld();
     virtual ~PhysicsWorld();
@@ -30,6 +30,8 @@ THE SOFTWARE.
 #include "base/CCData.h"
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
+#include "base/CCFrameProfiler.h"
+#include "base/CCBinaryValue.h"
 #include "platform/CCSAXParser.h"
 #include "base/ccUtils.h"
 
@@ -91,13 +93,18 @@ public:
 	ValueMap*  _curDict;
     ValueVector* _curArray;
 
-	std::stack<ValueMap*> _dictStack;
-    std::stack<ValueVector*> _arrayStack;
+    // The containers being parsed. They are moved into their parent once parsed,
+    // so the copies of the values share them, see Value.
+	std::stack<ValueMap> _dictStack;
+    std::stack<ValueVector> _arrayStack;
+    std::stack<std::string> _keyStack;  ///< the keys of the containers in their parent dictionary
     std::stack<SAXState>  _stateStack;
 
 public:
     DictMaker()        
         : _resultType(SAX_RESULT_NONE)
+        , _curDict(nullptr)
+        , _curArray(nullptr)
     {
     }
 
@@ -105,18 +112,6 @@ public:
     {
     }
 
-    ValueMap dictionaryWithContentsOfFile(const std::string& fileName)
-    {
-        _resultType = SAX_RESULT_DICT;
-        SAXParser parser;
-
-        CCASSERT(parser.init("UTF-8"), "The file format isn't UTF-8");
-        parser.setDelegator(this);
-
-        parser.parse(fileName);
-		return _rootDict;
-    }
-
 	ValueMap dictionaryWithDataOfFile(const char* filedata, int filesize)
 	{
 		_resultType = SAX_RESULT_DICT;
@@ -126,10 +121,10 @@ public:
 		parser.setDelegator(this);
 
 		parser.parse(filedata, filesize);
-		return _rootDict;
+		return std::move(_rootDict);
 	}
 
-    ValueVector arrayWithContentsOfFile(const std::string& fileName)
+    ValueVector arrayWithDataOfFile(const char* filedata, int filesize)
     {
         _resultType = SAX_RESULT_ARRAY;
         SAXParser parser;
@@ -137,8 +132,8 @@ public:
         CCASSERT(parser.init("UTF-8"), "The file format isn't UTF-8");
         parser.setDelegator(this);
 
-        parser.parse(fileName);
-		return _rootArray;
+        parser.parse(filedata, filesize);
+        return std::move(_rootArray);
     }
 
     void startElement(void *ctx, const char *name, const char **atts)
@@ -148,37 +143,15 @@ public:
         const std::string sName(name);
         if( sName == "dict" )
         {
-			if(_resultType == SAX_RESULT_DICT && _rootDict.empty())
-            {
-                _curDict = &_rootDict;
-            }
-
             _state = SAX_DICT;
 
-            SAXState preState = SAX_NONE;
-            if (! _stateStack.empty())
-            {
-                preState = _stateStack.top();
-            }
-
-            if (SAX_ARRAY == preState)
-            {
-                // add a new dictionary into the array
-                _curArray->push_back(Value(ValueMap()));
-				_curDict = &(_curArray->rbegin())->asValueMap();
-            }
-            else if (SAX_DICT == preState)
-            {
-                // add a new dictionary into the pre dictionary
-                CCASSERT(! _dictStack.empty(), "The state is wrong!");
-                ValueMap* preDict = _dictStack.top();
-                (*preDict)[_curKey] = Value(ValueMap());
-				_curDict = &(*preDict)[_curKey].asValueMap();
-            }
+            // the dictionary is added to its parent when it ends
+            _dictStack.push(ValueMap());
+            _keyStack.push(_curKey);
+            _curDict = &_dictStack.top();
 
             // record the dict state
             _stateStack.push(_state);
-            _dictStack.push(_curDict);
         }
         else if(sName == "key")
         {
@@ -200,31 +173,13 @@ public:
         {
             _state = SAX_ARRAY;
 
-			if (_resultType == SAX_RESULT_ARRAY && _rootArray.empty())
-            {
-				_curArray = &_rootArray;
-            }
-            SAXState preState = SAX_NONE;
-            if (! _stateStack.empty())
-            {
-                preState = _stateStack.top();
-            }
+            // the array is added to its parent when it ends
+            _arrayStack.push(ValueVector());
+            _keyStack.push(_curKey);
+            _curArray = &_arrayStack.top();
 
-            if (preState == SAX_DICT)
-            {
-                (*_curDict)[_curKey] = Value(ValueVector());
-				_curArray = &(*_curDict)[_curKey].asValueVector();
-            }
-            else if (preState == SAX_ARRAY)
-            {
-                CCASSERT(! _arrayStack.empty(), "The state is wrong!");
-                ValueVector* preArray = _arrayStack.top();
-                preArray->push_back(Value(ValueVector()));
-				_curArray = &(_curArray->rbegin())->asValueVector();
-            }
             // record the array state
             _stateStack.push(_state);
-            _arrayStack.push(_curArray);
         }
         else
         {
@@ -239,21 +194,49 @@ public:
         const std::string sName((char*)name);
         if( sName == "dict" )
         {
+            CCASSERT(! _dictStack.empty(), "The state is wrong!");
+            ValueMap dict = std::move(_dictStack.top());
             _stateStack.pop();
             _dictStack.pop();
-            if ( !_dictStack.empty())
+            _curDict = _dictStack.empty() ? nullptr : &_dictStack.top();
+
+            SAXState preState = _stateStack.empty() ? SAX_NONE : _stateStack.top();
+            if (SAX_ARRAY == preState)
             {
-                _curDict = _dictStack.top();
+                _curArray->push_back(Value(std::move(dict)));
             }
+            else if (SAX_DICT == preState)
+            {
+                (*_curDict)[_keyStack.top()] = Value(std::move(dict));
+            }
+            else if (_resultType == SAX_RESULT_DICT)
+            {
+                _rootDict = std::move(dict);
+            }
+            _keyStack.pop();
         }
         else if (sName == "array")
         {
+            CCASSERT(! _arrayStack.empty(), "The state is wrong!");
+            ValueVector array = std::move(_arrayStack.top());
             _stateStack.pop();
             _arrayStack.pop();
-            if (! _arrayStack.empty())
+            _curArray = _arrayStack.empty() ? nullptr : &_arrayStack.top();
+
+            SAXState preState = _stateStack.empty() ? SAX_NONE : _stateStack.top();
+            if (SAX_ARRAY == preState)
+            {
+                _curArray->push_back(Value(std::move(array)));
+            }
+            else if (SAX_DICT == preState)
             {
-                _curArray = _arrayStack.top();
+                (*_curDict)[_keyStack.top()] = Value(std::move(array));
             }
+            else if (_resultType == SAX_RESULT_ARRAY)
+            {
+                _rootArray = std::move(array);
+            }
+            _keyStack.pop();
         }
         else if (sName == "true")
         {
@@ -341,12 +324,26 @@ public:
 ValueMap FileUtils::getValueMapFromFile(const std::string& filename)
 {
     const std::string fullPath = fullPathForFilename(filename.c_str());
-    DictMaker tMaker;
-    return tMaker.dictionaryWithContentsOfFile(fullPath.c_str());
+    MappedData data = getMappedDataFromFile(fullPath);
+    if (data.isNull())
+        return ValueMap();
+    
+    return getValueMapFromData((const char*)data.getBytes(), (int)data.getSize());
 }
 
 ValueMap FileUtils::getValueMapFromData(const char* filedata, int filesize)
 {
+    const unsigned char* bytes = (const unsigned char*)filedata;
+    if (BinaryValue::isBinaryValue(bytes, filesize))
+    {
+        ValueMap ret;
+        if (!BinaryValue::readValueMap(bytes, filesize, ret))
+        {
+            CCLOG("cocos2d: FileUtils: invalid binary plist");
+        }
+        return ret;
+    }
+    
     DictMaker tMaker;
     return tMaker.dictionaryWithDataOfFile(filedata, filesize);
 }
@@ -354,8 +351,23 @@ ValueMap FileUtils::getValueMapFromData(const char* filedata, int filesize)
 ValueVector FileUtils::getValueVectorFromFile(const std::string& filename)
 {
     const std::string fullPath = fullPathForFilename(filename.c_str());
+    MappedData data = getMappedDataFromFile(fullPath);
+    if (data.isNull())
+        return ValueVector();
+    
+    const unsigned char* bytes = data.getBytes();
+    if (BinaryValue::isBinaryValue(bytes, data.getSize()))
+    {
+        ValueVector ret;
+        if (!BinaryValue::readValueVector(bytes, data.getSize(), ret))
+        {
+            CCLOG("cocos2d: FileUtils: invalid binary plist %s", fullPath.c_str());
+        }
+        return ret;
+    }
+    
     DictMaker tMaker;
-    return tMaker.arrayWithContentsOfFile(fullPath.c_str());
+    return tMaker.arrayWithDataOfFile((const char*)bytes, (int)data.getSize());
 }
 
 
@@ -523,11 +535,16 @@ void FileUtils::setDelegate(FileUtils *delegate)
 
 FileUtils::FileUtils()
     : _writablePath("")
+    , _fileMappingThreshold(64 * 1024)
 {
 }
 
 FileUtils::~FileUtils()
 {
+    for (auto pack : _frontResourcePacks)
+        delete pack;
+    for (auto pack : _backResourcePacks)
+        delete pack;
 }
 
 
@@ -546,6 +563,8 @@ void FileUtils::purgeCachedEntries()
 
 static Data getData(const std::string& filename, bool forString)
 {
+    CC_PROFILE_ZONE("FileUtils::getData");
+    
     if (filename.empty())
     {
         return Data::Null;
@@ -607,6 +626,10 @@ static Data getData(const std::string& filename, bool forString)
 
 std::string FileUtils::getStringFromFile(const std::string& filename)
 {
+    Data packData;
+    if (getDataFromResourcePack(filename, &packData))
+        return std::string((const char*)packData.getBytes(), packData.getSize());
+
     Data data = getData(filename, true);
     if (data.isNull())
     	return "";
@@ -617,9 +640,37 @@ std::string FileUtils::getStringFromFile(const std::string& filename)
 
 Data FileUtils::getDataFromFile(const std::string& filename)
 {
+    Data data;
+    if (getDataFromResourcePack(filename, &data))
+        return data;
+
     return getData(filename, false);
 }
 
+MappedData FileUtils::getMappedDataFromFile(const std::string& filename)
+{
+    CC_PROFILE_ZONE("FileUtils::getMappedDataFromFile");
+    
+    std::string fullPath = fullPathForFilename(filename);
+
+    const ResourcePack::Entry* entry = nullptr;
+    ResourcePack* pack = getResourcePackForPath(fullPath, &entry);
+    if (pack)
+    {
+        return entry ? pack->getMappedData(*entry) : MappedData();
+    }
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+    MappedData ret;
+    if (!fullPath.empty() && getFileSize(fullPath) >= _fileMappingThreshold && ret.map(fullPath))
+    {
+        return ret;
+    }
+#endif
+
+    return MappedData(getDataFromFile(fullPath));
+}
+
 unsigned char* FileUtils::getFileData(const std::string& filename, const char* mode, ssize_t *size)
 {
     unsigned char * buffer = nullptr;
@@ -758,9 +809,8 @@ std::string FileUtils::fullPathForFilename(const std::string &filename)
     const std::string newFilename( getNewFilename(filename) );
     
 	std::string fullpath;
-    
-    for (const auto& searchIt : _searchPathArray)
-    {
+
+    auto searchPath = [&](const std::string& searchIt) {
         for (const auto& resolutionIt : _searchResolutionsOrderArray)
         {
             fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
@@ -769,10 +819,30 @@ std::string FileUtils::fullPathForFilename(const std::string &filename)
             {
                 // Using the filename passed in as key.
                 _fullPathCache.insert(std::make_pair(filename, fullpath));
-                return fullpath;
+                return true;
             }
             
         }
+        return false;
+    };
+
+    // the resource packs are virtual search paths
+    for (const auto& pack : _frontResourcePacks)
+    {
+        if (searchPath(pack->getRoot()))
+            return fullpath;
+    }
+    
+    for (const auto& searchIt : _searchPathArray)
+    {
+        if (searchPath(searchIt))
+            return fullpath;
+    }
+
+    for (const auto& pack : _backResourcePacks)
+    {
+        if (searchPath(pack->getRoot()))
+            return fullpath;
     }
     
     if(isPopupNotify()){
@@ -900,6 +970,84 @@ void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
     }
 }
 
+bool FileUtils::mountResourcePack(const std::string& filename, bool front)
+{
+    std::string fullPath = fullPathForFilename(filename);
+    if (fullPath.empty())
+        return false;
+
+    unmountResourcePack(fullPath);
+
+    ResourcePack* pack = new (std::nothrow) ResourcePack();
+    if (!pack || !pack->open(fullPath))
+    {
+        delete pack;
+        return false;
+    }
+
+    if (front)
+        _frontResourcePacks.insert(_frontResourcePacks.begin(), pack);
+    else
+        _backResourcePacks.push_back(pack);
+
+    _fullPathCache.clear();
+    return true;
+}
+
+void FileUtils::unmountResourcePack(const std::string& filename)
+{
+    std::string fullPath = isAbsolutePath(filename) ? filename : fullPathForFilename(filename);
+    for (auto packs : { &_frontResourcePacks, &_backResourcePacks })
+    {
+        for (auto iter = packs->begin(); iter != packs->end(); ++iter)
+        {
+            if ((*iter)->getPath() == fullPath)
+            {
+                delete *iter;
+                packs->erase(iter);
+                _fullPathCache.clear();
+                return;
+            }
+        }
+    }
+}
+
+ResourcePack* FileUtils::getResourcePackForPath(const std::string& fullPath, const ResourcePack::Entry** entry) const
+{
+    for (auto packs : { &_frontResourcePacks, &_backResourcePacks })
+    {
+        for (const auto& pack : *packs)
+        {
+            const std::string& root = pack->getRoot();
+            if (fullPath.compare(0, root.length(), root) == 0)
+            {
+                *entry = pack->findEntry(fullPath.c_str() + root.length(), fullPath.length() - root.length());
+                return pack;
+            }
+        }
+    }
+    *entry = nullptr;
+    return nullptr;
+}
+
+bool FileUtils::getDataFromResourcePack(const std::string& filename, Data* data)
+{
+    if (_frontResourcePacks.empty() && _backResourcePacks.empty())
+        return false;
+
+    std::string fullPath = isAbsolutePath(filename) ? filename : fullPathForFilename(filename);
+    const ResourcePack::Entry* entry = nullptr;
+    ResourcePack* pack = getResourcePackForPath(fullPath, &entry);
+    if (!pack)
+        return false;
+
+    if (entry)
+    {
+        *data = pack->getData(*entry);
+    }
+    return true;
+}
+
 void FileUtils::setFilenameLookupDictionary(const ValueMap& filenameLookupDict)
 {
     _fullPathCache.clear();    
@@ -936,7 +1084,9 @@ std::string FileUtils::getFullPathForDirectoryAndFilename(const std::string& dir
     ret += filename;
     
     // if the file doesn't exist, return an empty string
-    if (!isFileExistInternal(ret)) {
+    // the files in a resource pack are looked up in its index instead of the file system
+    const ResourcePack::Entry* entry = nullptr;
+    if (getResourcePackForPath(ret, &entry) ? entry == nullptr : !isFileExistInternal(ret)) {
         ret = "";
     }
     return ret;
@@ -963,6 +1113,10 @@ bool FileUtils::isFileExist(const std::string& filename) const
 {
     if (isAbsolutePath(filename))
     {
+        const ResourcePack::Entry* entry = nullptr;
+        if (getResourcePackForPath(filename, &entry))
+            return entry != nullptr;
+
         return isFileExistInternal(filename);
     }
     else
@@ -1016,34 +1170,69 @@ bool FileUtils::isDirectoryExist(const std::string& dirPath)
     
     if (isAbsolutePath(dirPath))
     {
-        return isDirectoryExistInternal(dirPath);
+        return isDirectoryExistInPacksOrInternal(dirPath);
     }
     
     // Already Cached ?
     auto cacheIter = _fullPathCache.find(dirPath);
     if( cacheIter != _fullPathCache.end() )
     {
-        return isDirectoryExistInternal(cacheIter->second);
+        return isDirectoryExistInPacksOrInternal(cacheIter->second);
     }
     
 	std::string fullpath;
-    for (const auto& searchIt : _searchPathArray)
-    {
+    auto searchPath = [&](const std::string& searchIt) {
         for (const auto& resolutionIt : _searchResolutionsOrderArray)
         {
             // searchPath + file_path + resourceDirectory
             fullpath = searchIt + dirPath + resolutionIt;
-            if (isDirectoryExistInternal(fullpath))
+            if (isDirectoryExistInPacksOrInternal(fullpath))
             {
-                const_cast<FileUtils*>(this)->_fullPathCache.insert(std::make_pair(dirPath, fullpath));
+                _fullPathCache.insert(std::make_pair(dirPath, fullpath));
                 return true;
             }
         }
+        return false;
+    };
+
+    // the resource packs are virtual search paths, like in fullPathForFilename
+    for (const auto& pack : _frontResourcePacks)
+    {
+        if (searchPath(pack->getRoot()))
+            return true;
+    }
+
+    for (const auto& searchIt : _searchPathArray)
+    {
+        if (searchPath(searchIt))
+            return true;
+    }
+
+    for (const auto& pack : _backResourcePacks)
+    {
+        if (searchPath(pack->getRoot()))
+            return true;
     }
     
     return false;
 }
 
+bool FileUtils::isDirectoryExistInPacksOrInternal(const std::string& dirPath) const
+{
+    for (auto packs : { &_frontResourcePacks, &_backResourcePacks })
+    {
+        for (const auto& pack : *packs)
+        {
+            const std::string& root = pack->getRoot();
+            if (dirPath.compare(0, root.length(), root) == 0)
+            {
+                return pack->isDirectory(dirPath.c_str() + root.length(), dirPath.length() - root.length());
+            }
+        }
+    }
+    return isDirectoryExistInternal(dirPath);
+}
+
 bool FileUtils::createDirectory(const std::string& path)
 {
     CCASSERT(!path.empty(), "Invalid path");
@@ -1327,6 +1516,10 @@ long FileUtils::getFileSize(const std::string &filepath)
             return 0;
     }
     
+    const ResourcePack::Entry* entry = nullptr;
+    if (getResourcePackForPath(fullpath, &entry))
+        return entry ? (long)entry->originalSize : -1;
+
     struct stat info;
     // Get data associated with "crt_stat.c":
     int result = stat( fullpath.c_str(), &info );
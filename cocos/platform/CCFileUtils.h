@@ -33,6 +33,8 @@ THE SOFTWARE.
 #include "base/ccTypes.h"
 #include "base/CCValue.h"
 #include "base/CCData.h"
+#include "platform/CCMappedData.h"
+#include "platform/CCResourcePack.h"
 
 NS_CC_BEGIN
 
@@ -102,6 +104,17 @@ public:
      *  @return A data object.
      */
     virtual Data getDataFromFile(const std::string& filename);
+
+    /**
+     *  Creates a read-only view of a file, without copying its content when the platform can memory map it.
+     *  The files smaller than the mapping threshold are read as by `getDataFromFile`.
+     *  @return A view that owns the mapping, or the data of the file.
+     */
+    virtual MappedData getMappedDataFromFile(const std::string& filename);
+
+    /** Sets the size from which `getMappedDataFromFile` maps the files. Mapping small files costs more than reading them. */
+    void setFileMappingThreshold(ssize_t size) { _fileMappingThreshold = size; }
+    ssize_t getFileMappingThreshold() const { return _fileMappingThreshold; }
     
     /**
      *  Gets resource file data
@@ -111,6 +124,7 @@ public:
      *  @param[out] pSize If the file read operation succeeds, it will be the data size, otherwise 0.
      *  @return Upon success, a pointer to the data is returned, otherwise NULL.
      *  @warning Recall: you are responsible for calling free() on any Non-NULL pointer returned.
+     *  @warning The files in the mounted resource packs aren't read, use getDataFromFile for them.
      */
     CC_DEPRECATED_ATTRIBUTE virtual unsigned char* getFileData(const std::string& filename, const char* mode, ssize_t *size);
 
@@ -296,6 +310,20 @@ public:
      */
     virtual const std::vector<std::string>& getSearchPaths() const;
 
+    /**
+     *  Mounts a resource pack made by tools/resource-pack/pack_resources.py.
+     *  The files of the pack are found by fullPathForFilename as if the pack were a search path,
+     *  without any access to the file system. Their full paths are the full path of the pack followed by their path in the pack.
+     *
+     *  @param filename The pack file.
+     *  @param front Whether the pack is searched before the search paths, or after them.
+     *  @return true if the pack was mounted.
+     */
+    bool mountResourcePack(const std::string& filename, bool front = true);
+
+    /** Unmounts a resource pack mounted by mountResourcePack */
+    void unmountResourcePack(const std::string& filename);
+
     /**
      *  Gets the writable path.
      *  @return  The path that can be write/read a file in
@@ -362,6 +390,7 @@ public:
      *
      *  @param dirPath The path of the directory, it could be a relative or an absolute path.
      *  @return true if the directory exists, otherwise it will return false.
+     *  A directory of a mounted resource pack exists if the pack has files in it.
      */
     virtual bool isDirectoryExist(const std::string& dirPath);
     
@@ -481,6 +510,23 @@ protected:
      *  @return The full path for the file, if not found, the return value will be an empty string
      */
     virtual std::string searchFullPathForFilename(const std::string& filename) const;
+
+    /**
+     *  Returns the mounted resource pack that contains a full path, or nullptr if the path isn't in a pack.
+     *  @param entry Set to the entry of the file, or nullptr if the pack doesn't contain it.
+     */
+    ResourcePack* getResourcePackForPath(const std::string& fullPath, const ResourcePack::Entry** entry) const;
+
+    /**
+     *  Reads a file from the mounted resource packs.
+     *  @return false if the file isn't in a pack, the platform reads it then.
+     */
+    bool getDataFromResourcePack(const std::string& filename, Data* data);
+
+    /**
+     *  Checks a directory in the mounted resource packs, or in the file system if the path isn't in a pack.
+     */
+    bool isDirectoryExistInPacksOrInternal(const std::string& dirPath) const;
     
     
     /** Dictionary used to lookup filenames based on a key.
@@ -518,6 +564,17 @@ protected:
      *  This variable is used for improving the performance of file search.
      */
     std::unordered_map<std::string, std::string> _fullPathCache;
+
+    /**
+     * The files from this size are memory mapped by getMappedDataFromFile.
+     */
+    ssize_t _fileMappingThreshold;
+
+    /**
+     * The mounted resource packs, searched before and after the search paths.
+     */
+    std::vector<ResourcePack*> _frontResourcePacks;
+    std::vector<ResourcePack*> _backResourcePacks;
     
     /**
      * Writable path.
@@ -0,0 +1,160 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "platform/CCMappedData.h"
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+NS_CC_BEGIN
+
+MappedData::MappedData()
+: _bytes(nullptr)
+, _size(0)
+, _mapping(nullptr)
+, _mappingSize(0)
+{
+}
+
+MappedData::MappedData(Data&& data)
+: _bytes(nullptr)
+, _size(0)
+, _mapping(nullptr)
+, _mappingSize(0)
+, _data(std::move(data))
+{
+    _bytes = _data.getBytes();
+    _size = _data.getSize();
+}
+
+MappedData::MappedData(MappedData&& other)
+: _bytes(nullptr)
+, _size(0)
+, _mapping(nullptr)
+, _mappingSize(0)
+{
+    move(other);
+}
+
+MappedData::~MappedData()
+{
+    clear();
+}
+
+MappedData& MappedData::operator= (MappedData&& other)
+{
+    if (this != &other)
+    {
+        clear();
+        move(other);
+    }
+    return *this;
+}
+
+void MappedData::move(MappedData& other)
+{
+    _bytes = other._bytes;
+    _size = other._size;
+    _mapping = other._mapping;
+    _mappingSize = other._mappingSize;
+    _data = std::move(other._data);
+
+    other._bytes = nullptr;
+    other._size = 0;
+    other._mapping = nullptr;
+    other._mappingSize = 0;
+}
+
+bool MappedData::map(const std::string& fullPath, size_t offset, size_t size)
+{
+    clear();
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+    int fd = open(fullPath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || offset >= static_cast<size_t>(st.st_size))
+    {
+        close(fd);
+        return false;
+    }
+    if (size == 0 || offset + size > static_cast<size_t>(st.st_size))
+    {
+        size = st.st_size - offset;
+    }
+
+    // the mapping starts on a page boundary
+    size_t pageOffset = offset % sysconf(_SC_PAGESIZE);
+    size_t mappingSize = size + pageOffset;
+
+    // private and writable: a consumer writing to the bytes gets its own copy of the page
+    void* mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, offset - pageOffset);
+    // the mapping stays valid once the file is closed
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+        return false;
+
+    // the files are mostly parsed from the start to the end
+    madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+
+    _mapping = mapping;
+    _mappingSize = mappingSize;
+    _bytes = static_cast<unsigned char*>(mapping) + pageOffset;
+    _size = size;
+    return true;
+#else
+    return false;
+#endif
+}
+
+Data MappedData::toData() const
+{
+    Data ret;
+    ret.copy(_bytes, _size);
+    return ret;
+}
+
+void MappedData::clear()
+{
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+    if (_mapping)
+    {
+        munmap(_mapping, _mappingSize);
+    }
+#endif
+    _data.clear();
+    _bytes = nullptr;
+    _size = 0;
+    _mapping = nullptr;
+    _mappingSize = 0;
+}
+
+NS_CC_END
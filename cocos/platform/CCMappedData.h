@@ -0,0 +1,107 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CC_MAPPED_DATA_H__
+#define __CC_MAPPED_DATA_H__
+
+#include <string>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/CCData.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup platform
+ * @{
+ */
+
+/** @brief Read-only view of the content of a file.
+
+ Where the platform supports it, the file is memory mapped: the bytes are the pages of the file,
+ they are read from the disk on demand and are not copied to the heap.
+ Otherwise, or for the small files, the view owns a `Data` with the content of the file.
+ The pages are mapped copy-on-write, so a consumer that writes to the bytes doesn't change the file.
+ A MappedData can be moved but not copied, call `toData()` to get a copy.
+ */
+class CC_DLL MappedData
+{
+public:
+    MappedData();
+    /** Takes the buffer of the data */
+    explicit MappedData(Data&& data);
+    MappedData(MappedData&& other);
+    ~MappedData();
+
+    MappedData& operator= (MappedData&& other);
+
+    /** Maps a file. Returns false if the platform can't map files or if the file can't be opened.
+     @param fullPath the full path of the file, see `FileUtils::fullPathForFilename`
+     @param offset the start of the mapped range in the file
+     @param size the size of the mapped range, 0 maps the file up to its end
+     */
+    bool map(const std::string& fullPath, size_t offset = 0, size_t size = 0);
+
+    /**
+     * @js NA
+     * @lua NA
+     */
+    unsigned char* getBytes() const { return _bytes; }
+    /**
+     * @js NA
+     * @lua NA
+     */
+    ssize_t getSize() const { return _size; }
+
+    /** Check whether the data is null. */
+    bool isNull() const { return _bytes == nullptr || _size == 0; }
+
+    /** Returns whether or not the bytes are mapped pages of a file */
+    bool isMapped() const { return _mapping != nullptr; }
+
+    /** Returns a copy of the bytes */
+    Data toData() const;
+
+    /** Unmaps the file or frees the buffer */
+    void clear();
+
+private:
+    MappedData(const MappedData&);
+    MappedData& operator= (const MappedData&);
+
+    void move(MappedData& other);
+
+    unsigned char* _bytes;
+    ssize_t _size;
+    void* _mapping;
+    size_t _mappingSize;
+    Data _data;
+};
+
+// end of platform group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_MAPPED_DATA_H__
@@ -0,0 +1,263 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "platform/CCResourcePack.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "base/ccMacros.h"
+#include "base/ZipUtils.h"
+
+NS_CC_BEGIN
+
+namespace
+{
+    const char PACK_MAGIC[4] = { 'C', 'C', 'P', 'K' };
+    const uint32_t PACK_VERSION = 1;
+
+    // on disk, little endian
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t alignment;
+        uint64_t indexOffset;
+        uint64_t namesOffset;
+        uint64_t namesSize;
+        uint64_t reserved;
+    };
+
+    static_assert(sizeof(Header) == 48, "the header of a resource pack is 48 bytes");
+    static_assert(sizeof(ResourcePack::Entry) == 48, "the entries of a resource pack are 48 bytes");
+
+    bool readAt(FILE* fp, uint64_t offset, void* buffer, size_t size)
+    {
+        return fseek(fp, static_cast<long>(offset), SEEK_SET) == 0 && fread(buffer, 1, size, fp) == size;
+    }
+}
+
+ResourcePack::ResourcePack()
+: _bucketShift(63)
+{
+}
+
+ResourcePack::~ResourcePack()
+{
+}
+
+uint64_t ResourcePack::hash(const char* name, size_t length)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i)
+    {
+        h ^= static_cast<unsigned char>(name[i]);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+bool ResourcePack::open(const std::string& fullPath)
+{
+    FILE* fp = fopen(fullPath.c_str(), "rb");
+    if (!fp)
+    {
+        CCLOG("cocos2d: ResourcePack: can not open %s", fullPath.c_str());
+        return false;
+    }
+
+    uint64_t fileSize = 0;
+    if (fseek(fp, 0, SEEK_END) == 0)
+    {
+        long end = ftell(fp);
+        fileSize = end > 0 ? static_cast<uint64_t>(end) : 0;
+    }
+
+    // the index and the names must be in the file, before anything is allocated for them
+    Header header;
+    bool ok = readAt(fp, 0, &header, sizeof(header))
+        && memcmp(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) == 0
+        && header.version == PACK_VERSION
+        && header.indexOffset <= fileSize
+        && header.entryCount <= (fileSize - header.indexOffset) / sizeof(Entry)
+        && header.namesOffset <= fileSize
+        && header.namesSize <= fileSize - header.namesOffset;
+
+    if (ok)
+    {
+        _entries.resize(header.entryCount);
+        _names.resize(static_cast<size_t>(header.namesSize));
+        ok = (header.entryCount == 0 || readAt(fp, header.indexOffset, &_entries[0], header.entryCount * sizeof(Entry)))
+            && (header.namesSize == 0 || readAt(fp, header.namesOffset, &_names[0], static_cast<size_t>(header.namesSize)));
+    }
+    fclose(fp);
+
+    // the names and the content of the entries must be in the pack too, and the index sorted for the buckets
+    for (size_t i = 0; ok && i < _entries.size(); ++i)
+    {
+        const Entry& entry = _entries[i];
+        ok = entry.nameOffset <= _names.size()
+            && entry.nameLength <= _names.size() - entry.nameOffset
+            && entry.offset <= fileSize
+            && entry.size <= fileSize - entry.offset
+            && (i == 0 || _entries[i - 1].hash <= entry.hash);
+    }
+
+    if (!ok)
+    {
+        CCLOG("cocos2d: ResourcePack: %s is not a valid resource pack", fullPath.c_str());
+        _entries.clear();
+        _names.clear();
+        return false;
+    }
+
+    _path = fullPath;
+    _root = fullPath + '/';
+
+    // about one entry per bucket
+    int bucketBits = 1;
+    while (bucketBits < 20 && (static_cast<size_t>(1) << bucketBits) < _entries.size())
+    {
+        ++bucketBits;
+    }
+    _bucketShift = 64 - bucketBits;
+
+    size_t bucketCount = static_cast<size_t>(1) << bucketBits;
+    _buckets.assign(bucketCount + 1, 0);
+    uint32_t entryIndex = 0;
+    for (size_t bucket = 0; bucket <= bucketCount; ++bucket)
+    {
+        while (entryIndex < _entries.size() && (_entries[entryIndex].hash >> _bucketShift) < bucket)
+        {
+            ++entryIndex;
+        }
+        _buckets[bucket] = entryIndex;
+    }
+
+    return true;
+}
+
+const ResourcePack::Entry* ResourcePack::findEntry(const char* name, size_t length) const
+{
+    if (_entries.empty())
+        return nullptr;
+
+    uint64_t h = hash(name, length);
+    size_t bucket = static_cast<size_t>(h >> _bucketShift);
+    for (uint32_t i = _buckets[bucket]; i < _buckets[bucket + 1]; ++i)
+    {
+        const Entry& entry = _entries[i];
+        if (entry.hash == h && entry.nameLength == length && _names.compare(entry.nameOffset, length, name, length) == 0)
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool ResourcePack::isDirectory(const char* name, size_t length) const
+{
+    while (length > 0 && name[length - 1] == '/')
+    {
+        --length;
+    }
+    if (length == 0)
+        return true;
+
+    // the pack only has files, a directory exists if a file is under it
+    for (const auto& entry : _entries)
+    {
+        if (entry.nameLength > length && _names[entry.nameOffset + length] == '/'
+            && _names.compare(entry.nameOffset, length, name, length) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string ResourcePack::getEntryName(const Entry& entry) const
+{
+    return _names.substr(entry.nameOffset, entry.nameLength);
+}
+
+Data ResourcePack::getData(const Entry& entry) const
+{
+    Data ret;
+    if (entry.size == 0)
+        return ret;
+
+    Compression compression = static_cast<Compression>(entry.compression);
+    if (compression != Compression::NONE && compression != Compression::ZLIB)
+    {
+        CCLOG("cocos2d: ResourcePack: unsupported compression %u for %s", entry.compression, getEntryName(entry).c_str());
+        return ret;
+    }
+
+    FILE* fp = fopen(_path.c_str(), "rb");
+    if (!fp)
+        return ret;
+
+    unsigned char* buffer = static_cast<unsigned char*>(malloc(entry.size));
+    bool ok = buffer && readAt(fp, entry.offset, buffer, entry.size);
+    fclose(fp);
+
+    if (!ok)
+    {
+        free(buffer);
+        CCLOG("cocos2d: ResourcePack: can not read %s", getEntryName(entry).c_str());
+        return ret;
+    }
+
+    if (compression == Compression::ZLIB)
+    {
+        unsigned char* inflated = nullptr;
+        ssize_t inflatedSize = ZipUtils::inflateMemoryWithHint(buffer, entry.size, &inflated, entry.originalSize);
+        free(buffer);
+        if (inflated)
+        {
+            ret.fastSet(inflated, inflatedSize);
+        }
+    }
+    else
+    {
+        ret.fastSet(buffer, entry.size);
+    }
+
+    return ret;
+}
+
+MappedData ResourcePack::getMappedData(const Entry& entry) const
+{
+    if (static_cast<Compression>(entry.compression) == Compression::NONE && entry.size > 0)
+    {
+        MappedData mapped;
+        if (mapped.map(_path, entry.offset, entry.size))
+            return mapped;
+    }
+    return MappedData(getData(entry));
+}
+
+NS_CC_END
@@ -0,0 +1,132 @@
+/****************************************************************************
+Copyright (c) 2014 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CC_RESOURCE_PACK_H__
+#define __CC_RESOURCE_PACK_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/CCData.h"
+#include "platform/CCMappedData.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup platform
+ * @{
+ */
+
+/** @brief Read-only pack of resource files, made by tools/resource-pack/pack_resources.py
+
+ A pack is a header, an index of the entries sorted by the hash of their names, the names,
+ then the content of the entries. Every entry starts on a multiple of the alignment of the pack,
+ so the uncompressed entries can be memory mapped. An entry can be stored as is or compressed with zlib.
+
+ The index is loaded when the pack is opened. The entries are found with one lookup in a bucket table
+ indexed by the top bits of the hash, the content is read on demand.
+ */
+class CC_DLL ResourcePack
+{
+public:
+    enum class Compression
+    {
+        NONE = 0,
+        ZLIB = 1,
+        LZ4 = 2,    ///< reserved, not supported yet
+    };
+
+    struct Entry
+    {
+        uint64_t hash;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint64_t offset;
+        uint64_t size;          ///< size in the pack
+        uint64_t originalSize;  ///< size once uncompressed
+        uint32_t compression;
+        uint32_t reserved;
+    };
+
+    ResourcePack();
+    ~ResourcePack();
+
+    /** Opens a pack and loads its index. Returns false if the file isn't a valid pack,
+     or if an entry points outside of the names or of the file */
+    bool open(const std::string& fullPath);
+
+    /** The full path of the pack */
+    const std::string& getPath() const { return _path; }
+
+    /** The root of the virtual paths of the entries: the full path of the pack followed by '/' */
+    const std::string& getRoot() const { return _root; }
+
+    ssize_t getEntryCount() const { return _entries.size(); }
+
+    /** The entries, sorted by the hash of their names */
+    const std::vector<Entry>& getEntries() const { return _entries; }
+
+    /** Returns the entry of a file, or nullptr if the pack doesn't contain it
+     @param name the path of the file, relative to the root of the pack
+     */
+    const Entry* findEntry(const char* name, size_t length) const;
+    const Entry* findEntry(const std::string& name) const { return findEntry(name.c_str(), name.length()); }
+
+    /** Whether some files of the pack are in a directory, the pack doesn't store the directories.
+     Walks all the entries, it isn't meant for frequent lookups
+     @param name the path of the directory, relative to the root of the pack
+     */
+    bool isDirectory(const char* name, size_t length) const;
+
+    /** Returns the path of an entry, relative to the root of the pack */
+    std::string getEntryName(const Entry& entry) const;
+
+    /** Reads and uncompresses an entry */
+    Data getData(const Entry& entry) const;
+
+    /** Maps an uncompressed entry where the platform supports it, otherwise reads it */
+    MappedData getMappedData(const Entry& entry) const;
+
+    /** The hash of the entry names, 64 bits FNV-1a */
+    static uint64_t hash(const char* name, size_t length);
+
+protected:
+    std::string _path;
+    std::string _root;
+    std::vector<Entry> _entries;
+    std::string _names;
+
+    // _entries[_buckets[i]] is the first entry whose hash starts with the bits i
+    std::vector<uint32_t> _buckets;
+    int _bucketShift;
+};
+
+// end of platform group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_RESOURCE_PACK_H__
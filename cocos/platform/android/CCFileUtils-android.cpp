@@ -28,6 +28,7 @@ THE SOFTWARE.
 
 #include "CCFileUtils-android.h"
 #include "platform/CCCommon.h"
+#include "base/CCFrameProfiler.h"
 #include "jni/Java_org_cocos2dx_lib_Cocos2dxHelper.h"
 #include "android/asset_manager.h"
 #include "android/asset_manager_jni.h"
@@ -202,6 +203,8 @@ bool FileUtilsAndroid::isAbsolutePath(const std::string& strPath) const
 
 Data FileUtilsAndroid::getData(const std::string& filename, bool forString)
 {
+    CC_PROFILE_ZONE("FileUtils::getData");
+    
     if (filename.empty())
     {
         return Data::Null;
@@ -310,6 +313,10 @@ Data FileUtilsAndroid::getData(const std::string& filename, bool forString)
 
 std::string FileUtilsAndroid::getStringFromFile(const std::string& filename)
 {
+    Data packData;
+    if (getDataFromResourcePack(filename, &packData))
+        return std::string((const char*)packData.getBytes(), packData.getSize());
+
     Data data = getData(filename, true);
     if (data.isNull())
         return "";
@@ -320,6 +327,10 @@ std::string FileUtilsAndroid::getStringFromFile(const std::string& filename)
     
 Data FileUtilsAndroid::getDataFromFile(const std::string& filename)
 {
+    Data data;
+    if (getDataFromResourcePack(filename, &data))
+        return data;
+
     return getData(filename, false);
 }
 
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "base/CCDirector.h"
 #include "platform/CCFileUtils.h"
 #include "platform/CCSAXParser.h"
+#include "base/CCBinaryValue.h"
 
 NS_CC_BEGIN
 
@@ -83,7 +84,7 @@ static void addItemToArray(id item, ValueVector& array)
             addValueToDict(subKey, subValue, dict);
         }
 
-        array.push_back(Value(dict));
+        array.push_back(Value(std::move(dict)));
         return;
     }
 
@@ -95,7 +96,7 @@ static void addItemToArray(id item, ValueVector& array)
         {
             addItemToArray(subItem, subArray);
         }
-        array.push_back(Value(subArray));
+        array.push_back(Value(std::move(subArray)));
         return;
     }
 }
@@ -213,7 +214,7 @@ static void addValueToDict(id nsKey, id nsValue, ValueMap& dict)
             id subValue = [nsValue objectForKey:subKey];
             addValueToDict(subKey, subValue, subDict);
         }
-        dict[key] = Value(subDict);
+        dict[key] = Value(std::move(subDict));
         return;
     }
 
@@ -226,7 +227,7 @@ static void addValueToDict(id nsKey, id nsValue, ValueMap& dict)
         {
             addItemToArray(item, valueArray);
         }
-        dict[key] = Value(valueArray);
+        dict[key] = Value(std::move(valueArray));
         return;
     }
 
@@ -387,6 +388,13 @@ bool FileUtilsApple::isFileExistInternal(const std::string& filePath) const
 
 std::string FileUtilsApple::getFullPathForDirectoryAndFilename(const std::string& directory, const std::string& filename)
 {
+    // the files of a resource pack are looked up in its index
+    const ResourcePack::Entry* entry = nullptr;
+    if (getResourcePackForPath(directory, &entry))
+    {
+        return FileUtils::getFullPathForDirectoryAndFilename(directory, filename);
+    }
+
     if (directory[0] != '/')
     {
         NSString* fullpath = [getBundle() pathForResource:[NSString stringWithUTF8String:filename.c_str()]
@@ -409,25 +417,18 @@ std::string FileUtilsApple::getFullPathForDirectoryAndFilename(const std::string
 
 ValueMap FileUtilsApple::getValueMapFromFile(const std::string& filename)
 {
-    std::string fullPath = fullPathForFilename(filename);
-    NSString* path = [NSString stringWithUTF8String:fullPath.c_str()];
-    NSDictionary* dict = [NSDictionary dictionaryWithContentsOfFile:path];
-
-    ValueMap ret;
-
-    if (dict != nil)
-    {
-        for (id key in [dict allKeys])
-        {
-            id value = [dict objectForKey:key];
-            addValueToDict(key, value, ret);
-        }
-    }
-    return ret;
+    // NSDictionary can't read the binary plists and the files of a resource pack, so the bytes are read first
+    Data data = getDataFromFile(fullPathForFilename(filename));
+    return data.isNull() ? ValueMap() : getValueMapFromData((const char*)data.getBytes(), (int)data.getSize());
 }
 
 ValueMap FileUtilsApple::getValueMapFromData(const char* filedata, int filesize)
 {
+    if (BinaryValue::isBinaryValue((const unsigned char*)filedata, filesize))
+    {
+        return FileUtils::getValueMapFromData(filedata, filesize);
+    }
+    
     NSData* file = [NSData dataWithBytes:filedata length:filesize];
     NSPropertyListFormat format;
     NSError* error;
@@ -471,11 +472,27 @@ ValueVector FileUtilsApple::getValueVectorFromFile(const std::string& filename)
     //    pPath = [[NSBundle mainBundle] pathForResource:pPath ofType:pathExtension];
     //    fixing cannot read data using Array::createWithContentsOfFile
     std::string fullPath = fullPathForFilename(filename);
-    NSString* path = [NSString stringWithUTF8String:fullPath.c_str()];
-    NSArray* array = [NSArray arrayWithContentsOfFile:path];
+    Data data = getDataFromFile(fullPath);
 
     ValueVector ret;
 
+    if (BinaryValue::isBinaryValue(data.getBytes(), data.getSize()))
+    {
+        if (!BinaryValue::readValueVector(data.getBytes(), data.getSize(), ret))
+        {
+            CCLOG("cocos2d: FileUtils: invalid binary plist %s", fullPath.c_str());
+        }
+        return ret;
+    }
+
+    if (data.isNull())
+        return ret;
+
+    NSData* file = [NSData dataWithBytesNoCopy:data.getBytes() length:data.getSize() freeWhenDone:NO];
+    id array = [NSPropertyListSerialization propertyListWithData:file options:NSPropertyListImmutable format:nil error:nil];
+    if (![array isKindOfClass:[NSArray class]])
+        return ret;
+
     for (id value in array)
     {
         addItemToArray(value, ret);
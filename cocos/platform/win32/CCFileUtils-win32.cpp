@@ -202,6 +202,10 @@ static Data getData(const std::string& filename, bool forString)
 
 std::string FileUtilsWin32::getStringFromFile(const std::string& filename)
 {
+    Data packData;
+    if (getDataFromResourcePack(filename, &packData))
+        return std::string((const char*)packData.getBytes(), packData.getSize());
+
     Data data = getData(filename, true);
 	if (data.isNull())
 	{
@@ -214,6 +218,10 @@ std::string FileUtilsWin32::getStringFromFile(const std::string& filename)
     
 Data FileUtilsWin32::getDataFromFile(const std::string& filename)
 {
+    Data data;
+    if (getDataFromResourcePack(filename, &data))
+        return data;
+
     return getData(filename, false);
 }
 
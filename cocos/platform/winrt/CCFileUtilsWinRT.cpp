@@ -185,6 +185,10 @@ static Data getData(const std::string& filename, bool forString)
 
 std::string CCFileUtilsWinRT::getStringFromFile(const std::string& filename)
 {
+    Data packData;
+    if (getDataFromResourcePack(filename, &packData))
+        return std::string((const char*)packData.getBytes(), packData.getSize());
+
     Data data = getData(filename, true);
 	if (data.isNull())
 	{
@@ -114,6 +114,8 @@ protected:
     
     // depth
     float _depth;
+
+    friend class RenderCommandArena;
 };
 
 NS_CC_END
@@ -26,74 +26,220 @@
 #ifndef __CC_RENDERCOMMANDPOOL_H__
 #define __CC_RENDERCOMMANDPOOL_H__
 
-#include <list>
+#include <stdlib.h>
+#include <vector>
+#include <new>
+#include <utility>
+#include <type_traits>
 
 #include "platform/CCPlatformMacros.h"
+#include "renderer/CCRenderCommand.h"
 
 NS_CC_BEGIN
 
+/** Pool of `RenderCommand` objects of a single type.
+ Commands are allocated in contiguous blocks and handed out with a bump cursor.
+ `reset()` makes every command of the pool available again without touching the heap.
+ */
 template <class T>
 class RenderCommandPool
 {
 public:
     RenderCommandPool()
+    : _blockIndex(0)
+    , _blockOffset(0)
     {
     }
     ~RenderCommandPool()
     {
-//        if( 0 != _usedPool.size())
-//        {
-//            CCLOG("All RenderCommand should not be used when Pool is released!");
-//        }
         _freePool.clear();
-        for (typename std::list<T*>::iterator iter = _allocatedPoolBlocks.begin(); iter != _allocatedPoolBlocks.end(); ++iter)
+        for (auto& block : _allocatedPoolBlocks)
         {
-            delete[] *iter;
-            *iter = nullptr;
+            delete[] block;
+            block = nullptr;
         }
         _allocatedPoolBlocks.clear();
     }
 
     T* generateCommand()
     {
-        T* result = nullptr;
-        if(_freePool.empty())
+        if (!_freePool.empty())
+        {
+            T* result = _freePool.back();
+            _freePool.pop_back();
+            return result;
+        }
+
+        if (_blockOffset == COMMANDS_ALLOCATE_BLOCK_SIZE)
+        {
+            ++_blockIndex;
+            _blockOffset = 0;
+        }
+        if (_blockIndex == _allocatedPoolBlocks.size())
         {
             AllocateCommands();
         }
-        result = _freePool.front();
-        _freePool.pop_front();
-        //_usedPool.insert(result);
-        return result;
+        return _allocatedPoolBlocks[_blockIndex] + _blockOffset++;
     }
     
     void pushBackCommand(T* ptr)
     {
-//        if(_usedPool.find(ptr) == _usedPool.end())
-//        {
-//            CCLOG("push Back Wrong command!");
-//            return;
-//        }
-        
         _freePool.push_back(ptr);
-        //_usedPool.erase(ptr);
-        
     }
+
+    /** Returns all the generated commands to the pool in one go. The memory is kept for reuse. */
+    void reset()
+    {
+        _freePool.clear();
+        _blockIndex = 0;
+        _blockOffset = 0;
+    }
+
 private:
+    static const size_t COMMANDS_ALLOCATE_BLOCK_SIZE = 32;
+
     void AllocateCommands()
     {
-        static const int COMMANDS_ALLOCATE_BLOCK_SIZE = 32;
         T* commands = new (std::nothrow) T[COMMANDS_ALLOCATE_BLOCK_SIZE];
         _allocatedPoolBlocks.push_back(commands);
-        for(int index = 0; index < COMMANDS_ALLOCATE_BLOCK_SIZE; ++index)
+    }
+
+    std::vector<T*> _allocatedPoolBlocks;
+    std::vector<T*> _freePool;
+    size_t _blockIndex;
+    size_t _blockOffset;
+};
+
+/** Frame scoped arena for `RenderCommand` objects of any type.
+ Commands are bump-allocated from big memory blocks, and they are all destroyed at once by `reset()`,
+ which is called by the `Renderer` once the queued commands were processed.
+ The blocks are kept between frames, so after warming up there is no heap traffic per command.
+ */
+class RenderCommandArena
+{
+public:
+    static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    explicit RenderCommandArena(size_t blockSize = DEFAULT_BLOCK_SIZE)
+    : _blockSize(blockSize)
+    , _blockIndex(0)
+    , _blockOffset(0)
+    , _usedBytes(0)
+    , _peakCommandCount(0)
+    , _peakUsedBytes(0)
+    {
+    }
+
+    ~RenderCommandArena()
+    {
+        reset();
+        for (auto& block : _blocks)
+        {
+            free(block.data);
+        }
+        _blocks.clear();
+    }
+
+    /** Creates a command of type T inside the arena. The command is valid until the next `reset()` */
+    template <class T, class... Args>
+    T* allocateCommand(Args&&... args)
+    {
+        static_assert(std::is_base_of<RenderCommand, T>::value, "RenderCommandArena only holds RenderCommand objects");
+        void* memory = allocate(sizeof(T), std::alignment_of<T>::value);
+        if (memory == nullptr)
+            return nullptr;
+
+        T* command = new (memory) T(std::forward<Args>(args)...);
+        _commands.push_back(command);
+        return command;
+    }
+
+    /** Destroys all the commands of the arena and rewinds it. The memory blocks are kept for the next frame */
+    void reset()
+    {
+        for (auto command : _commands)
         {
-            _freePool.push_back(commands+index);
+            command->~RenderCommand();
         }
+        _commands.clear();
+        _blockIndex = 0;
+        _blockOffset = 0;
+        _usedBytes = 0;
+    }
+
+    /** Number of commands alive in the arena */
+    ssize_t getCommandCount() const { return _commands.size(); }
+    /** Bytes used by the commands alive in the arena */
+    size_t getUsedBytes() const { return _usedBytes; }
+    /** Bytes reserved by the arena blocks */
+    size_t getCapacity() const
+    {
+        size_t capacity = 0;
+        for (const auto& block : _blocks)
+        {
+            capacity += block.size;
+        }
+        return capacity;
+    }
+    /** Maximum number of commands that were alive at the same time */
+    ssize_t getPeakCommandCount() const { return _peakCommandCount; }
+    /** Maximum number of bytes that were used at the same time */
+    size_t getPeakUsedBytes() const { return _peakUsedBytes; }
+
+private:
+    struct Block
+    {
+        char* data;
+        size_t size;
+    };
+
+    void* allocate(size_t size, size_t alignment)
+    {
+        while (_blockIndex < _blocks.size())
+        {
+            const Block& block = _blocks[_blockIndex];
+            size_t offset = (_blockOffset + alignment - 1) & ~(alignment - 1);
+            if (offset + size <= block.size)
+            {
+                _blockOffset = offset + size;
+                return track(block.data + offset, size);
+            }
+            ++_blockIndex;
+            _blockOffset = 0;
+        }
+
+        Block block;
+        block.size = size > _blockSize ? size : _blockSize;
+        block.data = static_cast<char*>(malloc(block.size));
+        if (block.data == nullptr)
+        {
+            CCLOGERROR("RenderCommandArena: out of memory");
+            return nullptr;
+        }
+        _blocks.push_back(block);
+        _blockIndex = _blocks.size() - 1;
+        _blockOffset = size;
+        return track(block.data, size);
+    }
+
+    void* track(void* memory, size_t size)
+    {
+        _usedBytes += size;
+        if (_usedBytes > _peakUsedBytes)
+            _peakUsedBytes = _usedBytes;
+        if (static_cast<ssize_t>(_commands.size()) + 1 > _peakCommandCount)
+            _peakCommandCount = _commands.size() + 1;
+        return memory;
     }
 
-    std::list<T*> _allocatedPoolBlocks;
-    std::list<T*> _freePool;
-    //std::set<T*> _usedPool;
+    std::vector<Block> _blocks;
+    std::vector<RenderCommand*> _commands;
+    size_t _blockSize;
+    size_t _blockIndex;
+    size_t _blockOffset;
+    size_t _usedBytes;
+    ssize_t _peakCommandCount;
+    size_t _peakUsedBytes;
 };
 
 NS_CC_END
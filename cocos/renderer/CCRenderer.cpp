@@ -39,6 +39,8 @@
 #include "base/CCConfiguration.h"
 #include "base/CCDirector.h"
 #include "base/CCEventDispatcher.h"
+#include "base/CCJobSystem.h"
+#include "base/CCFrameProfiler.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventType.h"
 #include "2d/CCCamera.h"
@@ -47,28 +49,93 @@
 NS_CC_BEGIN
 
 // helper
-static bool compareRenderCommand(RenderCommand* a, RenderCommand* b)
+
+// maps a float into an unsigned integer that keeps the same order
+static inline uint32_t floatToSortKey(float value)
 {
-    return a->getGlobalOrder() < b->getGlobalOrder();
+    // -0 and +0 are equal for the comparison operators, keep them together
+    if (value == 0)
+        value = 0;
+
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
 }
 
-static bool compare3DCommand(RenderCommand* a, RenderCommand* b)
+static const int RADIX_BITS = 11;
+static const size_t RADIX_SIZE = 1 << RADIX_BITS;
+static const uint64_t RADIX_MASK = RADIX_SIZE - 1;
+static const size_t RADIX_SORT_MIN_SIZE = 256;
+
+// LSD radix sort of the high 32 bits of the keys. Since the low 32 bits keep the submission index,
+// and LSD radix sort is stable, the result is the same as a full sort of the keys.
+static void radixSortKeys(std::vector<uint64_t>& keys, std::vector<uint64_t>& scratch)
 {
-    return  a->getDepth() > b->getDepth();
+    const size_t count = keys.size();
+    if (count < RADIX_SORT_MIN_SIZE)
+    {
+        std::sort(keys.begin(), keys.end());
+        return;
+    }
+
+    scratch.resize(count);
+    uint64_t* src = keys.data();
+    uint64_t* dst = scratch.data();
+    size_t offsets[RADIX_SIZE];
+
+    for (int shift = 32; shift < 64; shift += RADIX_BITS)
+    {
+        memset(offsets, 0, sizeof(offsets));
+        for (size_t i = 0; i < count; ++i)
+        {
+            ++offsets[(src[i] >> shift) & RADIX_MASK];
+        }
+
+        // all the keys share this digit: nothing to do in this pass
+        if (offsets[(src[0] >> shift) & RADIX_MASK] == count)
+            continue;
+
+        size_t sum = 0;
+        for (size_t bucket = 0; bucket < RADIX_SIZE; ++bucket)
+        {
+            size_t bucketCount = offsets[bucket];
+            offsets[bucket] = sum;
+            sum += bucketCount;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            dst[offsets[(src[i] >> shift) & RADIX_MASK]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+
+    if (src != keys.data())
+    {
+        keys.swap(scratch);
+    }
 }
 
 // queue
 
+RenderQueue::RenderQueue()
+: _commands(QUEUE_COUNT)
+, _isCullEnabled(false)
+, _isDepthEnabled(false)
+, _isDepthWrite(GL_FALSE)
+{
+}
+
 void RenderQueue::push_back(RenderCommand* command)
 {
     float z = command->getGlobalOrder();
     if(z < 0)
     {
-        _commands[QUEUE_GROUP::GLOBALZ_NEG].push_back(command);
+        pushSorted(QUEUE_GROUP::GLOBALZ_NEG, command, floatToSortKey(z));
     }
     else if(z > 0)
     {
-        _commands[QUEUE_GROUP::GLOBALZ_POS].push_back(command);
+        pushSorted(QUEUE_GROUP::GLOBALZ_POS, command, floatToSortKey(z));
     }
     else
     {
@@ -76,7 +143,8 @@ void RenderQueue::push_back(RenderCommand* command)
         {
             if(command->isTransparent())
             {
-                _commands[QUEUE_GROUP::TRANSPARENT_3D].push_back(command);
+                // transparent 3D commands are sorted from back to front
+                pushSorted(QUEUE_GROUP::TRANSPARENT_3D, command, ~floatToSortKey(command->getDepth()));
             }
             else
             {
@@ -90,6 +158,13 @@ void RenderQueue::push_back(RenderCommand* command)
     }
 }
 
+void RenderQueue::pushSorted(QUEUE_GROUP group, RenderCommand* command, uint32_t sortValue)
+{
+    auto& commands = _commands[group];
+    _sortKeys[group].push_back((static_cast<uint64_t>(sortValue) << 32) | static_cast<uint32_t>(commands.size()));
+    commands.push_back(command);
+}
+
 ssize_t RenderQueue::size() const
 {
     ssize_t result(0);
@@ -103,10 +178,52 @@ ssize_t RenderQueue::size() const
 
 void RenderQueue::sort()
 {
-    // Don't sort _queue0, it already comes sorted
-    std::sort(std::begin(_commands[QUEUE_GROUP::TRANSPARENT_3D]), std::end(_commands[QUEUE_GROUP::TRANSPARENT_3D]), compare3DCommand);
-    std::sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_NEG]), std::end(_commands[QUEUE_GROUP::GLOBALZ_NEG]), compareRenderCommand);
-    std::sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_POS]), std::end(_commands[QUEUE_GROUP::GLOBALZ_POS]), compareRenderCommand);
+    // Don't sort GLOBALZ_ZERO and OPAQUE_3D, they already come sorted
+    static const QUEUE_GROUP sortedGroups[] = { QUEUE_GROUP::GLOBALZ_NEG, QUEUE_GROUP::TRANSPARENT_3D, QUEUE_GROUP::GLOBALZ_POS };
+
+    // Big sub queues are sorted on worker threads, the biggest one stays on the calling thread
+    QUEUE_GROUP biggest = QUEUE_GROUP::GLOBALZ_NEG;
+    for (auto group : sortedGroups)
+    {
+        if (_commands[group].size() > _commands[biggest].size())
+            biggest = group;
+    }
+
+    auto jobSystem = JobSystem::getInstance();
+    std::vector<JobSystem::JobHandle> jobs;
+    for (auto group : sortedGroups)
+    {
+        if (group != biggest && _commands[group].size() >= PARALLEL_SORT_THRESHOLD)
+        {
+            jobs.push_back(jobSystem->schedule(std::bind(&RenderQueue::sortSubQueue, this, group), JobSystem::Priority::HIGH));
+        }
+        else if (group != biggest)
+        {
+            sortSubQueue(group);
+        }
+    }
+    sortSubQueue(biggest);
+
+    jobSystem->wait(jobs);
+}
+
+void RenderQueue::sortSubQueue(QUEUE_GROUP group)
+{
+    auto& commands = _commands[group];
+    auto& keys = _sortKeys[group];
+    CCASSERT(commands.size() == keys.size(), "Commands were added to the sub queue without a sort key");
+    if (commands.size() < 2)
+        return;
+
+    radixSortKeys(keys, _sortScratch[group]);
+
+    auto& sorted = _commandScratch[group];
+    sorted.resize(commands.size());
+    for (size_t i = 0, count = keys.size(); i < count; ++i)
+    {
+        sorted[i] = commands[static_cast<uint32_t>(keys[i])];
+    }
+    commands.swap(sorted);
 }
 
 RenderCommand* RenderQueue::operator[](ssize_t index) const
@@ -129,10 +246,11 @@ RenderCommand* RenderQueue::operator[](ssize_t index) const
 
 void RenderQueue::clear()
 {
-    _commands.clear();
+    // keep the capacity of the sub queues, they are refilled every frame
     for(int index = 0; index < QUEUE_COUNT; ++index)
     {
-        _commands.push_back(std::vector<RenderCommand*>());
+        _commands[index].clear();
+        _sortKeys[index].clear();
     }
 }
 
@@ -186,6 +304,12 @@ Renderer::Renderer()
 ,_filledIndex(0)
 ,_numberQuads(0)
 ,_glViewAssigned(false)
+,_drawnBatches(0)
+,_drawnVertices(0)
+,_frameCommandCount(0)
+,_frameArenaBytes(0)
+,_peakFrameCommandCount(0)
+,_peakFrameArenaBytes(0)
 ,_isRendering(false)
 ,_isDepthTestFor2D(false)
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -625,6 +749,8 @@ void Renderer::visitRenderQueue(RenderQueue& queue)
 
 void Renderer::render()
 {
+    CC_PROFILE_ZONE("Renderer::render");
+    
     //Uncomment this once everything is rendered by new renderer
     //glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -650,14 +776,18 @@ void Renderer::clean()
     // Clear render group
     for (size_t j = 0 ; j < _renderGroups.size(); j++)
     {
-        //commands are owned by nodes
-        // for (const auto &cmd : _renderGroups[j])
-        // {
-        //     cmd->releaseToCommandPool();
-        // }
+        //commands are owned by nodes or by the frame arena
         _renderGroups[j].clear();
     }
 
+    // Release the frame commands in one go. The renderer may be flushed more than once per frame (one per camera),
+    // so the stats are accumulated until clearDrawStats() is called
+    _frameCommandCount += _frameCommandArena.getCommandCount();
+    _frameArenaBytes += _frameCommandArena.getUsedBytes();
+    _peakFrameCommandCount = std::max(_peakFrameCommandCount, _frameCommandCount);
+    _peakFrameArenaBytes = std::max(_peakFrameArenaBytes, _frameArenaBytes);
+    _frameCommandArena.reset();
+
     // Clear batch commands
     _batchedCommands.clear();
     _batchQuadCommands.clear();
@@ -945,6 +1075,8 @@ void Renderer::drawBatchedQuads()
 
 void Renderer::flush()
 {
+    CC_PROFILE_ZONE("Renderer::flush");
+    
     flush2D();
     flush3D();
 }
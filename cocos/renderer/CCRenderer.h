@@ -31,6 +31,7 @@
 
 #include "platform/CCPlatformMacros.h"
 #include "renderer/CCRenderCommand.h"
+#include "renderer/CCRenderCommandPool.h"
 #include "renderer/CCGLProgram.h"
 #include "platform/CCGL.h"
 
@@ -44,9 +45,13 @@ class MeshCommand;
 /** Class that knows how to sort `RenderCommand` objects.
  Since the commands that have `z == 0` are "pushed back" in
  the correct order, the only `RenderCommand` objects that need to be sorted,
- are the ones that have `z < 0` and `z > 0`.
+ are the ones that have `z < 0` and `z > 0`, and the transparent 3D ones.
+
+ The sort key of each command is computed when it is pushed: the high 32 bits keep
+ the globalZOrder (or the inverted depth for transparent 3D commands) and the low 32 bits
+ keep the submission index, so the commands are radix sorted in a stable way.
 */
-class RenderQueue {
+class CC_DLL RenderQueue {
 public:
     enum QUEUE_GROUP
     {
@@ -58,11 +63,11 @@ public:
         QUEUE_COUNT = 5,
     };
 
+    /** Minimum number of commands of a sub queue to sort it on a worker thread */
+    static const size_t PARALLEL_SORT_THRESHOLD = 4096;
+
 public:
-    RenderQueue()
-    {
-        clear();
-    }
+    RenderQueue();
     void push_back(RenderCommand* command);
     ssize_t size() const;
     void sort();
@@ -75,8 +80,15 @@ public:
     void restoreRenderState();
     
 protected:
-    
+    void pushSorted(QUEUE_GROUP group, RenderCommand* command, uint32_t sortValue);
+    void sortSubQueue(QUEUE_GROUP group);
+
     std::vector<std::vector<RenderCommand*>> _commands;
+
+    // packed sort keys of the sorted sub queues, and scratch buffers reused between frames
+    std::vector<uint64_t> _sortKeys[QUEUE_COUNT];
+    std::vector<uint64_t> _sortScratch[QUEUE_COUNT];
+    std::vector<RenderCommand*> _commandScratch[QUEUE_COUNT];
     
     //Render State related
     bool _isCullEnabled;
@@ -146,7 +158,22 @@ public:
     /* RenderCommands (except) QuadCommand should update this value */
     void addDrawnVertices(ssize_t number) { _drawnVertices += number; };
     /* clear draw stats */
-    void clearDrawStats() { _drawnBatches = _drawnVertices = 0; }
+    void clearDrawStats() { _drawnBatches = _drawnVertices = 0; _frameCommandCount = 0; _frameArenaBytes = 0; }
+
+    /** Creates a `RenderCommand` from the frame arena.
+     The command doesn't need to be released: it is destroyed once the render queue that contains it was rendered.
+     Use it for commands that are generated each frame, instead of owning them in the node.
+     */
+    template <class T>
+    T* createFrameCommand() { return _frameCommandArena.allocateCommand<T>(); }
+    /* returns the number of commands created from the frame arena in the last frame */
+    ssize_t getFrameCommandCount() const { return _frameCommandCount; }
+    /* returns the bytes used by the frame arena in the last frame */
+    size_t getFrameArenaBytes() const { return _frameArenaBytes; }
+    /* returns the maximum number of commands created from the frame arena in one frame */
+    ssize_t getPeakFrameCommandCount() const { return _peakFrameCommandCount; }
+    /* returns the maximum number of bytes used by the frame arena in one frame */
+    size_t getPeakFrameArenaBytes() const { return _peakFrameArenaBytes; }
 
     /**
      * Enable/Disable depth test
@@ -220,6 +247,13 @@ protected:
     // stats
     ssize_t _drawnBatches;
     ssize_t _drawnVertices;
+
+    // commands which live until the end of the render pass
+    RenderCommandArena _frameCommandArena;
+    ssize_t _frameCommandCount;
+    size_t _frameArenaBytes;
+    ssize_t _peakFrameCommandCount;
+    size_t _peakFrameArenaBytes;
     //the flag for checking whether renderer is rendering
     bool _isRendering;
     
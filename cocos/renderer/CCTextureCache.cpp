@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include <stack>
 #include <cctype>
 #include <list>
+#include <chrono>
 
 #include "renderer/CCTexture2D.h"
 #include "base/ccMacros.h"
@@ -52,11 +53,10 @@ TextureCache * TextureCache::getInstance()
 }
 
 TextureCache::TextureCache()
-: _loadingThread(nullptr)
-, _asyncStructQueue(nullptr)
-, _imageInfoQueue(nullptr)
-, _needQuit(false)
-, _asyncRefCount(0)
+: _decodingCount(0)
+, _maxDecodingCount(0)
+, _uploadBytesPerFrame(0)
+, _uploadTimePerFrame(4)
 {
 }
 
@@ -66,8 +66,6 @@ TextureCache::~TextureCache()
 
     for( auto it=_textures.begin(); it!=_textures.end(); ++it)
         (it->second)->release();
-
-    CC_SAFE_DELETE(_loadingThread);
 }
 
 void TextureCache::destroyInstance()
@@ -89,6 +87,11 @@ std::string TextureCache::getDescription() const
 }
 
 void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback)
+{
+    addImageAsync(path, callback, AsyncPriority::NORMAL);
+}
+
+void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, AsyncPriority priority)
 {
     Texture2D *texture = nullptr;
 
@@ -104,166 +107,129 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
         return;
     }
 
-    // lazy init
-    if (_asyncStructQueue == nullptr)
-    {             
-        _asyncStructQueue = new queue<AsyncStruct*>();
-        _imageInfoQueue   = new deque<ImageInfo*>();        
-
-        // create a new thread to load images
-        _loadingThread = new std::thread(&TextureCache::loadImage, this);
+    // the image is already being loaded, wait for the same texture
+    auto pending = _asyncStructs.find(fullpath);
+    if (pending != _asyncStructs.end())
+    {
+        AsyncStruct *asyncStruct = pending->second;
+        asyncStruct->callbacks.push_back(callback);
 
-        _needQuit = false;
+        // raise the priority of a request that is still waiting for a decode worker
+        if (!asyncStruct->job && priority < asyncStruct->priority)
+        {
+            auto& queue = _asyncStructQueues[static_cast<int>(asyncStruct->priority)];
+            queue.erase(std::find(queue.begin(), queue.end(), asyncStruct));
+            asyncStruct->priority = priority;
+            _asyncStructQueues[static_cast<int>(priority)].push_back(asyncStruct);
+        }
+        return;
     }
 
-    if (0 == _asyncRefCount)
+    if (_asyncStructs.empty())
     {
         Director::getInstance()->getScheduler()->schedule(CC_SCHEDULE_SELECTOR(TextureCache::addImageAsyncCallBack), this, 0, false);
     }
 
-    ++_asyncRefCount;
-
     // generate async struct
-    AsyncStruct *data = new (std::nothrow) AsyncStruct(fullpath, callback);
-
-    // add async struct into queue
-    _asyncStructQueueMutex.lock();
-    _asyncStructQueue->push(data);
-    _asyncStructQueueMutex.unlock();
+    AsyncStruct *data = new (std::nothrow) AsyncStruct(fullpath, priority);
+    data->callbacks.push_back(callback);
+    _asyncStructs.insert(std::make_pair(fullpath, data));
+    _asyncStructQueues[static_cast<int>(priority)].push_back(data);
 
-    _sleepCondition.notify_one();
+    dispatchImageLoads();
 }
 
 void TextureCache::unbindImageAsync(const std::string& filename)
 {
-    _imageInfoMutex.lock();
-    if (_imageInfoQueue && !_imageInfoQueue->empty())
+    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(filename);
+    auto found = _asyncStructs.find(fullpath);
+    if (found != _asyncStructs.end())
     {
-        std::string fullpath = FileUtils::getInstance()->fullPathForFilename(filename);
-        auto found = std::find_if(_imageInfoQueue->begin(), _imageInfoQueue->end(), [&fullpath](ImageInfo* ptr)->bool{ return ptr->asyncStruct->filename == fullpath; });
-        if (found != _imageInfoQueue->end())
-        {
-            (*found)->asyncStruct->callback = nullptr;
-        }
+        found->second->callbacks.clear();
     }
-    _imageInfoMutex.unlock();
 }
 
 void TextureCache::unbindAllImageAsync()
 {
-    _imageInfoMutex.lock();
-    if (_imageInfoQueue && !_imageInfoQueue->empty())
+    for (auto& pending : _asyncStructs)
     {
-        std::for_each(_imageInfoQueue->begin(), _imageInfoQueue->end(), [](ImageInfo* ptr) { ptr->asyncStruct->callback = nullptr; });
+        pending.second->callbacks.clear();
     }
-    _imageInfoMutex.unlock();
 }
 
-void TextureCache::loadImage()
+void TextureCache::dispatchImageLoads()
 {
-    AsyncStruct *asyncStruct = nullptr;
+    auto jobSystem = JobSystem::getInstance();
+    int maxDecodingCount = _maxDecodingCount > 0 ? _maxDecodingCount : jobSystem->getWorkerCount();
 
-    while (true)
+    for (auto& queue : _asyncStructQueues)
     {
-        std::queue<AsyncStruct*> *pQueue = _asyncStructQueue;
-        _asyncStructQueueMutex.lock();
-        if (pQueue->empty())
-        {
-            _asyncStructQueueMutex.unlock();
-            if (_needQuit) {
-                break;
-            }
-            else {
-                std::unique_lock<std::mutex> lk(_sleepMutex);
-                _sleepCondition.wait(lk);
-                continue;
-            }
-        }
-        else
+        while (!queue.empty() && _decodingCount < maxDecodingCount)
         {
-            asyncStruct = pQueue->front();
-            pQueue->pop();
-            _asyncStructQueueMutex.unlock();
-        }        
-
-        Image *image = nullptr;
-        bool generateImage = false;
+            AsyncStruct *asyncStruct = queue.front();
+            queue.pop_front();
 
-        auto it = _textures.find(asyncStruct->filename);
-        if( it == _textures.end() )
-        {
-           _imageInfoMutex.lock();
-           ImageInfo *imageInfo;
-           size_t pos = 0;
-           size_t infoSize = _imageInfoQueue->size();
-           for (; pos < infoSize; pos++)
-           {
-               imageInfo = (*_imageInfoQueue)[pos];
-               if(imageInfo->asyncStruct->filename.compare(asyncStruct->filename) == 0)
-                   break;
-           }
-           _imageInfoMutex.unlock();
-           if(infoSize == 0 || pos == infoSize)
-               generateImage = true;
+            ++_decodingCount;
+            asyncStruct->job = jobSystem->schedule(std::bind(&TextureCache::loadImage, this, asyncStruct), JobSystem::Priority::LOW);
         }
-
-        if (generateImage)
-        {
-            const std::string& filename = asyncStruct->filename;
-            // generate image      
-            image = new (std::nothrow) Image();
-            if (image && !image->initWithImageFileThreadSafe(filename))
-            {
-                CC_SAFE_RELEASE(image);
-                CCLOG("can not load %s", filename.c_str());
-                continue;
-            }
-        }    
-
-        // generate image info
-        ImageInfo *imageInfo = new (std::nothrow) ImageInfo();
-        imageInfo->asyncStruct = asyncStruct;
-        imageInfo->image = image;
-
-        // put the image info into the queue
-        _imageInfoMutex.lock();
-        _imageInfoQueue->push_back(imageInfo);
-        _imageInfoMutex.unlock();
     }
-    
-	if(_asyncStructQueue != nullptr)
+}
+
+void TextureCache::loadImage(AsyncStruct* asyncStruct)
+{
+    // runs on a JobSystem worker
+    const std::string& filename = asyncStruct->filename;
+    Image *image = new (std::nothrow) Image();
+    if (image && !image->initWithImageFileThreadSafe(filename))
     {
-        delete _asyncStructQueue;
-	    _asyncStructQueue = nullptr;
-        delete _imageInfoQueue;
-	    _imageInfoQueue = nullptr;
+        CC_SAFE_RELEASE_NULL(image);
+        CCLOG("can not load %s", filename.c_str());
     }
+    asyncStruct->image = image;
+
+    _imageInfoMutex.lock();
+    _imageInfoQueue.push_back(asyncStruct);
+    _imageInfoMutex.unlock();
 }
 
 void TextureCache::addImageAsyncCallBack(float dt)
 {
-    // the image is generated in loading thread
-    std::deque<ImageInfo*> *imagesQueue = _imageInfoQueue;
-
+    // the images are decoded by the JobSystem workers
+    std::deque<AsyncStruct*> decoded;
     _imageInfoMutex.lock();
-    if (imagesQueue->empty())
-    {
-        _imageInfoMutex.unlock();
-    }
-    else
+    decoded.swap(_imageInfoQueue);
+    _imageInfoMutex.unlock();
+
+    // upload the textures until the budget of the frame is spent, the other ones wait for the next frame
+    auto start = std::chrono::steady_clock::now();
+    size_t uploadedBytes = 0;
+    size_t uploadedCount = 0;
+    for (; uploadedCount < decoded.size(); ++uploadedCount)
     {
-        ImageInfo *imageInfo = imagesQueue->front();
-        imagesQueue->pop_front();
-        _imageInfoMutex.unlock();
+        if (uploadedCount > 0)
+        {
+            float elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if ((_uploadBytesPerFrame > 0 && uploadedBytes >= _uploadBytesPerFrame)
+                || (_uploadTimePerFrame > 0 && elapsed >= _uploadTimePerFrame))
+                break;
+        }
 
-        AsyncStruct *asyncStruct = imageInfo->asyncStruct;
-        Image *image = imageInfo->image;
+        AsyncStruct *asyncStruct = decoded[uploadedCount];
+        Image *image = asyncStruct->image;
 
         const std::string& filename = asyncStruct->filename;
 
         Texture2D *texture = nullptr;
-        if (image)
+        auto it = _textures.find(filename);
+        if (it != _textures.end())
         {
+            // loaded synchronously in the meantime
+            texture = it->second;
+        }
+        else if (image)
+        {
+            uploadedBytes += image->getDataLen();
+
             // generate texture in render thread
             texture = new (std::nothrow) Texture2D();
 
@@ -279,30 +245,37 @@ void TextureCache::addImageAsyncCallBack(float dt)
 
             texture->autorelease();
         }
-        else
-        {
-            auto it = _textures.find(asyncStruct->filename);
-            if(it != _textures.end())
-                texture = it->second;
-        }
-        
-        if (asyncStruct->callback)
+
+        // the callbacks may add or unbind other images
+        _asyncStructs.erase(filename);
+        if (texture)
         {
-            asyncStruct->callback(texture);
+            for (const auto& callback : asyncStruct->callbacks)
+            {
+                if (callback)
+                    callback(texture);
+            }
         }
-        
-        if(image)
-        {
-            image->release();
-        }       
+
+        CC_SAFE_RELEASE(image);
         delete asyncStruct;
-        delete imageInfo;
+    }
 
-        --_asyncRefCount;
-        if (0 == _asyncRefCount)
-        {
-            Director::getInstance()->getScheduler()->unschedule(CC_SCHEDULE_SELECTOR(TextureCache::addImageAsyncCallBack), this);
-        }
+    if (uploadedCount < decoded.size())
+    {
+        // keep the images over budget first in line for the next frame
+        _imageInfoMutex.lock();
+        _imageInfoQueue.insert(_imageInfoQueue.begin(), decoded.begin() + uploadedCount, decoded.end());
+        _imageInfoMutex.unlock();
+    }
+
+    // the decoded images waiting for the upload keep their decode slot, it bounds the memory they use
+    _decodingCount -= static_cast<int>(uploadedCount);
+    dispatchImageLoads();
+
+    if (_asyncStructs.empty())
+    {
+        Director::getInstance()->getScheduler()->unschedule(CC_SCHEDULE_SELECTOR(TextureCache::addImageAsyncCallBack), this);
     }
 }
 
@@ -519,10 +492,24 @@ void TextureCache::reloadAllTextures()
 
 void TextureCache::waitForQuit()
 {
-    // notify sub thread to quick
-    _needQuit = true;
-    _sleepCondition.notify_one();
-    if (_loadingThread) _loadingThread->join();
+    // drop the requests that are not decoded yet, and wait for the decode jobs in flight
+    for (auto& queue : _asyncStructQueues)
+    {
+        queue.clear();
+    }
+    for (const auto& pending : _asyncStructs)
+    {
+        if (pending.second->job)
+            JobSystem::getInstance()->wait(pending.second->job);
+    }
+    for (const auto& pending : _asyncStructs)
+    {
+        CC_SAFE_RELEASE(pending.second->image);
+        delete pending.second;
+    }
+    _asyncStructs.clear();
+    _imageInfoQueue.clear();
+    _decodingCount = 0;
 }
 
 std::string TextureCache::getCachedTextureInfo() const
@@ -30,14 +30,13 @@ THE SOFTWARE.
 
 #include <string>
 #include <mutex>
-#include <thread>
-#include <condition_variable>
-#include <queue>
-#include <string>
+#include <deque>
+#include <vector>
 #include <unordered_map>
 #include <functional>
 
 #include "base/CCRef.h"
+#include "base/CCJobSystem.h"
 #include "renderer/CCTexture2D.h"
 #include "platform/CCImage.h"
 
@@ -64,6 +63,15 @@ NS_CC_BEGIN
 class CC_DLL TextureCache : public Ref
 {
 public:
+    /** Order in which the images loaded asynchronously are decoded */
+    enum class AsyncPriority
+    {
+        HIGH,
+        NORMAL,
+        LOW,
+        COUNT,
+    };
+
     /** Returns the shared instance of the cache */
     CC_DEPRECATED_ATTRIBUTE static TextureCache * getInstance();
 
@@ -118,6 +126,29 @@ public:
     * @since v0.8
     */
     virtual void addImageAsync(const std::string &filepath, const std::function<void(Texture2D*)>& callback);
+
+    /* Same as addImageAsync(filepath, callback), the images of higher priority are decoded first.
+    * A request for an image that is already being loaded doesn't decode it again, the callback is added to the pending request.
+    */
+    virtual void addImageAsync(const std::string &filepath, const std::function<void(Texture2D*)>& callback, AsyncPriority priority);
+
+    /** Sets the maximum number of images decoded at the same time by the JobSystem workers.
+    * 0, the default, means one image per worker.
+    */
+    void setAsyncDecodeWorkerCount(int count) { _maxDecodingCount = count; }
+    int getAsyncDecodeWorkerCount() const { return _maxDecodingCount; }
+
+    /** Sets how many bytes of decoded images can be uploaded to textures per frame, 0 means no limit.
+    * At least one texture is uploaded per frame.
+    */
+    void setAsyncUploadBytesPerFrame(size_t bytes) { _uploadBytesPerFrame = bytes; }
+    size_t getAsyncUploadBytesPerFrame() const { return _uploadBytesPerFrame; }
+
+    /** Sets how many milliseconds can be spent per frame uploading decoded images to textures, 0 means no limit.
+    * At least one texture is uploaded per frame.
+    */
+    void setAsyncUploadTimePerFrame(float milliseconds) { _uploadTimePerFrame = milliseconds; }
+    float getAsyncUploadTimePerFrame() const { return _uploadTimePerFrame; }
     
     /* Unbind a specified bound image asynchronous callback
      * In the case an object who was bound to an image asynchronous callback was destroyed before the callback is invoked,
@@ -189,41 +220,38 @@ public:
     //called by director, please do not called outside
     void waitForQuit();
 
-private:
-    void addImageAsyncCallBack(float dt);
-    void loadImage();
-
 public:
     struct AsyncStruct
     {
     public:
-        AsyncStruct(const std::string& fn, std::function<void(Texture2D*)> f) : filename(fn), callback(f) {}
+        AsyncStruct(const std::string& fn, AsyncPriority p) : filename(fn), priority(p), image(nullptr) {}
 
         std::string filename;
-        std::function<void(Texture2D*)> callback;
+        std::vector<std::function<void(Texture2D*)>> callbacks;
+        AsyncPriority priority;
+        // set by the decode job
+        Image* image;
+        JobSystem::JobHandle job;
     };
 
-protected:
-    typedef struct _ImageInfo
-    {
-        AsyncStruct *asyncStruct;
-        Image        *image;
-    } ImageInfo;
-    
-    std::thread* _loadingThread;
-
-    std::queue<AsyncStruct*>* _asyncStructQueue;
-    std::deque<ImageInfo*>* _imageInfoQueue;
+private:
+    void addImageAsyncCallBack(float dt);
+    void loadImage(AsyncStruct* asyncStruct);
+    void dispatchImageLoads();
 
-    std::mutex _asyncStructQueueMutex;
+protected:
+    // requests by full path, until their textures are uploaded
+    std::unordered_map<std::string, AsyncStruct*> _asyncStructs;
+    // requests waiting for a decode worker
+    std::deque<AsyncStruct*> _asyncStructQueues[static_cast<int>(AsyncPriority::COUNT)];
+    // images decoded by the workers, waiting for the upload
+    std::deque<AsyncStruct*> _imageInfoQueue;
     std::mutex _imageInfoMutex;
 
-    std::mutex _sleepMutex;
-    std::condition_variable _sleepCondition;
-
-    bool _needQuit;
-
-    int _asyncRefCount;
+    int _decodingCount;
+    int _maxDecodingCount;
+    size_t _uploadBytesPerFrame;
+    float _uploadTimePerFrame;
 
     std::unordered_map<std::string, Texture2D*> _textures;
 };
@@ -26,6 +26,7 @@
 #include "AllocatorTest.h"
 #include "cocos2d.h"
 #include <chrono>
+#include <thread>
 
 namespace AllocatorTestNS
 {
@@ -38,7 +39,8 @@ namespace AllocatorTestNS
     
     static std::function<Layer*()> createFunctions[] =
     {
-        CL(AllocatorTest)
+        CL(AllocatorTest),
+        CL(AllocatorThreadTest)
     };
     
 #define MAX_LAYER (sizeof(createFunctions) / sizeof(createFunctions[0]))
@@ -148,17 +150,122 @@ namespace AllocatorTestNS
     {
     }
     
-    std::string AllocatorTest::title() const
+    //
+    // AllocatorThreadTest
+    //
+    
+#define kThreadIterations 20
+#define kThreadBlocks 5000
+    
+    AllocatorThreadTest::AllocatorThreadTest()
+    {
+        char buf[1000];
+        
+        const float x_start = 240;
+        const float y_start = 100;
+        const float y_delta = 20;
+        float y = 0;
+        
+        for (int threadCount = 1; threadCount <= 8; threadCount *= 2)
+        {
+            // the same blocks with malloc/free, which never go through the allocator, as a baseline
+            sprintf(buf, "%d thread(s) new/delete %f malloc/free %f", threadCount, run(threadCount, false), run(threadCount, true));
+            auto label = Label::createWithSystemFont(buf, "Helvetica", 12);
+            label->setPosition(x_start, y++ * y_delta + y_start);
+            addChild(label);
+        }
+    }
+    
+    double AllocatorThreadTest::run(int threadCount, bool useMalloc)
+    {
+        typedef std::vector<char*> tBlocks;
+        std::vector<tBlocks> blocks(threadCount);
+        
+        auto allocateBlock = [useMalloc](size_t size)
+        {
+            return useMalloc ? static_cast<char*>(malloc(size)) : new char[size];
+        };
+        
+        auto freeBlock = [useMalloc](char* block)
+        {
+            if (useMalloc)
+                free(block);
+            else
+                delete [] block;
+        };
+        
+        auto allocate = [&blocks, &allocateBlock, &freeBlock](int index)
+        {
+            tBlocks& mine = blocks[index];
+            mine.reserve(kThreadBlocks);
+            for (int i = 0; i < kThreadBlocks; ++i)
+                mine.push_back(allocateBlock(16 + (i % 8) * 16));
+            
+            // free half of them here, the other half is freed by the next thread
+            for (int i = 0; i < kThreadBlocks; i += 2)
+                freeBlock(mine[i]);
+        };
+        
+        auto deallocate = [&blocks, &freeBlock, threadCount](int index)
+        {
+            tBlocks& theirs = blocks[(index + 1) % threadCount];
+            for (int i = 1; i < kThreadBlocks; i += 2)
+                freeBlock(theirs[i]);
+            theirs.clear();
+        };
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int iteration = 0; iteration < kThreadIterations; ++iteration)
+        {
+            std::vector<std::thread> threads;
+            for (int i = 0; i < threadCount; ++i)
+                threads.push_back(std::thread(allocate, i));
+            for (auto& thread : threads)
+                thread.join();
+            
+            threads.clear();
+            for (int i = 0; i < threadCount; ++i)
+                threads.push_back(std::thread(deallocate, i));
+            for (auto& thread : threads)
+                thread.join();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        std::chrono::duration<double> elapsed_seconds = end - start;
+        return elapsed_seconds.count();
+    }
+    
+    std::string AllocatorThreadTest::title() const
+    {
+        return "Allocator Thread Test";
+    }
+    
+    std::string AllocatorThreadTest::subtitle() const
+    {
+#if CC_ENABLE_ALLOCATOR && CC_ENABLE_ALLOCATOR_GLOBAL_NEW_DELETE && CC_ENABLE_ALLOCATOR_THREAD_CACHE
+        return "global new/delete with thread caches";
+#elif CC_ENABLE_ALLOCATOR && CC_ENABLE_ALLOCATOR_GLOBAL_NEW_DELETE
+        return "global new/delete without thread caches";
+#else
+        return "system new/delete";
+#endif
+    }
+    
+    //
+    // AllocatorTestBase
+    //
+    
+    std::string AllocatorTestBase::title() const
     {
         return "Allocator Test";
     }
     
-    std::string AllocatorTest::subtitle() const
+    std::string AllocatorTestBase::subtitle() const
     {
         return "";
     }
     
-    void AllocatorTest::restartCallback( Ref* sender )
+    void AllocatorTestBase::restartCallback( Ref* sender )
     {
         auto s = new AllocatorTestScene();
         s->addChild(restartAllocatorTestAction());
@@ -166,7 +273,7 @@ namespace AllocatorTestNS
         s->release();
     }
     
-    void AllocatorTest::nextCallback( Ref* sender )
+    void AllocatorTestBase::nextCallback( Ref* sender )
     {
         auto s = new AllocatorTestScene();
         s->addChild( nextAllocatorTestAction() );
@@ -174,7 +281,7 @@ namespace AllocatorTestNS
         s->release();
     }
     
-    void AllocatorTest::backCallback( Ref* sender )
+    void AllocatorTestBase::backCallback( Ref* sender )
     {
         auto s = new AllocatorTestScene();
         s->addChild( backAllocatorTestAction() );
@@ -182,17 +289,17 @@ namespace AllocatorTestNS
         s->release();
     }
     
-    void AllocatorTest::onEnter()
+    void AllocatorTestBase::onEnter()
     {
         BaseTest::onEnter();
     }
     
-    void AllocatorTest::onExit()
+    void AllocatorTestBase::onExit()
     {
         BaseTest::onExit();
     }
     
-    void AllocatorTest::update(float delta)
+    void AllocatorTestBase::update(float delta)
     {
     }
     
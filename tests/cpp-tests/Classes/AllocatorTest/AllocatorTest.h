@@ -69,13 +69,9 @@ namespace AllocatorTestNS
         uint8_t bytes[kObjectSize];
     };
     
-    class AllocatorTest : public BaseTest
+    class AllocatorTestBase : public BaseTest
     {
     public:
-        CREATE_FUNC(AllocatorTest);
-        AllocatorTest();
-        virtual ~AllocatorTest();
-        
         virtual std::string title() const;
         virtual std::string subtitle() const;
         
@@ -89,6 +85,29 @@ namespace AllocatorTestNS
         virtual void update(float delta);
     };
     
+    class AllocatorTest : public AllocatorTestBase
+    {
+    public:
+        CREATE_FUNC(AllocatorTest);
+        AllocatorTest();
+        virtual ~AllocatorTest();
+    };
+    
+    // new/delete of small blocks from several threads, half of the blocks are freed by another thread
+    // than the one that allocated them.
+    class AllocatorThreadTest : public AllocatorTestBase
+    {
+    public:
+        CREATE_FUNC(AllocatorThreadTest);
+        AllocatorThreadTest();
+        
+        virtual std::string title() const override;
+        virtual std::string subtitle() const override;
+        
+    protected:
+        double run(int threadCount, bool useMalloc);
+    };
+    
     class AllocatorTestScene : public TestScene
     {
     public:
@@ -1,5 +1,8 @@
 #include "FileUtilsTest.h"
 
+#include <cfloat>
+#include <chrono>
+
 static std::function<Layer*()> createFunctions[] = {
     CL(TestResolutionDirectories),
     CL(TestSearchPath),
@@ -8,6 +11,9 @@ static std::function<Layer*()> createFunctions[] = {
     CL(TestFileFuncs),
     CL(TestDirectoryFuncs),
     CL(TextWritePlist),
+    CL(TestMappedData),
+    CL(TestResourcePack),
+    CL(TestBinaryPlist),
 };
 
 static int sceneIdx=-1;
@@ -550,3 +556,307 @@ std::string TextWritePlist::subtitle() const
     std::string writablePath = FileUtils::getInstance()->getWritablePath().c_str();
     return ("See plist file at your writablePath");
 }
+
+// TestMappedData
+
+// resident anonymous memory in KB, the heap copies of the files count in it but not the mapped pages
+static long getAnonymousMemory()
+{
+    long kb = 0;
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+    FILE* fp = fopen("/proc/self/status", "r");
+    if (fp)
+    {
+        char line[128];
+        while (fgets(line, sizeof(line), fp))
+        {
+            if (sscanf(line, "RssAnon: %ld", &kb) == 1)
+                break;
+        }
+        fclose(fp);
+    }
+#endif
+    return kb;
+}
+
+void TestMappedData::onEnter()
+{
+    FileUtilsDemo::onEnter();
+    auto s = Director::getInstance()->getWinSize();
+    auto sharedFileUtils = FileUtils::getInstance();
+
+    static const char* files[] = { "Sprite3DTest/ReskinGirl.c3b", "Sprite3DTest/LightMapScene.c3b", "Images/landscape-1024x1024.png" };
+    static const int LOAD_COUNT = 20;
+
+    // reads every page, as a parser does
+    auto touch = [](const unsigned char* bytes, ssize_t size) {
+        unsigned int sum = 0;
+        for (ssize_t i = 0; i < size; i += 4096)
+            sum += bytes[i];
+        return sum;
+    };
+
+    int y = s.height * 3 / 4;
+    for (const auto& file : files)
+    {
+        // warm the file cache of the os, both paths read the same pages
+        touch(sharedFileUtils->getDataFromFile(file).getBytes(), sharedFileUtils->getFileSize(file));
+
+        unsigned int sum = 0;
+        long readMemory = getAnonymousMemory();
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::vector<Data> datas;
+            for (int i = 0; i < LOAD_COUNT; ++i)
+            {
+                datas.push_back(sharedFileUtils->getDataFromFile(file));
+                sum += touch(datas.back().getBytes(), datas.back().getSize());
+            }
+            readMemory = getAnonymousMemory() - readMemory;
+        }
+        float readTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        long mappedMemory = getAnonymousMemory();
+        start = std::chrono::steady_clock::now();
+        {
+            std::vector<MappedData> datas;
+            for (int i = 0; i < LOAD_COUNT; ++i)
+            {
+                datas.push_back(sharedFileUtils->getMappedDataFromFile(file));
+                sum += touch(datas.back().getBytes(), datas.back().getSize());
+            }
+            mappedMemory = getAnonymousMemory() - mappedMemory;
+        }
+        float mappedTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        auto msg = StringUtils::format("%s x%d: read %.2f ms %ld KB, mapped %.2f ms %ld KB", file, LOAD_COUNT, readTime, readMemory, mappedTime, mappedMemory);
+        log("%s (%u)", msg.c_str(), sum);
+        auto label = Label::createWithSystemFont(msg, "", 16);
+        label->setPosition(s.width/2, y);
+        this->addChild(label);
+        y -= 40;
+    }
+}
+
+std::string TestMappedData::title() const
+{
+    return "FileUtils: getMappedDataFromFile";
+}
+
+std::string TestMappedData::subtitle() const
+{
+    return "Load time and resident heap of getDataFromFile and getMappedDataFromFile";
+}
+
+// TestResourcePack
+
+// Misc/resources.cpk packs the small files of Images/:
+// tools/resource-pack/pack_resources.py <dir with the Images/ files smaller than 12KB> Misc/resources.cpk
+static const char* RESOURCE_PACK = "Misc/resources.cpk";
+
+void TestResourcePack::onEnter()
+{
+    FileUtilsDemo::onEnter();
+    auto s = Director::getInstance()->getWinSize();
+    auto sharedFileUtils = FileUtils::getInstance();
+
+    // the names of the packed files, the same files exist loose in the resources
+    std::vector<std::string> files;
+    {
+        ResourcePack pack;
+        if (!pack.open(sharedFileUtils->fullPathForFilename(RESOURCE_PACK)))
+        {
+            auto label = Label::createWithSystemFont("Can't open Misc/resources.cpk", "", 20);
+            label->setPosition(s.width/2, s.height/2);
+            this->addChild(label);
+            return;
+        }
+        for (const auto& entry : pack.getEntries())
+        {
+            files.push_back(pack.getEntryName(entry));
+        }
+    }
+
+    // resolves and reads every file, as a game does while it starts
+    auto load = [&]() {
+        sharedFileUtils->purgeCachedEntries();
+        size_t bytes = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& file : files)
+        {
+            bytes += sharedFileUtils->getDataFromFile(sharedFileUtils->fullPathForFilename(file)).getSize();
+        }
+        float time = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return std::make_pair(time, bytes);
+    };
+
+    static const int ROUND_COUNT = 5;
+    float looseTime = FLT_MAX, packTime = FLT_MAX;
+    size_t looseBytes = 0, packBytes = 0;
+
+    for (int i = 0; i < ROUND_COUNT; ++i)
+    {
+        auto result = load();
+        looseTime = std::min(looseTime, result.first);
+        looseBytes = result.second;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool mounted = sharedFileUtils->mountResourcePack(RESOURCE_PACK);
+    float mountTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    for (int i = 0; mounted && i < ROUND_COUNT; ++i)
+    {
+        auto result = load();
+        packTime = std::min(packTime, result.first);
+        packBytes = result.second;
+    }
+
+    const char* packedPath = "Images/grossini.png";
+    std::string messages[] = {
+        StringUtils::format("%d files, best of %d rounds", (int)files.size(), ROUND_COUNT),
+        StringUtils::format("loose files: %.2f ms, %d bytes", looseTime, (int)looseBytes),
+        StringUtils::format("pack: mount %.2f ms, %.2f ms, %d bytes", mountTime, packTime, (int)packBytes),
+        StringUtils::format("%s -> %s", packedPath, sharedFileUtils->fullPathForFilename(packedPath).c_str()),
+    };
+
+    int y = s.height * 3 / 4;
+    for (const auto& msg : messages)
+    {
+        log("%s", msg.c_str());
+        auto label = Label::createWithSystemFont(msg, "", 16);
+        label->setPosition(s.width/2, y);
+        this->addChild(label);
+        y -= 40;
+    }
+
+    // the sprite is loaded from the pack
+    auto sprite = Sprite::create(packedPath);
+    if (sprite)
+    {
+        sprite->setPosition(s.width/2, y - 40);
+        this->addChild(sprite);
+    }
+}
+
+void TestResourcePack::onExit()
+{
+    auto sharedFileUtils = FileUtils::getInstance();
+    sharedFileUtils->unmountResourcePack(RESOURCE_PACK);
+    sharedFileUtils->purgeCachedEntries();
+
+    FileUtilsDemo::onExit();
+}
+
+std::string TestResourcePack::title() const
+{
+    return "FileUtils: mountResourcePack";
+}
+
+std::string TestResourcePack::subtitle() const
+{
+    return "Startup load time of loose files and of the same files in a resource pack";
+}
+
+// TestBinaryPlist
+
+static const char* BINARY_PLIST_XML = "binary_plist_test_xml.plist";
+static const char* BINARY_PLIST_BINARY = "binary_plist_test_binary.plist";
+
+// a large sprite sheet, in the format 2 of the sprite frame cache
+static ValueMap createSpriteSheet(int frameCount)
+{
+    ValueMap frames;
+    for (int i = 0; i < frameCount; ++i)
+    {
+        ValueMap frame;
+        frame["frame"] = Value(StringUtils::format("{{%d,%d},{30,30}}", (i % 64) * 32, (i / 64) * 32));
+        frame["offset"] = Value("{0,0}");
+        frame["rotated"] = Value(i % 3 == 0);
+        frame["sourceColorRect"] = Value("{{1,1},{30,30}}");
+        frame["sourceSize"] = Value("{32,32}");
+        frames[StringUtils::format("sprite_%04d.png", i)] = Value(frame);
+    }
+    
+    ValueMap metadata;
+    metadata["format"] = Value(2);
+    metadata["realTextureFileName"] = Value("sprites.png");
+    metadata["size"] = Value("{2048,2048}");
+    metadata["textureFileName"] = Value("sprites.png");
+    
+    ValueMap sheet;
+    sheet["frames"] = Value(frames);
+    sheet["metadata"] = Value(metadata);
+    return sheet;
+}
+
+void TestBinaryPlist::onEnter()
+{
+    FileUtilsDemo::onEnter();
+    auto s = Director::getInstance()->getWinSize();
+    auto sharedFileUtils = FileUtils::getInstance();
+    
+    static const int FRAME_COUNT = 4000;
+    static const int LOAD_COUNT = 10;
+    
+    std::string writablePath = sharedFileUtils->getWritablePath();
+    std::string xmlPath = writablePath + BINARY_PLIST_XML;
+    std::string binaryPath = writablePath + BINARY_PLIST_BINARY;
+    
+    // the binary form is made from the loaded plist, as tools/binary-plist/convert_plists.py does
+    ValueMap sheet = createSpriteSheet(FRAME_COUNT);
+    sharedFileUtils->writeToFile(sheet, xmlPath);
+    ValueMap xmlSheet = sharedFileUtils->getValueMapFromFile(xmlPath);
+    BinaryValue::writeToFile(Value(xmlSheet), binaryPath);
+    
+    auto load = [=](const std::string& path, ValueMap& loaded) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < LOAD_COUNT; ++i)
+        {
+            loaded = sharedFileUtils->getValueMapFromFile(path);
+        }
+        return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / LOAD_COUNT;
+    };
+    
+    ValueMap binarySheet;
+    float xmlTime = load(xmlPath, xmlSheet);
+    float binaryTime = load(binaryPath, binarySheet);
+    bool same = Value(xmlSheet) == Value(binarySheet);
+    
+    std::string lines[] = {
+        StringUtils::format("%d frames", FRAME_COUNT),
+        StringUtils::format("XML: %.2f ms, %ld bytes", xmlTime, sharedFileUtils->getFileSize(xmlPath)),
+        StringUtils::format("binary: %.2f ms, %ld bytes", binaryTime, sharedFileUtils->getFileSize(binaryPath)),
+        same ? "same content" : "different content!",
+    };
+    
+    int y = s.height * 3 / 4;
+    for (const auto& line : lines)
+    {
+        log("%s", line.c_str());
+        auto label = Label::createWithSystemFont(line, "", 20);
+        label->setPosition(s.width/2, y);
+        this->addChild(label);
+        y -= 40;
+    }
+}
+
+void TestBinaryPlist::onExit()
+{
+    auto sharedFileUtils = FileUtils::getInstance();
+    std::string writablePath = sharedFileUtils->getWritablePath();
+    sharedFileUtils->removeFile(writablePath + BINARY_PLIST_XML);
+    sharedFileUtils->removeFile(writablePath + BINARY_PLIST_BINARY);
+    
+    FileUtilsDemo::onExit();
+}
+
+std::string TestBinaryPlist::title() const
+{
+    return "FileUtils: binary plist";
+}
+
+std::string TestBinaryPlist::subtitle() const
+{
+    return "Load time of a large sprite sheet plist and of its binary form";
+}
@@ -103,4 +103,36 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class TestMappedData : public FileUtilsDemo
+{
+public:
+    CREATE_FUNC(TestMappedData);
+
+    virtual void onEnter() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
+class TestResourcePack : public FileUtilsDemo
+{
+public:
+    CREATE_FUNC(TestResourcePack);
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
+class TestBinaryPlist : public FileUtilsDemo
+{
+public:
+    CREATE_FUNC(TestBinaryPlist);
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
 #endif /* __FILEUTILSTEST_H__ */
@@ -40,6 +40,7 @@ static std::function<Layer*()> createFunctions[] =
     CL(NewDrawNodeTest),
     CL(NewCullingTest),
     CL(VBOFullTest),
+    CL(FrameCommandArenaTest),
     CL(CaptureScreenTest)
 };
 
@@ -564,6 +565,110 @@ std::string VBOFullTest::subtitle() const
     return "VBO full Test, everthing should render normally";
 }
 
+// Draws every quad with its own QuadCommand taken from the renderer frame arena
+class FrameArenaQuadsNode : public Node
+{
+public:
+    static FrameArenaQuadsNode* create(const std::string& filename, int quadCount)
+    {
+        auto node = new (std::nothrow) FrameArenaQuadsNode();
+        if (node && node->init(filename, quadCount))
+        {
+            node->autorelease();
+            return node;
+        }
+        CC_SAFE_DELETE(node);
+        return nullptr;
+    }
+
+    virtual void draw(Renderer* renderer, const Mat4& transform, uint32_t flags) override
+    {
+        for (auto& quad : _quads)
+        {
+            auto command = renderer->createFrameCommand<QuadCommand>();
+            // the frame arena is full: skip the remaining quads for this frame
+            if (command == nullptr)
+                break;
+            command->init(_globalZOrder, _texture->getName(), getGLProgramState(), BlendFunc::ALPHA_NON_PREMULTIPLIED, &quad, 1, transform, flags);
+            renderer->addCommand(command);
+        }
+    }
+
+protected:
+    FrameArenaQuadsNode()
+    : _texture(nullptr)
+    {
+    }
+
+    bool init(const std::string& filename, int quadCount)
+    {
+        if (!Node::init())
+            return false;
+
+        auto sprite = Sprite::create(filename);
+        if (sprite == nullptr)
+            return false;
+
+        _texture = sprite->getTexture();
+        setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP));
+
+        Size s = Director::getInstance()->getWinSize();
+        V3F_C4B_T2F_Quad spriteQuad = sprite->getQuad();
+        _quads.resize(quadCount);
+        for (auto& quad : _quads)
+        {
+            quad = spriteQuad;
+            Vec3 offset(CCRANDOM_0_1() * s.width, CCRANDOM_0_1() * s.height, 0);
+            quad.bl.vertices = quad.bl.vertices * 0.2f + offset;
+            quad.br.vertices = quad.br.vertices * 0.2f + offset;
+            quad.tl.vertices = quad.tl.vertices * 0.2f + offset;
+            quad.tr.vertices = quad.tr.vertices * 0.2f + offset;
+        }
+        return true;
+    }
+
+    Texture2D* _texture;
+    std::vector<V3F_C4B_T2F_Quad> _quads;
+};
+
+FrameCommandArenaTest::FrameCommandArenaTest()
+{
+    Size s = Director::getInstance()->getWinSize();
+
+    addChild(FrameArenaQuadsNode::create("Images/grossini_dance_01.png", 5000));
+
+    _statsLabel = Label::createWithTTF("", "fonts/arial.ttf", 12);
+    _statsLabel->setPosition(s.width / 2, s.height - 70);
+    addChild(_statsLabel);
+
+    schedule(CC_SCHEDULE_SELECTOR(FrameCommandArenaTest::updateStats), 0.5f);
+}
+
+FrameCommandArenaTest::~FrameCommandArenaTest()
+{
+
+}
+
+void FrameCommandArenaTest::updateStats(float dt)
+{
+    auto renderer = Director::getInstance()->getRenderer();
+    char buf[128];
+    snprintf(buf, sizeof(buf), "commands: %d (peak %d)   arena: %d bytes (peak %d)",
+             (int)renderer->getFrameCommandCount(), (int)renderer->getPeakFrameCommandCount(),
+             (int)renderer->getFrameArenaBytes(), (int)renderer->getPeakFrameArenaBytes());
+    _statsLabel->setString(buf);
+}
+
+std::string FrameCommandArenaTest::title() const
+{
+    return "New Renderer";
+}
+
+std::string FrameCommandArenaTest::subtitle() const
+{
+    return "5000 quad commands per frame from the frame arena";
+}
+
 CaptureScreenTest::CaptureScreenTest()
 {
     Size s = Director::getInstance()->getWinSize();
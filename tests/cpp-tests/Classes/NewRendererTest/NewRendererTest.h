@@ -146,6 +146,22 @@ protected:
     virtual ~VBOFullTest();
 };
 
+class FrameCommandArenaTest : public MultiSceneTest
+{
+public:
+    CREATE_FUNC(FrameCommandArenaTest);
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+    void updateStats(float dt);
+
+protected:
+    FrameCommandArenaTest();
+    virtual ~FrameCommandArenaTest();
+
+    Label* _statsLabel;
+};
+
 class CaptureScreenTest : public MultiSceneTest
 {
     static const int childTag = 119;
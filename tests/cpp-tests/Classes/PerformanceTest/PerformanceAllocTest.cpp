@@ -39,6 +39,7 @@ static std::function<PerformceAllocScene*()> createFunctions[] =
     CL(SpriteCreateEmptyTest),
     CL(SpriteCreateTest),
     CL(SpriteDeallocTest),
+    CL(SpriteSpawnDespawnTest),
 };
 
 #define MAX_LAYER    (sizeof(createFunctions) / sizeof(createFunctions[0]))
@@ -470,6 +471,69 @@ const char*  SpriteDeallocTest::testName()
     return "Sprite::~Sprite()";
 }
 
+////////////////////////////////////////////////////////
+//
+// SpriteSpawnDespawnTest
+//
+////////////////////////////////////////////////////////
+void SpriteSpawnDespawnTest::updateQuantityOfNodes()
+{
+    currentQuantityOfNodes = quantityOfNodes;
+}
+
+void SpriteSpawnDespawnTest::initWithQuantityOfNodes(unsigned int nNodes)
+{
+    PerformceAllocScene::initWithQuantityOfNodes(nNodes);
+
+    log("Size of Sprite: %lu, MoveBy: %lu, Sequence: %lu, CallFunc: %lu\n", sizeof(Sprite), sizeof(MoveBy), sizeof(Sequence), sizeof(CallFunc));
+
+    scheduleUpdate();
+}
+
+void SpriteSpawnDespawnTest::update(float dt)
+{
+    // a bullet: a sprite that moves, fades out and removes itself.
+    // they are all despawned in the same frame to measure the allocations only.
+    auto texture = Director::getInstance()->getTextureCache()->addImage("Images/grossini.png");
+
+    CC_PROFILER_START(this->profilerName());
+    {
+        // the objects are released when the pool goes out of scope, not at the end of the frame
+        AutoreleasePool pool;
+        auto layer = Node::create();
+        addChild(layer);
+        for( int i=0; i<quantityOfNodes; ++i) {
+            auto sprite = Sprite::createWithTexture(texture);
+            sprite->runAction(Sequence::create(MoveBy::create(1, Vec2(100, 0)),
+                                               FadeOut::create(0.5f),
+                                               CallFunc::create([sprite](){ sprite->removeFromParent(); }),
+                                               nullptr));
+            layer->addChild(sprite);
+        }
+        layer->removeFromParent();
+    }
+    CC_PROFILER_STOP(this->profilerName());
+}
+
+std::string SpriteSpawnDespawnTest::title() const
+{
+    return "Sprite Spawn/Despawn";
+}
+
+std::string SpriteSpawnDespawnTest::subtitle() const
+{
+#if CC_ENABLE_ALLOCATOR && CC_ENABLE_ALLOCATOR_OBJECT_POOLS
+    return "Sprite + Sequence, with object pools. See console";
+#else
+    return "Sprite + Sequence, without object pools. See console";
+#endif
+}
+
+const char*  SpriteSpawnDespawnTest::testName()
+{
+    return "Sprite spawn/despawn";
+}
+
 ///----------------------------------------
 void runAllocPerformanceTest()
 {
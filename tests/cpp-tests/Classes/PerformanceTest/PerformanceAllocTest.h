@@ -115,6 +115,19 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class SpriteSpawnDespawnTest : public PerformceAllocScene
+{
+public:
+    CREATE_FUNC(SpriteSpawnDespawnTest);
+
+    virtual void updateQuantityOfNodes();
+    virtual void initWithQuantityOfNodes(unsigned int nNodes);
+    virtual void update(float dt);
+    virtual const char* testName();
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
 
 void runAllocPerformanceTest();
 
@@ -4,6 +4,7 @@
 #include "PerformanceContainerTest.h"
 
 #include <algorithm>
+#include <unordered_set>
 
 // Enable profiles for this file
 #undef CC_PROFILER_DISPLAY_TIMERS
@@ -36,7 +37,8 @@ static std::function<PerformanceContainerScene*()> createFunctions[] =
 {
     CL(TemplateVectorPerfTest),
     CL(TemplateMapStringKeyPerfTest),
-    CL(TemplateMapIntKeyPerfTest)
+    CL(TemplateMapIntKeyPerfTest),
+    CL(ValuePerfTest)
 };
 
 #define MAX_LAYER    (sizeof(createFunctions) / sizeof(createFunctions[0]))
@@ -830,6 +832,155 @@ std::string TemplateMapIntKeyPerfTest::subtitle() const
     return "Test 'insert', See console";
 }
 
+////////////////////////////////////////////////////////
+//
+// ValuePerfTest
+//
+////////////////////////////////////////////////////////
+
+// The approximate memory held by a value. The containers in `shared` are already counted, pass nullptr to count every copy.
+static size_t valueMemory(const Value& value, std::unordered_set<const void*>* shared)
+{
+    size_t ret = 0;
+    switch (value.getType())
+    {
+        case Value::Type::STRING:
+        {
+            // the short strings are stored in the value
+            size_t length = value.asString().length();
+            if (length >= 16)
+                ret += length + 16;
+            break;
+        }
+        case Value::Type::VECTOR:
+        {
+            const auto& vector = value.asValueVector();
+            if (shared && !shared->insert(&vector).second)
+                break;
+            ret += sizeof(vector) + vector.capacity() * sizeof(Value);
+            for (const auto& element : vector)
+                ret += valueMemory(element, shared);
+            break;
+        }
+        case Value::Type::MAP:
+        {
+            const auto& map = value.asValueMap();
+            if (shared && !shared->insert(&map).second)
+                break;
+            ret += sizeof(map) + map.bucket_count() * sizeof(void*);
+            for (const auto& element : map)
+            {
+                ret += sizeof(element) + 2 * sizeof(void*);
+                if (element.first.length() >= 16)
+                    ret += element.first.length() + 1;
+                ret += valueMemory(element.second, shared);
+            }
+            break;
+        }
+        case Value::Type::INT_KEY_MAP:
+        {
+            const auto& map = value.asIntKeyMap();
+            if (shared && !shared->insert(&map).second)
+                break;
+            ret += sizeof(map) + map.bucket_count() * sizeof(void*);
+            for (const auto& element : map)
+                ret += sizeof(element) + 2 * sizeof(void*) + valueMemory(element.second, shared);
+            break;
+        }
+        default:
+            break;
+    }
+    return ret;
+}
+
+void ValuePerfTest::generateTestFunctions()
+{
+    static const char* plistFile = "animations/grossini.plist";
+    static const char* tmxFile = "TileMaps/ortho-objects.tmx";
+    
+    // quantityOfNodes copies of a loaded file, then the memory they hold with and without sharing
+    auto copyValues = [this](const Value& value){
+        std::vector<Value> copies;
+        copies.reserve(quantityOfNodes);
+        
+        CC_PROFILER_START(this->profilerName());
+        for( int i=0; i<quantityOfNodes; ++i)
+            copies.push_back(value);
+        CC_PROFILER_STOP(this->profilerName());
+        
+        std::unordered_set<const void*> shared;
+        size_t sharedMemory = 0;
+        size_t deepMemory = 0;
+        for (const auto& copy : copies)
+        {
+            sharedMemory += sizeof(Value) + valueMemory(copy, &shared);
+            deepMemory += sizeof(Value) + valueMemory(copy, nullptr);
+        }
+        
+        auto label = static_cast<Label*>(this->getChildByTag(TAG_SUBTITLE));
+        label->setString(StringUtils::format("%d copies: %d KB, %d KB without sharing", quantityOfNodes, (int)(sharedMemory / 1024), (int)(deepMemory / 1024)));
+    };
+    
+    auto loadTMX = [](){
+        ValueMap ret;
+        auto mapInfo = TMXMapInfo::create(tmxFile);
+        ret["properties"] = Value(mapInfo->getProperties());
+        ValueVector objectGroups;
+        for (const auto& objectGroup : mapInfo->getObjectGroups())
+        {
+            ValueMap group;
+            group["properties"] = Value(objectGroup->getProperties());
+            group["objects"] = Value(objectGroup->getObjects());
+            objectGroups.push_back(Value(std::move(group)));
+        }
+        ret["objectGroups"] = Value(std::move(objectGroups));
+        return ret;
+    };
+    
+    TestFunction testFunctions[] = {
+        { "plist load",    [=](){
+            int count = std::max(1, quantityOfNodes / 100);
+            
+            CC_PROFILER_START(this->profilerName());
+            for( int i=0; i<count; ++i)
+                FileUtils::getInstance()->getValueMapFromFile(plistFile);
+            CC_PROFILER_STOP(this->profilerName());
+        } } ,
+        
+        { "plist copy",    [=](){
+            copyValues(Value(FileUtils::getInstance()->getValueMapFromFile(plistFile)));
+        } } ,
+        
+        { "tmx load",    [=](){
+            int count = std::max(1, quantityOfNodes / 100);
+            
+            CC_PROFILER_START(this->profilerName());
+            for( int i=0; i<count; ++i)
+                loadTMX();
+            CC_PROFILER_STOP(this->profilerName());
+        } } ,
+        
+        { "tmx copy",    [=](){
+            copyValues(Value(loadTMX()));
+        } } ,
+    };
+    
+    for (const auto& func : testFunctions)
+    {
+        _testFunctions.push_back(func);
+    }
+}
+
+std::string ValuePerfTest::title() const
+{
+    return "Value Perf test";
+}
+
+std::string ValuePerfTest::subtitle() const
+{
+    return "Test 'plist load', See console";
+}
+
 ///----------------------------------------
 void runContainerPerformanceTest()
 {
@@ -38,6 +38,7 @@ static std::function<PerformanceEventDispatcherScene*()> createFunctions[] =
     CL(TouchEventDispatchingPerfTest),
     CL(KeyboardEventDispatchingPerfTest),
     CL(CustomEventDispatchingPerfTest),
+    CL(SceneGraphListenersChangePerfTest),
 };
 
 #define MAX_LAYER    (sizeof(createFunctions) / sizeof(createFunctions[0]))
@@ -51,6 +52,8 @@ enum {
 enum {
     kMaxNodes = 15000,
     kNodesIncrease = 500,
+    kButtonsPerPanel = 100,
+    kChangeListenersNodes = 10000,
 };
 
 static int g_curCase = 0;
@@ -781,6 +784,133 @@ std::string CustomEventDispatchingPerfTest::subtitle() const
     return "Test 'custom-scenegraph', See console";
 }
 
+////////////////////////////////////////////////////////
+//
+// SceneGraphListenersChangePerfTest
+//
+////////////////////////////////////////////////////////
+
+void SceneGraphListenersChangePerfTest::initWithQuantityOfNodes(unsigned int nNodes)
+{
+    // a big UI: 10000 buttons by default
+    PerformanceEventDispatcherScene::initWithQuantityOfNodes(std::max(nNodes, (unsigned int)kChangeListenersNodes));
+}
+
+void SceneGraphListenersChangePerfTest::createButtons()
+{
+    // the buttons are in panels, like in a UI
+    _buttons.clear();
+    Node* panel = nullptr;
+    for (int i = 0; i < _quantityOfNodes; ++i)
+    {
+        if (i % kButtonsPerPanel == 0)
+        {
+            panel = Node::create();
+            addChild(panel);
+            _nodes.push_back(panel);
+        }
+        addButton(panel, -1);
+    }
+    
+    _lastRenderedCount = _quantityOfNodes;
+}
+
+void SceneGraphListenersChangePerfTest::addButton(Node* panel, int index)
+{
+    auto listener = EventListenerTouchOneByOne::create();
+    listener->onTouchBegan = [](Touch* touch, Event* event){
+        return false;
+    };
+    
+    auto button = Node::create();
+    panel->addChild(button, rand() % 3 - 1);
+    _eventDispatcher->addEventListenerWithSceneGraphPriority(listener, button);
+    
+    if (index < 0)
+        _buttons.push_back(button);
+    else
+        _buttons[index] = button;
+}
+
+void SceneGraphListenersChangePerfTest::dispatchTouch()
+{
+    EventTouch touchEvent;
+    touchEvent.setEventCode(EventTouch::EventCode::BEGAN);
+    std::vector<Touch*> touches;
+    
+    Touch* touch = new (std::nothrow) Touch();
+    touch->autorelease();
+    touch->setTouchInfo(0, rand() % 200, rand() % 200);
+    touches.push_back(touch);
+    touchEvent.setTouches(touches);
+    
+    // the listeners are sorted again before the touch is dispatched
+    CC_PROFILER_START(this->profilerName());
+    _eventDispatcher->dispatchEvent(&touchEvent);
+    CC_PROFILER_STOP(this->profilerName());
+}
+
+void SceneGraphListenersChangePerfTest::generateTestFunctions()
+{
+    TestFunction testFunctions[] = {
+        { "add-remove",    [=](){
+            if (_quantityOfNodes != _lastRenderedCount)
+            {
+                createButtons();
+            }
+            
+            // a button goes away, another one comes in its panel
+            for (int i = 0; i < 10; ++i)
+            {
+                int index = rand() % _buttons.size();
+                auto panel = _buttons[index]->getParent();
+                _buttons[index]->removeFromParent();
+                addButton(panel, index);
+            }
+            
+            dispatchTouch();
+        } } ,
+        
+        { "reorder",    [=](){
+            if (_quantityOfNodes != _lastRenderedCount)
+            {
+                createButtons();
+            }
+            
+            for (int i = 0; i < 10; ++i)
+            {
+                _buttons[rand() % _buttons.size()]->setLocalZOrder(rand() % 3 - 1);
+            }
+            
+            dispatchTouch();
+        } } ,
+        
+        { "no-change",    [=](){
+            if (_quantityOfNodes != _lastRenderedCount)
+            {
+                createButtons();
+            }
+            
+            dispatchTouch();
+        } } ,
+    };
+    
+    for (const auto& func : testFunctions)
+    {
+        _testFunctions.push_back(func);
+    }
+}
+
+std::string SceneGraphListenersChangePerfTest::title() const
+{
+    return "Scene Graph Listeners Change Perf test";
+}
+
+std::string SceneGraphListenersChangePerfTest::subtitle() const
+{
+    return "Test 'add-remove', See console";
+}
+
 ///----------------------------------------
 void runEventDispatcherPerformanceTest()
 {
@@ -100,6 +100,25 @@ private:
     std::vector<EventListener*> _customListeners;
 };
 
+class SceneGraphListenersChangePerfTest : public PerformanceEventDispatcherScene
+{
+public:
+    CREATE_FUNC(SceneGraphListenersChangePerfTest);
+    
+    virtual void initWithQuantityOfNodes(unsigned int nNodes) override;
+    virtual void generateTestFunctions() override;
+    
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    
+private:
+    void createButtons();
+    void addButton(Node* panel, int index);
+    void dispatchTouch();
+    
+    std::vector<Node*> _buttons;
+};
+
 void runEventDispatcherPerformanceTest();
 
 #endif /* defined(__PERFORMANCE_EVENTDISPATCHER_TEST_H__) */
@@ -1,10 +1,12 @@
 #include "PerformanceLabelTest.h"
 
+#include <chrono>
+
 enum {
     kMaxNodes = 200,
     kNodesIncrease = 10,
 
-    TEST_COUNT = 5,
+    TEST_COUNT = 9,
 };
 
 enum {
@@ -19,13 +21,34 @@ enum {
     kCaseLabelBMFontUpdate,
     kCaseLabelUpdate,
     kCaseLabelBMFontBigLabels,
-    kCaseLabelBigLabels
+    kCaseLabelBigLabels,
+    kCaseLabelCJKUpdate,
+    kCaseLabelCJKAsyncUpdate,
+    kCaseLabelTTFCounters,
+    kCaseLabelBMFontCounters
 };
 
 #define LongSentencesExample "Lorem ipsum dolor sit amet, consectetur adipisicing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.\
 Lorem ipsum dolor sit amet, consectetur adipisicing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.\
 Lorem ipsum dolor sit amet, consectetur adipisicing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua."
 
+// chat-like text: the labels keep showing letters that are not in the atlas yet
+static const char* s_CJKSentences[] = {
+    "你好，今天晚上一起去吃饭吗？",
+    "我们在公园门口见面吧",
+    "明天的会议改到下午三点",
+    "这个周末天气怎么样？",
+    "谢谢你的帮助，辛苦了！",
+    "新年快乐，万事如意",
+    "请把文件发到我的邮箱",
+    "路上堵车，我晚点到",
+    "こんにちは、元気ですか？",
+    "駅の近くで待っています",
+    "안녕하세요, 반갑습니다",
+    "오늘 저녁에 시간 있어요?",
+};
+static const int s_CJKSentenceCount = sizeof(s_CJKSentences) / sizeof(s_CJKSentences[0]);
+
 
 ////////////////////////////////////////////////////////
 //
@@ -87,6 +110,9 @@ void LabelMainScene::initWithSubTest(int nodes)
     _lastRenderedCount = 0;
     _quantityNodes = 0;
     _accumulativeTime = 0.0f;
+    _maxUpdateTime = 0.0f;
+    _totalUpdateTime = 0.0f;
+    _updateCount = 0;
 
     _labelContainer = Layer::create();
     addChild(_labelContainer);
@@ -158,6 +184,14 @@ std::string LabelMainScene::title() const
         return "Testing LabelBMFont Big Labels";
     case kCaseLabelBigLabels:
         return "Testing Label Big Labels";
+    case kCaseLabelCJKUpdate:
+        return "Testing Label CJK Update";
+    case kCaseLabelCJKAsyncUpdate:
+        return "Testing Label CJK Async Update";
+    case kCaseLabelTTFCounters:
+        return "Testing Label TTF Counters";
+    case kCaseLabelBMFontCounters:
+        return "Testing Label BMFont Counters";
     default:
         break;
     }
@@ -247,6 +281,51 @@ void LabelMainScene::onIncrease(Ref* sender)
             }
             break;
         }        
+    case kCaseLabelCJKUpdate:
+    case kCaseLabelCJKAsyncUpdate:
+        {
+            TTFConfig ttfConfig("fonts/HKYuanMini.ttf", 30, GlyphCollection::DYNAMIC);
+            for( int i=0;i< kNodesIncrease;i++)
+            {
+                auto label = Label::createWithTTF(ttfConfig, "", TextHAlignment::LEFT);
+                label->setPosition(Vec2((size.width/2 + rand() % 50), rand()%((int)size.height)));
+                _labelContainer->addChild(label, 1, _quantityNodes);
+
+                // in the async case, the glyphs are rasterized by the workers and the first sentences are in the atlas before they are shown
+                auto fontAtlas = label->getFontAtlas();
+                bool async = _s_labelCurCase == kCaseLabelCJKAsyncUpdate;
+                if (fontAtlas && fontAtlas->isAsyncRasterization() != async)
+                {
+                    fontAtlas->setAsyncRasterization(async);
+                    if (async)
+                    {
+                        fontAtlas->prewarmLetterDefinitions(std::string(s_CJKSentences[0]) + s_CJKSentences[1]);
+                    }
+                }
+
+                _quantityNodes++;
+            }
+            break;
+        }
+    case kCaseLabelTTFCounters:
+    case kCaseLabelBMFontCounters:
+        {
+            // the scores of a HUD: all the labels are there at once
+            TTFConfig ttfConfig("fonts/arial.ttf", 24, GlyphCollection::DYNAMIC);
+            while (_quantityNodes < kMaxNodes)
+            {
+                Label* label;
+                if (_s_labelCurCase == kCaseLabelTTFCounters)
+                    label = Label::createWithTTF(ttfConfig, "0", TextHAlignment::LEFT);
+                else
+                    label = Label::createWithBMFont("fonts/bitmapFontTest3.fnt", "0");
+                label->setPosition(Vec2(rand() % (int)size.width, rand() % (int)size.height));
+                _labelContainer->addChild(label, 1, _quantityNodes);
+
+                _quantityNodes++;
+            }
+            break;
+        }
     default:
         break;
     }
@@ -291,6 +370,11 @@ void  LabelMainScene::dumpProfilerFPS()
     
     averagerFPS = totalFPS / _vecFPS.size();
     log("Cur test: %d, cur label nums:%d, the min FPS value is %.1f,the max FPS value is %.1f,the averager FPS is %.1f", LabelMainScene::_s_labelCurCase, _quantityNodes, minFPS, maxFPS, averagerFPS);
+    if (_maxUpdateTime > 0)
+    {
+        log("the longest update of the strings took %.2f ms", _maxUpdateTime);
+        log("the update of the strings took %.3f ms on average", _totalUpdateTime / std::max(_updateCount, 1));
+    }
     
 }
 
@@ -310,6 +394,51 @@ void LabelMainScene::updateAutoTest(float dt)
 
 void LabelMainScene::updateText(float dt)
 {
+    if (_s_labelCurCase == kCaseLabelCJKUpdate || _s_labelCurCase == kCaseLabelCJKAsyncUpdate)
+    {
+        // a new sentence every half second, for each label
+        int step = static_cast<int>(_accumulativeTime * 2);
+        _accumulativeTime += dt;
+        if (step == static_cast<int>(_accumulativeTime * 2))
+            return;
+
+        auto start = std::chrono::steady_clock::now();
+        int index = step;
+        for(const auto &child : _labelContainer->getChildren()) {
+            Label* label = (Label*)child;
+            label->setString(s_CJKSentences[index++ % s_CJKSentenceCount]);
+            // the layout rasterizes the missing letters
+            label->getContentSize();
+        }
+        float elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        _maxUpdateTime = std::max(_maxUpdateTime, elapsed);
+        _totalUpdateTime += elapsed;
+        _updateCount++;
+        return;
+    }
+
+    if (_s_labelCurCase == kCaseLabelTTFCounters || _s_labelCurCase == kCaseLabelBMFontCounters)
+    {
+        // every label counts on every frame, most of the time only the last digits change
+        _accumulativeTime += dt;
+        int frame = static_cast<int>(_accumulativeTime * 60);
+        char text[16];
+
+        auto start = std::chrono::steady_clock::now();
+        int index = 0;
+        for(const auto &child : _labelContainer->getChildren()) {
+            Label* label = (Label*)child;
+            sprintf(text, "%d", 100000 + frame * 7 + index++ * 13);
+            label->setString(text);
+            label->getContentSize();
+        }
+        float elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        _maxUpdateTime = std::max(_maxUpdateTime, elapsed);
+        _totalUpdateTime += elapsed;
+        _updateCount++;
+        return;
+    }
+
     if(_s_labelCurCase > kCaseLabelUpdate)
         return;
 
@@ -377,6 +506,9 @@ void LabelMainScene::autoShowLabelTests(int curCase,int nodes)
     _lastRenderedCount = 0;
     _quantityNodes = 0;
     _accumulativeTime = 0.0f;
+    _maxUpdateTime = 0.0f;
+    _totalUpdateTime = 0.0f;
+    _updateCount = 0;
     while(_quantityNodes < nodes)
         onIncrease(this);
 }
@@ -48,7 +48,7 @@ public:
 
 private:
     static const  int MAX_AUTO_TEST_TIMES  = 35;
-    static const  int MAX_SUB_TEST_NUMS    = 5;
+    static const  int MAX_SUB_TEST_NUMS    = 9;
     
 
     void  dumpProfilerFPS();
@@ -67,6 +67,10 @@ private:
     int            _executeTimes;
 
     float          _accumulativeTime;
+    // the longest setString of the CJK and the counter cases, in milliseconds
+    float          _maxUpdateTime;
+    float          _totalUpdateTime;
+    int            _updateCount;
 };
 
 void runLabelTest();
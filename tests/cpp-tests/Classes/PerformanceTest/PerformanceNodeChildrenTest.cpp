@@ -46,6 +46,7 @@ static std::function<NodeChildrenMainScene*()> createFunctions[] =
     CL(SortAllChildrenSpriteSheet),
 
     CL(VisitSceneGraph),
+    CL(PrepareTransformsSceneGraph),
 };
 
 #define MAX_LAYER    (sizeof(createFunctions) / sizeof(createFunctions[0]))
@@ -968,6 +969,83 @@ const char*  VisitSceneGraph::testName()
     return "visit()";
 }
 
+////////////////////////////////////////////////////////
+//
+// PrepareTransformsSceneGraph
+//
+////////////////////////////////////////////////////////
+static const int s_transformThreadCounts[] = { 1, 2, 4, 8 };
+static const int kTransformGroups = 16;
+static const int kTransformClusterSize = 32;
+
+void PrepareTransformsSceneGraph::initWithQuantityOfNodes(unsigned int nodes)
+{
+    _root = Node::create();
+    _root->setPosition(Vec2(-1000, -1000));
+    addChild(_root);
+
+    NodeChildrenMainScene::initWithQuantityOfNodes(nodes);
+    scheduleUpdate();
+}
+
+void PrepareTransformsSceneGraph::updateQuantityOfNodes()
+{
+    // one subtree per group, made of clusters of nodes
+    _root->removeAllChildren();
+    for (int i = 0; i < kTransformGroups; ++i)
+    {
+        _root->addChild(Node::create());
+    }
+
+    for (int i = 0; i < quantityOfNodes; ++i)
+    {
+        auto group = _root->getChildren().at(i % kTransformGroups);
+        if (group->getChildrenCount() == 0 || group->getChildren().back()->getChildrenCount() == kTransformClusterSize)
+        {
+            group->addChild(Node::create());
+        }
+        auto node = Node::create();
+        node->setPosition(Vec2(i % 100, i / 100));
+        node->setRotation(i % 360);
+        group->getChildren().back()->addChild(node);
+    }
+
+    currentQuantityOfNodes = quantityOfNodes;
+}
+
+void PrepareTransformsSceneGraph::update(float dt)
+{
+    char name[128];
+    for (auto threadCount : s_transformThreadCounts)
+    {
+        // dirty every group, so the transforms of all the nodes are computed again
+        for (const auto& group : _root->getChildren())
+        {
+            group->setRotation(group->getRotation() + 1);
+        }
+
+        snprintf(name, sizeof(name), "%s %d threads", profilerName(), threadCount);
+        CC_PROFILER_START(name);
+        prepareTransforms(threadCount);
+        CC_PROFILER_STOP(name);
+    }
+}
+
+std::string PrepareTransformsSceneGraph::title() const
+{
+    return "Parallel transform update";
+}
+
+std::string PrepareTransformsSceneGraph::subtitle() const
+{
+    return "Scene::prepareTransforms() by thread count. See console";
+}
+
+const char*  PrepareTransformsSceneGraph::testName()
+{
+    return "prepareTransforms()";
+}
+
 ///----------------------------------------
 void runNodeChildrenTest()
 {
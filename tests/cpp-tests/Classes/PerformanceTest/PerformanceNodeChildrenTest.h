@@ -226,6 +226,22 @@ public:
     virtual const char* testName() override;
 };
 
+class PrepareTransformsSceneGraph : public NodeChildrenMainScene
+{
+public:
+    CREATE_FUNC(PrepareTransformsSceneGraph);
+
+    void initWithQuantityOfNodes(unsigned int nodes) override;
+    virtual void update(float dt) override;
+    void updateQuantityOfNodes() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual const char* testName() override;
+
+protected:
+    Node* _root;
+};
+
 void runNodeChildrenTest();
 
 #endif // __PERFORMANCE_NODE_CHILDREN_TEST_H__
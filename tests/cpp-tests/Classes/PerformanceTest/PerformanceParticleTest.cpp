@@ -1,14 +1,17 @@
 #include "PerformanceParticleTest.h"
 
+#include <chrono>
 
 enum {
     kTagInfoLayer = 1,
     kTagMainLayer = 2,
     kTagParticleSystem = 3,
     kTagLabelAtlas = 4,
+    kTagExtraEmitter = 5,
+    kTagUpdateTime = 6,
     kTagMenuLayer = 1000,
 
-    TEST_COUNT = 4,
+    TEST_COUNT = 5,
 };
 
 enum {
@@ -51,6 +54,9 @@ void ParticleMenuLayer::showCurrentTest()
     case 3:
         pNewScene = new (std::nothrow) ParticlePerformTest4;
         break;
+    case 4:
+        pNewScene = new (std::nothrow) ParticlePerformTest5;
+        break;
     }
 
     s_nParCurIdx = _curCase;
@@ -548,6 +554,139 @@ void ParticlePerformTest4::doTest()
 
 }
 
+////////////////////////////////////////////////////////
+//
+// ParticlePerformTest5
+//
+////////////////////////////////////////////////////////
+enum {
+    kEmitterCount = 4,
+    // a ParticleSystemQuad has 16 bit indices, at most 16383 quads
+    kParticlesPerEmitter = 12500,
+};
+
+std::string ParticlePerformTest5::title() const
+{
+    char str[40] = {0};
+    sprintf(str, "E (%d) %d particles", subtestNumber, kEmitterCount * kParticlesPerEmitter);
+    std::string strRet = str;
+    return strRet;
+}
+
+void ParticlePerformTest5::doTest()
+{
+    auto s = Director::getInstance()->getWinSize();
+    auto texture = Director::getInstance()->getTextureCache()->addImage("Images/fire.png");
+
+    while (getChildByTag(kTagExtraEmitter))
+    {
+        removeChildByTag(kTagExtraEmitter, true);
+    }
+
+    // the +/- buttons don't apply, always 4 emitters of 12500 particles side by side
+    for (int i = 0; i < kEmitterCount; ++i)
+    {
+        ParticleSystem* particleSystem;
+        if (i == 0)
+        {
+            particleSystem = (ParticleSystem*)getChildByTag(kTagParticleSystem);
+            particleSystem->setTotalParticles(kParticlesPerEmitter);
+        }
+        else
+        {
+            particleSystem = ParticleSystemQuad::createWithTotalParticles(kParticlesPerEmitter);
+            particleSystem->setTexture(texture);
+            addChild(particleSystem, 0, kTagExtraEmitter);
+        }
+
+        particleSystem->setDuration(-1);
+        particleSystem->setGravity(Vec2(0,-90));
+        particleSystem->setAngle(90);
+        particleSystem->setAngleVar(0);
+        particleSystem->setRadialAccel(0);
+        particleSystem->setRadialAccelVar(0);
+        particleSystem->setSpeed(180);
+        particleSystem->setSpeedVar(50);
+        particleSystem->setPosition(Vec2(s.width * (2 * i + 1) / (2 * kEmitterCount), 100));
+        particleSystem->setPosVar(Vec2(s.width / (2 * kEmitterCount), 0));
+        particleSystem->setLife(2.0f);
+        particleSystem->setLifeVar(1);
+        particleSystem->setEmissionRate(particleSystem->getTotalParticles() / particleSystem->getLife());
+        particleSystem->setStartColor(Color4F(0.5f, 0.5f, 0.5f, 1.0f));
+        particleSystem->setStartColorVar(Color4F(0.5f, 0.5f, 0.5f, 1.0f));
+        particleSystem->setEndColor(Color4F(0.1f, 0.1f, 0.1f, 0.2f));
+        particleSystem->setEndColorVar(Color4F(0.1f, 0.1f, 0.1f, 0.2f));
+        particleSystem->setEndSize(4.0f);
+        particleSystem->setStartSize(4.0f);
+        particleSystem->setEndSizeVar(0);
+        particleSystem->setStartSizeVar(0);
+        particleSystem->setStartSpin(0);
+        particleSystem->setEndSpin(360);
+        particleSystem->setBlendAdditive(false);
+    }
+
+    if (!getChildByTag(kTagUpdateTime))
+    {
+        auto label = Label::createWithSystemFont("", "", 16);
+        label->setPosition(Vec2(s.width/2, s.height - 130));
+        addChild(label, 1, kTagUpdateTime);
+
+        schedule(CC_SCHEDULE_SELECTOR(ParticlePerformTest5::measure));
+    }
+
+    _updateTime = 0;
+    _updateFrames = 0;
+
+    if (isRunning())
+    {
+        stopEmitterUpdates();
+    }
+}
+
+void ParticlePerformTest5::onEnter()
+{
+    ParticleMainScene::onEnter();
+    stopEmitterUpdates();
+}
+
+void ParticlePerformTest5::stopEmitterUpdates()
+{
+    // the emitters are updated by measure()
+    for (auto child : getChildren())
+    {
+        if (child->getTag() == kTagParticleSystem || child->getTag() == kTagExtraEmitter)
+        {
+            child->unscheduleUpdate();
+        }
+    }
+}
+
+void ParticlePerformTest5::measure(float dt)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (auto child : getChildren())
+    {
+        if (child->getTag() == kTagParticleSystem || child->getTag() == kTagExtraEmitter)
+        {
+            child->update(dt);
+        }
+    }
+    _updateTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    ++_updateFrames;
+
+    if (_updateFrames % 60 == 0)
+    {
+        auto label = (Label*)getChildByTag(kTagUpdateTime);
+        char str[60] = {0};
+        sprintf(str, "update: %.3f ms per frame", _updateTime / _updateFrames);
+        label->setString(str);
+        log("%s", str);
+
+        _updateTime = 0;
+        _updateFrames = 0;
+    }
+}
+
 void runParticleTest()
 {
     auto scene = new (std::nothrow) ParticlePerformTest1;
@@ -58,6 +58,22 @@ public:
     virtual void doTest();
 };
 
+class ParticlePerformTest5 : public ParticleMainScene
+{
+public:
+    virtual std::string title() const override;
+    virtual void doTest();
+    virtual void onEnter() override;
+
+    void measure(float dt);
+
+protected:
+    void stopEmitterUpdates();
+
+    double _updateTime;
+    int _updateFrames;
+};
+
 void runParticleTest();
 
 #endif
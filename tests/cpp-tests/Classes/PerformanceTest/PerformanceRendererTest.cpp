@@ -10,6 +10,8 @@
 #include "PerformanceTextureTest.h"
 #include "../testResource.h"
 
+#include <chrono>
+
 RenderTestLayer::RenderTestLayer()
 : PerformBasicLayer(true, 1, 1)
 {
@@ -53,3 +55,128 @@ void runRendererTest()
     auto scene = RenderTestLayer::scene();
     Director::getInstance()->replaceScene(scene);
 }
+
+////////////////////////////////////////////////////////
+//
+// RenderQueueSortTest
+//
+////////////////////////////////////////////////////////
+static const int s_sortCommandCounts[RenderQueueSortTest::TEST_COUNT] = { 10000, 50000, 100000 };
+
+static bool compareGlobalOrder(RenderCommand* a, RenderCommand* b)
+{
+    return a->getGlobalOrder() < b->getGlobalOrder();
+}
+
+RenderQueueSortTest::RenderQueueSortTest(int nCurCase)
+: PerformBasicLayer(true, TEST_COUNT, nCurCase)
+, _commandCount(s_sortCommandCounts[nCurCase])
+, _comparatorTime(0)
+, _radixTime(0)
+, _frames(0)
+, _resultLabel(nullptr)
+{
+}
+
+RenderQueueSortTest::~RenderQueueSortTest()
+{
+}
+
+void RenderQueueSortTest::onEnter()
+{
+    PerformBasicLayer::onEnter();
+
+    auto s = Director::getInstance()->getWinSize();
+
+    auto label = Label::createWithTTF("Render Queue Sort", "fonts/arial.ttf", 32);
+    label->setPosition(Vec2(s.width/2, s.height-50));
+    addChild(label, 1);
+
+    char subtitle[64];
+    snprintf(subtitle, sizeof(subtitle), "%d commands, globalZ < 0 and > 0", _commandCount);
+    auto subLabel = Label::createWithTTF(subtitle, "fonts/Thonburi.ttf", 16);
+    subLabel->setPosition(Vec2(s.width/2, s.height-80));
+    addChild(subLabel, 1);
+
+    _resultLabel = Label::createWithTTF("", "fonts/arial.ttf", 20);
+    _resultLabel->setPosition(Vec2(s.width/2, s.height/2));
+    addChild(_resultLabel, 1);
+
+    // few distinct orders, like in a real scene, so there are a lot of ties
+    _commands.resize(_commandCount);
+    _orders.resize(_commandCount);
+    for (int i = 0; i < _commandCount; ++i)
+    {
+        float order = static_cast<float>(std::rand() % 64 - 32);
+        _orders[i] = (order == 0) ? 1 : order;
+    }
+
+    schedule(CC_SCHEDULE_SELECTOR(RenderQueueSortTest::doPerformanceTest));
+}
+
+void RenderQueueSortTest::doPerformanceTest(float dt)
+{
+    // reorder the commands each frame, as a moving scene would do
+    std::random_shuffle(_orders.begin(), _orders.end());
+
+    std::vector<RenderCommand*> zNeg;
+    std::vector<RenderCommand*> zPos;
+    RenderQueue queue;
+    for (int i = 0; i < _commandCount; ++i)
+    {
+        _commands[i].init(_orders[i]);
+        queue.push_back(&_commands[i]);
+        (_orders[i] < 0 ? zNeg : zPos).push_back(&_commands[i]);
+    }
+
+    // previous implementation: std::sort with a comparator, one sub queue after the other
+    auto begin = std::chrono::steady_clock::now();
+    std::sort(zNeg.begin(), zNeg.end(), compareGlobalOrder);
+    std::sort(zPos.begin(), zPos.end(), compareGlobalOrder);
+    auto end = std::chrono::steady_clock::now();
+    _comparatorTime += std::chrono::duration<double, std::milli>(end - begin).count();
+
+    begin = std::chrono::steady_clock::now();
+    queue.sort();
+    end = std::chrono::steady_clock::now();
+    _radixTime += std::chrono::duration<double, std::milli>(end - begin).count();
+
+    // the draw order must follow the globalZOrder, ties keep the submission order
+    const auto& sortedNeg = queue.getSubQueue(RenderQueue::QUEUE_GROUP::GLOBALZ_NEG);
+    const auto& sortedPos = queue.getSubQueue(RenderQueue::QUEUE_GROUP::GLOBALZ_POS);
+    CCASSERT(std::is_sorted(sortedNeg.begin(), sortedNeg.end(), compareGlobalOrder), "GLOBALZ_NEG queue is not sorted");
+    CCASSERT(std::is_sorted(sortedPos.begin(), sortedPos.end(), compareGlobalOrder), "GLOBALZ_POS queue is not sorted");
+    CC_UNUSED_PARAM(sortedNeg);
+    CC_UNUSED_PARAM(sortedPos);
+
+    if (++_frames == 30)
+    {
+        char result[128];
+        snprintf(result, sizeof(result), "std::sort: %.3f ms\nradix sort: %.3f ms\nspeedup: %.2fx",
+                 _comparatorTime / _frames, _radixTime / _frames, _comparatorTime / std::max(_radixTime, 0.0001));
+        _resultLabel->setString(result);
+        CCLOG("RenderQueueSortTest %d commands: %s", _commandCount, result);
+        _comparatorTime = _radixTime = 0;
+        _frames = 0;
+    }
+}
+
+void RenderQueueSortTest::showCurrentTest()
+{
+    auto scene = Scene::create();
+    auto layer = new (std::nothrow) RenderQueueSortTest(_curCase);
+    scene->addChild(layer);
+    layer->release();
+
+    Director::getInstance()->replaceScene(scene);
+}
+
+void runRenderQueueSortTest()
+{
+    auto scene = Scene::create();
+    auto layer = new (std::nothrow) RenderQueueSortTest();
+    scene->addChild(layer);
+    layer->release();
+
+    Director::getInstance()->replaceScene(scene);
+}
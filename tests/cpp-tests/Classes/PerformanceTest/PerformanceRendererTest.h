@@ -24,5 +24,29 @@ public:
     static Scene* scene();
 };
 
+class RenderQueueSortTest : public PerformBasicLayer
+{
+public:
+    static const int TEST_COUNT = 3;
+
+    RenderQueueSortTest(int nCurCase = 0);
+    virtual ~RenderQueueSortTest();
+
+    virtual void onEnter() override;
+    virtual void showCurrentTest() override;
+
+    void doPerformanceTest(float dt);
+
+protected:
+    int _commandCount;
+    std::vector<CustomCommand> _commands;
+    std::vector<float> _orders;
+    double _comparatorTime;
+    double _radixTime;
+    int _frames;
+    Label* _resultLabel;
+};
+
 void runRendererTest();
+void runRenderQueueSortTest();
 #endif
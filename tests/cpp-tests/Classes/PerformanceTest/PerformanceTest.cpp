@@ -33,6 +33,7 @@ struct {
 	{ "Touches Perf Test",[](Ref*sender){runTouchesTest();} },
     { "Label Perf Test",[](Ref*sender){runLabelTest();} },
     //{ "Renderer Perf Test",[](Ref*sender){runRendererTest();} },
+    { "Render Queue Sort Perf Test",[](Ref*sender){runRenderQueueSortTest();} },
     { "Container Perf Test", [](Ref* sender ) { runContainerPerformanceTest(); } },
     { "EventDispatcher Perf Test", [](Ref* sender ) { runEventDispatcherPerformanceTest(); } },
     { "Scenario Perf Test", [](Ref* sender ) { runScenarioTest(); } },
@@ -2,7 +2,7 @@
 
 enum
 {
-    TEST_COUNT = 1,
+    TEST_COUNT = 2,
 };
 
 static int s_nTexCurCase = 0;
@@ -32,6 +32,9 @@ void TextureMenuLayer::showCurrentTest()
     case 0:
         scene = TextureTest::scene();
         break;
+    case 1:
+        scene = TextureAsyncTest::scene();
+        break;
     }
     s_nTexCurCase = _curCase;
 
@@ -348,7 +351,141 @@ std::string TextureTest::subtitle() const
 Scene* TextureTest::scene()
 {
     auto scene = Scene::create();
-    TextureTest *layer = new (std::nothrow) TextureTest(false, TEST_COUNT, s_nTexCurCase);
+    TextureTest *layer = new (std::nothrow) TextureTest(true, TEST_COUNT, s_nTexCurCase);
+    scene->addChild(layer);
+    layer->release();
+
+    return scene;
+}
+
+////////////////////////////////////////////////////////
+//
+// TextureAsyncTest
+//
+////////////////////////////////////////////////////////
+static const char* s_asyncImages[] = {
+    "Images/landscape-1024x1024.png",
+    "Images/PlanetCute-1024x1024.png",
+    "Images/texture1024x1024.png",
+    "Images/texture512x512.png",
+    "Images/noise.png",
+    "Images/atlastest.png",
+    "Images/grossini_dance_atlas-mono.png",
+    "Images/spritesheet1.png",
+    "Images/HelloWorld.png",
+    "Images/background1.png",
+    "Images/background2.png",
+    "Images/stone.png",
+    "Images/bitmapFontTest3.png",
+    "Images/Fog.png",
+    "Images/powered.png",
+    "Images/test-rgba1.png",
+    "Images/elephant1_Normal.png",
+    "Images/assetMgrBackground2.png",
+    "Images/background.png",
+    "Images/test_image.png",
+    "Images/pattern1.png",
+    "Images/grossini_dance_atlas.png",
+    "Images/background1.jpg",
+    "Images/background2.jpg",
+    "Images/background3.jpg",
+};
+static const int s_asyncImageCount = sizeof(s_asyncImages) / sizeof(s_asyncImages[0]);
+
+// decode workers of each run, 0 is one per JobSystem worker
+static const int s_asyncDecodeWorkers[] = { 1, 2, 4, 0 };
+static const int s_asyncRunCount = sizeof(s_asyncDecodeWorkers) / sizeof(s_asyncDecodeWorkers[0]);
+
+TextureAsyncTest::TextureAsyncTest(bool bControlMenuVisible, int nMaxCases, int nCurCase)
+: TextureMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+, _run(0)
+, _loadedCount(0)
+, _maxFrameTime(0)
+, _resultLabel(nullptr)
+{
+}
+
+TextureAsyncTest::~TextureAsyncTest()
+{
+    auto cache = Director::getInstance()->getTextureCache();
+    cache->unbindAllImageAsync();
+    cache->setAsyncDecodeWorkerCount(0);
+}
+
+void TextureAsyncTest::performTests()
+{
+    auto s = Director::getInstance()->getWinSize();
+    _resultLabel = Label::createWithTTF("", "fonts/arial.ttf", 16);
+    _resultLabel->setPosition(Vec2(s.width/2, s.height/2));
+    addChild(_resultLabel, 1);
+
+    scheduleUpdate();
+    startRun();
+}
+
+void TextureAsyncTest::startRun()
+{
+    auto cache = Director::getInstance()->getTextureCache();
+    for (int i = 0; i < s_asyncImageCount; ++i)
+    {
+        cache->removeTextureForKey(s_asyncImages[i]);
+    }
+
+    _loadedCount = 0;
+    _maxFrameTime = 0;
+    cache->setAsyncDecodeWorkerCount(s_asyncDecodeWorkers[_run]);
+    gettimeofday(&_startTime, nullptr);
+
+    for (int i = 0; i < s_asyncImageCount; ++i)
+    {
+        cache->addImageAsync(s_asyncImages[i], CC_CALLBACK_1(TextureAsyncTest::imageLoaded, this));
+    }
+}
+
+void TextureAsyncTest::update(float dt)
+{
+    if (_loadedCount < s_asyncImageCount)
+    {
+        _maxFrameTime = std::max(_maxFrameTime, dt);
+    }
+}
+
+void TextureAsyncTest::imageLoaded(Texture2D* texture)
+{
+    if (++_loadedCount < s_asyncImageCount)
+        return;
+
+    float loadTime = calculateDeltaTime(&_startTime);
+    int workers = s_asyncDecodeWorkers[_run];
+    if (workers == 0)
+        workers = JobSystem::getInstance()->getWorkerCount();
+
+    auto line = StringUtils::format("%d decode workers: %.1f ms, max frame %.1f ms", workers, loadTime * 1000, _maxFrameTime * 1000);
+    log("%s", line.c_str());
+    _results += line + "\n";
+    _resultLabel->setString(_results);
+
+    if (++_run < s_asyncRunCount)
+    {
+        // start the next run from a clean cache, outside of the callback
+        scheduleOnce([this](float){ startRun(); }, 0, "startRun");
+    }
+}
+
+std::string TextureAsyncTest::title() const
+{
+    return "Texture Async Load Perf Test";
+}
+
+std::string TextureAsyncTest::subtitle() const
+{
+    return StringUtils::format("Loads %d images with addImageAsync", s_asyncImageCount);
+}
+
+Scene* TextureAsyncTest::scene()
+{
+    auto scene = Scene::create();
+    TextureAsyncTest *layer = new (std::nothrow) TextureAsyncTest(true, TEST_COUNT, s_nTexCurCase);
     scene->addChild(layer);
     layer->release();
 
@@ -35,6 +35,31 @@ public:
     static Scene* scene();
 };
 
+class TextureAsyncTest : public TextureMenuLayer
+{
+public:
+    TextureAsyncTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0);
+    virtual ~TextureAsyncTest();
+
+    virtual void performTests() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void update(float dt) override;
+
+    void startRun();
+    void imageLoaded(Texture2D* texture);
+
+    static Scene* scene();
+
+protected:
+    int _run;
+    int _loadedCount;
+    float _maxFrameTime;
+    struct timeval _startTime;
+    std::string _results;
+    Label* _resultLabel;
+};
+
 void runTextureTest();
 
 #endif
@@ -29,7 +29,7 @@
 
 enum
 {
-    TEST_COUNT = 3,
+    TEST_COUNT = 4,
 };
 
 static int s_nTouchCurCase = 0;
@@ -53,6 +53,9 @@ void TouchesMainScene::showCurrentTest()
     case 2:
         layer = new (std::nothrow) TouchesPerformTest3(true, TEST_COUNT, _curCase);
         break;
+    case 3:
+        layer = new (std::nothrow) TouchesPerformTest4(true, TEST_COUNT, _curCase);
+        break;
     }
     s_nTouchCurCase = _curCase;
 
@@ -306,6 +309,143 @@ void TouchesPerformTest3::showCurrentTest()
         case 2:
             layer = new (std::nothrow) TouchesPerformTest3(true, TEST_COUNT, _curCase);
             break;
+        case 3:
+            layer = new (std::nothrow) TouchesPerformTest4(true, TEST_COUNT, _curCase);
+            break;
+    }
+    s_nTouchCurCase = _curCase;
+    
+    if (layer)
+    {
+        auto scene = Scene::create();
+        scene->addChild(layer);
+        layer->release();
+        
+        Director::getInstance()->replaceScene(scene);
+    }
+}
+
+////////////////////////////////////////////////////////
+//
+// TouchesPerformTest4
+//
+////////////////////////////////////////////////////////
+
+#define HIT_TEST_PROFILER_NAME  "TouchHitTestProfileName"
+#define HIT_TEST_NODE_NUM 5000
+
+void TouchesPerformTest4::onEnter()
+{
+    PerformBasicLayer::onEnter();
+    
+    auto s = Director::getInstance()->getWinSize();
+    
+    // add title
+    auto label = Label::createWithTTF(title().c_str(), "fonts/arial.ttf", 32);
+    addChild(label, 1);
+    label->setPosition(Vec2(s.width/2, s.height-50));
+    
+    srand((unsigned)time(nullptr));
+    
+    for (int i = 0; i < HIT_TEST_NODE_NUM; ++i)
+    {
+        auto node = Node::create();
+        node->setContentSize(Size(20, 20));
+        node->setPosition(Vec2(CCRANDOM_0_1() * s.width, CCRANDOM_0_1() * s.height));
+        
+        auto listener = EventListenerTouchOneByOne::create();
+        listener->setSwallowTouches(true);
+        listener->onTouchBegan = [node](Touch* touch, Event* event){
+            // the usual test of the listeners that only want the touches on their node
+            Vec2 location = node->convertToNodeSpace(touch->getLocation());
+            Size size = node->getContentSize();
+            return Rect(0, 0, size.width, size.height).containsPoint(location);
+        };
+        _eventDispatcher->addEventListenerWithSceneGraphPriority(listener, node);
+        _listeners.push_back(listener);
+        
+        addChild(node, rand() % HIT_TEST_NODE_NUM);
+    }
+    
+    auto emitEvents = [this](bool hitTest){
+        CC_PROFILER_PURGE_ALL();
+        
+        for (auto& listener : _listeners)
+        {
+            listener->setHitTestEnabled(hitTest);
+        }
+        
+        auto s = Director::getInstance()->getWinSize();
+        std::vector<Touch*> touches;
+        for (int i = 0; i < EventTouch::MAX_TOUCHES; ++i)
+        {
+            Touch* touch = new (std::nothrow) Touch();
+            touch->setTouchInfo(i, CCRANDOM_0_1() * s.width, CCRANDOM_0_1() * s.height);
+            touches.push_back(touch);
+        }
+        
+        EventTouch event;
+        event.setTouches(touches);
+        
+        for (int i = 0; i < 100; ++i)
+        {
+            CC_PROFILER_START(HIT_TEST_PROFILER_NAME);
+            
+            event.setEventCode(EventTouch::EventCode::BEGAN);
+            _eventDispatcher->dispatchEvent(&event);
+            
+            CC_PROFILER_STOP(HIT_TEST_PROFILER_NAME);
+            
+            event.setEventCode(EventTouch::EventCode::ENDED);
+            _eventDispatcher->dispatchEvent(&event);
+        }
+        
+        CC_PROFILER_DISPLAY_TIMERS();
+        
+        for (auto& touch : touches)
+        {
+            touch->release();
+        }
+    };
+    
+    auto hitTestOffLabel = Label::createWithSystemFont("Emit Touch Event, hit test off", "", 24);
+    auto hitTestOffItem = MenuItemLabel::create(hitTestOffLabel, [=](Ref* sender){
+        emitEvents(false);
+    });
+    hitTestOffItem->setPosition(Vec2(0, 10));
+    
+    auto hitTestOnLabel = Label::createWithSystemFont("Emit Touch Event, hit test on", "", 24);
+    auto hitTestOnItem = MenuItemLabel::create(hitTestOnLabel, [=](Ref* sender){
+        emitEvents(true);
+    });
+    hitTestOnItem->setPosition(Vec2(0, -30));
+    
+    auto menu = Menu::create(hitTestOffItem, hitTestOnItem, nullptr);
+    addChild(menu, HIT_TEST_NODE_NUM);
+}
+
+std::string TouchesPerformTest4::title() const
+{
+    return "Touch Hit Test Perf Test";
+}
+
+void TouchesPerformTest4::showCurrentTest()
+{
+    Layer* layer = nullptr;
+    switch (_curCase)
+    {
+        case 0:
+            layer = new (std::nothrow) TouchesPerformTest1(true, TEST_COUNT, _curCase);
+            break;
+        case 1:
+            layer = new (std::nothrow) TouchesPerformTest2(true, TEST_COUNT, _curCase);
+            break;
+        case 2:
+            layer = new (std::nothrow) TouchesPerformTest3(true, TEST_COUNT, _curCase);
+            break;
+        case 3:
+            layer = new (std::nothrow) TouchesPerformTest4(true, TEST_COUNT, _curCase);
+            break;
     }
     s_nTouchCurCase = _curCase;
     
@@ -73,6 +73,22 @@ public:
     virtual void showCurrentTest() override;
 };
 
+class TouchesPerformTest4 : public PerformBasicLayer
+{
+public:
+    TouchesPerformTest4(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+    : PerformBasicLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+    
+    virtual void onEnter() override;
+    virtual std::string title() const;
+    virtual void showCurrentTest() override;
+    
+protected:
+    std::vector<EventListenerTouchOneByOne*> _listeners;
+};
+
 void runTouchesTest();
 
 #endif
@@ -1,4 +1,5 @@
 #include "PhysicsTest.h"
+#include <chrono>
 #include <cmath>
 #include "../testResource.h"
 #include "ui/CocosGUI.h"
@@ -24,7 +25,11 @@ namespace
         CL(Bug5482),
         CL(PhysicsFixedUpdate),
         CL(PhysicsTransformTest),
-        CL(PhysicsIssue9959)
+        CL(PhysicsIssue9959),
+        CL(PhysicsInterpolationTest),
+        CL(PhysicsStepBenchmark),
+        CL(PhysicsContactBenchmark),
+        CL(PhysicsQueryBenchmark)
 #else
         CL(PhysicsDemoDisabled),
 #endif
@@ -1900,4 +1905,420 @@ std::string PhysicsIssue9959::subtitle() const
     return "Test Scale9Sprite run scale/move/rotation action in physics scene";
 }
 
+void PhysicsInterpolationTest::onEnter()
+{
+    PhysicsDemo::onEnter();
+    
+    auto wall = Node::create();
+    wall->setPhysicsBody(PhysicsBody::createEdgeBox(VisibleRect::getVisibleRect().size, PhysicsMaterial(0.1f, 1.0f, 0.0f)));
+    wall->setPosition(VisibleRect::center());
+    addChild(wall);
+    
+    // a slow step, the nodes are drawn between the steps
+    _scene->getPhysicsWorld()->setFixedTimestep(1.0f / 15);
+    _scene->getPhysicsWorld()->setInterpolationEnabled(true);
+    
+    // the same two balls, one is also rotated by an action: only its rotation is copied to the body
+    _ball = makeBall(VisibleRect::center() + Vec2(-60, 100), 20);
+    addChild(_ball);
+    _rotatedBall = makeBall(VisibleRect::center() + Vec2(60, 100), 20);
+    _rotatedBall->runAction(RepeatForever::create(RotateBy::create(1.0f, 360.0f)));
+    addChild(_rotatedBall);
+    
+    _infoLabel = Label::createWithTTF("", "fonts/arial.ttf", 16);
+    _infoLabel->setPosition(VisibleRect::bottom() + Vec2(0, 40));
+    addChild(_infoLabel, 1);
+    
+    scheduleUpdate();
+}
+
+void PhysicsInterpolationTest::update(float delta)
+{
+    float gap = std::abs(_ball->getPhysicsBody()->getPosition().y - _rotatedBall->getPhysicsBody()->getPosition().y);
+    if (gap > 1.0f)
+    {
+        _infoLabel->setString(StringUtils::format("Failed: the rotated ball is %.1f points away", gap));
+    }
+    else
+    {
+        _infoLabel->setString("Passed");
+    }
+}
+
+std::string PhysicsInterpolationTest::title() const
+{
+    return "Interpolation Test";
+}
+
+std::string PhysicsInterpolationTest::subtitle() const
+{
+    return "Both balls should bounce at the same height";
+}
+
+// the bodies are added by batches, the average step of each batch is logged
+static const int kStepBenchmarkBatch = 250;
+static const int kStepBenchmarkMaxBodies = 2000;
+
+void PhysicsStepBenchmark::onEnter()
+{
+    PhysicsDemo::onEnter();
+    
+    _bodyCount = 0;
+    _stepCount = 0;
+    _totalStepTime = 0.0f;
+    _maxStepTime = 0.0f;
+    
+    auto wall = Node::create();
+    wall->setPhysicsBody(PhysicsBody::createEdgeBox(VisibleRect::getVisibleRect().size, PhysicsMaterial(0.1f, 0.5f, 0.5f)));
+    wall->setPosition(VisibleRect::center());
+    addChild(wall);
+    
+    // a few nodes moved by actions: only their bodies are synchronized with the nodes before a step
+    for (int i = 0; i < 8; ++i)
+    {
+        auto paddle = Node::create();
+        paddle->setPhysicsBody(PhysicsBody::createBox(Size(60, 8)));
+        paddle->getPhysicsBody()->setDynamic(false);
+        paddle->setPosition(VisibleRect::left() + Vec2(60 + i * 100, -80 + (i % 2) * 160));
+        paddle->runAction(RepeatForever::create(RotateBy::create(2.0f, 360.0f)));
+        addChild(paddle);
+    }
+    
+    _infoLabel = Label::createWithTTF("", "fonts/arial.ttf", 16);
+    _infoLabel->setPosition(VisibleRect::bottom() + Vec2(0, 40));
+    addChild(_infoLabel, 1);
+    
+    // the world is stepped by the test, to time the steps alone
+    _scene->getPhysicsWorld()->setAutoStep(false);
+    addBodies(0);
+    schedule(CC_SCHEDULE_SELECTOR(PhysicsStepBenchmark::addBodies), 3.0f);
+    scheduleUpdate();
+}
+
+void PhysicsStepBenchmark::addBodies(float delta)
+{
+    if (_stepCount > 0)
+    {
+        log("PhysicsStepBenchmark: %d bodies, step %.3f ms on average, %.3f ms at most", _bodyCount, _totalStepTime / _stepCount, _maxStepTime);
+    }
+    _stepCount = 0;
+    _totalStepTime = 0.0f;
+    _maxStepTime = 0.0f;
+    
+    if (_bodyCount >= kStepBenchmarkMaxBodies)
+    {
+        unschedule(CC_SCHEDULE_SELECTOR(PhysicsStepBenchmark::addBodies));
+        return;
+    }
+    
+    auto rect = VisibleRect::getVisibleRect();
+    for (int i = 0; i < kStepBenchmarkBatch; ++i)
+    {
+        Vec2 position(rect.origin.x + 20 + CCRANDOM_0_1() * (rect.size.width - 40), rect.origin.y + rect.size.height * (0.5f + CCRANDOM_0_1() * 0.45f));
+        addChild(i % 2 ? makeBall(position, 4) : makeBox(position, Size(8, 8)));
+    }
+    _bodyCount += kStepBenchmarkBatch;
+}
+
+void PhysicsStepBenchmark::update(float delta)
+{
+    auto start = std::chrono::steady_clock::now();
+    _scene->getPhysicsWorld()->step(1.0f / 60.0f);
+    float elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    ++_stepCount;
+    _totalStepTime += elapsed;
+    _maxStepTime = std::max(_maxStepTime, elapsed);
+    
+    char text[64];
+    sprintf(text, "%d bodies, step %.2f ms", _bodyCount, _totalStepTime / _stepCount);
+    _infoLabel->setString(text);
+}
+
+std::string PhysicsStepBenchmark::title() const
+{
+    return "Step Benchmark";
+}
+
+std::string PhysicsStepBenchmark::subtitle() const
+{
+    return "The cost of a step by body count, see the log";
+}
+
+void PhysicsContactBenchmark::onEnter()
+{
+    PhysicsDemo::onEnter();
+    
+    _mode = 0;
+    _batchCallbackId = 0;
+    _contactListener = nullptr;
+    _contactCount = 0;
+    _stepCount = 0;
+    _totalStepTime = 0.0f;
+    
+    auto wall = Node::create();
+    wall->setPhysicsBody(PhysicsBody::createEdgeBox(VisibleRect::getVisibleRect().size, PhysicsMaterial(0.1f, 0.2f, 0.5f)));
+    wall->setPosition(VisibleRect::center());
+    addChild(wall);
+    
+    // a pile of small balls: thousands of contacts on every step
+    auto rect = VisibleRect::getVisibleRect();
+    for (int i = 0; i < 1500; ++i)
+    {
+        Vec2 position(rect.origin.x + 10 + CCRANDOM_0_1() * (rect.size.width - 20), rect.origin.y + 10 + CCRANDOM_0_1() * (rect.size.height - 20));
+        auto ball = makeBall(position, 3, PhysicsMaterial(0.1f, 0.2f, 0.5f));
+        ball->getPhysicsBody()->setContactTestBitmask(0xFFFFFFFF);
+        addChild(ball);
+    }
+    
+    MenuItemFont::setFontSize(18);
+    auto item = MenuItemFont::create("Mode: events", CC_CALLBACK_1(PhysicsContactBenchmark::changeModeCallback, this));
+    auto menu = Menu::create(item, nullptr);
+    addChild(menu);
+    menu->setPosition(Vec2(VisibleRect::left().x+100, VisibleRect::top().y-10));
+    
+    _infoLabel = Label::createWithTTF("", "fonts/arial.ttf", 16);
+    _infoLabel->setPosition(VisibleRect::bottom() + Vec2(0, 40));
+    addChild(_infoLabel, 1);
+    
+    _contactListener = EventListenerPhysicsContact::create();
+    _contactListener->onContactBegin = [this](PhysicsContact& contact) -> bool
+    {
+        ++_contactCount;
+        return true;
+    };
+    _contactListener->onContactPreSolve = [](PhysicsContact& contact, PhysicsContactPreSolve& solve) -> bool
+    {
+        return true;
+    };
+    _eventDispatcher->addEventListenerWithSceneGraphPriority(_contactListener, this);
+    
+    _scene->getPhysicsWorld()->setAutoStep(false);
+    schedule(CC_SCHEDULE_SELECTOR(PhysicsContactBenchmark::logSteps), 3.0f);
+    scheduleUpdate();
+}
+
+void PhysicsContactBenchmark::onExit()
+{
+    if (_batchCallbackId != 0)
+    {
+        _scene->getPhysicsWorld()->removeContactBatchCallback(_batchCallbackId);
+        _batchCallbackId = 0;
+    }
+    PhysicsDemo::onExit();
+}
+
+void PhysicsContactBenchmark::changeModeCallback(Ref* sender)
+{
+    logSteps(0);
+    _mode = 1 - _mode;
+    
+    if (_mode == 0)
+    {
+        _scene->getPhysicsWorld()->removeContactBatchCallback(_batchCallbackId);
+        _batchCallbackId = 0;
+        _contactListener = EventListenerPhysicsContact::create();
+        _contactListener->onContactBegin = [this](PhysicsContact& contact) -> bool
+        {
+            ++_contactCount;
+            return true;
+        };
+        _contactListener->onContactPreSolve = [](PhysicsContact& contact, PhysicsContactPreSolve& solve) -> bool
+        {
+            return true;
+        };
+        _eventDispatcher->addEventListenerWithSceneGraphPriority(_contactListener, this);
+        ((MenuItemFont*)sender)->setString("Mode: events");
+    }
+    else
+    {
+        _eventDispatcher->removeEventListener(_contactListener);
+        _contactListener = nullptr;
+        _batchCallbackId = _scene->getPhysicsWorld()->addContactBatchCallback([this](PhysicsWorld& world, const std::vector<PhysicsContact*>& began, const std::vector<PhysicsContact*>& separated)
+        {
+            _contactCount += static_cast<int>(began.size());
+        });
+        ((MenuItemFont*)sender)->setString("Mode: batches");
+    }
+}
+
+void PhysicsContactBenchmark::logSteps(float delta)
+{
+    if (_stepCount > 0)
+    {
+        log("PhysicsContactBenchmark: %s, step %.3f ms on average, %d contacts began", _mode == 0 ? "events" : "batches", _totalStepTime / _stepCount, _contactCount);
+    }
+    _stepCount = 0;
+    _totalStepTime = 0.0f;
+    _contactCount = 0;
+}
+
+void PhysicsContactBenchmark::update(float delta)
+{
+    auto start = std::chrono::steady_clock::now();
+    _scene->getPhysicsWorld()->step(1.0f / 60.0f);
+    float elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    ++_stepCount;
+    _totalStepTime += elapsed;
+    
+    char text[64];
+    sprintf(text, "step %.2f ms", _totalStepTime / _stepCount);
+    _infoLabel->setString(text);
+}
+
+std::string PhysicsContactBenchmark::title() const
+{
+    return "Contact Benchmark";
+}
+
+std::string PhysicsContactBenchmark::subtitle() const
+{
+    return "Contact events or contact batches, see the log";
+}
+
+namespace
+{
+    const char* s_queryModeNames[] = { "Mode: rayCast", "Mode: batch", "Mode: parallel batch" };
+}
+
+void PhysicsQueryBenchmark::onEnter()
+{
+    PhysicsDemo::onEnter();
+    
+    _mode = 0;
+    _queryCount = 0;
+    _totalQueryTime = 0.0f;
+    
+    // many static shapes of about the same size, like the tiles of a level
+    auto rect = VisibleRect::getVisibleRect();
+    for (int i = 0; i < 1000; ++i)
+    {
+        Vec2 position(rect.origin.x + CCRANDOM_0_1() * rect.size.width, rect.origin.y + CCRANDOM_0_1() * rect.size.height);
+        auto node = Node::create();
+        auto body = CCRANDOM_0_1() > 0.5f ? PhysicsBody::createBox(Size(8, 8)) : PhysicsBody::createCircle(4);
+        body->setDynamic(false);
+        node->setPhysicsBody(body);
+        node->setPosition(position);
+        addChild(node);
+    }
+    
+    // the line of sight of 500 agents
+    for (int i = 0; i < 500; ++i)
+    {
+        _starts.push_back(Vec2(rect.origin.x + CCRANDOM_0_1() * rect.size.width, rect.origin.y + CCRANDOM_0_1() * rect.size.height));
+        _ends.push_back(Vec2(rect.origin.x + CCRANDOM_0_1() * rect.size.width, rect.origin.y + CCRANDOM_0_1() * rect.size.height));
+    }
+    
+    MenuItemFont::setFontSize(18);
+    auto modeItem = MenuItemFont::create(s_queryModeNames[_mode], CC_CALLBACK_1(PhysicsQueryBenchmark::changeModeCallback, this));
+    auto broadphaseItem = MenuItemFont::create("Broadphase: tree", CC_CALLBACK_1(PhysicsQueryBenchmark::changeBroadphaseCallback, this));
+    auto menu = Menu::create(modeItem, broadphaseItem, nullptr);
+    menu->alignItemsVertically();
+    addChild(menu);
+    menu->setPosition(Vec2(VisibleRect::left().x+100, VisibleRect::top().y-30));
+    
+    _drawNode = DrawNode::create();
+    addChild(_drawNode);
+    
+    _infoLabel = Label::createWithTTF("", "fonts/arial.ttf", 16);
+    _infoLabel->setPosition(VisibleRect::bottom() + Vec2(0, 40));
+    addChild(_infoLabel, 1);
+    
+    schedule(CC_SCHEDULE_SELECTOR(PhysicsQueryBenchmark::logQueries), 3.0f);
+    scheduleUpdate();
+}
+
+void PhysicsQueryBenchmark::changeModeCallback(Ref* sender)
+{
+    logQueries(0);
+    _mode = (_mode + 1) % 3;
+    ((MenuItemFont*)sender)->setString(s_queryModeNames[_mode]);
+}
+
+void PhysicsQueryBenchmark::changeBroadphaseCallback(Ref* sender)
+{
+    logQueries(0);
+    auto world = _scene->getPhysicsWorld();
+    if (world->getBroadphase() == PhysicsWorld::Broadphase::BB_TREE)
+    {
+        world->setBroadphase(PhysicsWorld::Broadphase::SPATIAL_HASH, 10.0f, 2000);
+        ((MenuItemFont*)sender)->setString("Broadphase: hash");
+    }
+    else
+    {
+        world->setBroadphase(PhysicsWorld::Broadphase::BB_TREE);
+        ((MenuItemFont*)sender)->setString("Broadphase: tree");
+    }
+}
+
+void PhysicsQueryBenchmark::logQueries(float delta)
+{
+    if (_queryCount > 0)
+    {
+        log("PhysicsQueryBenchmark: %s, %s, %d rays in %.3f ms on average", s_queryModeNames[_mode],
+            _scene->getPhysicsWorld()->getBroadphase() == PhysicsWorld::Broadphase::BB_TREE ? "tree" : "hash",
+            static_cast<int>(_starts.size()), _totalQueryTime / _queryCount);
+    }
+    _queryCount = 0;
+    _totalQueryTime = 0.0f;
+}
+
+void PhysicsQueryBenchmark::update(float delta)
+{
+    auto world = _scene->getPhysicsWorld();
+    auto start = std::chrono::steady_clock::now();
+    
+    if (_mode == 0)
+    {
+        _results.resize(_starts.size());
+        for (size_t i = 0; i < _starts.size(); ++i)
+        {
+            PhysicsRayCastResult& result = _results[i];
+            result.shape = nullptr;
+            result.fraction = 1.0f;
+            world->rayCast([&result](PhysicsWorld& world, const PhysicsRayCastInfo& info, void* data)->bool
+            {
+                if (result.shape == nullptr || info.fraction < result.fraction)
+                {
+                    result.shape = info.shape;
+                    result.contact = info.contact;
+                    result.normal = info.normal;
+                    result.fraction = info.fraction;
+                }
+                return true;
+            }, _starts[i], _ends[i], nullptr);
+        }
+    }
+    else
+    {
+        world->rayCastBatch(_starts.data(), _ends.data(), _starts.size(), _results, _mode == 2);
+    }
+    
+    float elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    ++_queryCount;
+    _totalQueryTime += elapsed;
+    
+    _drawNode->clear();
+    for (size_t i = 0; i < _starts.size(); ++i)
+    {
+        Vec2 end = _results[i].shape ? _results[i].contact : _ends[i];
+        _drawNode->drawSegment(_starts[i], end, 0.5f, _results[i].shape ? Color4F(1.0f, 0.0f, 0.0f, 0.5f) : Color4F(0.0f, 1.0f, 0.0f, 0.5f));
+    }
+    
+    char text[64];
+    sprintf(text, "%d rays, %.3f ms", static_cast<int>(_starts.size()), _totalQueryTime / _queryCount);
+    _infoLabel->setString(text);
+}
+
+std::string PhysicsQueryBenchmark::title() const
+{
+    return "Query Benchmark";
+}
+
+std::string PhysicsQueryBenchmark::subtitle() const
+{
+    return "Rays one by one or in batches, see the log";
+}
+
 #endif // ifndef CC_USE_PHYSICS
@@ -289,5 +289,89 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class PhysicsInterpolationTest : public PhysicsDemo
+{
+public:
+    CREATE_FUNC(PhysicsInterpolationTest);
+    
+    void onEnter() override;
+    virtual void update(float delta) override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    
+private:
+    Node* _ball;
+    Node* _rotatedBall;
+    Label* _infoLabel;
+};
+
+class PhysicsStepBenchmark : public PhysicsDemo
+{
+public:
+    CREATE_FUNC(PhysicsStepBenchmark);
+    
+    void onEnter() override;
+    void addBodies(float delta);
+    virtual void update(float delta) override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    
+private:
+    int _bodyCount;
+    int _stepCount;
+    float _totalStepTime;
+    float _maxStepTime;
+    Label* _infoLabel;
+};
+
+class PhysicsContactBenchmark : public PhysicsDemo
+{
+public:
+    CREATE_FUNC(PhysicsContactBenchmark);
+    
+    void onEnter() override;
+    void onExit() override;
+    void changeModeCallback(Ref* sender);
+    void logSteps(float delta);
+    virtual void update(float delta) override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    
+private:
+    // 0: a listener for each event, 1: a batch callback for each step
+    int _mode;
+    int _batchCallbackId;
+    EventListenerPhysicsContact* _contactListener;
+    int _contactCount;
+    int _stepCount;
+    float _totalStepTime;
+    Label* _infoLabel;
+};
+
+class PhysicsQueryBenchmark : public PhysicsDemo
+{
+public:
+    CREATE_FUNC(PhysicsQueryBenchmark);
+    
+    void onEnter() override;
+    void changeModeCallback(Ref* sender);
+    void changeBroadphaseCallback(Ref* sender);
+    void logQueries(float delta);
+    virtual void update(float delta) override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    
+private:
+    // 0: rayCast for each ray, 1: rayCastBatch, 2: parallel rayCastBatch
+    int _mode;
+    std::vector<Vec2> _starts;
+    std::vector<Vec2> _ends;
+    std::vector<PhysicsRayCastResult> _results;
+    int _queryCount;
+    float _totalQueryTime;
+    DrawNode* _drawNode;
+    Label* _infoLabel;
+};
+
 #endif
 #endif
@@ -1,6 +1,9 @@
 #include "SchedulerTest.h"
 #include "../testResource.h"
 
+#include <chrono>
+#include <thread>
+
 enum {
     kTagAnimationDance = 1,
 };
@@ -30,7 +33,9 @@ static std::function<Layer*()> createFunctions[] = {
     CL(SchedulerIssue2268),
     CL(ScheduleCallbackTest),
     CL(ScheduleUpdatePriority),
-    CL(SchedulerIssue10232)
+    CL(SchedulerIssue10232),
+    CL(SchedulerTimerStress),
+    CL(SchedulerPerformFunctionContention)
 };
 
 #define MAX_LAYER (sizeof(createFunctions) / sizeof(createFunctions[0]))
@@ -1239,3 +1244,148 @@ std::string SchedulerIssue10232::subtitle() const
 {
     return "Should not crash";
 }
+
+// SchedulerTimerStress
+
+void SchedulerTimerStress::onEnter()
+{
+    SchedulerTestLayer::onEnter();
+
+    auto s = Director::getInstance()->getWinSize();
+
+    static const int TIMER_COUNTS[] = { 1000, 5000, 10000, 20000 };
+    static const int TIMERS_PER_TARGET = 4;
+    static const int FRAME_COUNT = 600;
+
+    int y = s.height * 3 / 4;
+    for (const auto& timerCount : TIMER_COUNTS)
+    {
+        // a scheduler of its own, the cost of the frames is only the cost of the timers
+        auto scheduler = new (std::nothrow) Scheduler();
+        std::vector<int> targets(timerCount / TIMERS_PER_TARGET);
+        int calls = 0;
+
+        // cooldowns and AI ticks: a few updates per second at most, most of the timers are idle in a frame
+        for (int i = 0; i < timerCount; ++i)
+        {
+            scheduler->schedule([&calls](float dt) { ++calls; }, &targets[i / TIMERS_PER_TARGET], 0.5f + (i % 97) * 0.1f, false, StringUtils::format("timer%d", i));
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < FRAME_COUNT; ++frame)
+        {
+            // a tenth of the targets is paused during a second, like the nodes of a hidden menu
+            if (frame == 120 || frame == 180)
+            {
+                for (size_t target = 0; target < targets.size(); target += 10)
+                {
+                    if (frame == 120)
+                        scheduler->pauseTarget(&targets[target]);
+                    else
+                        scheduler->resumeTarget(&targets[target]);
+                }
+            }
+            scheduler->update(1.0f / 60);
+        }
+        float frameTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / FRAME_COUNT;
+
+        scheduler->release();
+
+        auto msg = StringUtils::format("%d timers: %.4f ms per frame, %.1f callbacks per frame", timerCount, frameTime, (float)calls / FRAME_COUNT);
+        log("%s", msg.c_str());
+        auto label = Label::createWithSystemFont(msg, "", 16);
+        label->setPosition(s.width/2, y);
+        this->addChild(label);
+        y -= 40;
+    }
+}
+
+std::string SchedulerTimerStress::title() const
+{
+    return "Timers stress test";
+}
+
+std::string SchedulerTimerStress::subtitle() const
+{
+    return "Frame cost of the custom selectors against the timer count";
+}
+
+// SchedulerPerformFunctionContention
+
+void SchedulerPerformFunctionContention::onEnter()
+{
+    SchedulerTestLayer::onEnter();
+
+    auto s = Director::getInstance()->getWinSize();
+
+    static const int THREAD_COUNTS[] = { 1, 2, 4, 8 };
+    static const int FUNCTIONS_PER_THREAD = 20000;
+    static const float TIME_BUDGETS[] = { 0.0f, 0.001f };
+
+    int y = s.height * 3 / 4;
+    for (const auto& threadCount : THREAD_COUNTS)
+    {
+        for (const auto& timeBudget : TIME_BUDGETS)
+        {
+            // a scheduler of its own, updated as fast as possible while the threads post small functions
+            auto scheduler = new (std::nothrow) Scheduler();
+            scheduler->setPerformFunctionsTimeBudget(timeBudget);
+
+            int performed = 0;
+            std::atomic<int> runningThreads(threadCount);
+            float postTime = 0;
+
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::thread> threads;
+            for (int i = 0; i < threadCount; ++i)
+            {
+                threads.push_back(std::thread([&]() {
+                    for (int j = 0; j < FUNCTIONS_PER_THREAD; ++j)
+                    {
+                        scheduler->performFunctionInCocosThread([&performed]() { ++performed; });
+                    }
+                    if (--runningThreads == 0)
+                    {
+                        scheduler->performFunctionInCocosThread([&postTime, start]() {
+                            postTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+                        });
+                    }
+                }));
+            }
+
+            int frames = 0;
+            float maxFrameTime = 0;
+            while (runningThreads > 0 || performed < threadCount * FUNCTIONS_PER_THREAD || postTime == 0)
+            {
+                auto frameStart = std::chrono::steady_clock::now();
+                scheduler->update(1.0f / 60);
+                maxFrameTime = std::max(maxFrameTime, std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+                ++frames;
+            }
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+            scheduler->release();
+
+            auto msg = StringUtils::format("%d threads, budget %.0f ms: posted in %.2f ms, %d frames, longest frame %.2f ms",
+                                           threadCount, timeBudget * 1000, postTime, frames, maxFrameTime);
+            log("%s", msg.c_str());
+            auto label = Label::createWithSystemFont(msg, "", 14);
+            label->setPosition(s.width/2, y);
+            this->addChild(label);
+            y -= 24;
+        }
+    }
+}
+
+std::string SchedulerPerformFunctionContention::title() const
+{
+    return "performFunctionInCocosThread contention";
+}
+
+std::string SchedulerPerformFunctionContention::subtitle() const
+{
+    return "20000 functions posted by each thread, with and without a time budget";
+}
@@ -342,4 +342,26 @@ public:
     void update(float dt);
 };
 
+class SchedulerTimerStress : public SchedulerTestLayer
+{
+public:
+    CREATE_FUNC(SchedulerTimerStress);
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+    void onEnter();
+};
+
+class SchedulerPerformFunctionContention : public SchedulerTestLayer
+{
+public:
+    CREATE_FUNC(SchedulerPerformFunctionContention);
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+    void onEnter();
+};
+
 #endif
@@ -28,12 +28,14 @@
 #include "3d/CCAnimation3D.h"
 #include "3d/CCAnimate3D.h"
 #include "3d/CCAttachNode.h"
+#include "3d/CCMeshSkin.h"
 #include "3d/CCRay.h"
 #include "3d/CCSprite3D.h"
 #include "renderer/CCVertexIndexBuffer.h"
 #include "DrawNode3D.h"
 
 #include <algorithm>
+#include <chrono>
 #include "../testResource.h"
 
 enum
@@ -63,6 +65,8 @@ static std::function<Layer*()> createFunctions[] =
     CL(AttachmentTest),
     CL(Sprite3DReskinTest),
     CL(Sprite3DWithOBBPerformanceTest),
+    CL(Sprite3DCrowdTest),
+    CL(Sprite3DSkinningBenchmark),
     CL(Sprite3DMirrorTest),
     CL(QuaternionTest),
     CL(Sprite3DEmptyTest),
@@ -2140,6 +2144,248 @@ void QuaternionTest::update(float delta)
     _sprite->setRotationQuat(quat);
 }
 
+Sprite3DCrowdTest::Sprite3DCrowdTest()
+: _actionManager(nullptr)
+, _label(nullptr)
+, _spriteCount(0)
+, _updateCount(0)
+, _totalUpdateTime(0.0f)
+{
+    _actionManager = new (std::nothrow) ActionManager();
+    
+    auto s = Director::getInstance()->getWinSize();
+    std::string fileName = "Sprite3DTest/orc.c3b";
+    auto animation = Animation3D::create(fileName);
+    
+    const int columns = 25;
+    const int rows = 20;
+    for (int i = 0; i < columns * rows; ++i)
+    {
+        auto sprite = Sprite3D::create(fileName);
+        sprite->setScale(0.8f);
+        sprite->setRotation3D(Vec3(0,180,0));
+        sprite->setPosition(Vec2(s.width * (i % columns + 0.5f) / columns, s.height * (0.15f + 0.65f * (i / columns + 0.5f) / rows)));
+        sprite->setActionManager(_actionManager);
+        addChild(sprite);
+        
+        if (animation)
+        {
+            auto animate = Animate3D::create(animation);
+            animate->setSpeed(0.5f + CCRANDOM_0_1());
+            sprite->runAction(RepeatForever::create(animate));
+        }
+        ++_spriteCount;
+    }
+    
+    _label = Label::createWithTTF("", "fonts/arial.ttf", 16);
+    _label->setPosition(Vec2(s.width / 2, s.height * 0.08f));
+    addChild(_label);
+    
+    schedule(CC_SCHEDULE_SELECTOR(Sprite3DCrowdTest::logUpdates), 3.0f);
+    scheduleUpdate();
+}
+
+Sprite3DCrowdTest::~Sprite3DCrowdTest()
+{
+    CC_SAFE_RELEASE(_actionManager);
+}
+
+std::string Sprite3DCrowdTest::title() const
+{
+    return "Animate3D crowd";
+}
+
+std::string Sprite3DCrowdTest::subtitle() const
+{
+    return "500 sprites sharing an animation, see the log";
+}
+
+void Sprite3DCrowdTest::update(float delta)
+{
+    auto start = std::chrono::steady_clock::now();
+    _actionManager->update(delta);
+    float elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    ++_updateCount;
+    _totalUpdateTime += elapsed;
+    
+    char text[64];
+    sprintf(text, "%d sprites, animations %.3f ms", _spriteCount, _totalUpdateTime / _updateCount);
+    _label->setString(text);
+}
+
+void Sprite3DCrowdTest::logUpdates(float delta)
+{
+    if (_updateCount > 0)
+    {
+        log("Sprite3DCrowdTest: %d sprites, animations updated in %.3f ms on average", _spriteCount, _totalUpdateTime / _updateCount);
+    }
+    _updateCount = 0;
+    _totalUpdateTime = 0.0f;
+}
+
+static const char* s_paletteModeNames[] = { "immediate", "batched", "shared" };
+
+Sprite3DSkinningBenchmark::Sprite3DSkinningBenchmark()
+: _actionManager(nullptr)
+, _crowd(nullptr)
+, _label(nullptr)
+, _modeItem(nullptr)
+, _afterUpdateListener(nullptr)
+, _afterDrawListener(nullptr)
+, _characterCount(0)
+, _frameCount(0)
+, _totalAnimationTime(0.0f)
+, _totalDrawTime(0.0f)
+{
+    _actionManager = new (std::nothrow) ActionManager();
+    
+    auto s = Director::getInstance()->getWinSize();
+    _crowd = Node::create();
+    addChild(_crowd);
+    
+    MenuItemFont::setFontName("fonts/arial.ttf");
+    MenuItemFont::setFontSize(40);
+    auto decrease = MenuItemFont::create(" - ", CC_CALLBACK_1(Sprite3DSkinningBenchmark::removeCharactersCallback, this));
+    decrease->setColor(Color3B(0,200,20));
+    auto increase = MenuItemFont::create(" + ", CC_CALLBACK_1(Sprite3DSkinningBenchmark::addCharactersCallback, this));
+    increase->setColor(Color3B(0,200,20));
+    MenuItemFont::setFontSize(24);
+    _modeItem = MenuItemFont::create("palettes: immediate", CC_CALLBACK_1(Sprite3DSkinningBenchmark::switchModeCallback, this));
+    
+    auto menu = Menu::create(decrease, increase, _modeItem, nullptr);
+    menu->alignItemsHorizontallyWithPadding(20);
+    menu->setPosition(Vec2(s.width / 2, s.height - 90));
+    addChild(menu, 1);
+    
+    _label = Label::createWithTTF("", "fonts/arial.ttf", 16);
+    _label->setPosition(Vec2(s.width / 2, s.height * 0.08f));
+    addChild(_label, 1);
+    
+    // the drawing is timed from the end of the updates to the end of the frame: the visit and the rendering
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    _afterUpdateListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_UPDATE, [this](EventCustom* event) {
+        _drawStart = std::chrono::steady_clock::now();
+    });
+    _afterDrawListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_DRAW, [this](EventCustom* event) {
+        _totalDrawTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - _drawStart).count();
+        ++_frameCount;
+    });
+    
+    MeshSkin::setPaletteMode(MeshSkin::PaletteMode::IMMEDIATE);
+    setCharacterCount(200);
+    
+    schedule(CC_SCHEDULE_SELECTOR(Sprite3DSkinningBenchmark::logFrames), 3.0f);
+    scheduleUpdate();
+}
+
+Sprite3DSkinningBenchmark::~Sprite3DSkinningBenchmark()
+{
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    dispatcher->removeEventListener(_afterUpdateListener);
+    dispatcher->removeEventListener(_afterDrawListener);
+    CC_SAFE_RELEASE(_actionManager);
+}
+
+std::string Sprite3DSkinningBenchmark::title() const
+{
+    return "Skinning benchmark";
+}
+
+std::string Sprite3DSkinningBenchmark::subtitle() const
+{
+    return "Frame cost by character count and palette mode, see the log";
+}
+
+void Sprite3DSkinningBenchmark::onExit()
+{
+    MeshSkin::setPaletteMode(MeshSkin::PaletteMode::IMMEDIATE);
+    Sprite3DTestDemo::onExit();
+}
+
+void Sprite3DSkinningBenchmark::setCharacterCount(int count)
+{
+    _crowd->removeAllChildren();
+    _characterCount = count;
+    
+    auto s = Director::getInstance()->getWinSize();
+    std::string fileName = "Sprite3DTest/orc.c3b";
+    auto animation = Animation3D::create(fileName);
+    
+    // a few groups playing at different speeds, so that the shared mode has several poses to compute
+    const float speeds[] = { 0.75f, 1.0f, 1.25f, 1.5f };
+    const int columns = std::max(1, static_cast<int>(sqrtf(count * 2.0f)));
+    const int rows = (count + columns - 1) / columns;
+    const float scale = std::min(0.8f, 20.0f / columns);
+    for (int i = 0; i < count; ++i)
+    {
+        auto sprite = Sprite3D::create(fileName);
+        sprite->setScale(scale);
+        sprite->setRotation3D(Vec3(0,180,0));
+        sprite->setPosition(Vec2(s.width * (i % columns + 0.5f) / columns, s.height * (0.15f + 0.6f * (i / columns + 0.5f) / rows)));
+        sprite->setActionManager(_actionManager);
+        _crowd->addChild(sprite);
+        
+        if (animation)
+        {
+            auto animate = Animate3D::create(animation);
+            animate->setSpeed(speeds[i % 4]);
+            sprite->runAction(RepeatForever::create(animate));
+        }
+    }
+    resetTimes();
+}
+
+void Sprite3DSkinningBenchmark::addCharactersCallback(Ref* sender)
+{
+    setCharacterCount(std::min(_characterCount + 100, 2000));
+}
+
+void Sprite3DSkinningBenchmark::removeCharactersCallback(Ref* sender)
+{
+    setCharacterCount(std::max(_characterCount - 100, 100));
+}
+
+void Sprite3DSkinningBenchmark::switchModeCallback(Ref* sender)
+{
+    int mode = (static_cast<int>(MeshSkin::getPaletteMode()) + 1) % 3;
+    MeshSkin::setPaletteMode(static_cast<MeshSkin::PaletteMode>(mode));
+    _modeItem->setString(std::string("palettes: ") + s_paletteModeNames[mode]);
+    resetTimes();
+}
+
+void Sprite3DSkinningBenchmark::update(float delta)
+{
+    auto start = std::chrono::steady_clock::now();
+    _actionManager->update(delta);
+    _totalAnimationTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    if (_frameCount > 0)
+    {
+        char text[96];
+        sprintf(text, "%d characters, animations %.3f ms, drawing %.3f ms", _characterCount, _totalAnimationTime / _frameCount, _totalDrawTime / _frameCount);
+        _label->setString(text);
+    }
+}
+
+void Sprite3DSkinningBenchmark::logFrames(float delta)
+{
+    if (_frameCount > 0)
+    {
+        log("Sprite3DSkinningBenchmark: %d characters, %s palettes: animations %.3f ms, drawing %.3f ms on average",
+            _characterCount, s_paletteModeNames[static_cast<int>(MeshSkin::getPaletteMode())],
+            _totalAnimationTime / _frameCount, _totalDrawTime / _frameCount);
+    }
+    resetTimes();
+}
+
+void Sprite3DSkinningBenchmark::resetTimes()
+{
+    _frameCount = 0;
+    _totalAnimationTime = 0.0f;
+    _totalDrawTime = 0.0f;
+}
+
 UseCaseSprite3D::UseCaseSprite3D()
 : _caseIdx(0)
 {
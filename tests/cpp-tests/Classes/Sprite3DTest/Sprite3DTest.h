@@ -28,6 +28,7 @@
 #include "../testBasic.h"
 #include "../BaseTest.h"
 #include <string>
+#include <chrono>
 
 namespace cocos2d {
     class Animate3D;
@@ -430,6 +431,63 @@ protected:
     void calculateRayByLocationInView(Ray* ray, const Vec2& location);
 };
 
+// 500 skinned sprites sharing an animation
+class Sprite3DCrowdTest : public Sprite3DTestDemo
+{
+public:
+    CREATE_FUNC(Sprite3DCrowdTest);
+    Sprite3DCrowdTest();
+    virtual ~Sprite3DCrowdTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    
+    virtual void update(float delta) override;
+    void logUpdates(float delta);
+    
+protected:
+    // the crowd has its own action manager, its updates are timed alone
+    cocos2d::ActionManager* _actionManager;
+    cocos2d::Label*         _label;
+    int                     _spriteCount;
+    int                     _updateCount;
+    float                   _totalUpdateTime;
+};
+
+class Sprite3DSkinningBenchmark : public Sprite3DTestDemo
+{
+public:
+    CREATE_FUNC(Sprite3DSkinningBenchmark);
+    Sprite3DSkinningBenchmark();
+    virtual ~Sprite3DSkinningBenchmark();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void onExit() override;
+    
+    virtual void update(float delta) override;
+    void logFrames(float delta);
+    
+    void addCharactersCallback(cocos2d::Ref* sender);
+    void removeCharactersCallback(cocos2d::Ref* sender);
+    void switchModeCallback(cocos2d::Ref* sender);
+    
+protected:
+    void setCharacterCount(int count);
+    void resetTimes();
+    
+    // the characters have their own action manager, the animations are timed apart from the drawing
+    cocos2d::ActionManager*         _actionManager;
+    cocos2d::Node*                  _crowd;
+    cocos2d::Label*                 _label;
+    cocos2d::MenuItemFont*          _modeItem;
+    cocos2d::EventListenerCustom*   _afterUpdateListener;
+    cocos2d::EventListenerCustom*   _afterDrawListener;
+    std::chrono::steady_clock::time_point _drawStart;
+    int                             _characterCount;
+    int                             _frameCount;
+    float                           _totalAnimationTime;
+    float                           _totalDrawTime;
+};
+
 class Sprite3DMirrorTest : public Sprite3DTestDemo
 {
 public:
@@ -683,6 +683,32 @@ void ValueTest::onEnter()
     Value v11(createValueMapIntKey());
     CCASSERT(v11.getType() == Value::Type::INT_KEY_MAP, "");
     CCASSERT(!v11.isNull(), "");
+
+    // short strings are stored in the value, long ones are shared by the copies
+    Value shortString(std::string(15, 'a'));
+    Value longString(std::string(16, 'b'));
+    Value longStringCopy = longString;
+    CCASSERT(shortString.asString() == std::string(15, 'a'), "");
+    CCASSERT(longStringCopy == longString && longStringCopy.asString() == std::string(16, 'b'), "");
+    longStringCopy = "c";
+    CCASSERT(longString.asString() == std::string(16, 'b'), "");
+    CCASSERT(Value("42").asInt() == 42 && !Value("false").asBool(), "");
+
+    // the containers are copied on write
+    Value v12 = v10;
+    v12.asValueMap()["ddd"] = v2;
+    CCASSERT(v10.asValueMap().size() == 3 && v12.asValueMap().size() == 4, "");
+
+    // the copies made once a reference was given out don't share it
+    ValueMap& map = v10.asValueMap();
+    Value v13 = v10;
+    map["eee"] = v2;
+    CCASSERT(v13.asValueMap().size() == 3 && v10.asValueMap().size() == 4, "");
+
+    // a value can be assigned an element of its own container
+    Value v14(createValueVector());
+    v14 = v14.asValueVector()[1];
+    CCASSERT(v14.getType() == Value::Type::INTEGER && v14.asInt() == 100, "");
 }
 
 std::string ValueTest::subtitle() const
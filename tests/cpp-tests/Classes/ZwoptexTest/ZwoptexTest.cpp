@@ -1,7 +1,9 @@
 #include "ZwoptexTest.h"
 #include "../testResource.h"
 
-#define MAX_LAYER    1
+#include <chrono>
+
+#define MAX_LAYER    2
 
 static int sceneIdx = -1;
 
@@ -14,6 +16,7 @@ Layer* createZwoptexLayer(int nIndex)
     switch(nIndex)
     {
     case 0: return new ZwoptexGenericTest();
+    case 1: return new ZwoptexAsyncTest();
     }
 
     return nullptr;
@@ -215,3 +218,118 @@ void ZwoptexTestScene::runThisTest()
 
     Director::getInstance()->replaceScene(this);
 }
+
+//------------------------------------------------------------------
+//
+// ZwoptexAsyncTest
+//
+//------------------------------------------------------------------
+ZwoptexAsyncTest::ZwoptexAsyncTest()
+: _sprite(nullptr)
+, _info(nullptr)
+, _pendingSheets(0)
+, _frameIndex(0)
+{
+}
+
+void ZwoptexAsyncTest::onEnter()
+{
+    ZwoptexTest::onEnter();
+
+    auto s = Director::getInstance()->getWinSize();
+
+    _info = Label::createWithTTF("loading...", "fonts/arial.ttf", 12);
+    _info->setPosition(Vec2(s.width/2, s.height/2 - 80));
+    addChild(_info);
+
+    for (int i = 1; i <= 14; ++i)
+    {
+        char name[32] = {0};
+        sprintf(name, "grossini_dance_%02d.png", i);
+        _frames.push_back(SpriteFrameCache::Handle(name));
+    }
+
+    // the sheets are parsed and their textures are decoded by the workers
+    // the test is retained until they are loaded, in case it is left before
+    auto cache = SpriteFrameCache::getInstance();
+    auto callback = [this](bool loaded) {
+        sheetLoaded(loaded);
+        release();
+    };
+    _pendingSheets = 2;
+    retain();
+    cache->addSpriteFramesWithFileAsync("zwoptex/grossini.plist", callback);
+    retain();
+    cache->addSpriteFramesWithFileAsync("zwoptex/grossini-generic.plist", callback);
+}
+
+void ZwoptexAsyncTest::sheetLoaded(bool loaded)
+{
+    if (!loaded)
+    {
+        _info->setString("couldn't load the sheets");
+        _pendingSheets = -1;
+        return;
+    }
+    if (_pendingSheets < 0 || --_pendingSheets > 0)
+        return;
+
+    auto cache = SpriteFrameCache::getInstance();
+    auto s = Director::getInstance()->getWinSize();
+
+    _sprite = Sprite::createWithSpriteFrame(cache->getSpriteFrame(_frames[0]));
+    _sprite->setPosition(Vec2(s.width/2 - 80, s.height/2));
+    addChild(_sprite);
+
+    auto generic = Sprite::createWithSpriteFrameName("grossini_dance_generic_01.png");
+    generic->setPosition(Vec2(s.width/2 + 80, s.height/2));
+    addChild(generic);
+
+    // the handles only look the names up again when the cache changes
+    const int lookups = 100000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < lookups; ++i)
+    {
+        cache->getSpriteFrameByName(_frames[i % _frames.size()].name);
+    }
+    auto byName = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < lookups; ++i)
+    {
+        cache->getSpriteFrame(_frames[i % _frames.size()]);
+    }
+    auto byHandle = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    char info[256] = {0};
+    snprintf(info, sizeof(info), "sheets: %d KB, %d KB\n%d lookups: %.2f ms by name, %.2f ms by handle",
+             (int)(cache->getSpriteSheetMemory("zwoptex/grossini.plist") / 1024),
+             (int)(cache->getSpriteSheetMemory("zwoptex/grossini-generic.plist") / 1024),
+             lookups, byName, byHandle);
+    _info->setString(info);
+
+    schedule(CC_SCHEDULE_SELECTOR(ZwoptexAsyncTest::nextFrame), 0.1f);
+}
+
+void ZwoptexAsyncTest::nextFrame(float dt)
+{
+    _frameIndex = (_frameIndex + 1) % _frames.size();
+    _sprite->setSpriteFrame(SpriteFrameCache::getInstance()->getSpriteFrame(_frames[_frameIndex]));
+}
+
+ZwoptexAsyncTest::~ZwoptexAsyncTest()
+{
+    auto cache = SpriteFrameCache::getInstance();
+    cache->removeSpriteFramesFromFile("zwoptex/grossini.plist");
+    cache->removeSpriteFramesFromFile("zwoptex/grossini-generic.plist");
+}
+
+std::string ZwoptexAsyncTest::title() const
+{
+    return "Zwoptex Async Loading";
+}
+
+std::string ZwoptexAsyncTest::subtitle() const
+{
+    return "Sheets loaded by the workers, frames looked up by handle";
+}
@@ -34,6 +34,26 @@ protected:
     int counter;
 };
 
+class ZwoptexAsyncTest : public ZwoptexTest
+{
+public:
+    ZwoptexAsyncTest();
+    ~ZwoptexAsyncTest();
+    virtual void onEnter() override;
+    void sheetLoaded(bool loaded);
+    void nextFrame(float dt);
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+protected:
+    Sprite* _sprite;
+    Label* _info;
+    int _pendingSheets;
+    int _frameIndex;
+    std::vector<SpriteFrameCache::Handle> _frames;
+};
+
 class ZwoptexTestScene : public TestScene
 {
 public:
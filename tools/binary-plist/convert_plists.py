@@ -0,0 +1,160 @@
+#!/usr/bin/python
+# ----------------------------------------------------------------------------
+# convert the XML plists of a game to their binary form, see cocos/base/CCBinaryValue.h
+#
+# Copyright 2014 (C) Chukong Technologies Inc.
+#
+# License: MIT
+# ----------------------------------------------------------------------------
+'''
+Converts XML plists to the binary form read by FileUtils::getValueMapFromFile.
+
+The binary file keeps the name of the plist: FileUtils detects the binary form by its magic,
+so the code that loads the plists doesn't change.
+
+Layout, little endian:
+    header   magic "CCBV", version, string count, size of the strings, size of the tree  (20 bytes)
+    strings  the keys and the strings: length (uint32) then the UTF-8 bytes, not terminated
+    tree     the root value, each value is its type (uint8) followed by its content
+
+Like the XML loader, <date> and <data> values are skipped, <real> values are doubles and
+the <integer> values that don't fit in 32 bits are stored as doubles.
+'''
+
+import os
+import plistlib
+import struct
+import sys
+
+from argparse import ArgumentParser
+
+MAGIC = b'CCBV'
+VERSION = 1
+HEADER_FORMAT = '<4sIIII'
+
+try:
+    string_types = (str, unicode)
+    integer_types = (int, long)
+except NameError:
+    # python 3
+    string_types = (str,)
+    integer_types = (int,)
+
+# Value::Type
+TYPE_INTEGER = 2
+TYPE_DOUBLE = 4
+TYPE_BOOLEAN = 5
+TYPE_STRING = 6
+TYPE_VECTOR = 7
+TYPE_MAP = 8
+
+
+class Writer(object):
+    def __init__(self):
+        self.strings = {}
+        self.string_bytes = bytearray()
+        self.tree = bytearray()
+
+    def write_string(self, value):
+        index = self.strings.get(value)
+        if index is None:
+            index = len(self.strings)
+            self.strings[value] = index
+            encoded = value if isinstance(value, bytes) else value.encode('utf-8')
+            self.string_bytes += struct.pack('<I', len(encoded)) + encoded
+        self.tree += struct.pack('<I', index)
+
+    def write_value(self, value):
+        # bool first, it is an int for python
+        if isinstance(value, bool):
+            self.tree += struct.pack('<BB', TYPE_BOOLEAN, 1 if value else 0)
+        elif isinstance(value, integer_types) and -2**31 <= value < 2**31:
+            self.tree += struct.pack('<Bi', TYPE_INTEGER, value)
+        elif isinstance(value, integer_types + (float,)):
+            self.tree += struct.pack('<Bd', TYPE_DOUBLE, float(value))
+        elif isinstance(value, string_types):
+            self.tree += struct.pack('<B', TYPE_STRING)
+            self.write_string(value)
+        elif isinstance(value, (list, tuple)):
+            values = [v for v in value if is_supported(v)]
+            self.tree += struct.pack('<BI', TYPE_VECTOR, len(values))
+            for v in values:
+                self.write_value(v)
+        elif isinstance(value, dict):
+            items = [(k, v) for k, v in value.items() if is_supported(v)]
+            self.tree += struct.pack('<BI', TYPE_MAP, len(items))
+            for k, v in items:
+                self.write_string(k)
+                self.write_value(v)
+        else:
+            raise Exception('unsupported value %r' % (value,))
+
+    def to_bytes(self):
+        header = struct.pack(HEADER_FORMAT, MAGIC, VERSION, len(self.strings), len(self.string_bytes), len(self.tree))
+        return header + bytes(self.string_bytes) + bytes(self.tree)
+
+
+def is_supported(value):
+    return isinstance(value, (bool, float, list, tuple, dict) + integer_types + string_types)
+
+
+def convert(data):
+    if hasattr(plistlib, 'loads'):
+        root = plistlib.loads(data, fmt=plistlib.FMT_XML)
+    else:
+        root = plistlib.readPlistFromString(data)
+    writer = Writer()
+    writer.write_value(root)
+    return writer.to_bytes()
+
+
+def is_xml_plist(data):
+    return data.lstrip()[:5] in (b'<?xml', b'<!DOC', b'<plis')
+
+
+def convert_file(input_path, output_path):
+    with open(input_path, 'rb') as f:
+        data = f.read()
+
+    if data[:len(MAGIC)] == MAGIC:
+        print('%s: already converted' % input_path)
+        converted = data
+    elif not is_xml_plist(data):
+        print('%s: not an XML plist, copied' % input_path)
+        converted = data
+    else:
+        converted = convert(data)
+        print('%s: %d -> %d bytes' % (input_path, len(data), len(converted)))
+
+    if input_path != output_path or converted is not data:
+        parent = os.path.dirname(output_path)
+        if parent and not os.path.isdir(parent):
+            os.makedirs(parent)
+        with open(output_path, 'wb') as f:
+            f.write(converted)
+
+
+def convert_dir(input_dir, output_dir):
+    for root, dirs, names in os.walk(input_dir):
+        dirs.sort()
+        for name in sorted(names):
+            if not name.lower().endswith('.plist'):
+                continue
+            path = os.path.join(root, name)
+            convert_file(path, os.path.join(output_dir, os.path.relpath(path, input_dir)))
+
+
+if __name__ == '__main__':
+    parser = ArgumentParser(description='Convert XML plists to the cocos2d-x binary form.')
+    parser.add_argument('input', help='A plist, or a directory whose .plist files are converted.')
+    parser.add_argument('output', nargs='?', help='The file or directory to write. Default: convert in place.')
+    args = parser.parse_args()
+
+    output = args.output or args.input
+    if os.path.isdir(args.input):
+        convert_dir(args.input, output)
+    elif os.path.isfile(args.input):
+        convert_file(args.input, output)
+    else:
+        print('%s does not exist' % args.input)
+        sys.exit(1)
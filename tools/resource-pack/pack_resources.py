@@ -0,0 +1,145 @@
+#!/usr/bin/python
+# ----------------------------------------------------------------------------
+# pack the resources of a game into one file, see cocos/platform/CCResourcePack.h
+#
+# Copyright 2014 (C) Chukong Technologies Inc.
+#
+# License: MIT
+# ----------------------------------------------------------------------------
+'''
+Packs the files of a directory into a resource pack.
+
+A pack mounted with FileUtils::mountResourcePack() is searched like a search path:
+"Images/grossini.png" is found in the pack if the directory contained Images/grossini.png.
+
+Layout, little endian:
+    header   magic "CCPK", version, entry count, alignment,
+             offset of the index, offset and size of the names, reserved  (48 bytes)
+    index    one entry per file, sorted by the hash of the name:
+             hash, name offset, name length, offset, size, original size,
+             compression, reserved  (48 bytes)
+    names    the relative paths of the files, '/' separated, not terminated
+    content  the files, each one starting on a multiple of the alignment
+'''
+
+import os
+import struct
+import sys
+import zlib
+
+from argparse import ArgumentParser
+
+MAGIC = b'CCPK'
+VERSION = 1
+HEADER_FORMAT = '<4sIIIQQQQ'
+ENTRY_FORMAT = '<QIIQQQII'
+
+COMPRESSION_NONE = 0
+COMPRESSION_ZLIB = 1
+
+# already compressed, zlib wouldn't save anything
+STORED_EXTENSIONS = ('.png', '.jpg', '.jpeg', '.webp', '.pvr.ccz', '.pkm', '.mp3', '.ogg', '.wav', '.caf', '.m4a', '.zip')
+
+
+def fnv1a_64(data):
+    h = 14695981039346656037
+    for c in bytearray(data):
+        h ^= c
+        h = (h * 1099511628211) & 0xFFFFFFFFFFFFFFFF
+    return h
+
+
+def align(value, alignment):
+    return (value + alignment - 1) // alignment * alignment
+
+
+def collect_files(input_dir):
+    files = []
+    for root, dirs, names in os.walk(input_dir):
+        dirs.sort()
+        for name in sorted(names):
+            if name.startswith('.'):
+                continue
+            path = os.path.join(root, name)
+            rel_path = os.path.relpath(path, input_dir).replace(os.sep, '/')
+            files.append((rel_path, path))
+    return files
+
+
+def pack(input_dir, output, alignment, compress, min_ratio):
+    files = collect_files(input_dir)
+
+    entries = []
+    names = b''
+    for rel_path, path in files:
+        name = rel_path.encode('utf-8')
+        with open(path, 'rb') as f:
+            content = f.read()
+
+        compression = COMPRESSION_NONE
+        stored = content
+        if compress and not rel_path.lower().endswith(STORED_EXTENSIONS):
+            deflated = zlib.compress(content, 9)
+            if len(deflated) < len(content) * min_ratio:
+                compression = COMPRESSION_ZLIB
+                stored = deflated
+
+        entries.append({
+            'hash': fnv1a_64(name),
+            'name_offset': len(names),
+            'name_length': len(name),
+            'content': stored,
+            'original_size': len(content),
+            'compression': compression,
+        })
+        names += name
+
+    entries.sort(key=lambda e: e['hash'])
+    for a, b in zip(entries, entries[1:]):
+        if a['hash'] == b['hash']:
+            raise Exception('hash collision, rename one of the files: %s' % names[b['name_offset']:b['name_offset'] + b['name_length']])
+
+    header_size = struct.calcsize(HEADER_FORMAT)
+    index_offset = header_size
+    names_offset = index_offset + len(entries) * struct.calcsize(ENTRY_FORMAT)
+    offset = align(names_offset + len(names), alignment)
+    for entry in entries:
+        entry['offset'] = offset
+        offset = align(offset + len(entry['content']), alignment)
+
+    with open(output, 'wb') as f:
+        f.write(struct.pack(HEADER_FORMAT, MAGIC, VERSION, len(entries), alignment,
+                            index_offset, names_offset, len(names), 0))
+        for entry in entries:
+            f.write(struct.pack(ENTRY_FORMAT, entry['hash'], entry['name_offset'], entry['name_length'],
+                                entry['offset'], len(entry['content']), entry['original_size'],
+                                entry['compression'], 0))
+        f.write(names)
+        for entry in entries:
+            f.write(b'\0' * (entry['offset'] - f.tell()))
+            f.write(entry['content'])
+
+    compressed = len([e for e in entries if e['compression'] != COMPRESSION_NONE])
+    print('%s: %d files, %d compressed, %d bytes' % (output, len(entries), compressed, os.path.getsize(output)))
+
+
+if __name__ == '__main__':
+    parser = ArgumentParser(description='Pack the files of a directory into a cocos2d-x resource pack.')
+    parser.add_argument('input', help='The directory to pack, the paths in the pack are relative to it.')
+    parser.add_argument('output', help='The pack to write.')
+    parser.add_argument('-a', '--align', dest='alignment', type=int, default=16,
+                        help='The alignment of the files in the pack. Use the page size (4096) to memory map the files. Default: 16.')
+    parser.add_argument('-n', '--no-compress', dest='compress', action='store_false',
+                        help='Store all the files as is. By default the files that zlib shrinks enough are compressed.')
+    parser.add_argument('--min-ratio', dest='min_ratio', type=float, default=0.9,
+                        help='A file is compressed if its compressed size is below this ratio of its size. Default: 0.9.')
+    args = parser.parse_args()
+
+    if not os.path.isdir(args.input):
+        print('%s is not a directory' % args.input)
+        sys.exit(1)
+    if args.alignment <= 0 or (args.alignment & (args.alignment - 1)) != 0:
+        print('the alignment must be a power of two')
+        sys.exit(1)
+
+    pack(args.input, args.output, args.alignment, args.compress, args.min_ratio)